@@ -7,6 +7,9 @@
 #include <vector>
 #include "../rand.h"
 #include "../graph_utils/edge_list_graphs.h"
+#include "../graph_utils/csr_graph.h"
+#include "../threads.h"
+#include <algorithm>
 
 namespace dlib
 {
@@ -127,9 +130,122 @@ namespace dlib
         return chinese_whispers(edges, labels, num_iterations, rnd);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long chinese_whispers (
+        const csr_graph& graph,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_iterations,
+        const unsigned long num_threads,
+        dlib::rand& rnd
+    )
+    {
+        labels.resize(graph.size());
+        for (unsigned long i = 0; i < labels.size(); ++i)
+            labels[i] = i;
+        if (graph.size() == 0)
+            return 0;
+
+        // Each pass over the graph visits the nodes in random buckets, one bucket after
+        // another.  The nodes in a bucket all pick their new labels at the same time, in
+        // parallel, based on the labels as they were before the bucket started.  So the
+        // results only depend on rnd, not on num_threads.  There are enough buckets that
+        // neighboring nodes are rarely updated at the same time, which would let them
+        // swap labels rather than agree on one.
+        const unsigned long num_buckets = std::min<unsigned long>(32, graph.size());
+        thread_pool tp(num_threads > 1 ? num_threads : 0);
+        std::vector<uint32> nodes;
+        std::vector<uint64> bucket_begin;
+        std::vector<unsigned long> new_labels(graph.size());
+
+        // labels_to_counts is scratch space, which each block of nodes gets its own
+        // copy of.
+        auto find_best_label = [&](long pos, std::vector<std::pair<unsigned long, double> >& labels_to_counts)
+        {
+            const unsigned long idx = nodes[pos];
+
+            // Count how many times each label happens amongst our neighbors.
+            labels_to_counts.clear();
+            for (auto e = graph.edges_begin(idx); e != graph.edges_end(idx); ++e)
+                labels_to_counts.push_back(std::make_pair(labels[graph.neighbor(e)], graph.weight(e)));
+            std::sort(labels_to_counts.begin(), labels_to_counts.end(),
+                [](const std::pair<unsigned long,double>& a, const std::pair<unsigned long,double>& b)
+                { return a.first < b.first; });
+
+            // find the most common label, breaking ties in favor of the smallest one.
+            double best_score = -std::numeric_limits<double>::infinity();
+            unsigned long best_label = labels[idx];
+            for (unsigned long i = 0; i < labels_to_counts.size(); )
+            {
+                const unsigned long label = labels_to_counts[i].first;
+                double score = 0;
+                for (; i < labels_to_counts.size() && labels_to_counts[i].first == label; ++i)
+                    score += labels_to_counts[i].second;
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_label = label;
+                }
+            }
+            new_labels[pos] = best_label;
+        };
+
+        for (unsigned long iter = 0; iter < num_iterations; ++iter)
+        {
+            impl::random_node_buckets(tp, graph.size(), num_buckets, rnd.get_random_32bit_number(), nodes, bucket_begin);
+
+            bool changed = false;
+            for (unsigned long b = 0; b < num_buckets; ++b)
+            {
+                parallel_for_blocked(tp, bucket_begin[b], bucket_begin[b+1], [&](long begin, long end)
+                {
+                    std::vector<std::pair<unsigned long, double> > labels_to_counts;
+                    for (long pos = begin; pos < end; ++pos)
+                        find_best_label(pos, labels_to_counts);
+                });
+                for (uint64 pos = bucket_begin[b]; pos < bucket_begin[b+1]; ++pos)
+                {
+                    if (labels[nodes[pos]] != new_labels[pos])
+                    {
+                        labels[nodes[pos]] = new_labels[pos];
+                        changed = true;
+                    }
+                }
+            }
+
+            // If no node changed its label then none ever will, so we can stop early.
+            if (!changed)
+                break;
+        }
+
+        // Remap the labels into a contiguous range, in the order they first appear.
+        std::vector<unsigned long> label_remap(labels.size(), labels.size());
+        unsigned long num_clusters = 0;
+        for (unsigned long i = 0; i < labels.size(); ++i)
+        {
+            if (label_remap[labels[i]] == labels.size())
+                label_remap[labels[i]] = num_clusters++;
+            labels[i] = label_remap[labels[i]];
+        }
+
+        return num_clusters;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long chinese_whispers (
+        const csr_graph& graph,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_iterations,
+        const unsigned long num_threads
+    )
+    {
+        dlib::rand rnd;
+        return chinese_whispers(graph, labels, num_iterations, num_threads, rnd);
+    }
+
 // ----------------------------------------------------------------------------------------
 
 }
 
 #endif // DLIB_CHINESE_WHISPErS_Hh_
-
@@ -7,6 +7,7 @@
 #include "../rand.h"
 #include "../graph_utils/ordered_sample_pair_abstract.h"
 #include "../graph_utils/sample_pair_abstract.h"
+#include "../graph_utils/csr_graph_abstract.h"
 
 namespace dlib
 {
@@ -89,9 +90,55 @@ namespace dlib
               where rnd is a default initialized dlib::rand object.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    unsigned long chinese_whispers (
+        const csr_graph& graph,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_iterations,
+        const unsigned long num_threads,
+        dlib::rand& rnd
+    );
+    /*!
+        ensures
+            - This function is a version of the above chinese_whispers() routines meant
+              for very large graphs.  It interprets graph the same way they interpret
+              their edges, so a "must link" edge has a weight of infinity, and it
+              returns the clustering in #labels in the same way.  In particular:
+                - returns the number of clusters found.
+                - #labels.size() == graph.size()
+                - for all valid i:
+                    - #labels[i] == the cluster ID of the node with index i in the graph.
+                    - 0 <= #labels[i] < the number of clusters found
+            - Unlike the above routines, which update one randomly picked node at a time,
+              each pass over the graph splits the nodes into random groups and updates
+              all the nodes in a group at once, using num_threads concurrent threads of
+              processing.  The groups are picked using rnd.  Therefore, the results
+              depend only on rnd and not on num_threads.  However, they are not the same
+              as the results of the above routines.
+            - When a node's neighbors have several equally common labels, the node takes
+              the smallest of them.
+            - The algorithm performs at most num_iterations passes over the graph.  It
+              stops early if a pass doesn't change any labels, since then no later pass
+              would either.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long chinese_whispers (
+        const csr_graph& graph,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_iterations,
+        const unsigned long num_threads
+    );
+    /*!
+        ensures
+            - performs: return chinese_whispers(graph, labels, num_iterations, num_threads, rnd)
+              where rnd is a default initialized dlib::rand object.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
 
 #endif // DLIB_CHINESE_WHISPErS_ABSTRACT_Hh_
-
@@ -6,6 +6,8 @@
 #include "modularity_clustering_abstract.h"
 #include "../sparse_vector.h"
 #include "../graph_utils/edge_list_graphs.h"
+#include "../graph_utils/csr_graph.h"
+#include "../threads.h"
 #include "../matrix.h"
 #include "../rand.h"
 
@@ -507,9 +509,378 @@ namespace dlib
         return 1.0/m*Q;
     }
 
+// ----------------------------------------------------------------------------------------
+
+    inline double modularity (
+        const csr_graph& graph,
+        const std::vector<unsigned long>& labels
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(labels.size() == graph.size(),
+                    "\t double modularity()"
+                    << "\n\t Invalid inputs were given to this function"
+                    << "\n\t labels.size(): " << labels.size()
+                    << "\n\t graph.size():  " << graph.size()
+        );
+
+        // Find the sum of the weights of the edges leaving each cluster by sorting the
+        // nodes by their label.
+        std::vector<std::pair<unsigned long,double> > cluster_sums(labels.size());
+        double Q = 0;
+        double m = 0;
+        for (unsigned long i = 0; i < labels.size(); ++i)
+        {
+            double k = 0;
+            for (auto e = graph.edges_begin(i); e != graph.edges_end(i); ++e)
+            {
+                k += graph.weight(e);
+                if (labels[i] == labels[graph.neighbor(e)])
+                    Q += graph.weight(e);
+            }
+            m += k;
+            cluster_sums[i] = std::make_pair(labels[i], k);
+        }
+
+        if (m == 0)
+            return 0;
+
+        std::sort(cluster_sums.begin(), cluster_sums.end());
+        for (unsigned long i = 0; i < cluster_sums.size(); )
+        {
+            const unsigned long label = cluster_sums[i].first;
+            double sum = 0;
+            for (; i < cluster_sums.size() && cluster_sums[i].first == label; ++i)
+                sum += cluster_sums[i].second;
+            Q -= sum*sum/m;
+        }
+
+        return 1.0/m*Q;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        inline unsigned long louvain_move_nodes (
+            thread_pool& tp,
+            const csr_graph& graph,
+            const std::vector<double>& k,
+            const double m,
+            const double eps,
+            std::vector<uint32>& comm
+        )
+        /*!
+            requires
+                - k.size() == graph.size()
+                - k[i] == the sum of the weights of the edges of node i
+                - m == the sum of all the edge weights in graph, and m > 0
+            ensures
+                - This is the first phase of the Louvain method.  It starts with each node
+                  in its own community and then moves nodes into the communities of their
+                  neighbors while that increases the modularity of the graph by at least
+                  eps per pass over the nodes.
+                - returns the number of communities found.
+                - #comm.size() == graph.size()
+                - #comm[i] == the community of node i.  The communities are numbered
+                  contiguously, in the order they first appear in #comm.
+                - The results don't depend on the number of threads in tp.
+        !*/
+        {
+            const unsigned long num_nodes = graph.size();
+            comm.resize(num_nodes);
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                comm[i] = i;
+            // tot[c] is the sum of the degrees of the nodes in community c.
+            std::vector<double> tot(k);
+            std::vector<uint32> comm_size(num_nodes, 1);
+
+            // Like the parallel chinese_whispers(), the nodes are visited in random
+            // buckets and all the nodes in a bucket pick their new community at once.
+            const unsigned long num_buckets = std::min<unsigned long>(32, num_nodes);
+            dlib::rand rnd;
+            std::vector<uint32> nodes;
+            std::vector<uint64> bucket_begin;
+            std::vector<uint32> new_comm(num_nodes);
+            std::vector<double> internal(num_nodes);
+
+            // links is scratch space, which each block of nodes gets its own copy of.
+            auto find_best_community = [&](long pos, std::vector<std::pair<uint32,double> >& links)
+            {
+                const unsigned long i = nodes[pos];
+                const uint32 c = comm[i];
+
+                // Find the weight of the edges from i to each neighboring community.
+                links.clear();
+                for (auto e = graph.edges_begin(i); e != graph.edges_end(i); ++e)
+                {
+                    if (graph.neighbor(e) != i)
+                        links.push_back(std::make_pair(comm[graph.neighbor(e)], graph.weight(e)));
+                }
+                std::sort(links.begin(), links.end(),
+                    [](const std::pair<uint32,double>& a, const std::pair<uint32,double>& b)
+                    { return a.first < b.first; });
+                unsigned long num_links = 0;
+                for (unsigned long j = 0; j < links.size(); ++j)
+                {
+                    if (num_links != 0 && links[num_links-1].first == links[j].first)
+                        links[num_links-1].second += links[j].second;
+                    else
+                        links[num_links++] = links[j];
+                }
+
+                // Moving i into community d, after taking it out of c, changes the
+                // modularity by (weight from i to d - tot[d]*k[i]/m)*2/m, give or take
+                // terms that don't depend on d.
+                double best_gain = -tot[c]*k[i]/m + k[i]*k[i]/m;
+                for (unsigned long j = 0; j < num_links; ++j)
+                {
+                    if (links[j].first == c)
+                        best_gain += links[j].second;
+                }
+                uint32 best = c;
+                for (unsigned long j = 0; j < num_links; ++j)
+                {
+                    const uint32 d = links[j].first;
+                    // Two nodes on their own could otherwise swap communities rather than
+                    // join up, so only the one with the larger community number moves.
+                    if (d == c || (comm_size[c] == 1 && comm_size[d] == 1 && d > c))
+                        continue;
+                    const double gain = links[j].second - tot[d]*k[i]/m;
+                    if (gain > best_gain)
+                    {
+                        best_gain = gain;
+                        best = d;
+                    }
+                }
+                new_comm[pos] = best;
+            };
+
+            auto current_modularity = [&]()
+            {
+                parallel_for(tp, 0, num_nodes, [&](long i)
+                {
+                    double sum = 0;
+                    for (auto e = graph.edges_begin(i); e != graph.edges_end(i); ++e)
+                    {
+                        if (comm[graph.neighbor(e)] == comm[i])
+                            sum += graph.weight(e);
+                    }
+                    internal[i] = sum;
+                });
+                double Q = 0;
+                for (unsigned long i = 0; i < num_nodes; ++i)
+                    Q += internal[i] - tot[i]*tot[i]/m;
+                return Q/m;
+            };
+
+            double Q = current_modularity();
+            while (true)
+            {
+                impl::random_node_buckets(tp, num_nodes, num_buckets, rnd.get_random_32bit_number(), nodes, bucket_begin);
+
+                unsigned long num_moves = 0;
+                for (unsigned long b = 0; b < num_buckets; ++b)
+                {
+                    parallel_for_blocked(tp, bucket_begin[b], bucket_begin[b+1], [&](long begin, long end)
+                    {
+                        std::vector<std::pair<uint32,double> > links;
+                        for (long pos = begin; pos < end; ++pos)
+                            find_best_community(pos, links);
+                    });
+                    for (uint64 pos = bucket_begin[b]; pos < bucket_begin[b+1]; ++pos)
+                    {
+                        const unsigned long i = nodes[pos];
+                        if (new_comm[pos] != comm[i])
+                        {
+                            tot[comm[i]] -= k[i];
+                            --comm_size[comm[i]];
+                            comm[i] = new_comm[pos];
+                            tot[comm[i]] += k[i];
+                            ++comm_size[comm[i]];
+                            ++num_moves;
+                        }
+                    }
+                }
+
+                if (num_moves == 0)
+                    break;
+                const double new_Q = current_modularity();
+                if (new_Q - Q < eps)
+                    break;
+                Q = new_Q;
+            }
+
+            // Number the communities contiguously.
+            std::vector<uint32> comm_remap(num_nodes, num_nodes);
+            unsigned long num_comms = 0;
+            for (unsigned long i = 0; i < num_nodes; ++i)
+            {
+                if (comm_remap[comm[i]] == num_nodes)
+                    comm_remap[comm[i]] = num_comms++;
+                comm[i] = comm_remap[comm[i]];
+            }
+            return num_comms;
+        }
+
+        inline void louvain_aggregate (
+            thread_pool& tp,
+            const csr_graph& graph,
+            const std::vector<uint32>& comm,
+            const unsigned long num_comms,
+            csr_graph& result
+        )
+        /*!
+            requires
+                - comm.size() == graph.size()
+                - for all valid i:
+                    - comm[i] < num_comms
+            ensures
+                - This is the second phase of the Louvain method.  It makes #result into
+                  the graph whose nodes are the communities in comm.  That is, the weight
+                  of the edge from community a to community b in #result is the sum of the
+                  weights of the edges from nodes in a to nodes in b.  So the edges within
+                  a community become a single self loop.
+                - #result.size() == num_comms
+        !*/
+        {
+            std::vector<uint64> member_begin(num_comms+1, 0);
+            for (unsigned long i = 0; i < comm.size(); ++i)
+                ++member_begin[comm[i]+1];
+            for (unsigned long c = 0; c < num_comms; ++c)
+                member_begin[c+1] += member_begin[c];
+            std::vector<uint32> members(comm.size());
+            std::vector<uint64> next(member_begin.begin(), member_begin.end()-1);
+            for (unsigned long i = 0; i < comm.size(); ++i)
+                members[next[comm[i]]++] = i;
+
+            std::vector<std::vector<std::pair<uint32,double> > > rows(num_comms);
+            parallel_for_blocked(tp, 0, num_comms, [&](long begin, long end)
+            {
+                std::vector<std::pair<uint32,double> > links;
+                for (long c = begin; c < end; ++c)
+                {
+                    links.clear();
+                    for (uint64 j = member_begin[c]; j < member_begin[c+1]; ++j)
+                    {
+                        const unsigned long i = members[j];
+                        for (auto e = graph.edges_begin(i); e != graph.edges_end(i); ++e)
+                            links.push_back(std::make_pair(comm[graph.neighbor(e)], graph.weight(e)));
+                    }
+                    std::sort(links.begin(), links.end(),
+                        [](const std::pair<uint32,double>& a, const std::pair<uint32,double>& b)
+                        { return a.first < b.first; });
+                    for (auto& l : links)
+                    {
+                        if (rows[c].size() != 0 && rows[c].back().first == l.first)
+                            rows[c].back().second += l.second;
+                        else
+                            rows[c].push_back(l);
+                    }
+                }
+            });
+
+            std::vector<uint64> offsets(num_comms+1, 0);
+            for (unsigned long c = 0; c < num_comms; ++c)
+                offsets[c+1] = offsets[c] + rows[c].size();
+            std::vector<uint32> neighbors(offsets.back());
+            std::vector<double> weights(offsets.back());
+            parallel_for(tp, 0, num_comms, [&](long c)
+            {
+                for (unsigned long j = 0; j < rows[c].size(); ++j)
+                {
+                    neighbors[offsets[c]+j] = rows[c][j].first;
+                    weights[offsets[c]+j] = rows[c][j].second;
+                }
+                std::vector<std::pair<uint32,double> >().swap(rows[c]);
+            });
+
+            csr_graph(std::move(offsets), std::move(neighbors), std::move(weights)).swap(result);
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long louvain_cluster (
+        const csr_graph& graph,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads = 1,
+        const double eps = 1e-6
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(eps >= 0,
+                    "\t unsigned long louvain_cluster()"
+                    << "\n\t Invalid inputs were given to this function"
+                    << "\n\t eps: " << eps
+        );
+
+        labels.resize(graph.size());
+        for (unsigned long i = 0; i < labels.size(); ++i)
+            labels[i] = i;
+        if (graph.size() == 0)
+            return 0;
+
+        thread_pool tp(num_threads > 1 ? num_threads : 0);
+        csr_graph level;
+        const csr_graph* g = &graph;
+        std::vector<double> k;
+        std::vector<uint32> comm;
+        while (true)
+        {
+            k.resize(g->size());
+            parallel_for(tp, 0, g->size(), [&](long i)
+            {
+                double sum = 0;
+                for (auto e = g->edges_begin(i); e != g->edges_end(i); ++e)
+                    sum += g->weight(e);
+                k[i] = sum;
+            });
+            double m = 0;
+            for (unsigned long i = 0; i < k.size(); ++i)
+                m += k[i];
+            if (m == 0)
+                break;
+
+            const unsigned long num_comms = impl::louvain_move_nodes(tp, *g, k, m, eps, comm);
+            for (unsigned long i = 0; i < labels.size(); ++i)
+                labels[i] = comm[labels[i]];
+            if (num_comms == g->size())
+                break;
+
+            // Now cluster the graph of the communities we just found.
+            impl::louvain_aggregate(tp, *g, comm, num_comms, level);
+            g = &level;
+        }
+
+        // Number the clusters in the order they first appear in labels.
+        std::vector<unsigned long> label_remap(labels.size(), labels.size());
+        unsigned long num_clusters = 0;
+        for (unsigned long i = 0; i < labels.size(); ++i)
+        {
+            if (label_remap[labels[i]] == labels.size())
+                label_remap[labels[i]] = num_clusters++;
+            labels[i] = label_remap[labels[i]];
+        }
+        return num_clusters;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    inline unsigned long louvain_cluster (
+        const std::vector<sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads = 1,
+        const double eps = 1e-6
+    )
+    {
+        return louvain_cluster(csr_graph(edges), labels, num_threads, eps);
+    }
+
 // ----------------------------------------------------------------------------------------
 
 }
 
+
 #endif // DLIB_MODULARITY_ClUSTERING__H__
 
@@ -6,6 +6,7 @@
 #include <vector>
 #include "../graph_utils/ordered_sample_pair_abstract.h"
 #include "../graph_utils/sample_pair_abstract.h"
+#include "../graph_utils/csr_graph_abstract.h"
 
 namespace dlib
 {
@@ -117,9 +118,84 @@ namespace dlib
               above.  
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    double modularity (
+        const csr_graph& graph,
+        const std::vector<unsigned long>& labels
+    );
+    /*!
+        requires
+            - labels.size() == graph.size()
+            - for all valid e:
+                - 0 <= graph.weight(e) < std::numeric_limits<double>::infinity()
+        ensures
+            - returns the modularity of graph when it is broken into subgraphs according
+              to the contents of labels.  This is the same value the modularity()
+              routine for ordered_sample_pair objects defined above gives for the edges
+              in graph.  So if graph was made from a vector of sample_pair objects then
+              this is also the same as modularity() for those sample_pairs.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long louvain_cluster (
+        const csr_graph& graph,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads = 1,
+        const double eps = 1e-6
+    );
+    /*!
+        requires
+            - eps >= 0
+            - graph is undirected.  That is, for each edge from node i to node j there is
+              an edge from node j to node i with the same weight.  For example, this is
+              true if graph was made from a vector of sample_pair objects.
+            - for all valid e:
+                - 0 <= graph.weight(e) < std::numeric_limits<double>::infinity()
+        ensures
+            - This function performs the clustering algorithm described in the paper
+              Fast unfolding of communities in large networks by Vincent D. Blondel,
+              Jean-Loup Guillaume, Renaud Lambiotte, and Etienne Lefebvre.  Like
+              newman_cluster(), it attempts to find the labeling that maximizes
+              modularity(graph, #labels).  But it takes about linear time in the number
+              of edges rather than working with dense matrices, so it can be used on
+              graphs with hundreds of millions of edges.
+            - returns the number of clusters found.
+            - #labels.size() == graph.size()
+            - for all valid i:
+                - #labels[i] == the cluster ID of the node with index i in the graph.
+                - 0 <= #labels[i] < the number of clusters found
+                  (i.e. cluster IDs are assigned contiguously and start at 0)
+            - The algorithm alternates between moving nodes into the clusters of their
+              neighbors and merging each cluster into a single node.  It moves nodes
+              until a pass over all the nodes improves the modularity by less than eps.
+            - This function will use num_threads concurrent threads of processing.  To
+              do this, the nodes are moved in random groups whose nodes all move at the
+              same time.  The groups are chosen the same way every time, so the results
+              are deterministic and don't depend on num_threads.
+            - Nodes without any edges are each put in their own cluster.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long louvain_cluster (
+        const std::vector<sample_pair>& edges,
+        std::vector<unsigned long>& labels,
+        const unsigned long num_threads = 1,
+        const double eps = 1e-6
+    );
+    /*!
+        requires
+            - eps >= 0
+            - for all valid i:
+                - 0 <= edges[i].distance() < std::numeric_limits<double>::infinity()
+        ensures
+            - performs: return louvain_cluster(csr_graph(edges), labels, num_threads, eps)
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
 
 #endif // DLIB_MODULARITY_ClUSTERING_ABSTRACT_Hh_
-
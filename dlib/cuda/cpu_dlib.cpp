@@ -9,6 +9,7 @@
 #include "tensor_tools.h"
 #include "../image_transforms/interpolation.h"
 #include "../threads.h"
+#include "../simd/simd_check.h"
 
 namespace dlib
 {
@@ -217,6 +218,323 @@ namespace dlib
             }
         }
 
+    // ------------------------------------------------------------------------------------
+
+        void sgemm_accumulate (
+            long m,
+            long n,
+            long k,
+            float alpha,
+            const float* A,
+            long lda,
+            bool trans_a,
+            const float* B,
+            long ldb,
+            bool trans_b,
+            float* C,
+            long ldc
+        )
+        {
+            // C += alpha*op(A)*op(B), using the same conventions as packed_sgemm().
+            if (m <= 0 || n <= 0 || k <= 0 || alpha == 0)
+                return;
+
+#ifdef DLIB_USE_BLAS
+            using namespace blas_bindings;
+            cblas_gemm(CblasRowMajor, trans_a ? CblasTrans : CblasNoTrans, trans_b ? CblasTrans : CblasNoTrans,
+                m, n, k, alpha, A, lda, B, ldb, 1, C, ldc);
+#else
+            // Split the output into independent slabs of whole micro kernel tiles, along
+            // whichever dimension is larger, and let each thread run its own packed_sgemm()
+            // on one of them.  Small products aren't worth the threading overhead.
+            const double flops = 2.0*m*n*k;
+            const long max_jobs = std::max<long>(1, std::min<double>(4*default_thread_pool().num_threads_in_pool(), flops/(1<<22)));
+            const bool split_cols = n >= m;
+            const long tile = split_cols ? ma::sgemm_nr : ma::sgemm_mr;
+            const long num_tiles = ((split_cols ? n : m) + tile - 1)/tile;
+            const long num_jobs = std::min(max_jobs, num_tiles);
+
+            auto run_job = [&](long job)
+            {
+                const long begin = num_tiles*job/num_jobs*tile;
+                const long end = std::min(num_tiles*(job+1)/num_jobs*tile, split_cols ? n : m);
+                if (split_cols)
+                {
+                    packed_sgemm(m, end-begin, k, alpha, A, lda, trans_a,
+                        trans_b ? B + begin*ldb : B + begin, ldb, trans_b,
+                        C + begin, ldc);
+                }
+                else
+                {
+                    packed_sgemm(end-begin, n, k, alpha,
+                        trans_a ? A + begin : A + begin*lda, lda, trans_a,
+                        B, ldb, trans_b,
+                        C + begin*ldc, ldc);
+                }
+            };
+
+            if (num_jobs == 1)
+                run_job(0);
+            else
+                parallel_for(0, num_jobs, run_job, 1);
+#endif
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        void gemm (
+            float beta,
+            tensor& dest,
+            float alpha,
+            const tensor& lhs,
+            bool trans_lhs,
+            const tensor& rhs,
+            bool trans_rhs
+        )
+        {
+            // Each tensor is viewed as the matrix mat(t), with t.num_samples() rows.
+            const long lhs_nr = lhs.num_samples(), lhs_nc = lhs_nr == 0 ? 0 : lhs.size()/lhs_nr;
+            const long rhs_nr = rhs.num_samples(), rhs_nc = rhs_nr == 0 ? 0 : rhs.size()/rhs_nr;
+            const long m = trans_lhs ? lhs_nc : lhs_nr;
+            const long k = trans_lhs ? lhs_nr : lhs_nc;
+            const long n = trans_rhs ? rhs_nr : rhs_nc;
+            DLIB_CASSERT(dest.num_samples() == m && (long)dest.size() == m*n &&
+                         (trans_rhs ? rhs_nc : rhs_nr) == k &&
+                         !is_same_object(dest,lhs) && !is_same_object(dest,rhs),
+                    "\n\t dest.num_samples(): " << dest.num_samples()
+                    <<"\n\t dest.size():        " << dest.size()
+                    <<"\n\t m: " << m << "  n: " << n << "  k: " << k
+                    <<"\n\t trans_rhs: " << trans_rhs << "  rhs rows: " << rhs_nr << "  rhs cols: " << rhs_nc
+                    );
+
+            if (dest.size() == 0)
+                return;
+
+#ifdef DLIB_USE_BLAS
+            if (beta != 0)
+            {
+                if (trans_lhs && trans_rhs)
+                    dest = alpha * trans(mat(lhs)) * trans(mat(rhs)) + beta * mat(dest);
+                else if (!trans_lhs && trans_rhs)
+                    dest = alpha * mat(lhs) * trans(mat(rhs)) + beta * mat(dest);
+                else if (trans_lhs && !trans_rhs)
+                    dest = alpha * trans(mat(lhs)) * mat(rhs) + beta * mat(dest);
+                else
+                    dest = alpha * mat(lhs) * mat(rhs) + beta * mat(dest);
+            }
+            else
+            {
+                if (trans_lhs && trans_rhs)
+                    dest = alpha * trans(mat(lhs)) * trans(mat(rhs));
+                else if (!trans_lhs && trans_rhs)
+                    dest = alpha * mat(lhs) * trans(mat(rhs));
+                else if (trans_lhs && !trans_rhs)
+                    dest = alpha * trans(mat(lhs)) * mat(rhs);
+                else
+                    dest = alpha * mat(lhs) * mat(rhs);
+            }
+#else
+            // Without a BLAS library, use dlib's own SIMD kernel.
+            float* C;
+            if (beta == 0)
+            {
+                C = dest.host_write_only();
+                std::fill(C, C+dest.size(), 0.0f);
+            }
+            else
+            {
+                C = dest.host();
+                if (beta != 1)
+                {
+                    for (size_t i = 0; i < dest.size(); ++i)
+                        C[i] *= beta;
+                }
+            }
+
+            sgemm_accumulate(m, n, k, alpha, lhs.host(), lhs_nc, trans_lhs, rhs.host(), rhs_nc, trans_rhs, C, n);
+#endif
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        namespace
+        {
+            template <fused_activation act>
+            void bias_add_activation (
+                float* d,
+                const float* s,
+                const float* b,
+                const float* r,
+                float param,
+                long num_samples,
+                long k,
+                long plane_size
+            )
+            {
+                for (long n = 0; n < num_samples; ++n)
+                {
+                    for (long i = 0; i < k; ++i)
+                    {
+                        const float bias = b ? b[i] : 0;
+                        for (long j = 0; j < plane_size; ++j)
+                        {
+                            float v = s[j] + bias;
+                            if (r)
+                                v += r[j];
+                            switch (act)
+                            {
+                                case fused_activation::NONE: break;
+                                case fused_activation::RELU: v = std::max(v, 0.0f); break;
+                                case fused_activation::LEAKY_RELU: v = v > 0 ? v : param*v; break;
+                                case fused_activation::CLIPPED_RELU: v = std::min(std::max(v, 0.0f), param); break;
+                                case fused_activation::ELU: v = v > 0 ? v : param*(std::exp(v) - 1.0f); break;
+                            }
+                            d[j] = v;
+                        }
+                        d += plane_size;
+                        s += plane_size;
+                        if (r)
+                            r += plane_size;
+                    }
+                }
+            }
+        }
+
+        void bias_add_activation (
+            tensor& dest,
+            const tensor& src,
+            const tensor& biases,
+            const tensor& residual,
+            fused_activation act,
+            float param
+        )
+        {
+            DLIB_CASSERT(have_same_dimensions(dest, src));
+            DLIB_CASSERT(biases.size() == 0 || (long)biases.size() == src.k());
+            DLIB_CASSERT(residual.size() == 0 || have_same_dimensions(residual, src));
+
+            const float* s = src.host();
+            float* d = is_same_object(dest, src) ? dest.host() : dest.host_write_only();
+            const float* b = biases.size() != 0 ? biases.host() : nullptr;
+            const float* r = residual.size() != 0 ? residual.host() : nullptr;
+            const long plane_size = src.nr()*src.nc();
+            switch (act)
+            {
+                case fused_activation::NONE: bias_add_activation<fused_activation::NONE>(d, s, b, r, param, src.num_samples(), src.k(), plane_size); break;
+                case fused_activation::RELU: bias_add_activation<fused_activation::RELU>(d, s, b, r, param, src.num_samples(), src.k(), plane_size); break;
+                case fused_activation::LEAKY_RELU: bias_add_activation<fused_activation::LEAKY_RELU>(d, s, b, r, param, src.num_samples(), src.k(), plane_size); break;
+                case fused_activation::CLIPPED_RELU: bias_add_activation<fused_activation::CLIPPED_RELU>(d, s, b, r, param, src.num_samples(), src.k(), plane_size); break;
+                case fused_activation::ELU: bias_add_activation<fused_activation::ELU>(d, s, b, r, param, src.num_samples(), src.k(), plane_size); break;
+            }
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        void quantize_to_int8 (
+            const float* src,
+            size_t n,
+            float scale,
+            int8_t* dest
+        )
+        {
+            // dest[i] = round(src[i]/scale), saturated to [-127, 127].
+            const float inv_scale = 1/scale;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const float v = std::round(src[i]*inv_scale);
+                dest[i] = static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, v)));
+            }
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        namespace
+        {
+            inline void int8_dot4 (
+                long k,
+                const int8_t* a,
+                const int8_t* b0,
+                const int8_t* b1,
+                const int8_t* b2,
+                const int8_t* b3,
+                int32_t* c
+            )
+            {
+                // c[j] = dot(a, bj) for the 4 rows of B, sharing the loads of a.
+                long p = 0;
+                int32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+#ifdef DLIB_HAVE_AVX2
+                __m256i acc0 = _mm256_setzero_si256();
+                __m256i acc1 = _mm256_setzero_si256();
+                __m256i acc2 = _mm256_setzero_si256();
+                __m256i acc3 = _mm256_setzero_si256();
+                for (; p + 16 <= k; p += 16)
+                {
+                    // Widen to 16 bits so _mm256_madd_epi16 can form pairwise sums of
+                    // products in 32 bit lanes without overflowing.
+                    const __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a+p)));
+                    acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b0+p)))));
+                    acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b1+p)))));
+                    acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b2+p)))));
+                    acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(va, _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b3+p)))));
+                }
+                int32_t temp[8];
+                _mm256_storeu_si256((__m256i*)temp, acc0); for (auto v : temp) s0 += v;
+                _mm256_storeu_si256((__m256i*)temp, acc1); for (auto v : temp) s1 += v;
+                _mm256_storeu_si256((__m256i*)temp, acc2); for (auto v : temp) s2 += v;
+                _mm256_storeu_si256((__m256i*)temp, acc3); for (auto v : temp) s3 += v;
+#endif
+                for (; p < k; ++p)
+                {
+                    const int32_t va = a[p];
+                    s0 += va*b0[p];
+                    s1 += va*b1[p];
+                    s2 += va*b2[p];
+                    s3 += va*b3[p];
+                }
+                c[0] = s0; c[1] = s1; c[2] = s2; c[3] = s3;
+            }
+        }
+
+        void int8_gemm (
+            long m,
+            long n,
+            long k,
+            const int8_t* A,
+            const int8_t* B,
+            int32_t* C
+        )
+        {
+            // C = A*trans(B), where A is m by k, B is n by k and C is m by n, all row major.
+            // Taking B transposed makes every output element a dot product of two
+            // contiguous rows.
+            const long rows_per_job = std::max<long>(1, (1<<20)/std::max<long>(1,n*k));
+            const long num_jobs = (m + rows_per_job - 1)/rows_per_job;
+            auto run_job = [&](long job)
+            {
+                const long end = std::min(m, (job+1)*rows_per_job);
+                for (long i = job*rows_per_job; i < end; ++i)
+                {
+                    const int8_t* a = A + i*k;
+                    int32_t* c = C + i*n;
+                    long j = 0;
+                    for (; j + 4 <= n; j += 4)
+                        int8_dot4(k, a, B + j*k, B + (j+1)*k, B + (j+2)*k, B + (j+3)*k, c + j);
+                    for (; j < n; ++j)
+                    {
+                        int32_t temp[4];
+                        int8_dot4(k, a, B + j*k, B + j*k, B + j*k, B + j*k, temp);
+                        c[j] = temp[0];
+                    }
+                }
+            };
+
+            if (num_jobs == 1)
+                run_job(0);
+            else
+                parallel_for(0, num_jobs, run_job);
+        }
+
     // ------------------------------------------------------------------------------------
 
         void add(
@@ -2833,7 +3151,7 @@ namespace dlib
     // ------------------------------------------------------------------------------------
 
         void img2col(
-            matrix<float>& output,
+            float* t,
             const tensor& data,
             long n,
             long filter_nr,
@@ -2844,19 +3162,12 @@ namespace dlib
             long padding_x
         )
         {
+            // Writes the out_nr*out_nc by data.k()*filter_nr*filter_nc Toeplitz matrix for
+            // the n-th sample in data into t, in row major order.
             const auto d = data.host() + data.k()*data.nr()*data.nc()*n;
             const rectangle boundary = get_rect(data);
 
-            const long out_nr = 1+(data.nr()+2*padding_y-filter_nr)/stride_y;
-            const long out_nc = 1+(data.nc()+2*padding_x-filter_nc)/stride_x;
-
-            output.set_size(out_nr*out_nc, 
-                            data.k()*filter_nr*filter_nc);
-            DLIB_CASSERT(output.size() != 0);
-            float* t = &output(0,0);
-
             // now fill in the Toeplitz output matrix for the n-th sample in data.  
-            long cnt = 0;
             const long max_r = data.nr() + padding_y-(filter_nr-1);
             const long max_c = data.nc() + padding_x-(filter_nc-1);
             for (long r = -padding_y; r < max_r; r+=stride_y)
@@ -2869,7 +3180,6 @@ namespace dlib
                         {
                             for (long x = 0; x < filter_nc; ++x)
                             {
-                                DLIB_ASSERT(cnt < output.size());
                                 long xx = c+x;
                                 long yy = r+y;
                                 if (boundary.contains(xx,yy))
@@ -2877,7 +3187,6 @@ namespace dlib
                                 else
                                     *t = 0;
                                 ++t;
-                                ++cnt;
                             }
                         }
                     }
@@ -2885,6 +3194,27 @@ namespace dlib
             }
         }
 
+        void img2col(
+            matrix<float>& output,
+            const tensor& data,
+            long n,
+            long filter_nr,
+            long filter_nc,
+            long stride_y,
+            long stride_x,
+            long padding_y,
+            long padding_x
+        )
+        {
+            const long out_nr = 1+(data.nr()+2*padding_y-filter_nr)/stride_y;
+            const long out_nc = 1+(data.nc()+2*padding_x-filter_nc)/stride_x;
+
+            output.set_size(out_nr*out_nc, 
+                            data.k()*filter_nr*filter_nc);
+            DLIB_CASSERT(output.size() != 0);
+            img2col(&output(0,0), data, n, filter_nr, filter_nc, stride_y, stride_x, padding_y, padding_x);
+        }
+
         void col2img(
             const matrix<float>& output,
             tensor& data,
@@ -2949,6 +3279,19 @@ namespace dlib
             const tensor& data,
             const tensor& filters
         )
+        {
+            forward(add_to_output, output, data, filters, nullptr, false);
+        }
+
+        void tensor_conv::
+        forward (
+            const bool add_to_output,
+            tensor& output,
+            const tensor& data,
+            const tensor& filters,
+            const float* biases,
+            bool use_relu
+        )
         {
             DLIB_CASSERT(is_same_object(output,data) == false);
             DLIB_CASSERT(is_same_object(output,filters) == false);
@@ -2965,15 +3308,311 @@ namespace dlib
             DLIB_CASSERT(output.nc() == 1+(data.nc()+2*last_padding_x-filters.nc())/last_stride_x);
 
 
-            matrix<float> temp;
+            if (output.size() == 0)
+                return;
+
+            if (filters.nr() == 1 && filters.nc() == 1 && last_stride_y == 1 && last_stride_x == 1 &&
+                last_padding_y == 0 && last_padding_x == 0)
+                conv_1x1(add_to_output, output, data, filters, biases, use_relu);
+            else if (filters.nr() == 3 && filters.nc() == 3 && last_stride_y == 1 && last_stride_x == 1)
+                conv_3x3_winograd(add_to_output, output, data, filters, biases, use_relu);
+            else
+                conv_img2col(add_to_output, output, data, filters, biases, use_relu);
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        // Upper bound, in floats, on the scratch space the forward convolution algorithms
+        // use for a group of samples.  More samples per group means bigger and more
+        // efficient matrix multiplies.  The scratch space is local to each call, like the
+        // img2col matrix used to be, so a network doesn't hold on to a copy of it for
+        // every convolutional layer.
+        const size_t conv_scratch_budget = 1<<23;
+
+        // Adds the bias of an output channel to a convolution output value and applies the
+        // relu, if requested.  The convolution algorithms call this as they write each
+        // output value, so the biases and relu don't need a pass over the output of their
+        // own.
+        inline float conv_output_value (
+            float v,
+            float bias,
+            bool use_relu
+        )
+        {
+            v += bias;
+            return use_relu ? std::max(v, 0.0f) : v;
+        }
+
+        void tensor_conv::
+        conv_1x1 (
+            const bool add_to_output,
+            tensor& output,
+            const tensor& data,
+            const tensor& filters,
+            const float* biases,
+            bool use_relu
+        )
+        {
+            // A 1x1 filter with no padding or striding is a plain matrix multiply of the
+            // filters with each sample, so no img2col copy is needed.
+            const long plane_size = data.nr()*data.nc();
+            const long in_sample_size = data.k()*plane_size;
+            const long out_sample_size = output.k()*plane_size;
+            float* out = add_to_output ? output.host() : output.host_write_only();
+            if (!add_to_output)
+                std::fill(out, out + output.size(), 0.0f);
+
+            const float* d = data.host();
+            const float* f = filters.host();
             for (long n = 0; n < data.num_samples(); ++n)
             {
-                img2col(temp, data, n, filters.nr(), filters.nc(), last_stride_y, last_stride_x, last_padding_y, last_padding_x);
+                sgemm_accumulate(filters.num_samples(), plane_size, data.k(), 1,
+                    f, data.k(), false,
+                    d + n*in_sample_size, plane_size, false,
+                    out + n*out_sample_size, plane_size);
+
+                // The matrix multiply writes straight into output, so the biases and relu
+                // are applied in a separate pass over the sample, while it's still in
+                // cache.
+                if (biases || use_relu)
+                {
+                    float* o = out + n*out_sample_size;
+                    for (long k = 0; k < output.k(); ++k, o += plane_size)
+                    {
+                        const float bias = biases ? biases[k] : 0;
+                        for (long j = 0; j < plane_size; ++j)
+                            o[j] = conv_output_value(o[j], bias, use_relu);
+                    }
+                }
+            }
+        }
+
+        void tensor_conv::
+        conv_img2col (
+            const bool add_to_output,
+            tensor& output,
+            const tensor& data,
+            const tensor& filters,
+            const float* biases,
+            bool use_relu
+        )
+        {
+            // Lower a group of samples at a time into one big Toeplitz matrix so a single
+            // matrix multiply computes the outputs for all of them.
+            const long out_plane_size = output.nr()*output.nc();
+            const long filter_size = filters.k()*filters.nr()*filters.nc();
+            const long num_filters = filters.num_samples();
+            const long group_size = std::max<long>(1, std::min<long>(data.num_samples(),
+                    conv_scratch_budget/(out_plane_size*std::max(filter_size, num_filters))));
+            std::vector<float> lowered_data, products;
+
+            float* out = add_to_output ? output.host() : output.host_write_only();
+            const float* f = filters.host();
+            for (long n = 0; n < data.num_samples(); n += group_size)
+            {
+                const long num = std::min<long>(group_size, data.num_samples()-n);
+                const long cols = num*out_plane_size;
+                lowered_data.resize(cols*filter_size);
+                products.assign(num_filters*cols, 0);
+
+                parallel_for(0, num, [&](long i)
+                {
+                    img2col(&lowered_data[i*out_plane_size*filter_size], data, n+i, filters.nr(), filters.nc(),
+                        last_stride_y, last_stride_x, last_padding_y, last_padding_x);
+                });
+
+                sgemm_accumulate(num_filters, cols, filter_size, 1,
+                    f, filter_size, false,
+                    lowered_data.data(), filter_size, true,
+                    products.data(), cols);
+
+                // products holds the num_filters by num*out_plane_size result, so scatter it
+                // back into the num samples of output.
+                for (long i = 0; i < num; ++i)
+                {
+                    for (long k = 0; k < num_filters; ++k)
+                    {
+                        float* o = out + ((n+i)*num_filters + k)*out_plane_size;
+                        const float* p = &products[k*cols + i*out_plane_size];
+                        const float bias = biases ? biases[k] : 0;
+                        if (add_to_output)
+                        {
+                            for (long j = 0; j < out_plane_size; ++j)
+                                o[j] = conv_output_value(o[j] + p[j], bias, use_relu);
+                        }
+                        else if (biases || use_relu)
+                        {
+                            for (long j = 0; j < out_plane_size; ++j)
+                                o[j] = conv_output_value(p[j], bias, use_relu);
+                        }
+                        else
+                        {
+                            std::copy(p, p + out_plane_size, o);
+                        }
+                    }
+                }
+            }
+        }
+
+        void tensor_conv::
+        conv_3x3_winograd (
+            const bool add_to_output,
+            tensor& output,
+            const tensor& data,
+            const tensor& filters,
+            const float* biases,
+            bool use_relu
+        )
+        {
+            /*
+                Stride 1 3x3 convolutions are computed with the Winograd F(2x2,3x3)
+                algorithm.  Each 2x2 block of output is
+                    Y = A'*[(G*g*G') .* (B'*d*B)]*A
+                where g is a 3x3 filter and d the overlapping 4x4 tile of input.  The
+                elementwise product, summed over input channels, becomes 16 independent
+                matrix multiplies, one for each of the 4x4 transformed coordinates.  This
+                takes 16 multiplies per 2x2 output block instead of the 36 a direct
+                method needs.
+            */
+            const long K = filters.num_samples();
+            const long C = data.k();
+            const long tiles_y = (output.nr()+1)/2;
+            const long tiles_x = (output.nc()+1)/2;
+            const long tiles_per_sample = tiles_y*tiles_x;
+            const long group_size = std::max<long>(1, std::min<long>(data.num_samples(),
+                    conv_scratch_budget/(16*tiles_per_sample*std::max(C,K))));
+            std::vector<float> transformed_filters, lowered_data, products;
+
+            // U holds G*g*G' for each filter as 16 K by C matrices.
+            transformed_filters.resize(16*K*C);
+            const float* f = filters.host();
+            parallel_for(0, K, [&](long k)
+            {
+                for (long c = 0; c < C; ++c)
+                {
+                    const float* g = f + (k*C + c)*9;
+                    float t[4][3];
+                    for (long x = 0; x < 3; ++x)
+                    {
+                        t[0][x] = g[x];
+                        t[1][x] = 0.5f*(g[x] + g[3+x] + g[6+x]);
+                        t[2][x] = 0.5f*(g[x] - g[3+x] + g[6+x]);
+                        t[3][x] = g[6+x];
+                    }
+                    float* u = &transformed_filters[k*C + c];
+                    for (long y = 0; y < 4; ++y)
+                    {
+                        u[(4*y+0)*K*C] = t[y][0];
+                        u[(4*y+1)*K*C] = 0.5f*(t[y][0] + t[y][1] + t[y][2]);
+                        u[(4*y+2)*K*C] = 0.5f*(t[y][0] - t[y][1] + t[y][2]);
+                        u[(4*y+3)*K*C] = t[y][2];
+                    }
+                }
+            });
+
+            const float* d = data.host();
+            float* out = add_to_output ? output.host() : output.host_write_only();
+            for (long n = 0; n < data.num_samples(); n += group_size)
+            {
+                const long num = std::min<long>(group_size, data.num_samples()-n);
+                const long T = num*tiles_per_sample;
+
+                // V holds B'*d*B for each input tile as 16 C by T matrices.
+                lowered_data.resize(16*C*T);
+                parallel_for(0, num*C, [&](long i)
+                {
+                    const long s = i/C;
+                    const long c = i%C;
+                    const float* plane = d + ((n+s)*C + c)*data.nr()*data.nc();
+                    float* v = &lowered_data[c*T + s*tiles_per_sample];
+                    for (long ty = 0; ty < tiles_y; ++ty)
+                    {
+                        for (long tx = 0; tx < tiles_x; ++tx, ++v)
+                        {
+                            const long top = 2*ty - last_padding_y;
+                            const long left = 2*tx - last_padding_x;
+                            float tile[4][4];
+                            for (long y = 0; y < 4; ++y)
+                            {
+                                for (long x = 0; x < 4; ++x)
+                                {
+                                    const long yy = top+y;
+                                    const long xx = left+x;
+                                    if (0 <= yy && yy < data.nr() && 0 <= xx && xx < data.nc())
+                                        tile[y][x] = plane[yy*data.nc() + xx];
+                                    else
+                                        tile[y][x] = 0;
+                                }
+                            }
+
+                            float t[4][4];
+                            for (long x = 0; x < 4; ++x)
+                            {
+                                t[0][x] = tile[0][x] - tile[2][x];
+                                t[1][x] = tile[1][x] + tile[2][x];
+                                t[2][x] = tile[2][x] - tile[1][x];
+                                t[3][x] = tile[1][x] - tile[3][x];
+                            }
+                            for (long y = 0; y < 4; ++y)
+                            {
+                                v[(4*y+0)*C*T] = t[y][0] - t[y][2];
+                                v[(4*y+1)*C*T] = t[y][1] + t[y][2];
+                                v[(4*y+2)*C*T] = t[y][2] - t[y][1];
+                                v[(4*y+3)*C*T] = t[y][1] - t[y][3];
+                            }
+                        }
+                    }
+                });
 
-                if (add_to_output)
-                    output.add_to_sample(n, mat(filters)*trans(temp));
-                else 
-                    output.set_sample(n, mat(filters)*trans(temp));
+                // M = U*V for each of the 16 transformed coordinates.
+                products.assign(16*K*T, 0);
+                for (long xi = 0; xi < 16; ++xi)
+                {
+                    sgemm_accumulate(K, T, C, 1,
+                        &transformed_filters[xi*K*C], C, false,
+                        &lowered_data[xi*C*T], T, false,
+                        &products[xi*K*T], T);
+                }
+
+                // Finally, each 2x2 block of output is A'*M*A.
+                parallel_for(0, num*K, [&](long i)
+                {
+                    const long s = i/K;
+                    const long k = i%K;
+                    float* o = out + ((n+s)*K + k)*output.nr()*output.nc();
+                    const float* m = &products[k*T + s*tiles_per_sample];
+                    const float bias = biases ? biases[k] : 0;
+                    for (long ty = 0; ty < tiles_y; ++ty)
+                    {
+                        for (long tx = 0; tx < tiles_x; ++tx, ++m)
+                        {
+                            float t[2][4];
+                            for (long x = 0; x < 4; ++x)
+                            {
+                                t[0][x] = m[x*K*T] + m[(4+x)*K*T] + m[(8+x)*K*T];
+                                t[1][x] = m[(4+x)*K*T] - m[(8+x)*K*T] - m[(12+x)*K*T];
+                            }
+                            for (long y = 0; y < 2 && 2*ty+y < output.nr(); ++y)
+                            {
+                                float* orow = o + (2*ty+y)*output.nc() + 2*tx;
+                                const float y0 = t[y][0] + t[y][1] + t[y][2];
+                                const float y1 = t[y][1] - t[y][2] - t[y][3];
+                                if (add_to_output)
+                                {
+                                    orow[0] = conv_output_value(orow[0] + y0, bias, use_relu);
+                                    if (2*tx+1 < output.nc())
+                                        orow[1] = conv_output_value(orow[1] + y1, bias, use_relu);
+                                }
+                                else
+                                {
+                                    orow[0] = conv_output_value(y0, bias, use_relu);
+                                    if (2*tx+1 < output.nc())
+                                        orow[1] = conv_output_value(y1, bias, use_relu);
+                                }
+                            }
+                        }
+                    }
+                });
             }
         }
 
@@ -2987,9 +3626,11 @@ namespace dlib
         )
         {
             DLIB_CASSERT(filters.num_samples() == biases.k());
-            (*this)(add_to_output, output,data,filters);
-            tt::add(1, output, 1, biases);
-            if (use_relu) tt::relu(output, output);
+            output.set_size(data.num_samples(),
+                            filters.num_samples(),
+                            1+(data.nr()+2*last_padding_y-filters.nr())/last_stride_y,
+                            1+(data.nc()+2*last_padding_x-filters.nc())/last_stride_x);
+            forward(add_to_output, output, data, filters, biases.host(), use_relu);
         }
 
         void tensor_conv::operator() (
@@ -3002,9 +3643,7 @@ namespace dlib
         )
         {
             DLIB_CASSERT(filters.num_samples() == biases.k());
-            (*this)(add_to_output, output, data, filters);
-            tt::add(1, output, 1, biases);
-            if (use_relu) tt::relu(output, output);
+            forward(add_to_output, output, data, filters, biases.host(), use_relu);
         }
 
 
@@ -3177,6 +3816,212 @@ namespace dlib
             }
         }
 
+    // ------------------------------------------------------------------------------------
+
+        namespace
+        {
+            // Block sizes used by the streaming attention kernels.  A block of query rows
+            // is compared against a block of key rows at a time so only a
+            // attention_query_block x attention_key_block tile of the score matrix is ever
+            // held in memory.
+            const long attention_query_block = 32;
+            const long attention_key_block = 64;
+
+            inline float attention_dot(const float* a, const float* b, long n)
+            {
+                float sum = 0;
+                for (long i = 0; i < n; ++i)
+                    sum += a[i]*b[i];
+                return sum;
+            }
+        }
+
+        void scaled_dot_product_attention(
+            resizable_tensor& dest,
+            resizable_tensor& softmax_stats,
+            const tensor& qkv,
+            long num_heads,
+            bool causal
+        )
+        {
+            DLIB_CASSERT(num_heads > 0 && qkv.nc() % (3*num_heads) == 0,
+                "\n\t qkv.nc():    " << qkv.nc() <<
+                "\n\t num_heads:  " << num_heads);
+
+            const long nr = qkv.nr();
+            const long d_model = qkv.nc()/3;
+            const long d_head = d_model/num_heads;
+            const long num_planes = qkv.num_samples()*qkv.k();
+            const float scale = 1.0f/std::sqrt(static_cast<float>(d_head));
+
+            dest.set_size(qkv.num_samples(), qkv.k(), nr, d_model);
+            softmax_stats.set_size(num_planes*num_heads, nr);
+
+            const float* in = qkv.host();
+            float* out = dest.host_write_only();
+            float* stats = softmax_stats.host_write_only();
+
+            parallel_for(0, num_planes*num_heads, [&](long task)
+            {
+                const long plane = task/num_heads;
+                const long h = task%num_heads;
+                const float* q = in + plane*nr*3*d_model + h*d_head;
+                const float* k = q + d_model;
+                const float* v = q + 2*d_model;
+                float* o = out + plane*nr*d_model + h*d_head;
+                float* lse = stats + task*nr;
+
+                std::vector<float> scores(attention_query_block*attention_key_block);
+                std::vector<float> acc(attention_query_block*d_head);
+                float row_max[attention_query_block];
+                float row_sum[attention_query_block];
+
+                for (long q0 = 0; q0 < nr; q0 += attention_query_block)
+                {
+                    const long qn = std::min(attention_query_block, nr - q0);
+                    std::fill(acc.begin(), acc.end(), 0.0f);
+                    std::fill(row_max, row_max + qn, -std::numeric_limits<float>::infinity());
+                    std::fill(row_sum, row_sum + qn, 0.0f);
+
+                    const long key_end = causal ? q0 + qn : nr;
+                    for (long k0 = 0; k0 < key_end; k0 += attention_key_block)
+                    {
+                        const long kn = std::min(attention_key_block, key_end - k0);
+                        for (long i = 0; i < qn; ++i)
+                        {
+                            const float* qi = q + (q0+i)*3*d_model;
+                            float* s = &scores[i*attention_key_block];
+                            // keys past the query position are masked out in causal mode
+                            const long valid = causal ? std::min(kn, q0 + i - k0 + 1) : kn;
+                            float blk_max = -std::numeric_limits<float>::infinity();
+                            for (long j = 0; j < valid; ++j)
+                            {
+                                s[j] = scale*attention_dot(qi, k + (k0+j)*3*d_model, d_head);
+                                blk_max = std::max(blk_max, s[j]);
+                            }
+                            if (valid <= 0)
+                                continue;
+
+                            // Rescale what has been accumulated so far to the new running
+                            // maximum and fold this block into the running softmax.
+                            const float new_max = std::max(row_max[i], blk_max);
+                            const float alpha = std::exp(row_max[i] - new_max);
+                            float* a = &acc[i*d_head];
+                            row_sum[i] *= alpha;
+                            for (long c = 0; c < d_head; ++c)
+                                a[c] *= alpha;
+                            for (long j = 0; j < valid; ++j)
+                            {
+                                const float pij = std::exp(s[j] - new_max);
+                                row_sum[i] += pij;
+                                const float* vj = v + (k0+j)*3*d_model;
+                                for (long c = 0; c < d_head; ++c)
+                                    a[c] += pij*vj[c];
+                            }
+                            row_max[i] = new_max;
+                        }
+                    }
+
+                    for (long i = 0; i < qn; ++i)
+                    {
+                        const float* a = &acc[i*d_head];
+                        float* oi = o + (q0+i)*d_model;
+                        const float inv_sum = 1.0f/row_sum[i];
+                        for (long c = 0; c < d_head; ++c)
+                            oi[c] = a[c]*inv_sum;
+                        lse[q0+i] = row_max[i] + std::log(row_sum[i]);
+                    }
+                }
+            });
+        }
+
+        void scaled_dot_product_attention_gradient(
+            tensor& qkv_grad,
+            const tensor& gradient_input,
+            const tensor& qkv,
+            const tensor& dest,
+            const tensor& softmax_stats,
+            long num_heads,
+            bool causal
+        )
+        {
+            DLIB_CASSERT(have_same_dimensions(qkv, qkv_grad));
+            DLIB_CASSERT(have_same_dimensions(gradient_input, dest));
+            DLIB_CASSERT(num_heads > 0 && qkv.nc() % (3*num_heads) == 0);
+            DLIB_CASSERT(dest.nc()*3 == qkv.nc() && dest.nr() == qkv.nr());
+            DLIB_CASSERT(softmax_stats.size() == (size_t)(qkv.num_samples()*qkv.k()*num_heads*qkv.nr()));
+
+            const long nr = qkv.nr();
+            const long d_model = qkv.nc()/3;
+            const long d_head = d_model/num_heads;
+            const long num_planes = qkv.num_samples()*qkv.k();
+            const float scale = 1.0f/std::sqrt(static_cast<float>(d_head));
+
+            const float* in = qkv.host();
+            const float* out = dest.host();
+            const float* gi = gradient_input.host();
+            const float* stats = softmax_stats.host();
+            float* grad = qkv_grad.host();
+
+            parallel_for(0, num_planes*num_heads, [&](long task)
+            {
+                const long plane = task/num_heads;
+                const long h = task%num_heads;
+                const long offset = plane*nr*3*d_model + h*d_head;
+                const float* q = in + offset;
+                const float* k = q + d_model;
+                const float* v = q + 2*d_model;
+                float* dq = grad + offset;
+                float* dk = dq + d_model;
+                float* dv = dq + 2*d_model;
+                const float* o = out + plane*nr*d_model + h*d_head;
+                const float* go = gi + plane*nr*d_model + h*d_head;
+                const float* lse = stats + task*nr;
+
+                // delta(i) = dot(dO(i), O(i)) is the term subtracted from each row of
+                // dP when back propagating through the softmax.
+                std::vector<float> delta(nr);
+                for (long i = 0; i < nr; ++i)
+                    delta[i] = attention_dot(go + i*d_model, o + i*d_model, d_head);
+
+                for (long q0 = 0; q0 < nr; q0 += attention_query_block)
+                {
+                    const long qn = std::min(attention_query_block, nr - q0);
+                    const long key_end = causal ? q0 + qn : nr;
+                    for (long k0 = 0; k0 < key_end; k0 += attention_key_block)
+                    {
+                        const long kn = std::min(attention_key_block, key_end - k0);
+                        for (long i = 0; i < qn; ++i)
+                        {
+                            const long qi_idx = q0 + i;
+                            const float* qi = q + qi_idx*3*d_model;
+                            const float* goi = go + qi_idx*d_model;
+                            float* dqi = dq + qi_idx*3*d_model;
+                            const long valid = causal ? std::min(kn, qi_idx - k0 + 1) : kn;
+                            for (long j = 0; j < valid; ++j)
+                            {
+                                const long kj_idx = k0 + j;
+                                const float* kj = k + kj_idx*3*d_model;
+                                const float* vj = v + kj_idx*3*d_model;
+                                float* dkj = dk + kj_idx*3*d_model;
+                                float* dvj = dv + kj_idx*3*d_model;
+
+                                const float pij = std::exp(scale*attention_dot(qi, kj, d_head) - lse[qi_idx]);
+                                const float dpij = attention_dot(goi, vj, d_head);
+                                const float dsij = pij*(dpij - delta[qi_idx])*scale;
+                                for (long c = 0; c < d_head; ++c)
+                                {
+                                    dvj[c] += pij*goi[c];
+                                    dqi[c] += dsij*kj[c];
+                                    dkj[c] += dsij*qi[c];
+                                }
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
     // ------------------------------------------------------------------------------------
 
         void transpose(
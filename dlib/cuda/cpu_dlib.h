@@ -9,6 +9,9 @@
 #include "tensor.h"
 #include "../geometry/rectangle.h"
 #include "../dnn/utilities.h"
+#include "fused_activation.h"
+#include <vector>
+#include <cstdint>
 
 namespace dlib
 {
@@ -45,6 +48,41 @@ namespace dlib
             const tensor& scales
         );
 
+        void gemm (
+            float beta,
+            tensor& dest,
+            float alpha,
+            const tensor& lhs,
+            bool trans_lhs,
+            const tensor& rhs,
+            bool trans_rhs
+        );
+
+        void bias_add_activation (
+            tensor& dest,
+            const tensor& src,
+            const tensor& biases,
+            const tensor& residual,
+            fused_activation act,
+            float param
+        );
+
+        void quantize_to_int8 (
+            const float* src,
+            size_t n,
+            float scale,
+            int8_t* dest
+        );
+
+        void int8_gemm (
+            long m,
+            long n,
+            long k,
+            const int8_t* A,
+            const int8_t* B,
+            int32_t* C
+        );
+
         void add(
             float beta,
             tensor& dest,
@@ -536,6 +574,26 @@ namespace dlib
             bool scale
         );
 
+    // -----------------------------------------------------------------------------------
+
+        void scaled_dot_product_attention(
+            resizable_tensor& dest,
+            resizable_tensor& softmax_stats,
+            const tensor& qkv,
+            long num_heads,
+            bool causal
+        );
+
+        void scaled_dot_product_attention_gradient(
+            tensor& qkv_grad,
+            const tensor& gradient_input,
+            const tensor& qkv,
+            const tensor& dest,
+            const tensor& softmax_stats,
+            long num_heads,
+            bool causal
+        );
+
     // -----------------------------------------------------------------------------------
 
         void compute_act_halt_probabilities(
@@ -725,6 +783,45 @@ namespace dlib
 
         private:
 
+            void forward (
+                const bool add_to_output,
+                tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                const float* biases,
+                bool use_relu
+            );
+
+            // The forward pass picks one of these based on the filter shape and stride.
+            // They add biases[k] (if biases isn't null) to the k-th output channel and
+            // apply the relu (if use_relu is true) as they write each output value.
+            void conv_1x1 (
+                const bool add_to_output,
+                tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                const float* biases,
+                bool use_relu
+            );
+
+            void conv_3x3_winograd (
+                const bool add_to_output,
+                tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                const float* biases,
+                bool use_relu
+            );
+
+            void conv_img2col (
+                const bool add_to_output,
+                tensor& output,
+                const tensor& data,
+                const tensor& filters,
+                const float* biases,
+                bool use_relu
+            );
+
             long last_stride_y = 0;
             long last_stride_x = 0;
             long last_padding_y = 0;
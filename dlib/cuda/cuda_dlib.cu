@@ -2733,6 +2733,151 @@ namespace dlib
                 src.k(), src.nr(), src.nc(), src.device(), add_to);
         }
 
+    // ----------------------------------------------------------------------------------------
+
+        __global__ void _cuda_scaled_dot_product_attention(
+            float* out, float* stats, const float* in, size_t num_rows,
+            long nr, long d_model, long d_head, long num_heads, float scale, bool causal
+        )
+        {
+            // Each thread computes one row of one head with a streaming softmax, so no
+            // score matrix is ever stored.
+            for (auto idx : grid_stride_range(0, num_rows))
+            {
+                const long task = idx/nr;
+                const long i = idx%nr;
+                const long plane = task/num_heads;
+                const long h = task%num_heads;
+                const float* q = in + plane*nr*3*d_model + h*d_head;
+                const float* k = q + d_model;
+                const float* v = q + 2*d_model;
+                const float* qi = q + i*3*d_model;
+                float* oi = out + (plane*nr + i)*d_model + h*d_head;
+
+                for (long c = 0; c < d_head; ++c)
+                    oi[c] = 0;
+
+                float row_max = -CUDART_INF_F;
+                float row_sum = 0;
+                const long key_end = causal ? i+1 : nr;
+                for (long j = 0; j < key_end; ++j)
+                {
+                    const float* kj = k + j*3*d_model;
+                    const float* vj = v + j*3*d_model;
+                    float sij = 0;
+                    for (long c = 0; c < d_head; ++c)
+                        sij += qi[c]*kj[c];
+                    sij *= scale;
+
+                    const float new_max = fmaxf(row_max, sij);
+                    const float alpha = expf(row_max - new_max);
+                    const float pij = expf(sij - new_max);
+                    row_sum = row_sum*alpha + pij;
+                    for (long c = 0; c < d_head; ++c)
+                        oi[c] = oi[c]*alpha + pij*vj[c];
+                    row_max = new_max;
+                }
+
+                for (long c = 0; c < d_head; ++c)
+                    oi[c] /= row_sum;
+                stats[idx] = row_max + logf(row_sum);
+            }
+        }
+
+        void scaled_dot_product_attention(
+            resizable_tensor& dest,
+            resizable_tensor& softmax_stats,
+            const tensor& qkv,
+            long num_heads,
+            bool causal
+        )
+        {
+            DLIB_CASSERT(num_heads > 0 && qkv.nc() % (3*num_heads) == 0,
+                "\n\t qkv.nc():    " << qkv.nc() <<
+                "\n\t num_heads:  " << num_heads);
+
+            const long d_model = qkv.nc()/3;
+            const long d_head = d_model/num_heads;
+            const long num_planes = qkv.num_samples()*qkv.k();
+            dest.set_size(qkv.num_samples(), qkv.k(), qkv.nr(), d_model);
+            softmax_stats.set_size(num_planes*num_heads, qkv.nr());
+
+            launch_kernel(_cuda_scaled_dot_product_attention, max_jobs(softmax_stats.size()),
+                dest.device(), softmax_stats.device(), qkv.device(), softmax_stats.size(),
+                qkv.nr(), d_model, d_head, num_heads, 1.0f/std::sqrt((float)d_head), causal);
+        }
+
+        __global__ void _cuda_scaled_dot_product_attention_gradient(
+            float* grad, const float* gi, const float* in, const float* out, const float* stats,
+            size_t num_rows, long nr, long d_model, long d_head, long num_heads, float scale, bool causal
+        )
+        {
+            for (auto idx : grid_stride_range(0, num_rows))
+            {
+                const long task = idx/nr;
+                const long i = idx%nr;
+                const long plane = task/num_heads;
+                const long h = task%num_heads;
+                const long offset = plane*nr*3*d_model + h*d_head;
+                const float* q = in + offset;
+                const float* k = q + d_model;
+                const float* v = q + 2*d_model;
+                float* dk = grad + offset + d_model;
+                float* dv = grad + offset + 2*d_model;
+                const float* qi = q + i*3*d_model;
+                float* dqi = grad + offset + i*3*d_model;
+                const float* oi = out + (plane*nr + i)*d_model + h*d_head;
+                const float* goi = gi + (plane*nr + i)*d_model + h*d_head;
+
+                float delta = 0;
+                for (long c = 0; c < d_head; ++c)
+                    delta += goi[c]*oi[c];
+
+                const long key_end = causal ? i+1 : nr;
+                for (long j = 0; j < key_end; ++j)
+                {
+                    const float* kj = k + j*3*d_model;
+                    const float* vj = v + j*3*d_model;
+                    float sij = 0, dpij = 0;
+                    for (long c = 0; c < d_head; ++c)
+                    {
+                        sij += qi[c]*kj[c];
+                        dpij += goi[c]*vj[c];
+                    }
+                    const float pij = expf(scale*sij - stats[idx]);
+                    const float dsij = pij*(dpij - delta)*scale;
+                    for (long c = 0; c < d_head; ++c)
+                    {
+                        dqi[c] += dsij*kj[c];
+                        atomicAdd(dk + j*3*d_model + c, dsij*qi[c]);
+                        atomicAdd(dv + j*3*d_model + c, pij*goi[c]);
+                    }
+                }
+            }
+        }
+
+        void scaled_dot_product_attention_gradient(
+            tensor& qkv_grad,
+            const tensor& gradient_input,
+            const tensor& qkv,
+            const tensor& dest,
+            const tensor& softmax_stats,
+            long num_heads,
+            bool causal
+        )
+        {
+            DLIB_CASSERT(have_same_dimensions(qkv, qkv_grad));
+            DLIB_CASSERT(have_same_dimensions(gradient_input, dest));
+            DLIB_CASSERT(num_heads > 0 && qkv.nc() % (3*num_heads) == 0);
+
+            const long d_model = qkv.nc()/3;
+            const long d_head = d_model/num_heads;
+            launch_kernel(_cuda_scaled_dot_product_attention_gradient, max_jobs(softmax_stats.size()),
+                qkv_grad.device(), gradient_input.device(), qkv.device(), dest.device(),
+                softmax_stats.device(), softmax_stats.size(), qkv.nr(), d_model, d_head,
+                num_heads, 1.0f/std::sqrt((float)d_head), causal);
+        }
+
     // ----------------------------------------------------------------------------------------
 
         // CUDA Kernels for ACT operations
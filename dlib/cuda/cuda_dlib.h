@@ -608,6 +608,26 @@ namespace dlib
             const tensor& src
         );
 
+    // ----------------------------------------------------------------------------------------
+
+        void scaled_dot_product_attention(
+            resizable_tensor& dest,
+            resizable_tensor& softmax_stats,
+            const tensor& qkv,
+            long num_heads,
+            bool causal
+        );
+
+        void scaled_dot_product_attention_gradient(
+            tensor& qkv_grad,
+            const tensor& gradient_input,
+            const tensor& qkv,
+            const tensor& dest,
+            const tensor& softmax_stats,
+            long num_heads,
+            bool causal
+        );
+
     // ----------------------------------------------------------------------------------------
 
         void compute_act_halt_probabilities(
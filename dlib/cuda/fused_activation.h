@@ -0,0 +1,24 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_CUDA_FUSED_ACTIVATION_H
+#define DLIB_CUDA_FUSED_ACTIVATION_H
+
+namespace dlib
+{
+// ----------------------------------------------------------------------------------------
+
+    /*!
+        This enum names the activation functions that can be applied as part of another
+        operation, such as a convolution or a residual add, rather than as a separate
+        pass over the data by an activation layer.  Some of them take a parameter:
+            - LEAKY_RELU: the slope for negative inputs (leaky_relu_'s alpha)
+            - CLIPPED_RELU: the ceiling (clipped_relu_'s ceiling)
+            - ELU: elu_'s alpha
+    !*/
+    enum class fused_activation { NONE = 0, RELU = 1, LEAKY_RELU = 2, CLIPPED_RELU = 3, ELU = 4 };
+
+// ----------------------------------------------------------------------------------------
+
+} // namespace dlib
+
+#endif // DLIB_CUDA_FUSED_ACTIVATION_H
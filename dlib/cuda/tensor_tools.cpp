@@ -217,28 +217,7 @@ namespace dlib { namespace tt
 #else
         if (mode == operation_mode::CHANNEL_WISE)
         {
-            if (beta != 0)
-            {
-                if (trans_lhs && trans_rhs)
-                    dest = alpha * trans(mat(lhs)) * trans(mat(rhs)) + beta * mat(dest);
-                else if (!trans_lhs && trans_rhs)
-                    dest = alpha * mat(lhs) * trans(mat(rhs)) + beta * mat(dest);
-                else if (trans_lhs && !trans_rhs)
-                    dest = alpha * trans(mat(lhs)) * mat(rhs) + beta * mat(dest);
-                else
-                    dest = alpha * mat(lhs) * mat(rhs) + beta * mat(dest);
-            }
-            else
-            {
-                if (trans_lhs && trans_rhs)
-                    dest = alpha * trans(mat(lhs)) * trans(mat(rhs));
-                else if (!trans_lhs && trans_rhs)
-                    dest = alpha * mat(lhs) * trans(mat(rhs));
-                else if (trans_lhs && !trans_rhs)
-                    dest = alpha * trans(mat(lhs)) * mat(rhs);
-                else
-                    dest = alpha * mat(lhs) * mat(rhs);
-            }
+            cpu::gemm(beta, dest, alpha, lhs, trans_lhs, rhs, trans_rhs);
         }
         else if (mode == operation_mode::PLANE_WISE)
         {
@@ -277,28 +256,7 @@ namespace dlib { namespace tt
                     auto dest_slice = dest_is_matrix ? alias_tensor(dest_rows, dest_cols)(dest, 0) :
                         alias_tensor(dest_rows, dest_cols)(dest, (b * num_channels + c) * dest_plane_size);
 
-                    if (beta != 0)
-                    {
-                        if (trans_lhs && trans_rhs)
-                            dest_slice = alpha * trans(mat(lhs_slice)) * trans(mat(rhs_slice)) + beta * mat(dest_slice);
-                        else if (!trans_lhs && trans_rhs)
-                            dest_slice = alpha * mat(lhs_slice) * trans(mat(rhs_slice)) + beta * mat(dest_slice);
-                        else if (trans_lhs && !trans_rhs)
-                            dest_slice = alpha * trans(mat(lhs_slice)) * mat(rhs_slice) + beta * mat(dest_slice);
-                        else
-                            dest_slice = alpha * mat(lhs_slice) * mat(rhs_slice) + beta * mat(dest_slice);
-                    }
-                    else
-                    {
-                        if (trans_lhs && trans_rhs)
-                            dest_slice = alpha * trans(mat(lhs_slice)) * trans(mat(rhs_slice));
-                        else if (!trans_lhs && trans_rhs)
-                            dest_slice = alpha * mat(lhs_slice) * trans(mat(rhs_slice));
-                        else if (trans_lhs && !trans_rhs)
-                            dest_slice = alpha * trans(mat(lhs_slice)) * mat(rhs_slice);
-                        else
-                            dest_slice = alpha * mat(lhs_slice) * mat(rhs_slice);
-                    }
+                    cpu::gemm(beta, dest_slice, alpha, lhs_slice.get(), trans_lhs, rhs_slice.get(), trans_rhs);
                 }
             }
         }
@@ -995,6 +953,36 @@ namespace dlib { namespace tt
 
 // ----------------------------------------------------------------------------------------
 
+    void bias_add_activation (
+        tensor& dest,
+        const tensor& src,
+        const tensor& biases,
+        const tensor& residual,
+        fused_activation act,
+        float param
+    )
+    {
+#ifdef DLIB_USE_CUDA
+        // There is no fused CUDA kernel, so compose the existing ones in place.
+        if (!is_same_object(dest, src))
+            memcpy(dest, src);
+        if (biases.size() != 0)
+            add(1, dest, 1, alias_tensor(1, biases.size())(biases));
+        if (residual.size() != 0)
+            add(dest, dest, residual);
+        switch (act)
+        {
+            case fused_activation::NONE: break;
+            case fused_activation::RELU: relu(dest, dest); break;
+            case fused_activation::LEAKY_RELU: leaky_relu(dest, dest, param); break;
+            case fused_activation::CLIPPED_RELU: clipped_relu(dest, dest, param); break;
+            case fused_activation::ELU: elu(dest, dest, param); break;
+        }
+#else
+        cpu::bias_add_activation(dest, src, biases, residual, act, param);
+#endif
+    }
+
     void relu (
         tensor& dest,
         const tensor& src
@@ -1412,6 +1400,40 @@ namespace dlib { namespace tt
 #endif
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void scaled_dot_product_attention(
+        resizable_tensor& dest,
+        resizable_tensor& softmax_stats,
+        const tensor& qkv,
+        long num_heads,
+        bool causal
+    )
+    {
+#ifdef DLIB_USE_CUDA
+        cuda::scaled_dot_product_attention(dest, softmax_stats, qkv, num_heads, causal);
+#else
+        cpu::scaled_dot_product_attention(dest, softmax_stats, qkv, num_heads, causal);
+#endif
+    }
+
+    void scaled_dot_product_attention_gradient(
+        tensor& qkv_grad,
+        const tensor& gradient_input,
+        const tensor& qkv,
+        const tensor& dest,
+        const tensor& softmax_stats,
+        long num_heads,
+        bool causal
+    )
+    {
+#ifdef DLIB_USE_CUDA
+        cuda::scaled_dot_product_attention_gradient(qkv_grad, gradient_input, qkv, dest, softmax_stats, num_heads, causal);
+#else
+        cpu::scaled_dot_product_attention_gradient(qkv_grad, gradient_input, qkv, dest, softmax_stats, num_heads, causal);
+#endif
+    }
+
 // ----------------------------------------------------------------------------------------
 
     void compute_act_halt_probabilities(
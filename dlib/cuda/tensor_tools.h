@@ -9,6 +9,7 @@
 #include "cusolver_dlibapi.h"
 #include "curand_dlibapi.h"
 #include "cpu_dlib.h"
+#include "fused_activation.h"
 #include "cuda_dlib.h"
 #include "../rand.h"
 #include <memory>
@@ -1579,6 +1580,32 @@ namespace dlib { namespace tt
               is_same_object(grad, gradient_input)==true
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    void bias_add_activation (
+        tensor& dest,
+        const tensor& src,
+        const tensor& biases,
+        const tensor& residual,
+        fused_activation act,
+        float param
+    );
+    /*!
+        requires
+            - have_same_dimensions(dest, src) == true
+            - biases.size() == 0 || biases.size() == src.k()
+            - residual.size() == 0 || have_same_dimensions(residual, src) == true
+        ensures
+            - Computes, in a single pass over the data:
+                #dest == f(src + B + residual)
+              where B is biases broadcast over each channel, i.e. the value biases.host()[k]
+              is added to every element of channel k, and f is the activation named by
+              act, using param as described in fused_activation.h.  An empty biases or
+              residual tensor is treated as zero.
+            - This function supports in-place operation, i.e. having
+              is_same_object(dest, src)==true
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     void relu (
@@ -2392,6 +2419,64 @@ namespace dlib { namespace tt
                     - #dest(n,k,c,r) == dest(n,k,c,r) + src(n,k,r,c)
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    void scaled_dot_product_attention(
+        resizable_tensor& dest,
+        resizable_tensor& softmax_stats,
+        const tensor& qkv,
+        long num_heads,
+        bool causal
+    );
+    /*!
+        requires
+            - num_heads > 0
+            - qkv.nc() % (3*num_heads) == 0
+        ensures
+            - Each of the qkv.num_samples()*qkv.k() planes of qkv is interpreted as a
+              sequence of qkv.nr() positions.  Row r of a plane contains the query, key and
+              value vectors of position r concatenated together, i.e. Q(r) is the first
+              qkv.nc()/3 columns, K(r) the next qkv.nc()/3 columns and V(r) the last
+              qkv.nc()/3 columns.  Each of these vectors is further split into num_heads
+              contiguous heads of d_head == qkv.nc()/(3*num_heads) values.
+            - #dest.num_samples() == qkv.num_samples()
+            - #dest.k() == qkv.k()
+            - #dest.nr() == qkv.nr()
+            - #dest.nc() == qkv.nc()/3
+            - For each plane and head h, computes the multi-head attention
+                dest_h = softmax(Q_h*trans(K_h)/sqrt(d_head))*V_h
+              where, if causal == true, the scores of position i against the positions
+              j > i are masked out (i.e. set to -infinity before the softmax).  The heads
+              are concatenated along the columns of #dest in the same order as in qkv.
+            - The softmax is computed in a single streaming pass over blocks of keys, so the
+              full qkv.nr() x qkv.nr() score matrix is never stored.  Instead, the log of
+              the softmax normalizer of each row is stored in #softmax_stats so that
+              scaled_dot_product_attention_gradient() can recompute the attention weights.
+    !*/
+
+    void scaled_dot_product_attention_gradient(
+        tensor& qkv_grad,
+        const tensor& gradient_input,
+        const tensor& qkv,
+        const tensor& dest,
+        const tensor& softmax_stats,
+        long num_heads,
+        bool causal
+    );
+    /*!
+        requires
+            - dest and softmax_stats were computed by calling
+              scaled_dot_product_attention(dest, softmax_stats, qkv, num_heads, causal)
+            - have_same_dimensions(qkv, qkv_grad) == true
+            - have_same_dimensions(gradient_input, dest) == true
+        ensures
+            - Let f(qkv) == dot(gradient_input, dest) where dest is the output of
+              scaled_dot_product_attention(), then this function computes the gradient of
+              f() with respect to qkv and adds it to qkv_grad.
+            - The attention weights are recomputed block by block from softmax_stats, so
+              like the forward pass this function never stores the full score matrix.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     // ACT (Adaptive Computation Time) operations
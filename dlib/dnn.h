@@ -27,6 +27,7 @@
 #include "dnn/core.h"
 #include "dnn/solvers.h"
 #include "dnn/trainer.h"
+#include "dnn/data_loader.h"
 #include "cuda/cpu_dlib.h"
 #include "cuda/tensor_tools.h"
 #include "dnn/utilities.h"
@@ -196,6 +196,72 @@ namespace dlib
 
     namespace impl
     {
+        class output_tensor_pool
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object holds the memory of layer outputs that nothing will read
+                    again during the current forward pass, so that the layers computed
+                    after them can reuse it instead of keeping their own.  It is what
+                    enable_inference_memory_sharing() installs into a network.
+
+                    Released tensors are handed back out in LIFO order.  Since a network
+                    computes its layers in the same order on every call to forward(),
+                    each layer ends up with the same buffer each time, so once the first
+                    forward pass has grown the buffers no further allocations happen.
+            !*/
+        public:
+
+            void acquire (
+                resizable_tensor& t
+            )
+            {
+                // t still holds its memory if it was never released, e.g. because it
+                // is the output of the network.
+                if (t.size() != 0 || free_tensors.empty())
+                    return;
+                t.swap(free_tensors.back());
+                free_tensors.pop_back();
+            }
+
+            void release (
+                resizable_tensor& t
+            )
+            {
+                if (t.size() == 0)
+                    return;
+                free_tensors.emplace_back();
+                free_tensors.back().swap(t);
+            }
+
+            size_t num_free_tensors (
+            ) const { return free_tensors.size(); }
+
+        private:
+            std::vector<resizable_tensor> free_tensors;
+        };
+
+        class output_pool_handle
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is the pointer to the output_tensor_pool held by each layer.  A copy
+                    of a network has its own output tensors, so copying a handle gives an
+                    empty one rather than sharing the pool of the original network.
+            !*/
+        public:
+            output_pool_handle() = default;
+            output_pool_handle(const output_pool_handle&) {}
+            output_pool_handle& operator=(const output_pool_handle&) { pool.reset(); return *this; }
+            output_pool_handle(output_pool_handle&&) = default;
+            output_pool_handle& operator=(output_pool_handle&&) = default;
+
+            explicit operator bool() const { return pool != nullptr; }
+            output_tensor_pool& operator*() const { return *pool; }
+
+            std::shared_ptr<output_tensor_pool> pool;
+        };
+
         class repeat_input_layer 
         {
             /*!
@@ -923,9 +989,19 @@ namespace dlib
                 this_layer_setup_called = true;
             }
             if (this_layer_operates_inplace())
+            {
                 impl::call_layer_forward(details, wsub, private_get_output());
+            }
             else
+            {
+                if (output_pool)
+                    (*output_pool).acquire(cached_output);
                 impl::call_layer_forward(details, wsub, cached_output);
+                // Nothing but this layer reads the output of the layer below, unless it's
+                // reached through a tag.  So when sharing memory we can let it go now.
+                if (output_pool)
+                    subnetwork->release_output(*output_pool);
+            }
 
             gradient_input_is_stale = true;
             return private_get_output();
@@ -988,6 +1064,7 @@ namespace dlib
             zero_gradients zero_grads = zero_gradients::yes
         )
         {
+            DLIB_CASSERT(!output_pool, "You can't call back_propagate_error() while inference memory sharing is enabled.");
             dimpl::subnet_wrapper<subnet_type> wsub(*subnetwork);
             params_grad.copy_size(details.get_layer_params());
             impl::call_layer_backward(details, private_get_output(),
@@ -1053,6 +1130,13 @@ namespace dlib
             call_clean_method_if_exists(details);
         }
 
+        // Used by enable_inference_memory_sharing() and disable_inference_memory_sharing().
+        void set_output_pool(const std::shared_ptr<impl::output_tensor_pool>& pool, bool /*parent_is_tag*/ = false)
+        {
+            output_pool.pool = pool;
+            subnetwork->set_output_pool(pool);
+        }
+
         friend void serialize(const add_layer& item, std::ostream& out)
         {
             int version = 2;
@@ -1113,6 +1197,19 @@ namespace dlib
             return impl::backward_requires_forward_output(details, *subnetwork);
         }
 
+        void release_output(impl::output_tensor_pool& pool)
+        {
+            if (this_layer_operates_inplace())
+                subnetwork->release_output(pool);
+            else
+                pool.release(cached_output);
+        }
+
+        void release_tagged_output(unsigned long id, impl::output_tensor_pool& pool, const tensor* keep)
+        {
+            subnetwork->release_tagged_output(id, pool, keep);
+        }
+
         void swap(add_layer& item)
         {
             std::swap(subnetwork,item.subnetwork);
@@ -1123,6 +1220,7 @@ namespace dlib
             std::swap(x_grad, item.x_grad);
             std::swap(cached_output, item.cached_output);
             std::swap(params_grad, item.params_grad);
+            std::swap(output_pool, item.output_pool);
         }
 
 
@@ -1143,6 +1241,8 @@ namespace dlib
         // It is here only to prevent it from being reallocated over and over.
         resizable_tensor temp_tensor;
 
+        // set by enable_inference_memory_sharing()
+        impl::output_pool_handle output_pool;
     };
 
     template <typename T, typename U, typename E>
@@ -1323,6 +1423,8 @@ namespace dlib
                 details.setup(wsub);
                 this_layer_setup_called = true;
             }
+            if (output_pool)
+                (*output_pool).acquire(cached_output);
             impl::call_layer_forward(details, wsub, cached_output);
             gradient_input_is_stale = true;
             return private_get_output();
@@ -1372,6 +1474,7 @@ namespace dlib
             zero_gradients zero_grads = zero_gradients::yes
         )
         {
+            DLIB_CASSERT(!output_pool, "You can't call back_propagate_error() while inference memory sharing is enabled.");
             // make sure grad_final is initialized to 0
             if (!have_same_dimensions(x, grad_final))
                 grad_final.copy_size(x);
@@ -1438,6 +1541,12 @@ namespace dlib
             call_clean_method_if_exists(details);
         }
 
+        // Used by enable_inference_memory_sharing() and disable_inference_memory_sharing().
+        void set_output_pool(const std::shared_ptr<impl::output_tensor_pool>& pool, bool /*parent_is_tag*/ = false)
+        {
+            output_pool.pool = pool;
+        }
+
         friend void serialize(const add_layer& item, std::ostream& out)
         {
             int version = 3;
@@ -1499,6 +1608,16 @@ namespace dlib
             return impl::backward_requires_forward_output(details, wsub);
         }
 
+        void release_output(impl::output_tensor_pool& pool)
+        {
+            pool.release(cached_output);
+        }
+
+        void release_tagged_output(unsigned long, impl::output_tensor_pool&, const tensor*)
+        {
+            // There are no tags below an input layer.
+        }
+
         class subnet_wrapper
         {
         public:
@@ -1537,6 +1656,7 @@ namespace dlib
             std::swap(cached_output, item.cached_output); 
             std::swap(grad_final, item.grad_final); 
             std::swap(_sample_expansion_factor, item._sample_expansion_factor); 
+            std::swap(output_pool, item.output_pool);
         }
 
         subnet_type input_layer_;
@@ -1554,6 +1674,9 @@ namespace dlib
         // member functions.
         resizable_tensor params_grad; 
         resizable_tensor temp_tensor; 
+
+        // set by enable_inference_memory_sharing()
+        impl::output_pool_handle output_pool;
     };
 
 // ----------------------------------------------------------------------------------------
@@ -1626,7 +1749,12 @@ namespace dlib
 
         const tensor& forward(const tensor& x)
         {
-            return subnetwork.forward(x);
+            const tensor& out = subnetwork.forward(x);
+            // Layers above this one can no longer reach the layer with the same tag ID
+            // below us, so its output is dead now.
+            if (output_pool)
+                subnetwork.release_tagged_output(ID, *output_pool, &out);
+            return out;
         }
 
         const tensor& get_output() const { return subnetwork.get_output(); }
@@ -1691,6 +1819,14 @@ namespace dlib
             subnetwork.clean();
         }
 
+        // Used by enable_inference_memory_sharing() and disable_inference_memory_sharing().
+        void set_output_pool(const std::shared_ptr<impl::output_tensor_pool>& pool, bool parent_is_tag_ = false)
+        {
+            output_pool.pool = pool;
+            parent_is_tag = parent_is_tag_;
+            subnetwork.set_output_pool(pool, true);
+        }
+
         friend void serialize(const add_tag_layer& item, std::ostream& out)
         {
             int version = 1;
@@ -1738,6 +1874,25 @@ namespace dlib
         bool this_layer_requires_forward_output(
         ) { return true; } 
 
+        void release_output(impl::output_tensor_pool&)
+        {
+            // Layers above this one may still read our output through the tag.  It is
+            // released once another tag with the same ID hides this one.
+        }
+
+        void release_tagged_output(unsigned long id, impl::output_tensor_pool& pool, const tensor* keep)
+        {
+            if (id != ID)
+            {
+                subnetwork.release_tagged_output(id, pool, keep);
+                return;
+            }
+            // If a tag sits right on top of this one, its output is our output and is
+            // still reachable.  So in that case keep it.
+            if (!parent_is_tag && &private_get_output() != keep)
+                subnetwork.release_output(pool);
+        }
+
         void disable_output_and_gradient_getters (
         ) 
         { 
@@ -1760,6 +1915,10 @@ namespace dlib
         // always empty. It's just here so we can have the get_parameter_gradient() methods
         // which have to return something.  So they return this empty tensor.
         resizable_tensor params_grad;
+
+        // set by enable_inference_memory_sharing()
+        impl::output_pool_handle output_pool;
+        bool parent_is_tag = false;
     };
 
 // ----------------------------------------------------------------------------------------
@@ -1910,8 +2069,16 @@ namespace dlib
         {
             subnetwork.forward(x);
             details[details.size()-1].forward(subnetwork.get_output());
+            if (output_pool)
+                subnetwork.release_output(*output_pool);
             for (long i = details.size()-2; i >= 0; --i)
+            {
                 details[i].forward(details[i+1].get_output());
+                // Tags inside a repeated group can't be reached from outside of it, so
+                // nothing reads the output of the group below once this one is done.
+                if (output_pool)
+                    details[i+1].release_output(*output_pool);
+            }
             return private_get_output();
         }
 
@@ -2009,6 +2176,15 @@ namespace dlib
                 d.clean();
         }
 
+        // Used by enable_inference_memory_sharing() and disable_inference_memory_sharing().
+        void set_output_pool(const std::shared_ptr<impl::output_tensor_pool>& pool, bool parent_is_tag = false)
+        {
+            output_pool.pool = pool;
+            for (size_t i = 0; i < details.size(); ++i)
+                details[i].set_output_pool(pool, i == 0 && parent_is_tag);
+            subnetwork.set_output_pool(pool);
+        }
+
         friend void serialize(const repeat& item, std::ostream& out)
         {
             int version = 1;
@@ -2069,6 +2245,17 @@ namespace dlib
             details[0].disable_output_and_gradient_getters();
         }
 
+        void release_output(impl::output_tensor_pool& pool)
+        {
+            details[0].release_output(pool);
+        }
+
+        void release_tagged_output(unsigned long id, impl::output_tensor_pool& pool, const tensor* keep)
+        {
+            // layer<tag>() doesn't look inside the repeated groups, so neither do we.
+            subnetwork.release_tagged_output(id, pool, keep);
+        }
+
 
         std::vector<repeated_layer_type> details; 
         subnet_type subnetwork;
@@ -2076,6 +2263,9 @@ namespace dlib
         // temp_tensor doesn't logically contribute to the state of this class.
         // It is here only to void needing to reallocate it over and over.
         resizable_tensor temp_tensor;
+
+        // set by enable_inference_memory_sharing()
+        impl::output_pool_handle output_pool;
     };
 
     template <
@@ -2259,6 +2449,12 @@ namespace dlib
             cached_output_ptr = 0;
         }
 
+        // Used by enable_inference_memory_sharing() and disable_inference_memory_sharing().
+        void set_output_pool(const std::shared_ptr<impl::output_tensor_pool>&, bool /*parent_is_tag*/ = false)
+        {
+            // This layer only holds the network's input, which isn't shared.
+        }
+
         friend void serialize(const add_tag_layer& item, std::ostream& out)
         {
             int version = 2;
@@ -2333,6 +2529,9 @@ namespace dlib
             DLIB_CASSERT(false,"This should never happen");
         }
 
+        void release_output(impl::output_tensor_pool&) {}
+        void release_tagged_output(unsigned long, impl::output_tensor_pool&, const tensor*) {}
+
         tensor& private_get_output() const
         { return const_cast<tensor&>(get_output()); }
         tensor& private_get_gradient_input() 
@@ -2725,6 +2924,12 @@ namespace dlib
             subnetwork.clean();
         }
 
+        // Used by enable_inference_memory_sharing() and disable_inference_memory_sharing().
+        void set_output_pool(const std::shared_ptr<impl::output_tensor_pool>& pool)
+        {
+            subnetwork.set_output_pool(pool);
+        }
+
         template <typename T, typename U>
         friend void serialize(const add_loss_layer<T,U>& item, std::ostream& out);
         template <typename T, typename U>
@@ -3054,6 +3259,10 @@ namespace dlib
         const tensor& forward(const tensor& x)
         {
             subnetwork.forward(x);
+            // Nothing reads the output of the layer right below a skip, only the tagged
+            // one, unless it is reached through a tag of its own.
+            if (output_pool && &subnetwork.private_get_output() != &private_get_output())
+                subnetwork.release_output(*output_pool);
             return layer<TAG_TYPE>(subnetwork).get_output();
         }
 
@@ -3125,6 +3334,13 @@ namespace dlib
             subnetwork.clean();
         }
 
+        // Used by enable_inference_memory_sharing() and disable_inference_memory_sharing().
+        void set_output_pool(const std::shared_ptr<impl::output_tensor_pool>& pool, bool /*parent_is_tag*/ = false)
+        {
+            output_pool.pool = pool;
+            subnetwork.set_output_pool(pool);
+        }
+
         friend void serialize(const add_skip_layer& item, std::ostream& out)
         {
             int version = 1;
@@ -3174,6 +3390,17 @@ namespace dlib
         void disable_output_and_gradient_getters (
         ) { layer<TAG_TYPE>(subnetwork).disable_output_and_gradient_getters(); }
 
+        void release_output(impl::output_tensor_pool&)
+        {
+            // Our output belongs to the tagged layer, which releases it when the tag is
+            // hidden by another one with the same ID.
+        }
+
+        void release_tagged_output(unsigned long id, impl::output_tensor_pool& pool, const tensor* keep)
+        {
+            subnetwork.release_tagged_output(id, pool, keep);
+        }
+
         tensor& private_get_output() const
         { return layer<TAG_TYPE>(subnetwork).private_get_output(); }
         tensor& private_get_gradient_input() 
@@ -3185,6 +3412,9 @@ namespace dlib
         // always empty. It's just here so we can have the get_parameter_gradient() methods
         // which have to return something.  So they return this empty tensor.
         resizable_tensor params_grad;
+
+        // set by enable_inference_memory_sharing()
+        impl::output_pool_handle output_pool;
     };
     template <template<typename> class T, typename U>
     struct is_nonloss_layer_type<add_skip_layer<T,U>> : std::true_type {};
@@ -3211,6 +3441,24 @@ namespace dlib
     template <typename SUBNET> using skip9  = add_skip_layer< tag9, SUBNET>;
     template <typename SUBNET> using skip10 = add_skip_layer<tag10, SUBNET>;
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename net_type>
+    void enable_inference_memory_sharing (
+        net_type& net
+    )
+    {
+        net.set_output_pool(std::make_shared<impl::output_tensor_pool>());
+    }
+
+    template <typename net_type>
+    void disable_inference_memory_sharing (
+        net_type& net
+    )
+    {
+        net.set_output_pool(nullptr);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     namespace timpl
@@ -3230,15 +3478,16 @@ namespace dlib
         {
         public:
             test_layer_subnet (
-                dlib::rand& rnd_
-            ) : rnd(rnd_) 
+                dlib::rand& rnd_,
+                const long nc_multiple_ = 1
+            ) : rnd(rnd_), nc_multiple(nc_multiple_)
             {
                 // Output and gradient_input have to have the same dimensions in each
                 // layer.
                 const long num_samples = rnd.get_random_32bit_number()%4+3;
                 const long k  = rnd.get_random_32bit_number()%4+2;
                 const long nr = ((rnd.get_random_32bit_number()%4)/2)*2+2;
-                const long nc = ((rnd.get_random_32bit_number()%4)/2)*2+2;
+                const long nc = (((rnd.get_random_32bit_number()%4)/2)*2+2)*nc_multiple;
 
                 output.set_size(num_samples, k, nr, nc);
                 gradient_input.set_size(num_samples, k, nr, nc);
@@ -3293,10 +3542,11 @@ namespace dlib
             void init_sub() const
             {
                 if (!subnetwork)
-                    subnetwork.reset(new test_layer_subnet(rnd));
+                    subnetwork.reset(new test_layer_subnet(rnd, nc_multiple));
             }
 
             dlib::rand& rnd;
+            long nc_multiple;
             mutable std::unique_ptr<test_layer_subnet> subnetwork;
             resizable_tensor output;
             resizable_tensor gradient_input;
@@ -3326,7 +3576,8 @@ namespace dlib
         >
     layer_test_results impl_test_layer (
         layer_details_type l,
-        const float base_eps 
+        const float base_eps,
+        const long nc_multiple
     )
     {
         using namespace timpl;
@@ -3336,7 +3587,7 @@ namespace dlib
         std::ostringstream sout;
         for (int iter = 0; iter < 10; ++iter)
         {
-            test_layer_subnet subnetwork(rnd);
+            test_layer_subnet subnetwork(rnd, nc_multiple);
             resizable_tensor output, out2, out3;
             // Run setup() and forward() as well to make sure any calls to subnet() have
             // happened before we start assuming we know how many data elements there are
@@ -3381,7 +3632,7 @@ namespace dlib
             // in in-place mode.
             if (impl::is_inplace_layer(l, subnetwork))
             {
-                test_layer_subnet subnetwork2(rnd);
+                test_layer_subnet subnetwork2(rnd, nc_multiple);
                 layer_details_type ll(l);
                 ll.setup(subnetwork2);
                 resizable_tensor ip_out;
@@ -3528,19 +3779,21 @@ namespace dlib
         typename layer_details_type
         >
     layer_test_results test_layer (
-        layer_details_type l
+        layer_details_type l,
+        const long nc_multiple = 1
     )
     {
+        DLIB_CASSERT(nc_multiple > 0);
         // Try a few different derivative step sizes to see if any work. 
         for (float base_eps = 0.0001; base_eps < 0.1; base_eps *= 2)
         {
-            auto result = impl_test_layer(l, base_eps);
+            auto result = impl_test_layer(l, base_eps, nc_multiple);
             if (result)
                 return result;
         }
         // However, if none of the step sizes worked then try this one and probably result
         // in returning an error.
-        return impl_test_layer(l, 0.01);
+        return impl_test_layer(l, 0.01, nc_multiple);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -1676,6 +1676,52 @@ namespace dlib
     template <typename SUBNET> using skip9  = add_skip_layer< tag9, SUBNET>;
     template <typename SUBNET> using skip10 = add_skip_layer<tag10, SUBNET>;
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename net_type>
+    void enable_inference_memory_sharing (
+        net_type& net
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, repeat,
+              or add_tag_layer.
+        ensures
+            - Makes net reuse the memory of layer outputs during forward passes.  Normally
+              every layer keeps its own output tensor, so a network uses as much memory as
+              all its outputs put together.  But when only running a network forward, the
+              output of a layer is dead as soon as the layer above it has run, unless a
+              tag makes it reachable from further up.  So once this function has been
+              called, each layer hands the memory of its input over to a pool shared by
+              all the layers in net when it is done with it, and each layer takes its own
+              output tensor from that pool.  Tagged outputs are kept until another tag with
+              the same ID hides them from the layers above, or until the end of the forward
+              pass if that never happens.  The outputs of layers inside a repeat layer are
+              also released once the repeated group above them has run.
+            - This leaves the outputs of net, i.e. net.get_output() or the input to net's
+              loss layer, unchanged.  However, after a call to forward(), the get_output()
+              of other layers is only valid if that layer's output is still reachable
+              through a tag.  Otherwise it is an empty tensor.
+            - A network using shared memory can't be trained.  That is,
+              back_propagate_error() must not be called on it until
+              disable_inference_memory_sharing(net) has been called.
+            - Copies of net don't share memory with net, nor with each other, unless
+              enable_inference_memory_sharing() is called on them too.
+    !*/
+
+    template <typename net_type>
+    void disable_inference_memory_sharing (
+        net_type& net
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, repeat,
+              or add_tag_layer.
+        ensures
+            - Undoes enable_inference_memory_sharing(net).  That is, each layer in net goes
+              back to keeping its own output tensor.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -2059,9 +2105,12 @@ namespace dlib
         typename layer_details_type
         >
     layer_test_results test_layer (
-        layer_details_type l
+        layer_details_type l,
+        const long nc_multiple = 1
     );
     /*!
+        requires
+            - nc_multiple > 0
         ensures
             - Checks if l correctly implements the EXAMPLE_COMPUTATIONAL_LAYER_ interface
               defined in layers_abstract.h.  Importantly, it computes numerical approximations 
@@ -2074,6 +2123,9 @@ namespace dlib
               arbitrary subnetworks as input.  So if you have designed a layer that expects
               only a certain restricted type of subnetwork then you might get a compile or
               runtime error when you call this function.
+            - The inputs given to l have random dimensions, except that their nc() is
+              always a multiple of nc_multiple.  So layers that need a certain number of
+              columns, such as attention_, can be tested by setting nc_multiple.
     !*/
 
 // ----------------------------------------------------------------------------------------
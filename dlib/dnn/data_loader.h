@@ -0,0 +1,238 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_DATA_LOADER_H_
+#define DLIB_DNn_DATA_LOADER_H_
+
+#include "data_loader_abstract.h"
+#include "core.h"
+#include "../rand.h"
+#include "../string.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class dnn_data_loader
+    {
+    public:
+
+        typedef typename net_type::input_type input_type;
+        typedef typename net_type::training_label_type training_label_type;
+        typedef typename net_type::input_layer_type input_layer_type;
+        typedef std::function<void(dlib::rand&, input_type&, training_label_type&)> sample_generator_type;
+
+        dnn_data_loader() = delete;
+        dnn_data_loader(const dnn_data_loader&) = delete;
+        dnn_data_loader& operator=(const dnn_data_loader&) = delete;
+
+        dnn_data_loader (
+            net_type& net,
+            sample_generator_type make_sample_,
+            size_t mini_batch_size_,
+            size_t num_workers = std::thread::hardware_concurrency(),
+            size_t max_prefetched_batches = 0,
+            unsigned long seed_ = 0
+        ) :
+            make_sample(std::move(make_sample_)),
+            mini_batch_size(mini_batch_size_),
+            seed(seed_),
+            input_layer(net.input_layer())
+        {
+            DLIB_CASSERT(make_sample != nullptr);
+            DLIB_CASSERT(mini_batch_size > 0);
+            num_workers = std::max<size_t>(num_workers, 1);
+            if (max_prefetched_batches == 0)
+                max_prefetched_batches = 2*num_workers;
+            slots.resize(max_prefetched_batches);
+
+            // Tensors handed to train_one_step() never go through net.to_tensor(), which
+            // is what tells the network its sample expansion factor.  So run one sample
+            // through it here, before any worker is started.
+            {
+                dlib::rand rnd(get_seed_string(~0ull));
+                input_type sample;
+                training_label_type label;
+                make_sample(rnd, sample, label);
+                resizable_tensor temp;
+                net.to_tensor(&sample, &sample+1, temp);
+            }
+
+            for (size_t i = 0; i < num_workers; ++i)
+                workers.emplace_back([this](){ thread(); });
+        }
+
+        ~dnn_data_loader(
+        )
+        {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stop = true;
+            }
+            slot_free.notify_all();
+            for (auto& w : workers)
+                w.join();
+        }
+
+        size_t get_mini_batch_size (
+        ) const { return mini_batch_size; }
+
+        size_t get_num_workers (
+        ) const { return workers.size(); }
+
+        size_t get_max_prefetched_batches (
+        ) const { return slots.size(); }
+
+        unsigned long long get_num_batches_delivered (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return next_to_deliver;
+        }
+
+        void get_next (
+            resizable_tensor& data,
+            std::vector<training_label_type>& labels
+        )
+        {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                batch& b = slots[next_to_deliver%slots.size()];
+                batch_ready.wait(lock, [&](){ return b.ready; });
+                // The slot stays ready and is never handed out, so every later call
+                // throws the same exception.
+                if (b.error)
+                    std::rethrow_exception(b.error);
+
+                // Hand the prepared buffers to the caller and keep the caller's old ones
+                // so the worker that fills this slot next can reuse their memory.
+                data.swap(b.data);
+                labels.swap(b.labels);
+                b.ready = false;
+                ++next_to_deliver;
+            }
+            slot_free.notify_all();
+        }
+
+        void get_next (
+            resizable_tensor& data
+        )
+        {
+            get_next(data, unused_labels);
+        }
+
+    private:
+
+        struct batch
+        {
+            resizable_tensor data;
+            std::vector<training_label_type> labels;
+            bool ready = false;
+            std::exception_ptr error;
+        };
+
+        std::string get_seed_string (
+            unsigned long long batch_index
+        ) const
+        {
+            return cast_to_string(seed) + " " + cast_to_string(batch_index);
+        }
+
+        void thread (
+        )
+        {
+            // Each worker converts samples to tensors with its own copy of the input layer
+            // and reuses its sample and tensor buffers from one mini-batch to the next.
+            input_layer_type il = input_layer;
+            std::vector<input_type> samples(mini_batch_size);
+            resizable_tensor data;
+            std::vector<training_label_type> labels;
+            dlib::rand rnd;
+
+            while (true)
+            {
+                unsigned long long idx;
+                {
+                    std::unique_lock<std::mutex> lock(m);
+                    slot_free.wait(lock, [&](){ return stop || next_to_make < next_to_deliver + slots.size(); });
+                    if (stop)
+                        return;
+                    idx = next_to_make++;
+                    batch& b = slots[idx%slots.size()];
+                    data.swap(b.data);
+                    labels.swap(b.labels);
+                }
+
+                try
+                {
+                    // Seeding by mini-batch index, rather than by worker, makes the
+                    // sequence of mini-batches independent of the number of workers and
+                    // of how the OS schedules them.
+                    rnd.set_seed(get_seed_string(idx));
+                    labels.resize(mini_batch_size);
+                    for (size_t i = 0; i < mini_batch_size; ++i)
+                        make_sample(rnd, samples[i], labels[i]);
+                    il.to_tensor(samples.begin(), samples.end(), data);
+                }
+                catch (...)
+                {
+                    // The exception is delivered by get_next() when it reaches this
+                    // mini-batch, so the ones before it, which were all taken by workers
+                    // before this one, are still delivered first.  No new mini-batches are
+                    // started since none of them could ever be delivered.
+                    {
+                        std::lock_guard<std::mutex> lock(m);
+                        batch& b = slots[idx%slots.size()];
+                        data.swap(b.data);
+                        labels.swap(b.labels);
+                        b.error = std::current_exception();
+                        b.ready = true;
+                        stop = true;
+                    }
+                    batch_ready.notify_all();
+                    slot_free.notify_all();
+                    return;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    batch& b = slots[idx%slots.size()];
+                    data.swap(b.data);
+                    labels.swap(b.labels);
+                    b.ready = true;
+                }
+                batch_ready.notify_all();
+            }
+        }
+
+        const sample_generator_type make_sample;
+        const size_t mini_batch_size;
+        const unsigned long seed;
+        const input_layer_type input_layer;
+
+        mutable std::mutex m;
+        std::condition_variable slot_free;
+        std::condition_variable batch_ready;
+        std::vector<batch> slots;  // batch i is prepared in slots[i%slots.size()]
+        unsigned long long next_to_make = 0;
+        unsigned long long next_to_deliver = 0;
+        bool stop = false;
+        std::vector<training_label_type> unused_labels;
+
+        std::vector<std::thread> workers;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_DATA_LOADER_H_
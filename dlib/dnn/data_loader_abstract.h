@@ -0,0 +1,170 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_DATA_LOADER_ABSTRACT_H_
+#ifdef DLIB_DNn_DATA_LOADER_ABSTRACT_H_
+
+#include "core_abstract.h"
+#include "../cuda/tensor_abstract.h"
+#include "../rand/rand_kernel_abstract.h"
+#include <functional>
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename net_type
+        >
+    class dnn_data_loader
+    {
+        /*!
+            REQUIREMENTS ON net_type
+                net_type is an add_loss_layer object.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object makes mini-batches for a dnn_trainer in a pool of background
+                threads.  Each worker thread calls a user supplied function to make the
+                samples of a mini-batch, which is usually where data loading and
+                augmentation happen, and then converts them into a tensor with its own
+                copy of the network's input layer.  Up to get_max_prefetched_batches()
+                finished mini-batches are kept ready, so that the thread driving the
+                trainer only has to swap the next one into place.  For example:
+
+                    dnn_data_loader<net_type> loader(net, make_sample, 64);
+                    resizable_tensor x;
+                    std::vector<unsigned long> y;
+                    while (trainer.get_learning_rate() >= 1e-6)
+                    {
+                        loader.get_next(x, y);
+                        trainer.train_one_step(x, y);
+                    }
+
+                The mini-batches are delivered in order, and mini-batch number i is
+                always made from a dlib::rand seeded from the seed and i.  So the
+                sequence of mini-batches you get depends only on the sample generator
+                and the seed, not on the number of worker threads or on how they are
+                scheduled.
+
+            THREAD SAFETY
+                get_next() must only be called from one thread at a time.  The sample
+                generator is called concurrently from all the worker threads.
+        !*/
+
+    public:
+
+        typedef typename net_type::input_type input_type;
+        typedef typename net_type::training_label_type training_label_type;
+        typedef typename net_type::input_layer_type input_layer_type;
+        typedef std::function<void(dlib::rand&, input_type&, training_label_type&)> sample_generator_type;
+
+        dnn_data_loader (
+            net_type& net,
+            sample_generator_type make_sample,
+            size_t mini_batch_size,
+            size_t num_workers = std::thread::hardware_concurrency(),
+            size_t max_prefetched_batches = 0,
+            unsigned long seed = 0
+        );
+        /*!
+            requires
+                - make_sample != nullptr
+                - mini_batch_size > 0
+                - make_sample(rnd, sample, label) can be called concurrently from several
+                  threads.  It must set sample and label to a new training sample, drawing
+                  all its random numbers from rnd.  sample and label may still hold a
+                  sample from an earlier call, whose memory it can reuse.
+            ensures
+                - #get_mini_batch_size() == mini_batch_size
+                - #get_num_workers() == max(num_workers, 1)
+                - if (max_prefetched_batches == 0) then
+                    - #get_max_prefetched_batches() == 2*get_num_workers()
+                - else
+                    - #get_max_prefetched_batches() == max_prefetched_batches
+                - #get_num_batches_delivered() == 0
+                - Calls make_sample() once and runs the result through net.to_tensor().
+                  This sets net.sample_expansion_factor(), which the train_one_step()
+                  and test_one_step() overloads of dnn_trainer that take tensors need.
+                  If you train on several devices, construct this object before the
+                  dnn_trainer so the trainer's copies of net see it too.
+                - Starts the worker threads, which immediately begin making mini-batches.
+        !*/
+
+        ~dnn_data_loader(
+        );
+        /*!
+            ensures
+                - Stops and joins all the worker threads.
+        !*/
+
+        size_t get_mini_batch_size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of samples in each mini-batch.
+        !*/
+
+        size_t get_num_workers (
+        ) const;
+        /*!
+            ensures
+                - returns the number of worker threads making mini-batches.
+        !*/
+
+        size_t get_max_prefetched_batches (
+        ) const;
+        /*!
+            ensures
+                - returns the largest number of mini-batches that are made ahead of the
+                  calls to get_next().
+        !*/
+
+        unsigned long long get_num_batches_delivered (
+        ) const;
+        /*!
+            ensures
+                - returns the number of times get_next() has returned a mini-batch.
+        !*/
+
+        void get_next (
+            resizable_tensor& data,
+            std::vector<training_label_type>& labels
+        );
+        /*!
+            ensures
+                - Waits for mini-batch number get_num_batches_delivered() to be ready and
+                  swaps it into data and labels.  That is:
+                    - #data is the output of net.input_layer().to_tensor() for the
+                      get_mini_batch_size() samples of that mini-batch.
+                    - #labels.size() == get_mini_batch_size() and #labels[i] is the label of
+                      the i-th sample.
+                - The previous contents of data and labels are not freed.  They are kept
+                  and reused to make a later mini-batch, so you don't need to hand the
+                  same objects back each time but doing so avoids reallocations.
+                - #get_num_batches_delivered() == get_num_batches_delivered() + 1
+            throws
+                - any exception thrown by the sample generator or by to_tensor() while
+                  making mini-batch number get_num_batches_delivered().  The mini-batches
+                  before a failed one are still delivered normally, and the exception is
+                  only thrown once get_next() reaches the failed mini-batch.  From then on
+                  every call to get_next() throws the same exception and
+                  get_num_batches_delivered() no longer changes.
+        !*/
+
+        void get_next (
+            resizable_tensor& data
+        );
+        /*!
+            ensures
+                - This function is identical to get_next(data, labels) except that the
+                  labels are discarded.  Use it with networks that use unsupervised
+                  losses.
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_DATA_LOADER_ABSTRACT_H_
@@ -13,13 +13,32 @@
 #include "../cuda/tensor_tools.h"
 #include "../vectorstream.h"
 #include "utilities.h"
+#include "quantization.h"
 #include "../cuda/operation_mode.h"
+#include "../cuda/fused_activation.h"
 #include <sstream>
 
 
 namespace dlib
 {
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        inline fused_activation deserialize_fused_activation (
+            std::istream& in,
+            const std::string& layer_name
+        )
+        {
+            int act;
+            deserialize(act, in);
+            if (act < (int)fused_activation::NONE || act > (int)fused_activation::ELU)
+                throw serialization_error("Invalid fused activation " + std::to_string(act) + " found while deserializing dlib::" + layer_name + ".");
+            return (fused_activation)act;
+        }
+    }
+
 // ----------------------------------------------------------------------------------------
 
     struct num_con_outputs
@@ -62,7 +81,8 @@ namespace dlib
             padding_y_(_padding_y),
             padding_x_(_padding_x),
             use_bias(true),
-            use_relu(false)
+            activation(fused_activation::NONE),
+            activation_param(0)
         {
             DLIB_CASSERT(num_filters_ > 0);
         }
@@ -110,16 +130,30 @@ namespace dlib
         void set_bias_learning_rate_multiplier(double val) { bias_learning_rate_multiplier = val; }
         void set_bias_weight_decay_multiplier(double val)  { bias_weight_decay_multiplier  = val; }
 
-        bool relu_is_disabled() const { return !use_relu; }
+        bool relu_is_disabled() const { return activation != fused_activation::RELU; }
 
         void disable_relu()
         {
-            use_relu = false;
+            disable_fused_activation();
         }
 
         void enable_relu()
         {
-            use_relu = true;
+            set_fused_activation(fused_activation::RELU);
+        }
+
+        fused_activation get_fused_activation() const { return activation; }
+        float get_fused_activation_param() const { return activation_param; }
+
+        void set_fused_activation(fused_activation act, float param = 0)
+        {
+            activation = act;
+            activation_param = param;
+        }
+
+        void disable_fused_activation()
+        {
+            set_fused_activation(fused_activation::NONE);
         }
 
         bool bias_is_disabled() const { return !use_bias; }
@@ -157,6 +191,22 @@ namespace dlib
             biases(params, filters.size()) = 0;
         }
 
+        bool is_quantized() const { return !quantized.empty(); }
+
+        void quantize_to_int8 (
+            float input_range
+        )
+        {
+            DLIB_CASSERT(input_range >= 0);
+            DLIB_CASSERT(!is_quantized() && params.size() != 0,
+                "The con_ layer must be allocated, and not already quantized, before it can be quantized.");
+            const long filter_size = filters.size()/num_filters_;
+            quantized.quantize(params.host(), num_filters_, filter_size, filter_size, 1,
+                use_bias ? params.host() + filters.size() : nullptr, input_range);
+            // The int8 copy replaces the float parameters entirely.
+            params.clear();
+        }
+
         inline dpoint map_input_to_output (
             dpoint p
         ) const
@@ -189,7 +239,9 @@ namespace dlib
             padding_y_(item.padding_y_),
             padding_x_(item.padding_x_),
             use_bias(item.use_bias),
-            use_relu(item.use_relu)
+            activation(item.activation),
+            activation_param(item.activation_param),
+            quantized(item.quantized)
         {
             // this->conv is non-copyable and basically stateless, so we have to write our
             // own copy to avoid trying to copy it and getting an error.
@@ -215,7 +267,9 @@ namespace dlib
             bias_weight_decay_multiplier = item.bias_weight_decay_multiplier;
             num_filters_ = item.num_filters_;
             use_bias = item.use_bias;
-            use_relu = item.use_relu;
+            activation = item.activation;
+            activation_param = item.activation_param;
+            quantized = item.quantized;
             return *this;
         }
 
@@ -245,6 +299,16 @@ namespace dlib
         template <typename SUBNET>
         void forward(const SUBNET& sub, resizable_tensor& output)
         {
+            const bool use_relu = activation == fused_activation::RELU;
+            if (is_quantized())
+            {
+                quantized.conv_forward(sub.get_output(), output, filters.nr(), filters.nc(),
+                    _stride_y, _stride_x, padding_y_, padding_x_, use_relu);
+                if (activation != fused_activation::NONE && !use_relu)
+                    tt::bias_add_activation(output, output, resizable_tensor(), resizable_tensor(), activation, activation_param);
+                return;
+            }
+
             conv.setup(sub.get_output(),
                        filters(params,0),
                        _stride_y,
@@ -252,7 +316,20 @@ namespace dlib
                        padding_y_,
                        padding_x_);
 
-            if (use_bias)
+            if (activation != fused_activation::NONE && !use_relu)
+            {
+                // The convolution only knows how to apply the biases and a relu as it
+                // writes its output, so add the biases and apply other activations in a
+                // separate pass over its output.
+                conv(false, output,
+                     sub.get_output(),
+                     filters(params,0));
+                if (use_bias)
+                    tt::bias_add_activation(output, output, biases(params, filters.size()), resizable_tensor(), activation, activation_param);
+                else
+                    tt::bias_add_activation(output, output, resizable_tensor(), resizable_tensor(), activation, activation_param);
+            }
+            else if (use_bias)
             {
                 conv(false, output,
                      sub.get_output(),
@@ -265,12 +342,15 @@ namespace dlib
                 conv(false, output,
                      sub.get_output(),
                      filters(params,0));
+                if (use_relu)
+                    tt::relu(output, output);
             }
         }
 
         template <typename SUBNET>
         void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad)
         {
+            DLIB_CASSERT(!is_quantized(), "A quantized con_ layer can't be trained.");
             conv.get_gradient_for_data (true, gradient_input, filters(params,0), sub.get_gradient_input());
             // no point computing the parameter gradients if they won't be used.
             if (learning_rate_multiplier != 0)
@@ -290,7 +370,7 @@ namespace dlib
 
         friend void serialize(const con_& item, std::ostream& out)
         {
-            serialize("con_6", out);
+            serialize("con_7", out);
             serialize(item.params, out);
             serialize(item.num_filters_, out);
             serialize(_nr, out);
@@ -306,7 +386,9 @@ namespace dlib
             serialize(item.bias_learning_rate_multiplier, out);
             serialize(item.bias_weight_decay_multiplier, out);
             serialize(item.use_bias, out);
-            serialize(item.use_relu, out);
+            serialize((int)item.activation, out);
+            serialize(item.activation_param, out);
+            serialize(item.quantized, out);
         }
 
         friend void deserialize(con_& item, std::istream& in)
@@ -317,7 +399,7 @@ namespace dlib
             long nc;
             int stride_y;
             int stride_x;
-            if (version == "con_4" || version == "con_5" || version == "con_6")
+            if (version == "con_4" || version == "con_5" || version == "con_6" || version == "con_7")
             {
                 deserialize(item.params, in);
                 deserialize(item.num_filters_, in);
@@ -339,13 +421,24 @@ namespace dlib
                 if (nc != _nc) throw serialization_error("Wrong nc found while deserializing dlib::con_");
                 if (stride_y != _stride_y) throw serialization_error("Wrong stride_y found while deserializing dlib::con_");
                 if (stride_x != _stride_x) throw serialization_error("Wrong stride_x found while deserializing dlib::con_");
-                if (version == "con_5" || version == "con_6")
+                if (version == "con_5" || version == "con_6" || version == "con_7")
                 {
                     deserialize(item.use_bias, in);
                 }
+                item.set_fused_activation(fused_activation::NONE);
+                item.quantized = int8_weights();
                 if (version == "con_6")
                 {
-                    deserialize(item.use_relu, in);
+                    bool use_relu;
+                    deserialize(use_relu, in);
+                    if (use_relu)
+                        item.set_fused_activation(fused_activation::RELU);
+                }
+                else if (version == "con_7")
+                {
+                    item.activation = impl::deserialize_fused_activation(in, "con_");
+                    deserialize(item.activation_param, in);
+                    deserialize(item.quantized, in);
                 }
             }
             else
@@ -377,9 +470,17 @@ namespace dlib
             {
                 out << " use_bias=false";
             }
-            if (item.use_relu)
+            switch (item.activation)
+            {
+                case fused_activation::NONE: break;
+                case fused_activation::RELU: out << " use_relu=true"; break;
+                case fused_activation::LEAKY_RELU: out << " fused_leaky_relu=" << item.activation_param; break;
+                case fused_activation::CLIPPED_RELU: out << " fused_clipped_relu=" << item.activation_param; break;
+                case fused_activation::ELU: out << " fused_elu=" << item.activation_param; break;
+            }
+            if (item.is_quantized())
             {
-                out << " use_relu="<< std::boolalpha << item.use_relu;
+                out << " int8";
             }
             return out;
         }
@@ -399,8 +500,10 @@ namespace dlib
                 << " bias_learning_rate_mult='"<<item.bias_learning_rate_multiplier<<"'"
                 << " bias_weight_decay_mult='"<<item.bias_weight_decay_multiplier<<"'"
                 << " use_bias='"<<(item.use_bias?"true":"false")<<"'"
-                << " use_relu='"<<(item.use_relu?"true":"false")<<"'"
-                << ">\n";
+                << " use_relu='"<<(item.activation == fused_activation::RELU?"true":"false")<<"'";
+            if (item.activation != fused_activation::NONE && item.activation != fused_activation::RELU)
+                out << " fused_activation='"<<(int)item.activation<<"' fused_activation_param='"<<item.activation_param<<"'";
+            out << ">\n";
             out << mat(item.params);
             out << "</con>\n";
         }
@@ -422,7 +525,11 @@ namespace dlib
         int padding_y_;
         int padding_x_;
         bool use_bias;
-        bool use_relu;
+        fused_activation activation;
+        float activation_param;
+
+        // set by quantize_to_int8(), in which case it's used instead of params.
+        int8_weights quantized;
     };
 
     template <
@@ -2109,6 +2216,23 @@ namespace dlib
         fc_bias_mode get_bias_mode (
         ) const { return bias_mode; }
 
+        bool is_quantized() const { return !quantized.empty(); }
+
+        void quantize_to_int8 (
+            float input_range
+        )
+        {
+            DLIB_CASSERT(input_range >= 0);
+            DLIB_CASSERT(!is_quantized() && params.size() != 0,
+                "The fc_ layer must be allocated, and not already quantized, before it can be quantized.");
+            // params holds the num_inputs by num_outputs weight matrix followed by the biases.
+            quantized.quantize(params.host(), num_outputs, num_inputs, 1, num_outputs,
+                (bias_mode == FC_HAS_BIAS && use_bias) ? params.host() + weights.size() : nullptr,
+                input_range);
+            // The int8 copy replaces the float parameters entirely.
+            params.clear();
+        }
+
         template <typename SUBNET>
         void setup (const SUBNET& sub)
         {
@@ -2136,6 +2260,12 @@ namespace dlib
         {
             DLIB_CASSERT((long)num_inputs == sub.get_output().nr()*sub.get_output().nc()*sub.get_output().k(),
                 "The size of the input tensor to this fc layer doesn't match the size the fc layer was trained with.");
+            if (is_quantized())
+            {
+                quantized.fc_forward(sub.get_output(), output);
+                return;
+            }
+
             output.set_size(sub.get_output().num_samples(), num_outputs);
 
             auto w = weights(params, 0);
@@ -2150,6 +2280,7 @@ namespace dlib
         template <typename SUBNET>
         void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad)
         {
+            DLIB_CASSERT(!is_quantized(), "A quantized fc_ layer can't be trained.");
             // no point computing the parameter gradients if they won't be used.
             if (learning_rate_multiplier != 0)
             {
@@ -2199,7 +2330,7 @@ namespace dlib
 
         friend void serialize(const fc_& item, std::ostream& out)
         {
-            serialize("fc_3", out);
+            serialize("fc_4", out);
             serialize(item.num_outputs, out);
             serialize(item.num_inputs, out);
             serialize(item.params, out);
@@ -2211,13 +2342,14 @@ namespace dlib
             serialize(item.bias_learning_rate_multiplier, out);
             serialize(item.bias_weight_decay_multiplier, out);
             serialize(item.use_bias, out);
+            serialize(item.quantized, out);
         }
 
         friend void deserialize(fc_& item, std::istream& in)
         {
             std::string version;
             deserialize(version, in);
-            if (version == "fc_2" || version == "fc_3")
+            if (version == "fc_2" || version == "fc_3" || version == "fc_4")
             {
                 deserialize(item.num_outputs, in);
                 deserialize(item.num_inputs, in);
@@ -2231,10 +2363,15 @@ namespace dlib
                 deserialize(item.weight_decay_multiplier, in);
                 deserialize(item.bias_learning_rate_multiplier, in);
                 deserialize(item.bias_weight_decay_multiplier, in);
-                if (version == "fc_3")
+                if (version == "fc_3" || version == "fc_4")
                 {
                     deserialize(item.use_bias, in);
                 }
+                item.quantized = int8_weights();
+                if (version == "fc_4")
+                {
+                    deserialize(item.quantized, in);
+                }
             }
             else
             {
@@ -2269,6 +2406,10 @@ namespace dlib
                 out << " learning_rate_mult="<<item.learning_rate_multiplier;
                 out << " weight_decay_mult="<<item.weight_decay_multiplier;
             }
+            if (item.is_quantized())
+            {
+                out << " int8";
+            }
             return out;
         }
 
@@ -2309,6 +2450,9 @@ namespace dlib
         double bias_learning_rate_multiplier;
         double bias_weight_decay_multiplier;
         bool use_bias;
+
+        // set by quantize_to_int8(), in which case it's used instead of params.
+        int8_weights quantized;
     };
 
     template <
@@ -2860,7 +3004,11 @@ namespace dlib
         void forward_inplace(const tensor& input, tensor& output)
         {
             if (disabled)
+            {
+                if (!is_same_object(input, output))
+                    memcpy(output, input);
                 return;
+            }
 
             auto g = gamma(params,0);
             auto b = beta(params,gamma.size());
@@ -3004,6 +3152,20 @@ namespace dlib
         {
         }
 
+        fused_activation get_fused_activation() const { return activation; }
+        float get_fused_activation_param() const { return activation_param; }
+
+        void set_fused_activation(fused_activation act, float param = 0)
+        {
+            activation = act;
+            activation_param = param;
+        }
+
+        void disable_fused_activation()
+        {
+            set_fused_activation(fused_activation::NONE);
+        }
+
         template <typename SUBNET>
         void setup (const SUBNET& /*sub*/)
         {
@@ -3018,12 +3180,27 @@ namespace dlib
                             std::max(t1.k(),t2.k()),
                             std::max(t1.nr(),t2.nr()),
                             std::max(t1.nc(),t2.nc()));
-            tt::add(output, t1, t2);
+            if (activation == fused_activation::NONE)
+            {
+                tt::add(output, t1, t2);
+            }
+            else if (have_same_dimensions(t1, t2))
+            {
+                // Add and activate in a single pass over the data.
+                tt::bias_add_activation(output, t1, resizable_tensor(), t2, activation, activation_param);
+            }
+            else
+            {
+                tt::add(output, t1, t2);
+                tt::bias_add_activation(output, output, resizable_tensor(), resizable_tensor(), activation, activation_param);
+            }
         }
 
         template <typename SUBNET>
         void backward(const tensor& gradient_input, SUBNET& sub, tensor& /*params_grad*/)
         {
+            DLIB_CASSERT(activation == fused_activation::NONE,
+                "add_prev_ can't be trained once an activation has been fused into it");
             // The gradient just flows backwards to the two layers that forward() added
             // together.
             tt::add(sub.get_gradient_input(), sub.get_gradient_input(), gradient_input);
@@ -3036,31 +3213,46 @@ namespace dlib
         inline dpoint map_input_to_output (const dpoint& p) const { return p; }
         inline dpoint map_output_to_input (const dpoint& p) const { return p; }
 
-        friend void serialize(const add_prev_& /*item*/, std::ostream& out)
+        friend void serialize(const add_prev_& item, std::ostream& out)
         {
-            serialize("add_prev_", out);
+            serialize("add_prev_2", out);
+            serialize((int)item.activation, out);
+            serialize(item.activation_param, out);
         }
 
-        friend void deserialize(add_prev_& /*item*/, std::istream& in)
+        friend void deserialize(add_prev_& item, std::istream& in)
         {
             std::string version;
             deserialize(version, in);
-            if (version != "add_prev_")
+            if (version != "add_prev_" && version != "add_prev_2")
                 throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::add_prev_.");
+            item.disable_fused_activation();
+            if (version == "add_prev_2")
+            {
+                item.activation = impl::deserialize_fused_activation(in, "add_prev_");
+                deserialize(item.activation_param, in);
+            }
         }
-        friend std::ostream& operator<<(std::ostream& out, const add_prev_& /*item*/)
+        friend std::ostream& operator<<(std::ostream& out, const add_prev_& item)
         {
             out << "add_prev"<<id;
+            if (item.activation != fused_activation::NONE)
+                out << "\t (fused_activation=" << (int)item.activation << ", param=" << item.activation_param << ")";
             return out;
         }
 
-        friend void to_xml(const add_prev_& /*item*/, std::ostream& out)
+        friend void to_xml(const add_prev_& item, std::ostream& out)
         {
-            out << "<add_prev tag='"<<id<<"'/>\n";
+            out << "<add_prev tag='"<<id<<"'";
+            if (item.activation != fused_activation::NONE)
+                out << " fused_activation='"<<(int)item.activation<<"' fused_activation_param='"<<item.activation_param<<"'";
+            out << "/>\n";
         }
 
     private:
         resizable_tensor params;
+        fused_activation activation = fused_activation::NONE;
+        float activation_param = 0;
     };
 
     template <
@@ -3657,7 +3849,11 @@ namespace dlib
         void forward_inplace(const tensor& input, tensor& output)
         {
             if (disabled)
+            {
+                if (!is_same_object(input, output))
+                    memcpy(output, input);
                 return;
+            }
 
             tt::relu(output, input);
         } 
@@ -3833,6 +4029,14 @@ namespace dlib
             return alpha;
         }
 
+        void disable()
+        {
+            params.clear();
+            disabled = true;
+        }
+
+        bool is_disabled() const { return disabled; }
+
         template <typename SUBNET>
         void setup(const SUBNET& /*sub*/)
         {
@@ -3840,6 +4044,13 @@ namespace dlib
 
         void forward_inplace(const tensor& input, tensor& output)
         {
+            if (disabled)
+            {
+                if (!is_same_object(input, output))
+                    memcpy(output, input);
+                return;
+            }
+
             tt::leaky_relu(output, input, alpha);
         }
 
@@ -3850,6 +4061,9 @@ namespace dlib
             tensor&
         )
         {
+            if (disabled)
+                return;
+
             tt::leaky_relu_gradient(data_grad, computed_output, gradient_input, alpha);
         }
 
@@ -3861,17 +4075,21 @@ namespace dlib
 
         friend void serialize(const leaky_relu_& item, std::ostream& out)
         {
-            serialize("leaky_relu_", out);
+            serialize("leaky_relu_2", out);
             serialize(item.alpha, out);
+            serialize(item.disabled, out);
         }
 
         friend void deserialize(leaky_relu_& item, std::istream& in)
         {
             std::string version;
             deserialize(version, in);
-            if (version != "leaky_relu_")
+            if (version != "leaky_relu_" && version != "leaky_relu_2")
                 throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::leaky_relu_.");
             deserialize(item.alpha, in);
+            item.disabled = false;
+            if (version == "leaky_relu_2")
+                deserialize(item.disabled, in);
         }
 
         friend std::ostream& operator<<(std::ostream& out, const leaky_relu_& item)
@@ -3879,17 +4097,23 @@ namespace dlib
             out << "leaky_relu\t("
                 << "alpha=" << item.alpha
                 << ")";
+            if (item.disabled)
+                out << "\t (disabled)";
             return out;
         }
 
         friend void to_xml(const leaky_relu_& item, std::ostream& out)
         {
-            out << "<leaky_relu alpha='"<< item.alpha << "'/>\n";
+            out << "<leaky_relu alpha='" << item.alpha << "'";
+            if (item.disabled)
+                out << " disabled='"<< std::boolalpha << item.disabled << "'";
+            out << "/>\n";
         }
 
     private:
         resizable_tensor params;
         float alpha;
+        bool disabled = false;
     };
 
     template <typename SUBNET>
@@ -4120,6 +4344,14 @@ namespace dlib
             return ceiling;
         }
 
+        void disable()
+        {
+            params.clear();
+            disabled = true;
+        }
+
+        bool is_disabled() const { return disabled; }
+
         template <typename SUBNET>
         void setup (const SUBNET& /*sub*/)
         {
@@ -4127,6 +4359,13 @@ namespace dlib
 
         void forward_inplace(const tensor& input, tensor& output)
         {
+            if (disabled)
+            {
+                if (!is_same_object(input, output))
+                    memcpy(output, input);
+                return;
+            }
+
             tt::clipped_relu(output, input, ceiling);
         }
 
@@ -4137,6 +4376,9 @@ namespace dlib
             tensor&
         )
         {
+            if (disabled)
+                return;
+
             tt::clipped_relu_gradient(data_grad, computed_output, gradient_input, ceiling);
         }
 
@@ -4148,17 +4390,21 @@ namespace dlib
 
         friend void serialize(const clipped_relu_& item, std::ostream& out)
         {
-            serialize("clipped_relu_", out);
+            serialize("clipped_relu_2", out);
             serialize(item.ceiling, out);
+            serialize(item.disabled, out);
         }
 
         friend void deserialize(clipped_relu_& item, std::istream& in)
         {
             std::string version;
             deserialize(version, in);
-            if (version != "clipped_relu_")
+            if (version != "clipped_relu_" && version != "clipped_relu_2")
                 throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::clipped_relu_.");
             deserialize(item.ceiling, in);
+            item.disabled = false;
+            if (version == "clipped_relu_2")
+                deserialize(item.disabled, in);
         }
 
         friend std::ostream& operator<<(std::ostream& out, const clipped_relu_& item)
@@ -4166,18 +4412,24 @@ namespace dlib
             out << "clipped_relu\t("
                 << "ceiling=" << item.ceiling
                 << ")";
+            if (item.disabled)
+                out << "\t (disabled)";
             return out;
         }
 
         friend void to_xml(const clipped_relu_& item, std::ostream& out)
         {
-            out << "<clipped_relu ceiling='" << item.ceiling << "'/>\n";
+            out << "<clipped_relu ceiling='" << item.ceiling << "'";
+            if (item.disabled)
+                out << " disabled='"<< std::boolalpha << item.disabled << "'";
+            out << "/>\n";
         }
 
 
     private:
         resizable_tensor params;
         float ceiling;
+        bool disabled = false;
     };
 
     template <typename SUBNET>
@@ -4199,6 +4451,14 @@ namespace dlib
             return alpha;
         }
 
+        void disable()
+        {
+            params.clear();
+            disabled = true;
+        }
+
+        bool is_disabled() const { return disabled; }
+
         template <typename SUBNET>
         void setup (const SUBNET& /*sub*/)
         {
@@ -4206,6 +4466,13 @@ namespace dlib
 
         void forward_inplace(const tensor& input, tensor& output)
         {
+            if (disabled)
+            {
+                if (!is_same_object(input, output))
+                    memcpy(output, input);
+                return;
+            }
+
             tt::elu(output, input, alpha);
         }
 
@@ -4216,6 +4483,9 @@ namespace dlib
             tensor&
         )
         {
+            if (disabled)
+                return;
+
             tt::elu_gradient(data_grad, computed_output, gradient_input, alpha);
         }
 
@@ -4227,17 +4497,21 @@ namespace dlib
 
         friend void serialize(const elu_& item, std::ostream& out)
         {
-            serialize("elu_", out);
+            serialize("elu_2", out);
             serialize(item.alpha, out);
+            serialize(item.disabled, out);
         }
 
         friend void deserialize(elu_& item, std::istream& in)
         {
             std::string version;
             deserialize(version, in);
-            if (version != "elu_")
+            if (version != "elu_" && version != "elu_2")
                 throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::elu_.");
             deserialize(item.alpha, in);
+            item.disabled = false;
+            if (version == "elu_2")
+                deserialize(item.disabled, in);
         }
 
         friend std::ostream& operator<<(std::ostream& out, const elu_& item)
@@ -4245,18 +4519,24 @@ namespace dlib
             out << "elu\t ("
                 << "alpha=" << item.alpha
                 << ")";
+            if (item.disabled)
+                out << "\t (disabled)";
             return out;
         }
 
         friend void to_xml(const elu_& item, std::ostream& out)
         {
-            out << "<elu alpha='" << item.alpha << "'/>\n";
+            out << "<elu alpha='" << item.alpha << "'";
+            if (item.disabled)
+                out << " disabled='"<< std::boolalpha << item.disabled << "'";
+            out << "/>\n";
         }
 
 
     private:
         resizable_tensor params;
         float alpha;
+        bool disabled = false;
     };
 
     template <typename SUBNET>
@@ -5328,11 +5608,13 @@ namespace dlib
     class positional_encodings_ {
     public:
         positional_encodings_(unsigned long sequence_dim_ = 1, unsigned long embedding_dim_ = 1) :
-            sequence_dim(sequence_dim_), embedding_dim(embedding_dim_)
+            sequence_dim(sequence_dim_), embedding_dim(embedding_dim_),
+            kv_cache_enabled(false), kv_cache_position(0)
         {
         }
         positional_encodings_(const positional_encodings_& item) : 
-            pe(item.pe), sequence_dim(item.sequence_dim), embedding_dim(item.embedding_dim)
+            pe(item.pe), sequence_dim(item.sequence_dim), embedding_dim(item.embedding_dim),
+            kv_cache_enabled(item.kv_cache_enabled), kv_cache_position(item.kv_cache_position)
         {
         }
         positional_encodings_& operator= (const positional_encodings_& item) {
@@ -5340,6 +5622,8 @@ namespace dlib
             pe = item.pe;
             sequence_dim = item.sequence_dim;
             embedding_dim = item.embedding_dim;
+            kv_cache_enabled = item.kv_cache_enabled;
+            kv_cache_position = item.kv_cache_position;
             return *this;
         }
         
@@ -5350,33 +5634,23 @@ namespace dlib
 
             sequence_dim = prev.nr();
             embedding_dim = prev.nc();
-            const unsigned long ns = prev.num_samples();
-            const unsigned long nk = prev.k();
-            const float n = 10000.0f;
-
-            pe.set_size(ns, nk, sequence_dim, embedding_dim);              
-            for (unsigned long s = 0; s < ns; ++s)
-            {
-                for (unsigned long k = 0; k < nk; ++k)
-                {
-                    for (unsigned long r = 0; r < sequence_dim; ++r)
-                    {
-                        for (unsigned long c = 0; c < embedding_dim; ++c)
-                        {
-                            float theta = static_cast<float>(r) / std::pow(n, static_cast<float>(c) / embedding_dim);
-                            if (c % 2 == 0) pe.host()[tensor_index(pe, s, k, r, c)] = std::sin(theta);
-                            else pe.host()[tensor_index(pe, s, k, r, c)] = std::cos(theta);
-                        }
-                    }
-                }
-            }
+            compute_encodings(pe, prev.num_samples(), prev.k(), 0);
         }
         
         template <typename SUBNET>
         void forward(const SUBNET& sub, resizable_tensor& output)
         {            
             const auto& prev_output = sub.get_output();            
-            if (!have_same_dimensions(pe, prev_output)) setup(sub);
+            if (kv_cache_enabled)
+            {
+                // Only the newly appended positions are given to us, so encode them
+                // starting from the number of positions we have already seen.
+                sequence_dim = prev_output.nr();
+                embedding_dim = prev_output.nc();
+                compute_encodings(pe, prev_output.num_samples(), prev_output.k(), kv_cache_position);
+                kv_cache_position += prev_output.nr();
+            }
+            else if (!have_same_dimensions(pe, prev_output)) setup(sub);
             
             output.set_size(prev_output.num_samples(), prev_output.k(), sequence_dim, embedding_dim);
             tt::add(output, prev_output, pe);
@@ -5395,6 +5669,12 @@ namespace dlib
         const tensor& get_positional_encodings() const { return pe; }
         tensor& get_positional_encodings() { return pe; }
 
+        void enable_kv_cache() { kv_cache_enabled = true; kv_cache_position = 0; }
+        void disable_kv_cache() { kv_cache_enabled = false; kv_cache_position = 0; pe.clear(); }
+        void clear_kv_cache() { kv_cache_position = 0; }
+        bool is_kv_cache_enabled() const { return kv_cache_enabled; }
+        long get_kv_cache_position() const { return kv_cache_position; }
+
         friend void serialize(const positional_encodings_& /*item*/, std::ostream& out)
         {
             serialize("positional_encodings_", out);
@@ -5418,9 +5698,40 @@ namespace dlib
         }
 
     private:
+        void compute_encodings(
+            resizable_tensor& dest,
+            const long ns,
+            const long nk,
+            const long position_offset
+        ) const
+        {
+            const float n = 10000.0f;
+
+            dest.set_size(ns, nk, sequence_dim, embedding_dim);
+            float* d = dest.host();
+            for (long s = 0; s < ns; ++s)
+            {
+                for (long k = 0; k < nk; ++k)
+                {
+                    for (unsigned long r = 0; r < sequence_dim; ++r)
+                    {
+                        const float pos = static_cast<float>(r + position_offset);
+                        for (unsigned long c = 0; c < embedding_dim; ++c)
+                        {
+                            float theta = pos / std::pow(n, static_cast<float>(c) / embedding_dim);
+                            if (c % 2 == 0) d[tensor_index(dest, s, k, r, c)] = std::sin(theta);
+                            else d[tensor_index(dest, s, k, r, c)] = std::cos(theta);
+                        }
+                    }
+                }
+            }
+        }
+
         resizable_tensor params; // unused
         resizable_tensor pe;
         unsigned long sequence_dim, embedding_dim;
+        bool kv_cache_enabled;
+        long kv_cache_position;
     };
 
     template <typename SUBNET>
@@ -5601,7 +5912,12 @@ namespace dlib
     class tril_
     {
     public:
-        tril_(): diag(diag_), diag_value(compute_diag_value()) {}
+        tril_(): diag(diag_), diag_value(compute_diag_value()), kv_cache_enabled(false) {}
+
+        void enable_kv_cache() { kv_cache_enabled = true; binary_mask.clear(); }
+        void disable_kv_cache() { kv_cache_enabled = false; binary_mask.clear(); }
+        void clear_kv_cache() {}
+        bool is_kv_cache_enabled() const { return kv_cache_enabled; }
         
         template <typename SUBNET>
         void setup(const SUBNET& /*sub*/)
@@ -5675,14 +5991,18 @@ namespace dlib
                 if (diag_value != 0.0f) {
                     output_mask.copy_size(t);
                     output_mask = 0;
-                }                                
-                for (long s = 0; s < output_mask.num_samples(); ++s)
+                }
+                // When only the last rows of a longer sequence are given to us (i.e.
+                // incremental decoding with cached keys and values) the rows are
+                // aligned to the end of the columns rather than to their start.
+                const long row_offset = kv_cache_enabled ? std::max<long>(t.nc() - t.nr(), 0) : 0;
+                for (long s = 0; s < binary_mask.num_samples(); ++s)
                 {
-                    for (long k = 0; k < output_mask.k(); ++k)
+                    for (long k = 0; k < binary_mask.k(); ++k)
                     {
-                        for (long r = 0; r < output_mask.nr(); ++r)
+                        for (long r = 0; r < binary_mask.nr(); ++r)
                         {
-                            for (long c = std::max(r + diag + 1, 0L); c < output_mask.nc(); ++c)
+                            for (long c = std::max(r + row_offset + diag + 1, 0L); c < binary_mask.nc(); ++c)
                             {
                                 if (diag_value != 0.0f) output_mask.host()[tensor_index(output_mask, s, k, r, c)] = diag_value;
                                 binary_mask.host()[tensor_index(binary_mask, s, k, r, c)] = 0;
@@ -5700,6 +6020,7 @@ namespace dlib
         resizable_tensor binary_mask, output_mask;
         long diag;
         float diag_value;
+        bool kv_cache_enabled;
     };
 
     template <typename SUBNET>
@@ -5711,6 +6032,213 @@ namespace dlib
     template <long diag, long num, long den, typename SUBNET>
     using tril_diag = add_layer<tril_<diag, void, num, den>, SUBNET>;
 
+// ----------------------------------------------------------------------------------------
+
+    class kv_cache_
+    {
+    public:
+        kv_cache_() : kv_cache_enabled(false) {}
+
+        template <typename SUBNET>
+        void setup(const SUBNET& /*sub*/) {}
+
+        template <typename SUBNET>
+        void forward(const SUBNET& sub, resizable_tensor& output)
+        {
+            const auto& prev = sub.get_output();
+            if (!kv_cache_enabled)
+            {
+                output.copy_size(prev);
+                memcpy(output, prev);
+                return;
+            }
+
+            if (cache.size() != 0)
+            {
+                DLIB_CASSERT(cache.num_samples() == prev.num_samples() &&
+                    cache.k() == prev.k() && cache.nc() == prev.nc(),
+                    "The tensors appended to a kv_cache_ layer must all have the same number of samples, channels and columns."
+                    << "\n\t cache.num_samples(): " << cache.num_samples()
+                    << "\n\t cache.k():           " << cache.k()
+                    << "\n\t cache.nc():          " << cache.nc()
+                    << "\n\t prev.num_samples():  " << prev.num_samples()
+                    << "\n\t prev.k():            " << prev.k()
+                    << "\n\t prev.nc():           " << prev.nc()
+                );
+            }
+
+            // Append the rows of each input plane to the end of the matching cached plane.
+            const long old_nr = cache.size() != 0 ? cache.nr() : 0;
+            const long new_nr = old_nr + prev.nr();
+            const long num_planes = prev.num_samples() * prev.k();
+            const long nc = prev.nc();
+            temp.set_size(prev.num_samples(), prev.k(), new_nr, nc);
+            float* d = temp.host_write_only();
+            const float* c = cache.host();
+            const float* s = prev.host();
+            for (long p = 0; p < num_planes; ++p)
+            {
+                std::copy(c + p*old_nr*nc, c + (p+1)*old_nr*nc, d + p*new_nr*nc);
+                std::copy(s + p*prev.nr()*nc, s + (p+1)*prev.nr()*nc, d + p*new_nr*nc + old_nr*nc);
+            }
+            cache.swap(temp);
+
+            output.copy_size(cache);
+            memcpy(output, cache);
+        }
+
+        template <typename SUBNET>
+        void backward(const tensor& gradient_input, SUBNET& sub, tensor& /*params_grad*/)
+        {
+            DLIB_CASSERT(!kv_cache_enabled, "kv_cache_ layers can't be trained while their cache is enabled.");
+            auto& prev_grad = sub.get_gradient_input();
+            tt::add(prev_grad, prev_grad, gradient_input);
+        }
+
+        void enable_kv_cache() { kv_cache_enabled = true; clear_kv_cache(); }
+        void disable_kv_cache() { kv_cache_enabled = false; clear_kv_cache(); }
+        void clear_kv_cache() { cache.clear(); temp.clear(); }
+        bool is_kv_cache_enabled() const { return kv_cache_enabled; }
+        long get_kv_cache_length() const { return cache.size() != 0 ? cache.nr() : 0; }
+        const tensor& get_kv_cache() const { return cache; }
+
+        inline dpoint map_input_to_output(const dpoint& p) const { return p; }
+        inline dpoint map_output_to_input(const dpoint& p) const { return p; }
+
+        const tensor& get_layer_params() const { return params; }
+        tensor& get_layer_params() { return params; }
+
+        friend void serialize(const kv_cache_& /*item*/, std::ostream& out)
+        {
+            serialize("kv_cache_", out);
+        }
+        friend void deserialize(kv_cache_& item, std::istream& in)
+        {
+            std::string version;
+            deserialize(version, in);
+            if (version != "kv_cache_")
+                throw serialization_error("Unexpected version '" + version + "' found while deserializing dlib::kv_cache_.");
+            item.disable_kv_cache();
+        }
+
+        friend std::ostream& operator<<(std::ostream& out, const kv_cache_& item)
+        {
+            out << "kv_cache (enabled=" << (item.kv_cache_enabled ? "true" : "false") << ")";
+            return out;
+        }
+        friend void to_xml(const kv_cache_& /*item*/, std::ostream& out)
+        {
+            out << "<kv_cache />\n";
+        }
+
+    private:
+        resizable_tensor params; // unused
+        resizable_tensor cache, temp;
+        bool kv_cache_enabled;
+    };
+
+    template <typename SUBNET>
+    using kv_cache = add_layer<kv_cache_, SUBNET>;
+
+// ----------------------------------------------------------------------------------------
+
+    enum attention_mask_mode { ATTENTION_NO_MASK = 0, ATTENTION_CAUSAL_MASK = 1 };
+
+    template <
+        long num_heads_,
+        attention_mask_mode mask_mode_
+        >
+    class attention_
+    {
+        static_assert(num_heads_ > 0, "The number of attention heads must be > 0.");
+
+    public:
+        attention_() {}
+
+        long get_num_heads() const { return num_heads_; }
+        attention_mask_mode get_mask_mode() const { return mask_mode_; }
+
+        template <typename SUBNET>
+        void setup(const SUBNET& sub)
+        {
+            DLIB_CASSERT(sub.get_output().nc() % (3*num_heads_) == 0,
+                "The input to an attention_ layer must contain the query, key and value vectors of each head."
+                << "\n\t sub.get_output().nc(): " << sub.get_output().nc()
+                << "\n\t num_heads:             " << num_heads_
+            );
+        }
+
+        template <typename SUBNET>
+        void forward(const SUBNET& sub, resizable_tensor& output)
+        {
+            tt::scaled_dot_product_attention(output, softmax_stats, sub.get_output(),
+                num_heads_, mask_mode_ == ATTENTION_CAUSAL_MASK);
+        }
+
+        template <typename SUBNET>
+        void backward(
+            const tensor& computed_output,
+            const tensor& gradient_input,
+            SUBNET& sub,
+            tensor& /*params_grad*/
+        )
+        {
+            tt::scaled_dot_product_attention_gradient(sub.get_gradient_input(), gradient_input,
+                sub.get_output(), computed_output, softmax_stats, num_heads_,
+                mask_mode_ == ATTENTION_CAUSAL_MASK);
+        }
+
+        inline dpoint map_input_to_output(const dpoint& p) const { return p; }
+        inline dpoint map_output_to_input(const dpoint& p) const { return p; }
+
+        const tensor& get_layer_params() const { return params; }
+        tensor& get_layer_params() { return params; }
+
+        friend void serialize(const attention_& /*item*/, std::ostream& out)
+        {
+            serialize("attention_", out);
+            serialize(num_heads_, out);
+            serialize((int)mask_mode_, out);
+        }
+
+        friend void deserialize(attention_& /*item*/, std::istream& in)
+        {
+            std::string version;
+            deserialize(version, in);
+            if (version != "attention_")
+                throw serialization_error("Unexpected version '" + version + "' found while deserializing dlib::attention_.");
+            long num_heads;
+            int mask_mode;
+            deserialize(num_heads, in);
+            deserialize(mask_mode, in);
+            if (num_heads != num_heads_) throw serialization_error("Wrong num_heads found while deserializing dlib::attention_");
+            if (mask_mode != mask_mode_) throw serialization_error("Wrong mask_mode found while deserializing dlib::attention_");
+        }
+
+        friend std::ostream& operator<<(std::ostream& out, const attention_& /*item*/)
+        {
+            out << "attention\t (num_heads=" << num_heads_
+                << ", causal=" << (mask_mode_ == ATTENTION_CAUSAL_MASK ? "true" : "false") << ")";
+            return out;
+        }
+
+        friend void to_xml(const attention_& /*item*/, std::ostream& out)
+        {
+            out << "<attention num_heads='" << num_heads_ << "'"
+                << " causal='" << (mask_mode_ == ATTENTION_CAUSAL_MASK ? "true" : "false") << "'/>\n";
+        }
+
+    private:
+        resizable_tensor params; // unused
+        resizable_tensor softmax_stats;
+    };
+
+    template <long num_heads, typename SUBNET>
+    using attention = add_layer<attention_<num_heads, ATTENTION_NO_MASK>, SUBNET>;
+
+    template <long num_heads, typename SUBNET>
+    using causal_attention = add_layer<attention_<num_heads, ATTENTION_CAUSAL_MASK>, SUBNET>;
+
 // ----------------------------------------------------------------------------------------
 
     template <long max_steps = 8>
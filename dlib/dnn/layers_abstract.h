@@ -666,6 +666,36 @@ namespace dlib
                 - #get_layer_params().size() == (#get_weights().size() + #get_biases().size())
         !*/
 
+        bool is_quantized(
+        ) const;
+        /*!
+            ensures
+                - returns true if quantize_to_int8() has been called on this layer.  In that
+                  case forward() computes the layer's output with 8 bit integer weights and
+                  activations, accumulating in 32 bit integers, and the float parameters are
+                  no longer stored.
+        !*/
+
+        void quantize_to_int8 (
+            float input_range
+        );
+        /*!
+            requires
+                - is_quantized() == false
+                - get_layer_params().size() != 0 (i.e. setup() has been called)
+                - input_range >= 0
+            ensures
+                - #is_quantized() == true
+                - Converts the weights of this layer to int8, with a separate scale for each
+                  output, and releases the float parameters.  That is,
+                  #get_layer_params().size() == 0.  Biases are kept in float.
+                - Inputs to forward() will be quantized to 8 bits, covering the range
+                  [-input_range, input_range].  Larger inputs are clipped.  Usually you
+                  don't call this directly but use quantize_to_int8(net, ...) from
+                  dnn/visitors_abstract.h, which measures input_range on calibration data.
+                - The layer can no longer be trained, i.e. backward() must not be called.
+        !*/
+
         template <typename SUBNET> void setup (const SUBNET& sub);
         template <typename SUBNET> void forward(const SUBNET& sub, resizable_tensor& output);
         template <typename SUBNET> void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad);
@@ -1204,6 +1234,7 @@ namespace dlib
         );
         /*!
             ensures
+                - #get_fused_activation() == fused_activation::NONE
                 - relu_is_disabled() returns true
         !*/
 
@@ -1211,6 +1242,7 @@ namespace dlib
         );
         /*!
             ensures
+                - #get_fused_activation() == fused_activation::RELU
                 - relu_is_disabled() returns false
         !*/
 
@@ -1218,8 +1250,48 @@ namespace dlib
         ) const;
         /*!
             ensures
-                - returns true if relu is disabled for this layer. This means no activation function
-                  will be applied after the convolution when calling forward.
+                - returns get_fused_activation() != fused_activation::RELU
+        !*/
+
+        fused_activation get_fused_activation(
+        ) const;
+        /*!
+            ensures
+                - returns the activation function applied to the output of the
+                  convolution, after the biases are added, when calling forward.  This is
+                  fused_activation::NONE by default.  fuse_layers() sets it to fold a
+                  following relu_, leaky_relu_, clipped_relu_ or elu_ layer into this layer.
+                - The biases and a relu are applied by the convolution itself as it writes
+                  its output (except by the CPU 1x1 convolution, which applies them in a
+                  pass over each sample right after computing it).  The other activations
+                  are applied, together with the biases, in one separate pass over the
+                  output of the convolution.  Either way, this saves the extra pass over
+                  the data and the output tensor a separate activation layer would need.
+        !*/
+
+        float get_fused_activation_param(
+        ) const;
+        /*!
+            ensures
+                - returns the parameter of get_fused_activation(), as described in
+                  dlib/cuda/fused_activation.h.
+        !*/
+
+        void set_fused_activation(
+            fused_activation act,
+            float param = 0
+        );
+        /*!
+            ensures
+                - #get_fused_activation() == act
+                - #get_fused_activation_param() == param
+        !*/
+
+        void disable_fused_activation(
+        );
+        /*!
+            ensures
+                - #get_fused_activation() == fused_activation::NONE
         !*/
 
         void disable_bias(
@@ -1249,6 +1321,36 @@ namespace dlib
                   methods either.
         !*/
 
+        bool is_quantized(
+        ) const;
+        /*!
+            ensures
+                - returns true if quantize_to_int8() has been called on this layer.  In that
+                  case forward() computes the layer's output with 8 bit integer weights and
+                  activations, accumulating in 32 bit integers, and the float parameters are
+                  no longer stored.
+        !*/
+
+        void quantize_to_int8 (
+            float input_range
+        );
+        /*!
+            requires
+                - is_quantized() == false
+                - get_layer_params().size() != 0 (i.e. setup() has been called)
+                - input_range >= 0
+            ensures
+                - #is_quantized() == true
+                - Converts the weights of this layer to int8, with a separate scale for each
+                  output, and releases the float parameters.  That is,
+                  #get_layer_params().size() == 0.  Biases are kept in float.
+                - Inputs to forward() will be quantized to 8 bits, covering the range
+                  [-input_range, input_range].  Larger inputs are clipped.  Usually you
+                  don't call this directly but use quantize_to_int8(net, ...) from
+                  dnn/visitors_abstract.h, which measures input_range on calibration data.
+                - The layer can no longer be trained, i.e. backward() must not be called.
+        !*/
+
         template <typename SUBNET> void setup (const SUBNET& sub);
         template <typename SUBNET> void forward(const SUBNET& sub, resizable_tensor& output);
         template <typename SUBNET> void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad);
@@ -3031,6 +3133,22 @@ namespace dlib
                 - returns the alpha parameter of the leaky_relu
         !*/
 
+        void disable(
+        );
+        /*!
+            ensures
+                - #is_disabled() == true
+                - This layer then performs the identity transform.  fuse_layers() calls
+                  this once the activation has been moved into the layer below.
+        !*/
+
+        bool is_disabled(
+        ) const;
+        /*!
+            ensures
+                - returns true if disable() has been called on this layer.
+        !*/
+
         template <typename SUBNET> void setup(const SUBNET& sub);
         void forward_inplace(const tensor& input, tensor& output);
         void backward_inplace(const tensor& computed_output, const tensor& gradient_input, tensor& data_grad, tensor& params_grad);
@@ -3186,6 +3304,22 @@ namespace dlib
                 - returns the celiling parameter of the clipped_relu
         !*/
 
+        void disable(
+        );
+        /*!
+            ensures
+                - #is_disabled() == true
+                - This layer then performs the identity transform.  fuse_layers() calls
+                  this once the activation has been moved into the layer below.
+        !*/
+
+        bool is_disabled(
+        ) const;
+        /*!
+            ensures
+                - returns true if disable() has been called on this layer.
+        !*/
+
         template <typename SUBNET> void setup (const SUBNET& sub);
         void forward_inplace(const tensor& input, tensor& output);
         void backward_inplace(const tensor& computed_output, const tensor& gradient_input, tensor& data_grad, tensor& params_grad);
@@ -3236,6 +3370,22 @@ namespace dlib
             ensures
                 - returns the alpha parameter of the elu
         !*/
+
+        void disable(
+        );
+        /*!
+            ensures
+                - #is_disabled() == true
+                - This layer then performs the identity transform.  fuse_layers() calls
+                  this once the activation has been moved into the layer below.
+        !*/
+
+        bool is_disabled(
+        ) const;
+        /*!
+            ensures
+                - returns true if disable() has been called on this layer.
+        !*/
         template <typename SUBNET> void setup (const SUBNET& sub);
         void forward_inplace(const tensor& input, tensor& output);
         void backward_inplace(const tensor& computed_output, const tensor& gradient_input, tensor& data_grad, tensor& params_grad);
@@ -3508,12 +3658,49 @@ namespace dlib
                     - C.k()  == max(A.k(), B.k())
                     - C.nr() == max(A.nr(), B.nr())
                     - C.nc() == max(A.nc(), B.nc())
+
+                fuse_layers() can additionally make this layer apply an activation
+                function to the sum, see get_fused_activation().
         !*/
 
     public:
         add_prev_(
         ); 
 
+        fused_activation get_fused_activation(
+        ) const;
+        /*!
+            ensures
+                - returns the activation function applied to the sum computed by
+                  forward().  This is fused_activation::NONE by default.  A layer with any
+                  other activation can only be used for inference.
+        !*/
+
+        float get_fused_activation_param(
+        ) const;
+        /*!
+            ensures
+                - returns the parameter of get_fused_activation(), as described in
+                  dlib/cuda/fused_activation.h.
+        !*/
+
+        void set_fused_activation(
+            fused_activation act,
+            float param = 0
+        );
+        /*!
+            ensures
+                - #get_fused_activation() == act
+                - #get_fused_activation_param() == param
+        !*/
+
+        void disable_fused_activation(
+        );
+        /*!
+            ensures
+                - #get_fused_activation() == fused_activation::NONE
+        !*/
+
         template <typename SUBNET> void setup (const SUBNET& sub);
         template <typename SUBNET> void forward(const SUBNET& sub, resizable_tensor& output);
         template <typename SUBNET> void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad);
@@ -4521,6 +4708,49 @@ namespace dlib
         template <typename SUBNET> void forward(const SUBNET& sub, resizable_tensor& output);
         template <typename SUBNET> void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad);
 
+        void enable_kv_cache(
+        );
+        /*!
+            ensures
+                - #is_kv_cache_enabled() == true
+                - #get_kv_cache_position() == 0
+                - From now on, each call to forward() is assumed to contain the sequence
+                  positions that follow the ones given in the previous calls.  So the rows
+                  of the input are encoded as positions get_kv_cache_position(),
+                  get_kv_cache_position()+1, ... and get_kv_cache_position() is then
+                  incremented by the number of input rows.
+        !*/
+
+        void disable_kv_cache(
+        );
+        /*!
+            ensures
+                - #is_kv_cache_enabled() == false
+                - #get_kv_cache_position() == 0
+        !*/
+
+        void clear_kv_cache(
+        );
+        /*!
+            ensures
+                - #get_kv_cache_position() == 0
+        !*/
+
+        bool is_kv_cache_enabled(
+        ) const;
+        /*!
+            ensures
+                - returns true if this layer is in incremental decoding mode.
+        !*/
+
+        long get_kv_cache_position(
+        ) const;
+        /*!
+            ensures
+                - returns the number of sequence positions processed since incremental
+                  decoding mode was enabled or the cache was last cleared.
+        !*/
+
         const tensor& get_layer_params() const;
         tensor& get_layer_params();
         const tensor& get_embeddings() const;
@@ -4603,6 +4833,12 @@ namespace dlib
                 // Create a layer that masks all elements 3 positions below the main diagonal with 0.25
                 tril_<-3, void, 1, 4> layer5;
 
+            INCREMENTAL DECODING
+                When is_kv_cache_enabled() == true and the input has fewer rows than columns,
+                the rows are taken to be the last rows of a larger square matrix.  That is,
+                row r of the input is masked as if it was row r + (nc - nr) so that the
+                scores of newly appended positions against cached keys are correctly masked.
+
             SERIALIZATION SUPPORT
                 This object supports serialization and deserialization via the serialize() and deserialize() functions.
         !*/
@@ -4612,6 +4848,34 @@ namespace dlib
         /*!
             ensures
                 - This object is properly initialized.
+                - #is_kv_cache_enabled() == false
+        !*/
+
+        void enable_kv_cache();
+        /*!
+            ensures
+                - #is_kv_cache_enabled() == true
+        !*/
+
+        void disable_kv_cache();
+        /*!
+            ensures
+                - #is_kv_cache_enabled() == false
+        !*/
+
+        void clear_kv_cache();
+        /*!
+            ensures
+                - This layer doesn't store any sequence state, so this function does nothing.
+                  It is provided so that all the incremental decoding layers share the same
+                  interface.
+        !*/
+
+        bool is_kv_cache_enabled() const;
+        /*!
+            ensures
+                - returns true if the mask is aligned for incremental decoding as described
+                  above.
         !*/
 
         template <typename SUBNET>
@@ -4699,6 +4963,190 @@ namespace dlib
     template <long diag, long num, long den, typename SUBNET>
     using tril_diag = add_layer<tril_<diag, void, num, den>, SUBNET>;
 
+// ----------------------------------------------------------------------------------------
+
+    class kv_cache_
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This is an implementation of the EXAMPLE_COMPUTATIONAL_LAYER_ interface
+                defined above.  It is used to cache the keys or values of an attention
+                block so that autoregressive text generation only needs to push the newly
+                generated position through the network instead of the whole sequence.
+
+                When is_kv_cache_enabled() == false, this layer is the identity function.
+                When it is enabled, the rows of each input plane are appended to the rows
+                cached from previous calls to forward() and the output is the whole cached
+                tensor.  So if the input has dimensions (N, K, R, C) and the layer has
+                already seen L rows, the output has dimensions (N, K, L+R, C).
+
+                To be cacheable an attention block must keep the sequence positions along
+                the rows of its tensors and put a kv_cache layer right after the key and
+                value projections, e.g.:
+
+                    template <typename SUBNET>
+                    using attention = multm_prev1<softmaxm<tril_mask<
+                                      multm_prev2<linear_no_bias<d_model, skip3<
+                                      tag2<transpose<kv_cache<linear_no_bias<d_model, skip3<
+                                      tag1<kv_cache<linear_no_bias<d_model,
+                                      tag3<SUBNET>>>>>>>>>>>>>>>;
+
+                Calling enable_kv_cache(net) then switches all such layers, as well as the
+                tril_ and positional_encodings_ layers, into incremental decoding mode.
+        !*/
+
+    public:
+
+        kv_cache_(
+        );
+        /*!
+            ensures
+                - #is_kv_cache_enabled() == false
+                - #get_kv_cache_length() == 0
+        !*/
+
+        void enable_kv_cache(
+        );
+        /*!
+            ensures
+                - #is_kv_cache_enabled() == true
+                - #get_kv_cache_length() == 0
+        !*/
+
+        void disable_kv_cache(
+        );
+        /*!
+            ensures
+                - #is_kv_cache_enabled() == false
+                - #get_kv_cache_length() == 0
+        !*/
+
+        void clear_kv_cache(
+        );
+        /*!
+            ensures
+                - #get_kv_cache_length() == 0
+                - #is_kv_cache_enabled() == is_kv_cache_enabled()
+        !*/
+
+        bool is_kv_cache_enabled(
+        ) const;
+        /*!
+            ensures
+                - returns true if this layer appends its inputs to its cache rather than
+                  just copying them to its output.
+        !*/
+
+        long get_kv_cache_length(
+        ) const;
+        /*!
+            ensures
+                - returns the number of rows currently held in the cache.
+        !*/
+
+        const tensor& get_kv_cache(
+        ) const;
+        /*!
+            ensures
+                - returns the cached tensor.  It has get_kv_cache_length() rows.
+        !*/
+
+        template <typename SUBNET> void setup (const SUBNET& sub);
+        template <typename SUBNET> void forward(const SUBNET& sub, resizable_tensor& output);
+        template <typename SUBNET> void backward(const tensor& gradient_input, SUBNET& sub, tensor& params_grad);
+        /*!
+            requires
+                - backward() is only called when is_kv_cache_enabled() == false.
+        !*/
+        dpoint map_input_to_output(dpoint p) const;
+        dpoint map_output_to_input(dpoint p) const;
+        const tensor& get_layer_params() const;
+        tensor& get_layer_params();
+        /*!
+            These functions are implemented as described in the EXAMPLE_COMPUTATIONAL_LAYER_
+            interface.  Note that the cache is not serialized.
+        !*/
+    };
+
+    template <typename SUBNET>
+    using kv_cache = add_layer<kv_cache_, SUBNET>;
+
+// ----------------------------------------------------------------------------------------
+
+    enum attention_mask_mode { ATTENTION_NO_MASK = 0, ATTENTION_CAUSAL_MASK = 1 };
+
+    template <
+        long num_heads_,
+        attention_mask_mode mask_mode_
+        >
+    class attention_
+    {
+        /*!
+            REQUIREMENTS ON TEMPLATE ARGUMENTS
+                - num_heads_ > 0
+
+            WHAT THIS OBJECT REPRESENTS
+                This is an implementation of the EXAMPLE_COMPUTATIONAL_LAYER_ interface
+                defined above.  It computes multi-head scaled dot-product attention in a
+                single fused operation.  That is, it computes the same thing as the chain of
+                extract, multm_prev, scaling, tril_mask, softmaxm and multm_prev layers used
+                to spell out attention, but without ever storing the num_positions x
+                num_positions score matrix of each head.  See
+                tt::scaled_dot_product_attention() for the details.
+
+                Each plane of the input tensor holds a sequence, one position per row, and
+                each row holds the query, key and value vectors of that position side by
+                side.  So the output of a linear_<3*d_model> layer is a suitable input.  If
+                the input has dimensions (N, K, R, 3*d_model) the output has dimensions
+                (N, K, R, d_model) and holds the concatenated outputs of the num_heads_
+                heads, each of size d_model/num_heads_.
+
+                If mask_mode_ == ATTENTION_CAUSAL_MASK, each position only attends to itself
+                and to the positions before it, as required by autoregressive models.
+        !*/
+
+    public:
+
+        attention_(
+        );
+
+        long get_num_heads(
+        ) const;
+        /*!
+            ensures
+                - returns num_heads_
+        !*/
+
+        attention_mask_mode get_mask_mode(
+        ) const;
+        /*!
+            ensures
+                - returns mask_mode_
+        !*/
+
+        template <typename SUBNET> void setup (const SUBNET& sub);
+        /*!
+            requires
+                - sub.get_output().nc() % (3*num_heads_) == 0
+        !*/
+        template <typename SUBNET> void forward(const SUBNET& sub, resizable_tensor& output);
+        template <typename SUBNET> void backward(const tensor& computed_output, const tensor& gradient_input, SUBNET& sub, tensor& params_grad);
+        dpoint map_input_to_output(dpoint p) const;
+        dpoint map_output_to_input(dpoint p) const;
+        const tensor& get_layer_params() const;
+        tensor& get_layer_params();
+        /*!
+            These functions are implemented as described in the EXAMPLE_COMPUTATIONAL_LAYER_
+            interface.  This layer has no parameters.
+        !*/
+    };
+
+    template <long num_heads, typename SUBNET>
+    using attention = add_layer<attention_<num_heads, ATTENTION_NO_MASK>, SUBNET>;
+
+    template <long num_heads, typename SUBNET>
+    using causal_attention = add_layer<attention_<num_heads, ATTENTION_CAUSAL_MASK>, SUBNET>;
+
 // ----------------------------------------------------------------------------------------
 
     template <long max_steps>
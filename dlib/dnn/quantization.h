@@ -0,0 +1,190 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DNn_QUANTIZATION_H_
+#define DLIB_DNn_QUANTIZATION_H_
+
+#include "quantization_abstract.h"
+#include "../cuda/tensor.h"
+#include "../cuda/cpu_dlib.h"
+#include "../serialize.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class int8_weights
+    {
+    public:
+
+        int8_weights() = default;
+
+        bool empty() const { return weights.empty(); }
+        long num_outputs() const { return static_cast<long>(scales.size()); }
+        long num_inputs() const { return empty() ? 0 : static_cast<long>(weights.size())/num_outputs(); }
+        float get_input_scale() const { return input_scale; }
+
+        void quantize (
+            const float* w,
+            long num_outputs_,
+            long num_inputs_,
+            long output_stride,
+            long input_stride,
+            const float* bias,
+            float input_range
+        )
+        {
+            DLIB_CASSERT(num_outputs_ > 0 && num_inputs_ > 0);
+            DLIB_CASSERT(input_range >= 0 && std::isfinite(input_range));
+            input_scale = input_range > 0 ? input_range/127 : 1;
+            weights.resize(num_outputs_*num_inputs_);
+            scales.resize(num_outputs_);
+            biases.assign(num_outputs_, 0);
+            for (long o = 0; o < num_outputs_; ++o)
+            {
+                // Each output gets its own symmetric scale so that one large filter
+                // doesn't cost all the others their precision.
+                float max_abs = 0;
+                for (long i = 0; i < num_inputs_; ++i)
+                    max_abs = std::max(max_abs, std::abs(w[o*output_stride + i*input_stride]));
+                const float weight_scale = max_abs > 0 ? max_abs/127 : 1;
+                for (long i = 0; i < num_inputs_; ++i)
+                    weights[o*num_inputs_ + i] = static_cast<int8_t>(std::round(w[o*output_stride + i*input_stride]/weight_scale));
+                scales[o] = weight_scale*input_scale;
+                if (bias)
+                    biases[o] = bias[o];
+            }
+        }
+
+        void fc_forward (
+            const tensor& input,
+            resizable_tensor& output
+        )
+        {
+            DLIB_CASSERT(!empty());
+            const long num_samples = input.num_samples();
+            DLIB_CASSERT((long)input.size() == num_samples*num_inputs());
+            output.set_size(num_samples, num_outputs());
+
+            quantized_input.resize(input.size());
+            cpu::quantize_to_int8(input.host(), input.size(), input_scale, quantized_input.data());
+            accumulators.resize(num_samples*num_outputs());
+            cpu::int8_gemm(num_samples, num_outputs(), num_inputs(), quantized_input.data(), weights.data(), accumulators.data());
+
+            float* out = output.host_write_only();
+            for (long n = 0; n < num_samples; ++n)
+            {
+                for (long o = 0; o < num_outputs(); ++o, ++out)
+                    *out = accumulators[n*num_outputs() + o]*scales[o] + biases[o];
+            }
+        }
+
+        void conv_forward (
+            const tensor& data,
+            resizable_tensor& output,
+            long filter_nr,
+            long filter_nc,
+            long stride_y,
+            long stride_x,
+            long padding_y,
+            long padding_x,
+            bool use_relu
+        )
+        {
+            DLIB_CASSERT(!empty());
+            DLIB_CASSERT(data.k()*filter_nr*filter_nc == num_inputs());
+            const long out_nr = 1+(data.nr()+2*padding_y-filter_nr)/stride_y;
+            const long out_nc = 1+(data.nc()+2*padding_x-filter_nc)/stride_x;
+            const long out_plane_size = out_nr*out_nc;
+            output.set_size(data.num_samples(), num_outputs(), out_nr, out_nc);
+
+            quantized_input.resize(data.size());
+            cpu::quantize_to_int8(data.host(), data.size(), input_scale, quantized_input.data());
+            lowered_input.resize(out_plane_size*num_inputs());
+            accumulators.resize(num_outputs()*out_plane_size);
+
+            float* out = output.host_write_only();
+            for (long n = 0; n < data.num_samples(); ++n)
+            {
+                // Lower the quantized sample into its Toeplitz matrix, one row per output
+                // location, the same way cpu::img2col() does for float tensors.
+                const int8_t* d = &quantized_input[n*data.k()*data.nr()*data.nc()];
+                int8_t* t = lowered_input.data();
+                for (long r = 0; r < out_nr; ++r)
+                {
+                    for (long c = 0; c < out_nc; ++c)
+                    {
+                        for (long k = 0; k < data.k(); ++k)
+                        {
+                            for (long y = 0; y < filter_nr; ++y)
+                            {
+                                const long yy = r*stride_y - padding_y + y;
+                                for (long x = 0; x < filter_nc; ++x, ++t)
+                                {
+                                    const long xx = c*stride_x - padding_x + x;
+                                    if (0 <= yy && yy < data.nr() && 0 <= xx && xx < data.nc())
+                                        *t = d[(k*data.nr() + yy)*data.nc() + xx];
+                                    else
+                                        *t = 0;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                cpu::int8_gemm(num_outputs(), out_plane_size, num_inputs(), weights.data(), lowered_input.data(), accumulators.data());
+
+                for (long k = 0; k < num_outputs(); ++k)
+                {
+                    const int32_t* acc = &accumulators[k*out_plane_size];
+                    for (long i = 0; i < out_plane_size; ++i, ++out)
+                    {
+                        const float v = acc[i]*scales[k] + biases[k];
+                        *out = (use_relu && v < 0) ? 0 : v;
+                    }
+                }
+            }
+        }
+
+        friend void serialize(const int8_weights& item, std::ostream& out)
+        {
+            serialize("int8_weights", out);
+            serialize(item.weights, out);
+            serialize(item.scales, out);
+            serialize(item.biases, out);
+            serialize(item.input_scale, out);
+        }
+
+        friend void deserialize(int8_weights& item, std::istream& in)
+        {
+            std::string version;
+            deserialize(version, in);
+            if (version != "int8_weights")
+                throw serialization_error("Unexpected version '"+version+"' found while deserializing dlib::int8_weights.");
+            deserialize(item.weights, in);
+            deserialize(item.scales, in);
+            deserialize(item.biases, in);
+            deserialize(item.input_scale, in);
+        }
+
+    private:
+
+        std::vector<int8_t> weights; // num_outputs() by num_inputs(), row major
+        std::vector<float> scales;   // converts an output's int32 sum back to float
+        std::vector<float> biases;
+        float input_scale = 1;
+
+        // scratch space for the forward passes
+        std::vector<int8_t> quantized_input;
+        std::vector<int8_t> lowered_input;
+        std::vector<int32_t> accumulators;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_QUANTIZATION_H_
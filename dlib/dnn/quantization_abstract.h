@@ -0,0 +1,144 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DNn_QUANTIZATION_ABSTRACT_H_
+#ifdef DLIB_DNn_QUANTIZATION_ABSTRACT_H_
+
+#include "../cuda/tensor_abstract.h"
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class int8_weights
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object holds the weights of a fully connected or convolutional layer
+                quantized to 8 bit integers, and runs that layer's forward pass with them.
+                It is what con_ and fc_ use once their quantize_to_int8() method has been
+                called.
+
+                The weights are stored as a num_outputs() by num_inputs() matrix W of
+                int8 values, with one scale per output, so that output o is approximately
+                    scale_o*dot(W[o], round(x/get_input_scale())) + bias_o
+                where x is the layer's input.  Inputs are quantized symmetrically into
+                [-127, 127] and the dot products are accumulated in 32 bit integers.
+        !*/
+
+    public:
+
+        int8_weights(
+        );
+        /*!
+            ensures
+                - #empty() == true
+        !*/
+
+        bool empty(
+        ) const;
+        /*!
+            ensures
+                - returns true if quantize() has never been called on this object.
+        !*/
+
+        long num_outputs(
+        ) const;
+        /*!
+            ensures
+                - returns the number of outputs, i.e. filters, of the quantized layer.
+        !*/
+
+        long num_inputs(
+        ) const;
+        /*!
+            ensures
+                - returns the number of inputs to each output of the quantized layer.
+        !*/
+
+        float get_input_scale(
+        ) const;
+        /*!
+            ensures
+                - returns the size of one integer step of the quantized input.  This is
+                  input_range/127 for the input_range given to quantize().
+        !*/
+
+        void quantize (
+            const float* w,
+            long num_outputs,
+            long num_inputs,
+            long output_stride,
+            long input_stride,
+            const float* bias,
+            float input_range
+        );
+        /*!
+            requires
+                - num_outputs > 0
+                - num_inputs > 0
+                - input_range >= 0
+                - for all valid o and i: w[o*output_stride + i*input_stride] is the
+                  weight connecting input i to output o.
+                - bias == nullptr or bias points to num_outputs floats.
+            ensures
+                - #empty() == false
+                - #num_outputs() == num_outputs
+                - #num_inputs() == num_inputs
+                - Quantizes the weights in w, using a separate scale for each output.
+                - #get_input_scale() == input_range/127, or 1 if input_range == 0.  That
+                  is, inputs in the range [-input_range, input_range] are represented
+                  without clipping.
+                - The bias values are kept in float.  If bias == nullptr they are 0.
+        !*/
+
+        void fc_forward (
+            const tensor& input,
+            resizable_tensor& output
+        );
+        /*!
+            requires
+                - empty() == false
+                - input.size() == input.num_samples()*num_inputs()
+            ensures
+                - Computes the output of a fully connected layer, as fc_ does.  That is,
+                  #output.num_samples() == input.num_samples(), #output.k() ==
+                  num_outputs() and each sample of #output holds the weighted sums of the
+                  corresponding input sample plus the biases.
+        !*/
+
+        void conv_forward (
+            const tensor& data,
+            resizable_tensor& output,
+            long filter_nr,
+            long filter_nc,
+            long stride_y,
+            long stride_x,
+            long padding_y,
+            long padding_x,
+            bool use_relu
+        );
+        /*!
+            requires
+                - empty() == false
+                - data.k()*filter_nr*filter_nc == num_inputs()
+                - stride_y > 0 && stride_x > 0
+            ensures
+                - Computes the output of a convolutional layer, as con_ does, using
+                  num_outputs() filters of size data.k() by filter_nr by filter_nc.  The
+                  biases are added to the result and, if use_relu == true, a relu is
+                  applied to it.
+        !*/
+    };
+
+    void serialize(const int8_weights& item, std::ostream& out);
+    void deserialize(int8_weights& item, std::istream& in);
+    /*!
+        provides serialization support
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DNn_QUANTIZATION_ABSTRACT_H_
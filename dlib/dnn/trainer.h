@@ -245,6 +245,29 @@ namespace dlib
             ++train_one_step_calls;
         }
 
+        void train_one_step (
+            resizable_tensor& data,
+            std::vector<training_label_type>& labels
+        )
+        {
+            DLIB_CASSERT(labels.size() > 0);
+            print_periodic_verbose_status();
+            sync_to_disk();
+            send_job(false, data, &labels);
+            ++train_one_step_calls;
+        }
+
+        void train_one_step (
+            resizable_tensor& data
+        )
+        {
+            DLIB_CASSERT(data.num_samples() > 0);
+            print_periodic_verbose_status();
+            sync_to_disk();
+            send_job(false, data, nullptr);
+            ++train_one_step_calls;
+        }
+
         void test_one_step (
             const std::vector<input_type>& data,
             const std::vector<training_label_type>& labels 
@@ -296,6 +319,29 @@ namespace dlib
             ++test_one_step_calls;
         }
 
+        void test_one_step (
+            resizable_tensor& data,
+            std::vector<training_label_type>& labels
+        )
+        {
+            DLIB_CASSERT(labels.size() > 0);
+            print_periodic_verbose_status();
+            sync_to_disk();
+            send_job(true, data, &labels);
+            ++test_one_step_calls;
+        }
+
+        void test_one_step (
+            resizable_tensor& data
+        )
+        {
+            DLIB_CASSERT(data.num_samples() > 0);
+            print_periodic_verbose_status();
+            sync_to_disk();
+            send_job(true, data, nullptr);
+            ++test_one_step_calls;
+        }
+
         void train (
             const std::vector<input_type>& data,
             const std::vector<training_label_type>& labels 
@@ -1242,6 +1288,77 @@ namespace dlib
             send_job(test_only, dbegin, dend, nothing);
         }
 
+        void send_job (
+            bool test_only,
+            resizable_tensor& data,
+            std::vector<training_label_type>* labels
+        )
+        {
+            propagate_exception();
+            const long sample_expansion_factor = devices[0]->net.sample_expansion_factor();
+            DLIB_CASSERT(sample_expansion_factor != 0,
+                "The network must have been given to to_tensor() at least once before "
+                "tensors can be passed to train_one_step() or test_one_step().");
+            DLIB_CASSERT(data.num_samples()%sample_expansion_factor == 0);
+            const size_t num = data.num_samples()/sample_expansion_factor;
+            DLIB_CASSERT(labels == nullptr || labels->size() == num,
+                "labels->size(): " << labels->size() << "\nnum: " << num);
+            size_t devs = devices.size();
+            job.t.resize(devs);
+            job.labels.resize(devs);
+            job.have_data.resize(devs);
+            job.test_only = test_only;
+
+            if (devs == 1)
+            {
+                // Hand the caller's buffers to the training thread as they are.  The
+                // caller gets back the buffers of an earlier job to refill.
+                job.t[0].swap(data);
+                if (labels)
+                    job.labels[0].swap(*labels);
+                job.have_data[0] = num > 0;
+                job_pipe.enqueue(job);
+                return;
+            }
+
+            // chop the data into devs blocks, each of about block_size elements.
+            const double block_size = num / static_cast<double>(devs);
+            const size_t sample_size = data.size()/data.num_samples();
+
+            const auto prev_dev = dlib::cuda::get_device();
+
+            double j = 0;
+
+            for (size_t i = 0; i < devs; ++i)
+            {
+                dlib::cuda::set_device(devices[i]->device_id);
+
+                const size_t start = static_cast<size_t>(std::round(j));
+                const size_t stop  = static_cast<size_t>(std::round(j + block_size));
+
+                if (start < stop)
+                {
+                    alias_tensor block((stop-start)*sample_expansion_factor, data.k(), data.nr(), data.nc());
+                    job.t[i].copy_size(block(data));
+                    memcpy(job.t[i], block(data, start*sample_expansion_factor*sample_size));
+                    if (labels)
+                        job.labels[i].assign(labels->begin()+start, labels->begin()+stop);
+                    job.have_data[i] = true;
+                }
+                else
+                {
+                    job.have_data[i] = false;
+                }
+
+                j += block_size;
+            }
+
+            DLIB_ASSERT(std::fabs(j - num) < 1e-10);
+
+            dlib::cuda::set_device(prev_dev);
+            job_pipe.enqueue(job);
+        }
+
         void print_progress()
         {
             if (lr_schedule.size() == 0)
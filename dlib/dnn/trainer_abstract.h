@@ -558,6 +558,49 @@ namespace dlib
                   accessing the network.
                 - #get_train_one_step_calls() == get_train_one_step_calls() + 1.
         !*/
+
+        void train_one_step (
+            resizable_tensor& data,
+            std::vector<training_label_type>& labels
+        );
+        /*!
+            requires
+                - labels.size() > 0
+                - data.num_samples() == labels.size()*get_net().sample_expansion_factor()
+                  (get_net().sample_expansion_factor() is set the first time the network's
+                  to_tensor() is called, so that must have happened at least once.
+                  dnn_data_loader's constructor does it for you.)
+                - data was made by the to_tensor() method of net_type's input layer.
+                - net_type uses a supervised loss.  
+                  i.e. net_type::training_label_type != no_label_type.
+            ensures
+                - Performs the same stochastic gradient update step as
+                  train_one_step(samples, labels) would, where samples are the inputs
+                  that were converted into data.  This lets you convert mini-batches into
+                  tensors outside the training thread, for instance with a
+                  dnn_data_loader, and keep the training thread busy with the network.
+                - When training on a single device, the contents of data and labels are
+                  handed to the training thread without being copied.  Therefore, #data
+                  and #labels are left in an unspecified state.  They hold memory from an
+                  earlier mini-batch which you can reuse to make the next one.
+                - #get_train_one_step_calls() == get_train_one_step_calls() + 1.
+        !*/
+
+        void train_one_step (
+            resizable_tensor& data
+        );
+        /*!
+            requires
+                - data.num_samples() > 0
+                - data.num_samples() is a multiple of get_net().sample_expansion_factor(),
+                  which must be non-zero.
+                - data was made by the to_tensor() method of net_type's input layer.
+                - net_type uses an unsupervised loss.  
+                  i.e. net_type::training_label_type == no_label_type.
+            ensures
+                - This function is identical to the version of train_one_step() defined
+                  immediately above except that it is for unsupervised losses.
+        !*/
         
         double get_average_loss (
         ) const;
@@ -712,6 +755,42 @@ namespace dlib
                 - #get_test_one_step_calls() == get_test_one_step_calls() + 1.
         !*/
 
+        void test_one_step (
+            resizable_tensor& data,
+            std::vector<training_label_type>& labels
+        );
+        /*!
+            requires
+                - labels.size() > 0
+                - data.num_samples() == labels.size()*get_net().sample_expansion_factor(),
+                  where get_net().sample_expansion_factor() != 0.
+                - data was made by the to_tensor() method of net_type's input layer.
+                - net_type uses a supervised loss.  
+                  i.e. net_type::training_label_type != no_label_type.
+            ensures
+                - Does the same thing as test_one_step(samples, labels), where samples are
+                  the inputs that were converted into data.
+                - As with train_one_step(data, labels), #data and #labels are left in an
+                  unspecified state.
+                - #get_test_one_step_calls() == get_test_one_step_calls() + 1.
+        !*/
+
+        void test_one_step (
+            resizable_tensor& data
+        );
+        /*!
+            requires
+                - data.num_samples() > 0
+                - data.num_samples() is a multiple of get_net().sample_expansion_factor(),
+                  which must be non-zero.
+                - data was made by the to_tensor() method of net_type's input layer.
+                - net_type uses an unsupervised loss.  
+                  i.e. net_type::training_label_type == no_label_type.
+            ensures
+                - This function is identical to the version of test_one_step() defined
+                  immediately above except that it is for unsupervised losses.
+        !*/
+
         void set_test_iterations_without_progress_threshold (
             unsigned long thresh 
         );
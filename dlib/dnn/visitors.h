@@ -433,39 +433,84 @@ namespace dlib
                 // disable other layer types
             }
 
-            // handle the case of convolutional layer followed by relu
-            template <long nf, long nr, long nc, int sy, int sx, int py, int px, typename U, typename R>
-            void fuse_convolution(add_layer<relu_, add_layer<con_<nf, nr, nc, sy, sx, py, px>, U>, R>& l)
+            // These map the activation layers that can be fused into a con_ or add_prev_
+            // layer to the corresponding fused_activation.  Other layers can't be fused.
+            template <typename T>
+            static bool get_fused_activation(const T&, fused_activation&, float&) { return false; }
+            static bool get_fused_activation(const relu_&, fused_activation& act, float& param)
             {
-                if (l.layer_details().is_disabled())
-                    return;
+                act = fused_activation::RELU;
+                param = 0;
+                return true;
+            }
+            static bool get_fused_activation(const leaky_relu_& l, fused_activation& act, float& param)
+            {
+                act = fused_activation::LEAKY_RELU;
+                param = l.get_alpha();
+                return true;
+            }
+            static bool get_fused_activation(const clipped_relu_& l, fused_activation& act, float& param)
+            {
+                act = fused_activation::CLIPPED_RELU;
+                param = l.get_ceiling();
+                return true;
+            }
+            static bool get_fused_activation(const elu_& l, fused_activation& act, float& param)
+            {
+                act = fused_activation::ELU;
+                param = l.get_alpha();
+                return true;
+            }
 
-                // get the convolution below the relu layer
-                auto& conv = l.subnet().layer_details();
+            // Moves the activation computed by the layer l into target, which must not
+            // already apply an activation of its own.
+            template <typename T, typename U, typename R, typename layer_type>
+            static void fuse_activation(add_layer<T, U, R>& l, layer_type& target)
+            {
+                fused_activation act;
+                float param;
+                if (!get_fused_activation(l.layer_details(), act, param) || l.layer_details().is_disabled())
+                    return;
+                if (target.get_fused_activation() != fused_activation::NONE)
+                    return;
 
-                conv.enable_relu();
+                target.set_fused_activation(act, param);
 
-                // disable the relu layer
+                // disable the activation layer
                 l.layer_details().disable();
             }
 
-            // handle the case of convolutional layer followed by affine followed by relu
-            template <long nf, long nr, long nc, int sy, int sx, int py, int px, typename U, typename E, typename R>
-            void fuse_convolution(add_layer<relu_, add_layer<affine_, add_layer<con_<nf, nr, nc, sy, sx, py, px>, U>, E>, R>& l)
+            // handle the case of convolutional layer followed by an activation
+            template <typename T, long nf, long nr, long nc, int sy, int sx, int py, int px, typename U, typename R>
+            void fuse_convolution(add_layer<T, add_layer<con_<nf, nr, nc, sy, sx, py, px>, U>, R>& l)
             {
-                if (l.layer_details().is_disabled())
+                // get the convolution below the activation layer
+                fuse_activation(l, l.subnet().layer_details());
+            }
+
+            // handle the case of convolutional layer followed by affine followed by an
+            // activation
+            template <typename T, long nf, long nr, long nc, int sy, int sx, int py, int px, typename U, typename E, typename R>
+            void fuse_convolution(add_layer<T, add_layer<affine_, add_layer<con_<nf, nr, nc, sy, sx, py, px>, U>, E>, R>& l)
+            {
+                fused_activation act;
+                float param;
+                if (!get_fused_activation(l.layer_details(), act, param))
                     return;
 
                 // fuse the convolutional layer followed by affine
                 fuse_convolution(l.subnet());
 
-                // get the convolution below the affine layer
-                auto& conv = l.subnet().subnet().layer_details();
-
-                conv.enable_relu();
+                // get the convolution below the affine layer, if the affine was folded into it
+                if (l.subnet().layer_details().is_disabled())
+                    fuse_activation(l, l.subnet().subnet().layer_details());
+            }
 
-                // disable the relu layer
-                l.layer_details().disable();
+            // handle the case of a residual connection followed by an activation
+            template <typename T, template<typename> class tag, typename U, typename R>
+            void fuse_convolution(add_layer<T, add_layer<add_prev_<tag>, U>, R>& l)
+            {
+                fuse_activation(l, l.subnet().layer_details());
             }
 
             // handle the case of convolutional layer followed by affine
@@ -477,6 +522,8 @@ namespace dlib
 
                 // get the convolution below the affine layer
                 auto& conv = l.subnet().layer_details();
+                if (conv.is_quantized() || conv.get_fused_activation() != fused_activation::NONE)
+                    return;
 
                 // get the parameters from the affine layer as alias_tensor_instance
                 alias_tensor_instance gamma = l.layer_details().get_gamma();
@@ -489,17 +536,19 @@ namespace dlib
 
                 tensor& params = conv.get_layer_params();
 
-                // update the biases
-                auto biases = alias_tensor(1, conv.num_filters());
-                biases(params, params.size() - conv.num_filters()) += mat(beta);
+                // update the biases: gamma*(conv(x) + b) + beta == (gamma*conv)(x) + gamma*b + beta
+                DLIB_CASSERT(conv.num_filters() == gamma.k());
+                const float* g = gamma.host();
+                const float* be = beta.host();
+                float* b = params.host() + params.size() - conv.num_filters();
+                for (long n = 0; n < conv.num_filters(); ++n)
+                    b[n] = g[n]*b[n] + be[n];
 
                 // guess the number of input channels
                 const long k_in = (params.size() - conv.num_filters()) / conv.num_filters() / conv.nr() / conv.nc();
 
                 // rescale the filters
-                DLIB_CASSERT(conv.num_filters() == gamma.k());
                 alias_tensor filter(1, k_in, conv.nr(), conv.nc());
-                const float* g = gamma.host();
                 for (long n = 0; n < conv.num_filters(); ++n)
                 {
                     filter(params, n * filter.size()) *= g[n];
@@ -509,6 +558,43 @@ namespace dlib
                 l.layer_details().disable();
             }
 
+            // handle the case of fully connected layer followed by affine
+            template <unsigned long no, fc_bias_mode bm, typename U, typename E>
+            void fuse_convolution(add_layer<affine_, add_layer<fc_<no, bm>, U>, E>& l)
+            {
+                if (l.layer_details().is_disabled())
+                    return;
+
+                // get the fully connected layer below the affine layer.  Without a bias
+                // there is nowhere to put beta, so leave those alone.
+                auto& fc = l.subnet().layer_details();
+                if (bm != FC_HAS_BIAS || fc.bias_is_disabled() || fc.is_quantized())
+                    return;
+
+                alias_tensor_instance gamma = l.layer_details().get_gamma();
+                alias_tensor_instance beta = l.layer_details().get_beta();
+                const long num_outputs = fc.get_num_outputs();
+                if ((long)gamma.size() != num_outputs)
+                    return;
+
+                // The weights are a num_inputs by num_outputs matrix followed by the
+                // biases, so column o of the weights and bias o feed output o.
+                const float* g = gamma.host();
+                const float* be = beta.host();
+                float* w = fc.get_layer_params().host();
+                const long num_inputs = fc.get_layer_params().size()/num_outputs - 1;
+                for (long i = 0; i < num_inputs; ++i, w += num_outputs)
+                {
+                    for (long o = 0; o < num_outputs; ++o)
+                        w[o] *= g[o];
+                }
+                for (long o = 0; o < num_outputs; ++o)
+                    w[o] = g[o]*w[o] + be[o];
+
+                // disable the affine layer
+                l.layer_details().disable();
+            }
+
             template <typename input_layer_type>
             void operator()(size_t , input_layer_type& ) const
             {
@@ -532,6 +618,186 @@ namespace dlib
         visit_layers(net, impl::visitor_fuse_layers());
     }
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        class visitor_int8_calibration
+        {
+        public:
+            enum class action { record_ranges, quantize };
+
+            visitor_int8_calibration(
+                std::vector<float>& ranges_,
+                const tensor& net_input_,
+                action what_
+            ) : ranges(ranges_), net_input(net_input_), what(what_) {}
+
+            template<typename input_layer_type>
+            void operator()(size_t , input_layer_type& ) const
+            {
+                // ignore other layers
+            }
+
+            template <typename T, typename U, typename E>
+            void operator()(size_t idx, add_layer<T,U,E>& l) const
+            {
+                update(idx, l.layer_details(), l.subnet());
+            }
+
+        private:
+
+            template <typename T, typename SUBNET>
+            void update(size_t, T&, const SUBNET&) const
+            {
+                // only con_ and fc_ layers have int8 implementations
+            }
+
+            template <long nf, long nr, long nc, int sy, int sx, int py, int px, typename SUBNET>
+            void update(size_t idx, con_<nf,nr,nc,sy,sx,py,px>& l, const SUBNET& sub) const { apply(idx, l, sub); }
+
+            template <unsigned long no, fc_bias_mode bm, typename SUBNET>
+            void update(size_t idx, fc_<no,bm>& l, const SUBNET& sub) const { apply(idx, l, sub); }
+
+            template <typename SUBNET>
+            auto layer_input(const SUBNET& sub, int) const -> decltype(sub.get_output())
+            {
+                return sub.get_output();
+            }
+
+            template <typename SUBNET>
+            const tensor& layer_input(const SUBNET&, long) const
+            {
+                // The bottom layer of a network reads directly from the input tensor,
+                // which the input layer doesn't keep.
+                return net_input;
+            }
+
+            template <typename layer_type, typename SUBNET>
+            void apply(size_t idx, layer_type& l, const SUBNET& sub) const
+            {
+                if (l.is_quantized())
+                    return;
+
+                switch (what)
+                {
+                    case action::record_ranges:
+                        ranges[idx] = std::max(ranges[idx], max(abs(mat(layer_input(sub, 0)))));
+                        break;
+                    case action::quantize:
+                        l.quantize_to_int8(ranges[idx]);
+                        break;
+                }
+            }
+
+            std::vector<float>& ranges;
+            const tensor& net_input;
+            action what;
+        };
+    }
+
+    template <typename net_type, typename input_type>
+    void quantize_to_int8 (
+        net_type& net,
+        const std::vector<input_type>& calibration_samples,
+        size_t mini_batch_size = 32
+    )
+    {
+        DLIB_CASSERT(calibration_samples.size() > 0 && mini_batch_size > 0);
+        DLIB_CASSERT(count_parameters(net) > 0, "The network has to be allocated before it can be quantized.");
+
+        // Run the calibration data through the network, recording the largest input
+        // magnitude each con_ and fc_ layer sees.  Those ranges become the layers'
+        // activation scales.
+        std::vector<float> ranges(net_type::num_layers, 0);
+        resizable_tensor x;
+        for (size_t i = 0; i < calibration_samples.size(); i += mini_batch_size)
+        {
+            const size_t end = std::min(i + mini_batch_size, calibration_samples.size());
+            net.to_tensor(calibration_samples.begin()+i, calibration_samples.begin()+end, x);
+            net.forward(x);
+            visit_layers(net, impl::visitor_int8_calibration(ranges, x, impl::visitor_int8_calibration::action::record_ranges));
+        }
+
+        visit_layers(net, impl::visitor_int8_calibration(ranges, x, impl::visitor_int8_calibration::action::quantize));
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        class visitor_kv_cache
+        {
+        public:
+            enum class action { enable, disable, clear };
+
+            visitor_kv_cache(action what_) : what(what_) {}
+
+            template <typename T>
+            void update(T&) const
+            {
+                // ignore layers that don't keep any incremental decoding state
+            }
+
+            void update(kv_cache_& l) const { apply(l); }
+            void update(positional_encodings_& l) const { apply(l); }
+
+            template <long diag, typename tag, long num, long den>
+            void update(tril_<diag, tag, num, den>& l) const { apply(l); }
+
+            template<typename input_layer_type>
+            void operator()(size_t , input_layer_type& ) const
+            {
+                // ignore other layers
+            }
+
+            template <typename T, typename U, typename E>
+            void operator()(size_t , add_layer<T,U,E>& l) const
+            {
+                update(l.layer_details());
+            }
+
+        private:
+
+            template <typename layer_type>
+            void apply(layer_type& l) const
+            {
+                switch (what)
+                {
+                    case action::enable: l.enable_kv_cache(); break;
+                    case action::disable: l.disable_kv_cache(); break;
+                    case action::clear: l.clear_kv_cache(); break;
+                }
+            }
+
+            action what;
+        };
+    }
+
+    template <typename net_type>
+    void enable_kv_cache (
+        net_type& net
+    )
+    {
+        visit_layers(net, impl::visitor_kv_cache(impl::visitor_kv_cache::action::enable));
+    }
+
+    template <typename net_type>
+    void disable_kv_cache (
+        net_type& net
+    )
+    {
+        visit_layers(net, impl::visitor_kv_cache(impl::visitor_kv_cache::action::disable));
+    }
+
+    template <typename net_type>
+    void clear_kv_cache (
+        net_type& net
+    )
+    {
+        visit_layers(net, impl::visitor_kv_cache(impl::visitor_kv_cache::action::clear));
+    }
+
 // ----------------------------------------------------------------------------------------
 
     namespace impl
@@ -55,14 +55,100 @@ namespace dlib
               add_tag_layer.
             - net has been properly allocated, that is: count_parameters(net) > 0.
         ensures
-            - Disables all the affine_ layers that have a convolution as an input.
-            - Updates the convolution weights beneath the affine_ layers to produce the same
+            - Disables all the affine_ layers that have a convolution, or a fully connected
+              layer with a bias, as an input.
+            - Updates the weights and biases beneath the affine_ layers to produce the same
               output as with the affine_ layers enabled.
-            - Disables all the relu_ layers that have a convolution as input.
-            - Disables all the relu_ layers that have an affine_ layer as input, with a
-              convolution as input.
-            - Updates the convolution to apply a relu activation function, to produce the same
-              output as with the relu_ layer enabled.
+            - Disables all the relu_, leaky_relu_, clipped_relu_ and elu_ layers that have
+              as input a convolution, an affine_ layer with a convolution as input, or an
+              add_prev_ layer, provided that layer doesn't already apply an activation.
+            - Updates the convolution or add_prev_ layer to apply the activation function
+              itself, to produce the same output as with the activation layer enabled.  The
+              activation is then computed in the same pass over the data as the biases or
+              the residual addition.
+            - The resulting network is meant for inference only.  It can't be trained.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename net_type, typename input_type>
+    void quantize_to_int8 (
+        net_type& net,
+        const std::vector<input_type>& calibration_samples,
+        size_t mini_batch_size = 32
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer or add_loss_layer.
+            - net has been properly allocated, that is: count_parameters(net) > 0.
+            - calibration_samples.size() > 0
+            - mini_batch_size > 0
+            - net.to_tensor() accepts iterators over calibration_samples.
+        ensures
+            - Converts every con_ and fc_ layer in net to run in 8 bit integer arithmetic,
+              by calling quantize_to_int8() on each of them.  Layers that are already
+              quantized are left alone.
+            - The int8 activation range of each layer is set to the largest input
+              magnitude that layer sees when calibration_samples is run through net, in
+              mini-batches of mini_batch_size.  So calibration_samples should be
+              representative of the data the network will be used on.
+            - The quantized layers keep only their int8 weights, reducing the memory they
+              use by about 4x, and the network can no longer be trained.  Other layers, such
+              as relu_, still run in float.  Calling fuse_layers(net) first lets con_ layers
+              absorb following affine_ and relu_ layers, which is also faster.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename net_type>
+    void enable_kv_cache (
+        net_type& net
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, or
+              add_tag_layer.
+        ensures
+            - Switches net into incremental decoding mode.  That is, calls enable_kv_cache()
+              on all the kv_cache_, tril_ and positional_encodings_ layers in net.  Any
+              previously cached state is discarded.
+            - In this mode, each call to forward() is expected to contain only the sequence
+              positions (i.e. rows) that come after the ones given in previous calls.  The
+              kv_cache_ layers append these rows to their cached keys and values, the tril_
+              layers align their mask to the end of the cached sequence, and the
+              positional_encodings_ layers encode the new rows starting at the number of
+              positions seen so far.  So for a causal network where every other layer acts
+              on each row independently, the output for the new rows is the same as the
+              last rows of the output obtained by running the whole sequence at once, while
+              only the new rows are pushed through the network.
+    !*/
+
+    template <typename net_type>
+    void disable_kv_cache (
+        net_type& net
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, or
+              add_tag_layer.
+        ensures
+            - Calls disable_kv_cache() on all the kv_cache_, tril_ and positional_encodings_
+              layers in net, returning net to its normal mode where each call to forward()
+              processes complete sequences.  Any cached state is discarded.
+    !*/
+
+    template <typename net_type>
+    void clear_kv_cache (
+        net_type& net
+    );
+    /*!
+        requires
+            - net_type is an object of type add_layer, add_loss_layer, add_skip_layer, or
+              add_tag_layer.
+        ensures
+            - Discards the cached keys, values and sequence positions of all the layers in
+              net so that the next call to forward() starts a new sequence.  Whether or not
+              incremental decoding mode is enabled is left unchanged.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -0,0 +1,237 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_CSR_GRAPH_Hh_
+#define DLIB_CSR_GRAPH_Hh_
+
+#include "csr_graph_abstract.h"
+#include "../threads.h"
+#include "../serialize.h"
+#include "../uintn.h"
+#include "../general_hash/murmur_hash3.h"
+#include "sample_pair.h"
+#include "ordered_sample_pair.h"
+#include "edge_list_graphs.h"
+#include <vector>
+#include <algorithm>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class csr_graph
+    {
+    public:
+
+        csr_graph (
+        ) : offsets(1,0) {}
+
+        explicit csr_graph (
+            const std::vector<sample_pair>& edges
+        )
+        {
+            build(edges, true);
+        }
+
+        explicit csr_graph (
+            const std::vector<ordered_sample_pair>& edges
+        )
+        {
+            build(edges, false);
+        }
+
+        csr_graph (
+            std::vector<uint64> offsets_,
+            std::vector<uint32> neighbors_,
+            std::vector<double> weights_
+        ) :
+            offsets(std::move(offsets_)),
+            neighbors(std::move(neighbors_)),
+            weights(std::move(weights_))
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(offsets.size() > 0 && offsets[0] == 0 &&
+                        offsets.back() == neighbors.size() && neighbors.size() == weights.size() &&
+                        std::is_sorted(offsets.begin(), offsets.end()) &&
+                        (neighbors.size() == 0 || *std::max_element(neighbors.begin(), neighbors.end()) < offsets.size()-1),
+                "\t csr_graph::csr_graph()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t offsets.size():   " << offsets.size()
+                << "\n\t neighbors.size(): " << neighbors.size()
+                << "\n\t weights.size():   " << weights.size()
+                );
+        }
+
+        unsigned long size (
+        ) const { return offsets.size()-1; }
+
+        uint64 number_of_edges (
+        ) const { return neighbors.size(); }
+
+        uint64 edges_begin (
+            unsigned long node
+        ) const { return offsets[node]; }
+
+        uint64 edges_end (
+            unsigned long node
+        ) const { return offsets[node+1]; }
+
+        unsigned long neighbor (
+            uint64 e
+        ) const { return neighbors[e]; }
+
+        double weight (
+            uint64 e
+        ) const { return weights[e]; }
+
+        void swap (
+            csr_graph& item
+        )
+        {
+            offsets.swap(item.offsets);
+            neighbors.swap(item.neighbors);
+            weights.swap(item.weights);
+        }
+
+        friend void serialize (
+            const csr_graph& item,
+            std::ostream& out
+        )
+        {
+            int version = 1;
+            dlib::serialize(version, out);
+            dlib::serialize(item.offsets, out);
+            dlib::serialize(item.neighbors, out);
+            dlib::serialize(item.weights, out);
+        }
+
+        friend void deserialize (
+            csr_graph& item,
+            std::istream& in
+        )
+        {
+            int version = 0;
+            dlib::deserialize(version, in);
+            if (version != 1)
+                throw serialization_error("Unexpected version found while deserializing dlib::csr_graph.");
+            dlib::deserialize(item.offsets, in);
+            dlib::deserialize(item.neighbors, in);
+            dlib::deserialize(item.weights, in);
+        }
+
+    private:
+
+        template <typename pair_type>
+        void build (
+            const std::vector<pair_type>& edges,
+            bool both_directions
+        )
+        {
+            const unsigned long num_nodes = max_index_plus_one(edges);
+
+            // This is a counting sort of the edges by their first node.  It keeps the
+            // edges of each node in the order they were given.
+            offsets.assign(num_nodes+1, 0);
+            for (auto& e : edges)
+            {
+                ++offsets[e.index1()+1];
+                if (both_directions && e.index1() != e.index2())
+                    ++offsets[e.index2()+1];
+            }
+            for (unsigned long i = 0; i < num_nodes; ++i)
+                offsets[i+1] += offsets[i];
+
+            neighbors.resize(offsets.back());
+            weights.resize(offsets.back());
+            std::vector<uint64> next(offsets.begin(), offsets.end()-1);
+            for (auto& e : edges)
+            {
+                neighbors[next[e.index1()]] = e.index2();
+                weights[next[e.index1()]++] = e.distance();
+                if (both_directions && e.index1() != e.index2())
+                {
+                    neighbors[next[e.index2()]] = e.index1();
+                    weights[next[e.index2()]++] = e.distance();
+                }
+            }
+        }
+
+        // The edges of node i are the ones numbered offsets[i] through offsets[i+1]-1.
+        std::vector<uint64> offsets;
+        std::vector<uint32> neighbors;
+        std::vector<double> weights;
+    };
+
+    inline void swap (
+        csr_graph& a,
+        csr_graph& b
+    ) { a.swap(b); }
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        inline void random_node_buckets (
+            thread_pool& tp,
+            const unsigned long num_nodes,
+            const unsigned long num_buckets,
+            const uint32 seed,
+            std::vector<uint32>& nodes,
+            std::vector<uint64>& bucket_begin
+        )
+        /*!
+            requires
+                - num_buckets > 0
+            ensures
+                - Randomly splits the nodes 0 through num_nodes-1 into num_buckets groups,
+                  using seed to pick the groups.
+                - #nodes.size() == num_nodes
+                - #bucket_begin.size() == num_buckets+1
+                - The nodes in the b-th group are #nodes[#bucket_begin[b]] through
+                  #nodes[#bucket_begin[b+1]-1], in increasing order.
+                - The groups depend only on num_nodes, num_buckets, and seed.  In
+                  particular, they don't depend on the number of threads in tp.
+        !*/
+        {
+            // The nodes are split into a fixed number of chunks and each chunk counting
+            // sorts its nodes into the buckets in parallel.
+            const unsigned long num_chunks = std::min<unsigned long>(64, std::max<unsigned long>(1, num_nodes/4096));
+            std::vector<uint64> counts(num_chunks*num_buckets, 0);
+            auto chunk_begin = [&](unsigned long c) { return num_nodes*c/num_chunks; };
+            auto bucket = [&](unsigned long i) { return murmur_hash3_2(i, seed)%num_buckets; };
+
+            parallel_for(tp, 0, num_chunks, [&](long c)
+            {
+                for (unsigned long i = chunk_begin(c); i < chunk_begin(c+1); ++i)
+                    ++counts[c*num_buckets + bucket(i)];
+            });
+
+            bucket_begin.assign(num_buckets+1, 0);
+            uint64 total = 0;
+            for (unsigned long b = 0; b < num_buckets; ++b)
+            {
+                bucket_begin[b] = total;
+                for (unsigned long c = 0; c < num_chunks; ++c)
+                {
+                    const uint64 temp = counts[c*num_buckets + b];
+                    counts[c*num_buckets + b] = total;
+                    total += temp;
+                }
+            }
+            bucket_begin[num_buckets] = total;
+
+            nodes.resize(num_nodes);
+            parallel_for(tp, 0, num_chunks, [&](long c)
+            {
+                for (unsigned long i = chunk_begin(c); i < chunk_begin(c+1); ++i)
+                    nodes[counts[c*num_buckets + bucket(i)]++] = i;
+            });
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_CSR_GRAPH_Hh_
+
@@ -0,0 +1,196 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_CSR_GRAPH_ABSTRACT_Hh_
+#ifdef DLIB_CSR_GRAPH_ABSTRACT_Hh_
+
+#include "sample_pair_abstract.h"
+#include "ordered_sample_pair_abstract.h"
+#include "edge_list_graphs_abstract.h"
+#include "../uintn.h"
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class csr_graph
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object is a weighted, directed graph stored in compressed sparse row
+                form.  That is, the edges leaving each node are stored one after another in
+                a single array, and each node just records where its edges start.  So
+                finding the neighbors of a node is a matter of reading a contiguous range
+                of memory, and the whole graph takes only 12 bytes per edge.  This makes it
+                a good representation for algorithms that repeatedly sweep over every node
+                of a very large graph, such as the chinese_whispers() and louvain_cluster()
+                routines which take a csr_graph.
+
+                The nodes are numbered 0 to size()-1 and the edges 0 to
+                number_of_edges()-1.  You can loop over the neighbors of a node like this:
+                    for (auto e = g.edges_begin(node); e != g.edges_end(node); ++e)
+                        // there is an edge from node to g.neighbor(e) with weight g.weight(e)
+        !*/
+
+    public:
+
+        csr_graph (
+        );
+        /*!
+            ensures
+                - #size() == 0
+                - #number_of_edges() == 0
+        !*/
+
+        explicit csr_graph (
+            const std::vector<sample_pair>& edges
+        );
+        /*!
+            ensures
+                - Interprets edges as an undirected graph.  So #*this contains, for each
+                  element of edges, an edge from edges[i].index1() to edges[i].index2() and
+                  an edge from edges[i].index2() to edges[i].index1(), both with a weight
+                  of edges[i].distance().  There is only one edge when the two indices
+                  are the same.  This is the same graph convert_unordered_to_ordered()
+                  produces.
+                - #size() == max_index_plus_one(edges)
+                - The edges of each node are in the order they appear in edges.
+        !*/
+
+        explicit csr_graph (
+            const std::vector<ordered_sample_pair>& edges
+        );
+        /*!
+            ensures
+                - Interprets edges as a directed graph.  So #*this contains, for each
+                  element of edges, an edge from edges[i].index1() to edges[i].index2()
+                  with a weight of edges[i].distance().
+                - #size() == max_index_plus_one(edges)
+                - #number_of_edges() == edges.size()
+                - The edges of each node are in the order they appear in edges.  Note
+                  that edges doesn't need to be sorted.
+        !*/
+
+        csr_graph (
+            std::vector<uint64> offsets,
+            std::vector<uint32> neighbors,
+            std::vector<double> weights
+        );
+        /*!
+            requires
+                - offsets.size() > 0
+                - offsets[0] == 0
+                - offsets is sorted in increasing order
+                - offsets.back() == neighbors.size() == weights.size()
+                - for all valid i:
+                    - neighbors[i] < offsets.size()-1
+            ensures
+                - Creates a graph directly from its compressed sparse row form.  This lets
+                  you build very large graphs without first making a vector of
+                  ordered_sample_pair objects.
+                - #size() == offsets.size()-1
+                - #number_of_edges() == neighbors.size()
+                - for all valid i:
+                    - #edges_begin(i) == offsets[i]
+                    - #edges_end(i) == offsets[i+1]
+                - for all valid e:
+                    - #neighbor(e) == neighbors[e]
+                    - #weight(e) == weights[e]
+        !*/
+
+        unsigned long size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of nodes in this graph.
+        !*/
+
+        uint64 number_of_edges (
+        ) const;
+        /*!
+            ensures
+                - returns the number of edges in this graph.
+        !*/
+
+        uint64 edges_begin (
+            unsigned long node
+        ) const;
+        /*!
+            requires
+                - node < size()
+            ensures
+                - returns the number of the first edge leaving node.
+        !*/
+
+        uint64 edges_end (
+            unsigned long node
+        ) const;
+        /*!
+            requires
+                - node < size()
+            ensures
+                - returns one past the number of the last edge leaving node.  So the edges
+                  leaving node are the ones numbered edges_begin(node) through
+                  edges_end(node)-1, and there are edges_end(node)-edges_begin(node) of them.
+        !*/
+
+        unsigned long neighbor (
+            uint64 e
+        ) const;
+        /*!
+            requires
+                - e < number_of_edges()
+            ensures
+                - returns the node that edge e goes to.
+        !*/
+
+        double weight (
+            uint64 e
+        ) const;
+        /*!
+            requires
+                - e < number_of_edges()
+            ensures
+                - returns the weight of edge e.
+        !*/
+
+        void swap (
+            csr_graph& item
+        );
+        /*!
+            ensures
+                - swaps *this and item
+        !*/
+    };
+
+    void swap (
+        csr_graph& a,
+        csr_graph& b
+    );
+    /*!
+        provides a global swap function
+    !*/
+
+    void serialize (
+        const csr_graph& item,
+        std::ostream& out
+    );
+    /*!
+        provides serialization support
+    !*/
+
+    void deserialize (
+        csr_graph& item,
+        std::istream& in
+    );
+    /*!
+        provides deserialization support
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_CSR_GRAPH_ABSTRACT_Hh_
+
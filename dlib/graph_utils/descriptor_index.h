@@ -0,0 +1,428 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_DESCRIPTOR_INDEX_Hh_
+#define DLIB_DESCRIPTOR_INDEX_Hh_
+
+#include "descriptor_index_abstract.h"
+#include "hnsw_index.h"
+#include "../matrix.h"
+#include "../simd.h"
+#include "../uintn.h"
+#include "../serialize.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        inline float squared_distance (
+            const float* a,
+            const float* b,
+            long n
+        )
+        {
+            simd8f acc = 0;
+            long i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                simd8f x, y;
+                x.load(a+i);
+                y.load(b+i);
+                x -= y;
+                acc += x*x;
+            }
+            float result = sum(acc);
+            for (; i < n; ++i)
+                result += (a[i]-b[i])*(a[i]-b[i]);
+            return result;
+        }
+
+        template <typename T>
+        struct descriptor_code;
+
+        template <>
+        struct descriptor_code<float>
+        {
+            typedef float type;
+
+            static void encode (
+                const float* d,
+                long n,
+                float* code,
+                float& scale
+            )
+            {
+                std::copy(d, d+n, code);
+                scale = 1;
+            }
+
+            static void decode (
+                const float* code,
+                float ,
+                long n,
+                float* d
+            ) { std::copy(code, code+n, d); }
+
+            static double distance_to (
+                const float* d,
+                const float* code,
+                float ,
+                long n
+            ) { return squared_distance(d, code, n); }
+
+            static double distance (
+                const float* code1,
+                float ,
+                const float* code2,
+                float ,
+                long n
+            ) { return squared_distance(code1, code2, n); }
+        };
+
+        template <>
+        struct descriptor_code<int8>
+        {
+            // The codes are stored offset by 128, so that it doesn't matter whether char
+            // is signed or not.
+            typedef uint8 type;
+
+            static void encode (
+                const float* d,
+                long n,
+                uint8* code,
+                float& scale
+            )
+            {
+                float largest = 0;
+                for (long i = 0; i < n; ++i)
+                    largest = std::max(largest, std::abs(d[i]));
+                scale = largest > 0 ? largest/127 : 1;
+                for (long i = 0; i < n; ++i)
+                    code[i] = static_cast<uint8>(128 + std::lround(d[i]/scale));
+            }
+
+            static void decode (
+                const uint8* code,
+                float scale,
+                long n,
+                float* d
+            )
+            {
+                for (long i = 0; i < n; ++i)
+                    d[i] = scale*((int)code[i] - 128);
+            }
+
+            static double distance_to (
+                const float* d,
+                const uint8* code,
+                float scale,
+                long n
+            )
+            {
+                // The code is expanded a block at a time into a small buffer on the
+                // stack, which the compiler vectorizes well, rather than into a buffer
+                // holding the whole descriptor.
+                const long block_size = 64;
+                float block[block_size];
+                double result = 0;
+                for (long i = 0; i < n; i += block_size)
+                {
+                    const long num = std::min(block_size, n-i);
+                    for (long j = 0; j < num; ++j)
+                        block[j] = scale*((int)code[i+j] - 128);
+                    result += squared_distance(d+i, block, num);
+                }
+                return result;
+            }
+
+            static double distance (
+                const uint8* code1,
+                float scale1,
+                const uint8* code2,
+                float scale2,
+                long n
+            )
+            {
+                // |scale1*a - scale2*b|^2 expands into dot products of the codes, which
+                // are computed exactly with integers (they can't overflow unless n is
+                // over 130000).  So only the last step rounds.
+                int32 aa = 0, bb = 0, ab = 0;
+                for (long i = 0; i < n; ++i)
+                {
+                    const int32 a = (int32)code1[i] - 128;
+                    const int32 b = (int32)code2[i] - 128;
+                    aa += a*a;
+                    bb += b*b;
+                    ab += a*b;
+                }
+                const double s1 = scale1, s2 = scale2;
+                return std::max(0.0, s1*s1*aa + s2*s2*bb - 2*s1*s2*ab);
+            }
+        };
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class descriptor_index
+    {
+    public:
+        typedef T storage_type;
+        typedef matrix<float,0,1> descriptor_type;
+
+        explicit descriptor_index (
+            unsigned long max_neighbors = 16,
+            unsigned long ef_construction = 100
+        ) :
+            dims(0),
+            graph(max_neighbors, ef_construction)
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(max_neighbors > 1 && ef_construction > 0,
+                "\t descriptor_index::descriptor_index()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t max_neighbors:   " << max_neighbors
+                << "\n\t ef_construction: " << ef_construction
+                );
+        }
+
+        unsigned long get_max_neighbors (
+        ) const { return graph.get_max_neighbors(); }
+
+        unsigned long get_ef_construction (
+        ) const { return graph.get_ef_construction(); }
+
+        void set_ef_search (
+            unsigned long ef
+        )
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(ef > 0,
+                "\t void descriptor_index::set_ef_search()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t ef: " << ef
+                );
+            graph.set_ef_search(ef);
+        }
+
+        unsigned long get_ef_search (
+        ) const { return graph.get_ef_search(); }
+
+        unsigned long size (
+        ) const { return graph.size(); }
+
+        long num_dimensions (
+        ) const { return dims; }
+
+        descriptor_type operator[] (
+            unsigned long idx
+        ) const
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(idx < size(),
+                "\t descriptor_type descriptor_index::operator[]()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t idx:    " << idx
+                << "\n\t size(): " << size()
+                );
+            descriptor_type d(dims);
+            code_type::decode(&codes[idx*dims], scales[idx], dims, &d(0));
+            return d;
+        }
+
+        void clear (
+        )
+        {
+            dims = 0;
+            codes.clear();
+            scales.clear();
+            graph.clear();
+        }
+
+        unsigned long add (
+            const descriptor_type& item
+        )
+        {
+            append(item);
+            graph.link_last(storage());
+            return size()-1;
+        }
+
+        template <
+            typename vector_type
+            >
+        void add (
+            const vector_type& items,
+            unsigned long num_threads
+        )
+        {
+            if (items.size() == 0)
+                return;
+            const unsigned long begin = size();
+            const long new_dims = size() == 0 ? items[0].size() : dims;
+            codes.reserve((begin + items.size())*new_dims);
+            scales.reserve(begin + items.size());
+            graph.reserve(begin + items.size());
+            for (unsigned long i = 0; i < items.size(); ++i)
+                append(items[i]);
+            graph.link(storage(), begin, num_threads);
+        }
+
+        std::vector<std::pair<double,unsigned long> > find_nearest (
+            const descriptor_type& item,
+            unsigned long k
+        ) const
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(size() == 0 || item.size() == num_dimensions(),
+                "\t std::vector<std::pair<double,unsigned long> > descriptor_index::find_nearest()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t item.size():      " << item.size()
+                << "\n\t num_dimensions(): " << num_dimensions()
+                );
+
+            impl::hnsw_visit_marks marks;
+            return find_nearest(item, k, marks);
+        }
+
+        template <
+            typename vector_type
+            >
+        std::vector<std::vector<std::pair<double,unsigned long> > > find_nearest (
+            const vector_type& items,
+            unsigned long k,
+            unsigned long num_threads
+        ) const
+        {
+            std::vector<std::vector<std::pair<double,unsigned long> > > results(items.size());
+            parallel_for_blocked(num_threads, 0, items.size(), [&](long begin, long end)
+            {
+                impl::hnsw_visit_marks marks;
+                for (long i = begin; i < end; ++i)
+                {
+                    // make sure requires clause is not broken
+                    DLIB_ASSERT(size() == 0 || items[i].size() == num_dimensions(),
+                        "\t std::vector<std::vector<std::pair<double,unsigned long> > > descriptor_index::find_nearest()"
+                        << "\n\t Invalid inputs were given to this function."
+                        << "\n\t i:                " << i
+                        << "\n\t items[i].size():  " << items[i].size()
+                        << "\n\t num_dimensions(): " << num_dimensions()
+                        );
+                    results[i] = find_nearest(items[i], k, marks);
+                }
+            });
+            return results;
+        }
+
+        friend void serialize (
+            const descriptor_index& item,
+            std::ostream& out
+        )
+        {
+            int version = 1;
+            dlib::serialize(version, out);
+            dlib::serialize(item.dims, out);
+            dlib::serialize(item.codes, out);
+            dlib::serialize(item.scales, out);
+            serialize(item.graph, out);
+        }
+
+        friend void deserialize (
+            descriptor_index& item,
+            std::istream& in
+        )
+        {
+            int version = 0;
+            dlib::deserialize(version, in);
+            if (version != 1)
+                throw serialization_error("Unexpected version found while deserializing dlib::descriptor_index.");
+            dlib::deserialize(item.dims, in);
+            dlib::deserialize(item.codes, in);
+            dlib::deserialize(item.scales, in);
+            deserialize(item.graph, in);
+        }
+
+    private:
+
+        typedef impl::descriptor_code<T> code_type;
+
+        std::vector<std::pair<double,unsigned long> > find_nearest (
+            const descriptor_type& item,
+            unsigned long k,
+            impl::hnsw_visit_marks& marks
+        ) const
+        {
+            // The graph is searched with squared distances, which are cheaper to compute
+            // and put the descriptors in the same order.
+            std::vector<std::pair<double,unsigned long> > results = graph.find_nearest(storage(), item, k, marks);
+            for (auto& r : results)
+                r.first = std::sqrt(r.first);
+            return results;
+        }
+
+        void append (
+            const descriptor_type& item
+        )
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(item.size() > 0 && (size() == 0 || item.size() == num_dimensions()),
+                "\t void descriptor_index::add()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t item.size():      " << item.size()
+                << "\n\t num_dimensions(): " << num_dimensions()
+                );
+
+            if (size() == 0)
+                dims = item.size();
+            codes.resize(codes.size() + dims);
+            scales.push_back(0);
+            code_type::encode(&item(0), dims, &codes[codes.size()-dims], scales.back());
+            graph.append();
+        }
+
+        struct code_storage
+        {
+            const descriptor_index& index;
+
+            double distance_to (
+                const descriptor_type& item,
+                unsigned long i
+            ) const
+            {
+                return code_type::distance_to(&item(0), &index.codes[i*index.dims], index.scales[i], index.dims);
+            }
+
+            double distance (
+                unsigned long i,
+                unsigned long j
+            ) const
+            {
+                return code_type::distance(&index.codes[i*index.dims], index.scales[i],
+                                           &index.codes[j*index.dims], index.scales[j], index.dims);
+            }
+        };
+
+        code_storage storage (
+        ) const { return code_storage{*this}; }
+
+        long dims;
+        // The i-th descriptor is codes[i*dims] through codes[i*dims+dims-1], scaled by
+        // scales[i].
+        std::vector<typename code_type::type> codes;
+        std::vector<float> scales;
+        impl::hnsw_graph graph;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DESCRIPTOR_INDEX_Hh_
+
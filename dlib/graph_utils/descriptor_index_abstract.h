@@ -0,0 +1,237 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_DESCRIPTOR_INDEX_ABSTRACT_Hh_
+#ifdef DLIB_DESCRIPTOR_INDEX_ABSTRACT_Hh_
+
+#include "hnsw_index_abstract.h"
+#include "../matrix/matrix_abstract.h"
+#include "../uintn.h"
+#include <vector>
+#include <utility>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    class descriptor_index
+    {
+        /*!
+            REQUIREMENTS ON T
+                T must be float or int8.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object is a set of descriptors, i.e. fixed length vectors of floats
+                like the ones made by deep metric learning networks trained with
+                loss_metric, that can be searched for the descriptors nearest to a query
+                in Euclidean distance.  For example, it can find which of millions of
+                enrolled faces a face descriptor matches, without comparing the query to
+                all of them.
+
+                It works like an hnsw_index<matrix<float,0,1>, squared_euclidean_distance>,
+                and so gives approximate results, but it is specialized for descriptors.
+                The descriptors are stored one after another in a single array rather than
+                as separate matrix objects, which saves memory and makes comparing them
+                faster.  If T is int8, each descriptor is also quantized to 8 bits per
+                element, using a scale chosen for each descriptor so its largest element
+                maps to 127.  That makes the index about 4 times smaller, at the cost of
+                slightly less accurate distances.  The distances are computed directly
+                from the 8 bit codes: between two stored descriptors with integer dot
+                products, and between a query and a stored descriptor by expanding each
+                code element as it is used.
+
+                The descriptors are numbered 0 to size()-1 in the order they were added.
+
+            THREAD SAFETY
+                It is safe to call the const methods of this object, such as
+                find_nearest(), from multiple threads at the same time, as long as no
+                thread is modifying the object.
+        !*/
+
+    public:
+
+        typedef T storage_type;
+        typedef matrix<float,0,1> descriptor_type;
+
+        explicit descriptor_index (
+            unsigned long max_neighbors = 16,
+            unsigned long ef_construction = 100
+        );
+        /*!
+            requires
+                - max_neighbors > 1
+                - ef_construction > 0
+            ensures
+                - #size() == 0
+                - #num_dimensions() == 0
+                - #get_max_neighbors() == max_neighbors
+                - #get_ef_construction() == ef_construction
+                - #get_ef_search() == 50
+        !*/
+
+        unsigned long get_max_neighbors (
+        ) const;
+        unsigned long get_ef_construction (
+        ) const;
+        void set_ef_search (
+            unsigned long ef
+        );
+        unsigned long get_ef_search (
+        ) const;
+        /*!
+            These have the same meaning as the hnsw_index methods with the same names.
+        !*/
+
+        unsigned long size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of descriptors in this index.
+        !*/
+
+        long num_dimensions (
+        ) const;
+        /*!
+            ensures
+                - returns the number of elements in each descriptor in this index.  This is
+                  set by the first descriptor added, and is 0 when size() == 0.
+        !*/
+
+        descriptor_type operator[] (
+            unsigned long idx
+        ) const;
+        /*!
+            requires
+                - idx < size()
+            ensures
+                - returns the idx-th descriptor added to this index, as it is stored.  So if
+                  T is int8, this is the quantized version of it.
+        !*/
+
+        void clear (
+        );
+        /*!
+            ensures
+                - #size() == 0
+                - #num_dimensions() == 0
+                - The settings, such as get_max_neighbors(), are not changed.
+        !*/
+
+        unsigned long add (
+            const descriptor_type& item
+        );
+        /*!
+            requires
+                - item.size() > 0
+                - if (size() != 0) then
+                    - item.size() == num_dimensions()
+            ensures
+                - Adds item to this index.
+                - #size() == size() + 1
+                - #num_dimensions() == item.size()
+                - returns size(), the index of item.
+        !*/
+
+        template <
+            typename vector_type
+            >
+        void add (
+            const vector_type& items,
+            unsigned long num_threads
+        );
+        /*!
+            requires
+                - vector_type is any container that looks like a std::vector or
+                  dlib::array and contains descriptor_type objects.
+                - All the elements of items have the same size, and it is > 0.
+                - if (size() != 0 && items.size() != 0) then
+                    - items[0].size() == num_dimensions()
+            ensures
+                - Adds all the elements of items to this index, in order, using
+                  num_threads concurrent threads of processing.  This works the same way
+                  hnsw_index::add(items, num_threads) does.  In particular, the result
+                  doesn't depend on num_threads.
+                - #size() == size() + items.size()
+        !*/
+
+        std::vector<std::pair<double,unsigned long> > find_nearest (
+            const descriptor_type& item,
+            unsigned long k
+        ) const;
+        /*!
+            requires
+                - if (size() != 0) then
+                    - item.size() == num_dimensions()
+            ensures
+                - Searches this index for the k descriptors nearest to item.
+                - returns a vector R of at most k (distance, index) pairs, sorted by
+                  increasing distance, such that:
+                    - for all valid i:
+                        - R[i].second < size()
+                        - R[i].first == length(item - (*this)[R[i].second])
+                          (up to rounding, as the distance is computed in single precision)
+                  Since the search is approximate, R may miss some of the true nearest
+                  neighbors.  R is shorter than k only if size() < k, or in the rare
+                  case that the search can't reach enough descriptors.
+                - Each call allocates 4*size() bytes of scratch memory to keep track of
+                  the descriptors it has visited.  So when searching for many items, the
+                  version of find_nearest() that takes them all at once is faster, since
+                  each of its threads reuses that memory.
+        !*/
+
+        template <
+            typename vector_type
+            >
+        std::vector<std::vector<std::pair<double,unsigned long> > > find_nearest (
+            const vector_type& items,
+            unsigned long k,
+            unsigned long num_threads
+        ) const;
+        /*!
+            requires
+                - vector_type is any container that looks like a std::vector or
+                  dlib::array and contains descriptor_type objects.
+                - if (size() != 0) then
+                    - for all valid i: items[i].size() == num_dimensions()
+            ensures
+                - returns a vector R such that:
+                    - R.size() == items.size()
+                    - for all valid i:
+                        - R[i] == find_nearest(items[i], k)
+                - This function will use num_threads concurrent threads of processing to
+                  search for all the items at once.
+        !*/
+    };
+
+    template <
+        typename T
+        >
+    void serialize (
+        const descriptor_index<T>& item,
+        std::ostream& out
+    );
+    /*!
+        provides serialization support.  The descriptors are saved as they are stored, so
+        an int8 index stays 4 times smaller on disk too.
+    !*/
+
+    template <
+        typename T
+        >
+    void deserialize (
+        descriptor_index<T>& item,
+        std::istream& in
+    );
+    /*!
+        provides deserialization support
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_DESCRIPTOR_INDEX_ABSTRACT_Hh_
+
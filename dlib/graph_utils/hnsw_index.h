@@ -0,0 +1,812 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_HNSW_INDEX_Hh_
+#define DLIB_HNSW_INDEX_Hh_
+
+#include "hnsw_index_abstract.h"
+#include "../threads.h"
+#include "../rand.h"
+#include "../serialize.h"
+#include "../uintn.h"
+#include "sample_pair.h"
+#include "edge_list_graphs.h"
+#include <vector>
+#include <queue>
+#include <tuple>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        class hnsw_visit_marks
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object records which samples a graph search has visited.  It
+                    marks them with a number that is different for each search, so the
+                    marks don't need to be cleared between searches and reusing the same
+                    object for many searches is cheap.
+            !*/
+        public:
+
+            void start_search (
+                unsigned long num_samples
+            )
+            {
+                if (marks.size() < num_samples)
+                    marks.resize(num_samples, 0);
+                if (++tag == 0)
+                {
+                    std::fill(marks.begin(), marks.end(), 0);
+                    tag = 1;
+                }
+            }
+
+            bool visit (
+                uint32 i
+            )
+            /*!
+                ensures
+                    - marks sample i as visited and returns true if it wasn't visited
+                      already in this search.
+            !*/
+            {
+                if (marks[i] == tag)
+                    return false;
+                marks[i] = tag;
+                return true;
+            }
+
+        private:
+            std::vector<uint32> marks;
+            uint32 tag = 0;
+        };
+
+    // ------------------------------------------------------------------------------------
+
+        class hnsw_graph
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object is the graph of an hnsw_index without the samples.  The
+                    methods that compare samples take a storage object that holds them,
+                    which must provide:
+                        - storage.distance_to(item, i): the distance from item to the i-th
+                          sample.
+                        - storage.distance(i, j): the distance between the i-th and j-th
+                          samples.
+                    That way, indexes that store their samples differently can share it.
+
+                    Searching the graph needs a hnsw_visit_marks object.  The const
+                    methods take one from the caller, so concurrent searches each use
+                    their own.
+            !*/
+
+        public:
+
+            typedef std::pair<double,unsigned long> neighbor;
+
+            hnsw_graph (
+                unsigned long max_neighbors_,
+                unsigned long ef_construction_
+            ) :
+                max_neighbors(max_neighbors_),
+                ef_construction(ef_construction_),
+                ef_search(50),
+                entry_point(0),
+                top_level(-1)
+            {
+            }
+
+            unsigned long get_max_neighbors (
+            ) const { return max_neighbors; }
+
+            unsigned long get_ef_construction (
+            ) const { return ef_construction; }
+
+            void set_ef_search (
+                unsigned long ef
+            ) { ef_search = ef; }
+
+            unsigned long get_ef_search (
+            ) const { return ef_search; }
+
+            unsigned long size (
+            ) const { return neighbors.size(); }
+
+            void clear (
+            )
+            {
+                neighbors.clear();
+                insert_marks.clear();
+                entry_point = 0;
+                top_level = -1;
+                rnd.clear();
+            }
+
+            void reserve (
+                unsigned long num
+            ) { neighbors.reserve(num); }
+
+            void append (
+            )
+            /*!
+                ensures
+                    - makes room for one more sample, which isn't linked into the graph
+                      yet.
+            !*/
+            {
+                // Pick the highest layer the new sample appears in.  Each layer has about
+                // max_neighbors times fewer samples than the one below it.
+                const double u = 1 - rnd.get_random_double();
+                const long level = static_cast<long>(std::floor(-std::log(u)/std::log((double)max_neighbors)));
+                neighbors.push_back(std::vector<std::vector<uint32> >(level+1));
+            }
+
+            template <typename storage_type>
+            void link (
+                const storage_type& storage,
+                unsigned long begin,
+                unsigned long num_threads
+            )
+            /*!
+                requires
+                    - the samples from begin to size()-1 have been appended but aren't
+                      linked into the graph yet.
+                ensures
+                    - links those samples into the graph.
+            !*/
+            {
+                // The new samples are inserted in batches.  Each batch searches the graph
+                // made from the earlier samples in parallel and is then linked into it.
+                // Samples in the same batch don't see each other while this happens, so
+                // batches are kept small relative to the graph.  The batch sizes only
+                // depend on the size of the graph, not on num_threads, so neither do the
+                // results.
+                const unsigned long max_batch_size = 2048;
+                thread_pool tp(num_threads > 1 ? num_threads : 0);
+                insert_marks.resize(std::max<unsigned long>(1, num_threads));
+                unsigned long i = begin;
+                while (i < size())
+                {
+                    const unsigned long batch_size = std::min<unsigned long>(max_batch_size, std::max<unsigned long>(1, i/32));
+                    const unsigned long end = std::min<unsigned long>(size(), i + batch_size);
+                    insert(storage, i, end, &tp);
+                    i = end;
+                }
+            }
+
+            template <typename storage_type>
+            void link_last (
+                const storage_type& storage
+            )
+            /*!
+                requires
+                    - the last sample has been appended but isn't linked into the graph
+                      yet.
+                ensures
+                    - links it into the graph.
+            !*/
+            {
+                insert_marks.resize(std::max<size_t>(1, insert_marks.size()));
+                insert(storage, size()-1, size(), nullptr);
+            }
+
+            template <typename storage_type, typename query_type>
+            std::vector<neighbor> find_nearest (
+                const storage_type& storage,
+                const query_type& item,
+                unsigned long k,
+                hnsw_visit_marks& marks
+            ) const
+            {
+                std::vector<neighbor> results;
+                if (top_level < 0 || k == 0)
+                    return results;
+
+                uint32 ep = entry_point;
+                double ep_dist = storage.distance_to(item, ep);
+                for (long level = top_level; level > 0; --level)
+                    greedy_search(storage, item, ep, ep_dist, level);
+
+                const std::vector<candidate> best = search_layer(storage, item, ep, ep_dist, std::max(ef_search, k), 0, marks);
+                for (unsigned long i = 0; i < best.size() && results.size() < k; ++i)
+                {
+                    if (best[i].first < std::numeric_limits<double>::infinity())
+                        results.push_back(neighbor(best[i].first, best[i].second));
+                }
+                return results;
+            }
+
+            friend void serialize (
+                const hnsw_graph& item,
+                std::ostream& out
+            )
+            {
+                dlib::serialize(item.max_neighbors, out);
+                dlib::serialize(item.ef_construction, out);
+                dlib::serialize(item.ef_search, out);
+                dlib::serialize(item.neighbors, out);
+                dlib::serialize(item.entry_point, out);
+                dlib::serialize(item.top_level, out);
+                dlib::serialize(item.rnd, out);
+            }
+
+            friend void deserialize (
+                hnsw_graph& item,
+                std::istream& in
+            )
+            {
+                dlib::deserialize(item.max_neighbors, in);
+                dlib::deserialize(item.ef_construction, in);
+                dlib::deserialize(item.ef_search, in);
+                dlib::deserialize(item.neighbors, in);
+                dlib::deserialize(item.entry_point, in);
+                dlib::deserialize(item.top_level, in);
+                dlib::deserialize(item.rnd, in);
+                item.insert_marks.clear();
+            }
+
+        private:
+
+            typedef std::pair<double,uint32> candidate;
+
+            struct stored_sample
+            {
+                // The sample being inserted, when searching for its neighbors.
+                unsigned long idx;
+            };
+
+            template <typename storage_type, typename query_type>
+            static double query_distance (
+                const storage_type& storage,
+                const query_type& item,
+                uint32 n
+            ) { return storage.distance_to(item, n); }
+
+            template <typename storage_type>
+            static double query_distance (
+                const storage_type& storage,
+                const stored_sample& item,
+                uint32 n
+            ) { return storage.distance(item.idx, n); }
+
+            unsigned long max_links (
+                long level
+            ) const { return level == 0 ? 2*max_neighbors : max_neighbors; }
+
+            template <typename storage_type, typename query_type>
+            void greedy_search (
+                const storage_type& storage,
+                const query_type& item,
+                uint32& ep,
+                double& ep_dist,
+                long level
+            ) const
+            /*!
+                ensures
+                    - Walks from ep along the links in the given layer to the closest
+                      sample to item it can reach, and stores it into #ep and its distance
+                      into #ep_dist.
+            !*/
+            {
+                bool changed = true;
+                while (changed)
+                {
+                    changed = false;
+                    for (const uint32 n : neighbors[ep][level])
+                    {
+                        const double d = query_distance(storage, item, n);
+                        if (d < ep_dist)
+                        {
+                            ep_dist = d;
+                            ep = n;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+
+            template <typename storage_type, typename query_type>
+            std::vector<candidate> search_layer (
+                const storage_type& storage,
+                const query_type& item,
+                uint32 ep,
+                double ep_dist,
+                unsigned long ef,
+                long level,
+                hnsw_visit_marks& marks
+            ) const
+            /*!
+                ensures
+                    - returns the ef samples closest to item that a best first search from
+                      ep along the links in the given layer finds, sorted by increasing
+                      distance.
+                    - uses marks to keep track of the samples it has visited.
+            !*/
+            {
+                marks.start_search(size());
+
+                std::priority_queue<candidate, std::vector<candidate>, std::greater<candidate> > to_visit;
+                std::priority_queue<candidate> best;
+                to_visit.push(candidate(ep_dist, ep));
+                best.push(candidate(ep_dist, ep));
+                marks.visit(ep);
+                while (!to_visit.empty())
+                {
+                    const candidate c = to_visit.top();
+                    if (c.first > best.top().first)
+                        break;
+                    to_visit.pop();
+
+                    for (const uint32 n : neighbors[c.second][level])
+                    {
+                        if (!marks.visit(n))
+                            continue;
+
+                        const double d = query_distance(storage, item, n);
+                        if (best.size() < ef || d < best.top().first)
+                        {
+                            to_visit.push(candidate(d, n));
+                            best.push(candidate(d, n));
+                            if (best.size() > ef)
+                                best.pop();
+                        }
+                    }
+                }
+
+                std::vector<candidate> results(best.size());
+                for (unsigned long i = results.size(); i > 0; --i)
+                {
+                    results[i-1] = best.top();
+                    best.pop();
+                }
+                return results;
+            }
+
+            template <typename storage_type>
+            std::vector<uint32> select_neighbors (
+                const storage_type& storage,
+                const std::vector<candidate>& candidates,
+                unsigned long m
+            ) const
+            /*!
+                requires
+                    - candidates is sorted by increasing distance.
+                ensures
+                    - returns up to m of the candidates to link to.  A candidate is skipped
+                      if it is closer to one of the already selected candidates than to
+                      the sample the candidates are for, since it can then be reached
+                      through that candidate.  This keeps links going in many directions,
+                      which is what makes the graph navigable when the samples are
+                      clustered.
+            !*/
+            {
+                std::vector<uint32> selected;
+                for (const candidate& c : candidates)
+                {
+                    if (selected.size() >= m)
+                        break;
+                    bool keep = true;
+                    for (const uint32 s : selected)
+                    {
+                        if (storage.distance(c.second, s) < c.first)
+                        {
+                            keep = false;
+                            break;
+                        }
+                    }
+                    if (keep)
+                        selected.push_back(c.second);
+                }
+                return selected;
+            }
+
+            template <typename storage_type>
+            void insert (
+                const storage_type& storage,
+                unsigned long begin,
+                unsigned long end,
+                thread_pool* tp
+            )
+            /*!
+                requires
+                    - the samples from begin to end-1 have been appended but aren't linked
+                      into the graph yet.
+                    - insert_marks.size() > 0
+                ensures
+                    - links those samples into the graph.
+            !*/
+            {
+                if (top_level < 0)
+                {
+                    // The first sample has nothing to link to.  It just becomes the entry
+                    // point.
+                    entry_point = begin;
+                    top_level = neighbors[begin].size()-1;
+                    if (++begin == end)
+                        return;
+                }
+
+                // First find the neighbors of each new sample among the samples already
+                // in the graph.  Since the graph isn't modified while doing this, it can
+                // be done for all the new samples at once.  They are split into one chunk
+                // for each element of insert_marks, which the chunk uses for its searches.
+                auto find_links = [&](long i, hnsw_visit_marks& marks)
+                {
+                    const long level = neighbors[i].size()-1;
+                    const stored_sample item = {(unsigned long)i};
+                    uint32 ep = entry_point;
+                    double ep_dist = storage.distance(i, ep);
+                    for (long l = top_level; l > level; --l)
+                        greedy_search(storage, item, ep, ep_dist, l);
+                    for (long l = std::min(level, top_level); l >= 0; --l)
+                    {
+                        const std::vector<candidate> cands = search_layer(storage, item, ep, ep_dist, ef_construction, l, marks);
+                        neighbors[i][l] = select_neighbors(storage, cands, max_neighbors);
+                        ep = cands[0].second;
+                        ep_dist = cands[0].first;
+                    }
+                };
+                const unsigned long num_chunks = std::min<unsigned long>(insert_marks.size(), end-begin);
+                auto find_chunk_links = [&](long c)
+                {
+                    const unsigned long chunk_begin = begin + (end-begin)*c/num_chunks;
+                    const unsigned long chunk_end = begin + (end-begin)*(c+1)/num_chunks;
+                    for (unsigned long i = chunk_begin; i < chunk_end; ++i)
+                        find_links(i, insert_marks[c]);
+                };
+                if (tp && num_chunks > 1)
+                    parallel_for(*tp, 0, num_chunks, find_chunk_links);
+                else
+                    for (unsigned long c = 0; c < num_chunks; ++c)
+                        find_chunk_links(c);
+
+                // Then add the reverse links.  Group them by the list they go into, so
+                // each list is updated by only one thread, in an order that doesn't
+                // depend on the threads.
+                std::vector<std::tuple<uint32,uint32,uint32> > reverse_links;
+                for (unsigned long i = begin; i < end; ++i)
+                {
+                    for (unsigned long l = 0; l < neighbors[i].size(); ++l)
+                    {
+                        for (const uint32 n : neighbors[i][l])
+                            reverse_links.push_back(std::make_tuple(n, (uint32)l, (uint32)i));
+                    }
+                }
+                std::sort(reverse_links.begin(), reverse_links.end());
+                std::vector<unsigned long> group_begin;
+                for (unsigned long i = 0; i < reverse_links.size(); ++i)
+                {
+                    if (i == 0 || std::get<0>(reverse_links[i]) != std::get<0>(reverse_links[i-1]) ||
+                        std::get<1>(reverse_links[i]) != std::get<1>(reverse_links[i-1]))
+                    {
+                        group_begin.push_back(i);
+                    }
+                }
+                group_begin.push_back(reverse_links.size());
+
+                auto add_reverse_links = [&](long g)
+                {
+                    const uint32 n = std::get<0>(reverse_links[group_begin[g]]);
+                    const uint32 l = std::get<1>(reverse_links[group_begin[g]]);
+                    std::vector<uint32>& links = neighbors[n][l];
+                    for (unsigned long i = group_begin[g]; i < group_begin[g+1]; ++i)
+                        links.push_back(std::get<2>(reverse_links[i]));
+
+                    if (links.size() > max_links(l))
+                    {
+                        std::vector<candidate> cands;
+                        cands.reserve(links.size());
+                        for (const uint32 m : links)
+                            cands.push_back(candidate(storage.distance(n, m), m));
+                        std::sort(cands.begin(), cands.end());
+                        links = select_neighbors(storage, cands, max_links(l));
+                    }
+                };
+                if (tp)
+                    parallel_for(*tp, 0, group_begin.size()-1, add_reverse_links);
+                else
+                    for (unsigned long g = 0; g+1 < group_begin.size(); ++g)
+                        add_reverse_links(g);
+
+                for (unsigned long i = begin; i < end; ++i)
+                {
+                    if ((long)neighbors[i].size()-1 > top_level)
+                    {
+                        entry_point = i;
+                        top_level = neighbors[i].size()-1;
+                    }
+                }
+            }
+
+            unsigned long max_neighbors;
+            unsigned long ef_construction;
+            unsigned long ef_search;
+
+            // neighbors[i][l] == the samples linked to sample i in layer l.
+            std::vector<std::vector<std::vector<uint32> > > neighbors;
+            uint32 entry_point;
+            long top_level;
+            dlib::rand rnd;
+
+            // Scratch space for the searches done while inserting samples.  It isn't part
+            // of the graph, so it isn't serialized.
+            std::vector<hnsw_visit_marks> insert_marks;
+        };
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename sample_type_,
+        typename distance_function_type_
+        >
+    class hnsw_index
+    {
+    public:
+        typedef sample_type_ sample_type;
+        typedef distance_function_type_ distance_function_type;
+
+        hnsw_index (
+        ) : hnsw_index(distance_function_type()) {}
+
+        explicit hnsw_index (
+            const distance_function_type& dist_funct_,
+            unsigned long max_neighbors = 16,
+            unsigned long ef_construction = 100
+        ) :
+            dist_funct(dist_funct_),
+            graph(max_neighbors, ef_construction)
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(max_neighbors > 1 && ef_construction > 0,
+                "\t hnsw_index::hnsw_index()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t max_neighbors:   " << max_neighbors
+                << "\n\t ef_construction: " << ef_construction
+                );
+        }
+
+        const distance_function_type& get_distance_function (
+        ) const { return dist_funct; }
+
+        unsigned long get_max_neighbors (
+        ) const { return graph.get_max_neighbors(); }
+
+        unsigned long get_ef_construction (
+        ) const { return graph.get_ef_construction(); }
+
+        void set_ef_search (
+            unsigned long ef
+        )
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(ef > 0,
+                "\t void hnsw_index::set_ef_search()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t ef: " << ef
+                );
+            graph.set_ef_search(ef);
+        }
+
+        unsigned long get_ef_search (
+        ) const { return graph.get_ef_search(); }
+
+        unsigned long size (
+        ) const { return samples.size(); }
+
+        const sample_type& operator[] (
+            unsigned long idx
+        ) const
+        {
+            // make sure requires clause is not broken
+            DLIB_ASSERT(idx < size(),
+                "\t const sample_type& hnsw_index::operator[]()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t idx:    " << idx
+                << "\n\t size(): " << size()
+                );
+            return samples[idx];
+        }
+
+        void clear (
+        )
+        {
+            samples.clear();
+            graph.clear();
+        }
+
+        unsigned long add (
+            const sample_type& item
+        )
+        {
+            samples.push_back(item);
+            graph.append();
+            graph.link_last(storage());
+            return samples.size()-1;
+        }
+
+        template <
+            typename vector_type
+            >
+        void add (
+            const vector_type& items,
+            unsigned long num_threads
+        )
+        {
+            const unsigned long begin = samples.size();
+            samples.reserve(begin + items.size());
+            graph.reserve(begin + items.size());
+            for (unsigned long i = 0; i < items.size(); ++i)
+            {
+                samples.push_back(items[i]);
+                graph.append();
+            }
+            graph.link(storage(), begin, num_threads);
+        }
+
+        std::vector<std::pair<double,unsigned long> > find_nearest (
+            const sample_type& item,
+            unsigned long k
+        ) const
+        {
+            impl::hnsw_visit_marks marks;
+            return graph.find_nearest(storage(), item, k, marks);
+        }
+
+        template <
+            typename vector_type
+            >
+        std::vector<std::vector<std::pair<double,unsigned long> > > find_nearest (
+            const vector_type& items,
+            unsigned long k,
+            unsigned long num_threads
+        ) const
+        {
+            std::vector<std::vector<std::pair<double,unsigned long> > > results(items.size());
+            parallel_for_blocked(num_threads, 0, items.size(), [&](long begin, long end)
+            {
+                impl::hnsw_visit_marks marks;
+                for (long i = begin; i < end; ++i)
+                    results[i] = graph.find_nearest(storage(), items[i], k, marks);
+            });
+            return results;
+        }
+
+        friend void serialize (
+            const hnsw_index& item,
+            std::ostream& out
+        )
+        {
+            int version = 1;
+            dlib::serialize(version, out);
+            dlib::serialize(item.samples, out);
+            serialize(item.graph, out);
+        }
+
+        friend void deserialize (
+            hnsw_index& item,
+            std::istream& in
+        )
+        {
+            int version = 0;
+            dlib::deserialize(version, in);
+            if (version != 1)
+                throw serialization_error("Unexpected version found while deserializing dlib::hnsw_index.");
+            dlib::deserialize(item.samples, in);
+            deserialize(item.graph, in);
+        }
+
+    private:
+
+        struct sample_storage
+        {
+            const std::vector<sample_type>& samples;
+            const distance_function_type& dist_funct;
+
+            double distance_to (
+                const sample_type& item,
+                unsigned long i
+            ) const { return dist_funct(item, samples[i]); }
+
+            double distance (
+                unsigned long i,
+                unsigned long j
+            ) const { return dist_funct(samples[i], samples[j]); }
+        };
+
+        sample_storage storage (
+        ) const { return sample_storage{samples, dist_funct}; }
+
+        distance_function_type dist_funct;
+        std::vector<sample_type> samples;
+        impl::hnsw_graph graph;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename sample_type,
+        typename distance_function_type,
+        typename alloc
+        >
+    void find_k_nearest_neighbors_hnsw (
+        const hnsw_index<sample_type,distance_function_type>& index,
+        const unsigned long k,
+        const unsigned long num_threads,
+        std::vector<sample_pair, alloc>& edges
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(k > 0,
+            "\t void find_k_nearest_neighbors_hnsw()"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t index.size(): " << index.size()
+            << "\n\t k:            " << k
+            );
+
+        // The index holds the samples, so it can also be the list of samples to search
+        // for.  Ask for one extra neighbor since a sample usually finds itself.
+        const std::vector<std::vector<std::pair<double,unsigned long> > > nearest = index.find_nearest(index, k+1, num_threads);
+
+        edges.clear();
+        for (unsigned long i = 0; i < nearest.size(); ++i)
+        {
+            unsigned long num = 0;
+            for (unsigned long j = 0; j < nearest[i].size() && num < k; ++j)
+            {
+                if (nearest[i][j].second != i)
+                {
+                    edges.push_back(sample_pair(i, nearest[i][j].second, nearest[i][j].first));
+                    ++num;
+                }
+            }
+        }
+        remove_duplicate_edges(edges);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename vector_type,
+        typename distance_function_type,
+        typename alloc
+        >
+    void find_k_nearest_neighbors_hnsw (
+        const vector_type& samples,
+        const distance_function_type& dist_funct,
+        const unsigned long k,
+        const unsigned long num_threads,
+        std::vector<sample_pair, alloc>& edges
+    )
+    {
+        // make sure requires clause is not broken
+        DLIB_ASSERT(k > 0,
+            "\t void find_k_nearest_neighbors_hnsw()"
+            << "\n\t Invalid inputs were given to this function."
+            << "\n\t samples.size(): " << samples.size()
+            << "\n\t k:              " << k
+            );
+
+        typedef typename std::remove_const<typename std::remove_reference<decltype(samples[0])>::type>::type sample_type;
+        hnsw_index<sample_type,distance_function_type> index(dist_funct, 16, std::max<unsigned long>(100, 2*k));
+        index.set_ef_search(std::max<unsigned long>(50, 2*k));
+        index.add(samples, num_threads);
+        find_k_nearest_neighbors_hnsw(index, k, num_threads, edges);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_HNSW_INDEX_Hh_
+
@@ -0,0 +1,340 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_HNSW_INDEX_ABSTRACT_Hh_
+#ifdef DLIB_HNSW_INDEX_ABSTRACT_Hh_
+
+#include "sample_pair_abstract.h"
+#include "edge_list_graphs_abstract.h"
+#include <vector>
+#include <utility>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename sample_type_,
+        typename distance_function_type_
+        >
+    class hnsw_index
+    {
+        /*!
+            REQUIREMENTS ON sample_type_
+                Must be copyable and serializable.
+
+            REQUIREMENTS ON distance_function_type_
+                Must be a function object such that dist_funct(a,b), for two
+                sample_type_ objects a and b, evaluates to a floating point number, for
+                example, the objects defined in dlib/graph_utils/function_objects_abstract.h.
+                It must be safe for multiple threads to call it at the same time.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object is a set of samples that can be searched for the samples
+                nearest to a query.  It is a Hierarchical Navigable Small World graph, as
+                described in the paper:
+                    Efficient and robust approximate nearest neighbor search using
+                    Hierarchical Navigable Small World graphs by Yu. A. Malkov and D. A.
+                    Yashunin
+                That is, each sample is linked to some of its nearest neighbors, in a
+                stack of layers that each contain about get_max_neighbors() times fewer
+                samples than the layer below.  A search starts in the top layer and walks
+                down the layers towards the query, so finding the nearest neighbors of a
+                query takes roughly logarithmic time in size() instead of the linear time
+                of comparing the query to every sample.  The results are approximate,
+                but usually almost all of the true nearest neighbors are found.
+
+                Samples can be added at any time, and adding a sample doesn't change the
+                indices of the samples already in the index.  The index is numbered 0 to
+                size()-1 in the order the samples were added.
+
+            THREAD SAFETY
+                It is safe to call the const methods of this object, such as
+                find_nearest(), from multiple threads at the same time, as long as no
+                thread is modifying the object.
+        !*/
+
+    public:
+
+        typedef sample_type_ sample_type;
+        typedef distance_function_type_ distance_function_type;
+
+        hnsw_index (
+        );
+        /*!
+            ensures
+                - performs: hnsw_index(distance_function_type())
+        !*/
+
+        explicit hnsw_index (
+            const distance_function_type& dist_funct,
+            unsigned long max_neighbors = 16,
+            unsigned long ef_construction = 100
+        );
+        /*!
+            requires
+                - max_neighbors > 1
+                - ef_construction > 0
+            ensures
+                - #size() == 0
+                - #get_distance_function() == dist_funct
+                - #get_max_neighbors() == max_neighbors
+                - #get_ef_construction() == ef_construction
+                - #get_ef_search() == 50
+        !*/
+
+        const distance_function_type& get_distance_function (
+        ) const;
+        /*!
+            ensures
+                - returns the distance function used to compare samples.
+        !*/
+
+        unsigned long get_max_neighbors (
+        ) const;
+        /*!
+            ensures
+                - returns the number of neighbors each sample is linked to in the upper
+                  layers of the graph.  In the bottom layer it is linked to up to twice
+                  as many.  Larger values give more accurate results but make the index
+                  bigger and slower.  Values between 8 and 48 are typical, with larger
+                  values being better for samples with many dimensions.
+        !*/
+
+        unsigned long get_ef_construction (
+        ) const;
+        /*!
+            ensures
+                - returns the number of candidate neighbors considered when a sample is
+                  added to the index.  Larger values make the graph better, and so the
+                  searches more accurate, but make add() slower.
+        !*/
+
+        void set_ef_search (
+            unsigned long ef
+        );
+        /*!
+            requires
+                - ef > 0
+            ensures
+                - #get_ef_search() == ef
+        !*/
+
+        unsigned long get_ef_search (
+        ) const;
+        /*!
+            ensures
+                - returns the number of candidate neighbors find_nearest() keeps while
+                  searching, or k if that is larger.  Larger values make the searches
+                  more accurate but slower.
+        !*/
+
+        unsigned long size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of samples in this index.
+        !*/
+
+        const sample_type& operator[] (
+            unsigned long idx
+        ) const;
+        /*!
+            requires
+                - idx < size()
+            ensures
+                - returns the idx-th sample added to this index.
+        !*/
+
+        void clear (
+        );
+        /*!
+            ensures
+                - #size() == 0
+                - The settings, such as get_max_neighbors(), are not changed.
+        !*/
+
+        unsigned long add (
+            const sample_type& item
+        );
+        /*!
+            ensures
+                - Adds item to this index.
+                - #size() == size() + 1
+                - #(*this)[size()] == item
+                - returns size(), the index of item.
+        !*/
+
+        template <
+            typename vector_type
+            >
+        void add (
+            const vector_type& items,
+            unsigned long num_threads
+        );
+        /*!
+            requires
+                - vector_type is any container that looks like a std::vector or
+                  dlib::array and contains sample_type objects.
+            ensures
+                - Adds all the elements of items to this index, in order.
+                - #size() == size() + items.size()
+                - for all valid i:
+                    - #(*this)[size()+i] == items[i]
+                - This function will use num_threads concurrent threads of processing.
+                  To do this, the items are added in small batches whose elements are
+                  linked into the graph at the same time.  So the graph is not the same
+                  as the one made by calling add(items[i]) for each item, but it doesn't
+                  depend on num_threads.
+        !*/
+
+        std::vector<std::pair<double,unsigned long> > find_nearest (
+            const sample_type& item,
+            unsigned long k
+        ) const;
+        /*!
+            ensures
+                - Searches this index for the k samples nearest to item, according to
+                  get_distance_function().
+                - returns a vector R of at most k (distance, index) pairs, sorted by
+                  increasing distance, such that:
+                    - for all valid i:
+                        - R[i].second < size()
+                        - R[i].first == get_distance_function()(item, (*this)[R[i].second])
+                        - R[i].first < std::numeric_limits<double>::infinity()
+                  Since the search is approximate, R may miss some of the true nearest
+                  neighbors.  R is shorter than k only if size() < k, or if some of the
+                  samples are at an infinite distance from item or not reachable through
+                  the graph because of such distances.
+                - Each call allocates 4*size() bytes of scratch memory to keep track of
+                  the samples it has visited.  So when searching for many items, the
+                  version of find_nearest() that takes them all at once is faster, since
+                  each of its threads reuses that memory.
+        !*/
+
+        template <
+            typename vector_type
+            >
+        std::vector<std::vector<std::pair<double,unsigned long> > > find_nearest (
+            const vector_type& items,
+            unsigned long k,
+            unsigned long num_threads
+        ) const;
+        /*!
+            requires
+                - vector_type is any container that looks like a std::vector or
+                  dlib::array and contains sample_type objects.
+            ensures
+                - returns a vector R such that:
+                    - R.size() == items.size()
+                    - for all valid i:
+                        - R[i] == find_nearest(items[i], k)
+                - This function will use num_threads concurrent threads of processing to
+                  search for all the items at once.
+        !*/
+    };
+
+    template <
+        typename sample_type,
+        typename distance_function_type
+        >
+    void serialize (
+        const hnsw_index<sample_type,distance_function_type>& item,
+        std::ostream& out
+    );
+    /*!
+        provides serialization support.  Note that the distance function is not saved, so
+        deserialize() leaves the distance function of the object it loads into unchanged.
+    !*/
+
+    template <
+        typename sample_type,
+        typename distance_function_type
+        >
+    void deserialize (
+        hnsw_index<sample_type,distance_function_type>& item,
+        std::istream& in
+    );
+    /*!
+        provides deserialization support
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename sample_type,
+        typename distance_function_type,
+        typename alloc
+        >
+    void find_k_nearest_neighbors_hnsw (
+        const hnsw_index<sample_type,distance_function_type>& index,
+        const unsigned long k,
+        const unsigned long num_threads,
+        std::vector<sample_pair, alloc>& edges
+    );
+    /*!
+        requires
+            - k > 0
+        ensures
+            - This function computes an approximate form of a k nearest neighbors graph of
+              the samples in index.  In particular, it searches index for the k nearest
+              neighbors of each of its samples with index.find_nearest() and stores the
+              edges to them into #edges.
+            - for all valid i:
+                - #edges[i].distance() == index.get_distance_function()(index[#edges[i].index1()], index[#edges[i].index2()])
+                - #edges[i].distance() < std::numeric_limits<double>::infinity()
+            - contains_duplicate_pairs(#edges) == false
+            - This function will use num_threads concurrent threads of processing.  You
+              should set this value equal to the number of processing cores on your
+              computer for maximum speed.
+            - Since samples can be added to an hnsw_index at any time, this function can
+              be used to update the graph after new samples arrive without rebuilding
+              the index.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename vector_type,
+        typename distance_function_type,
+        typename alloc
+        >
+    void find_k_nearest_neighbors_hnsw (
+        const vector_type& samples,
+        const distance_function_type& dist_funct,
+        const unsigned long k,
+        const unsigned long num_threads,
+        std::vector<sample_pair, alloc>& edges
+    );
+    /*!
+        requires
+            - k > 0
+            - dist_funct(samples[i], samples[j]) must be a valid expression that evaluates
+              to a floating point number
+            - dist_funct is threadsafe.  This means that it must be safe for multiple
+              threads to invoke its member functions at the same time.
+            - vector_type is any container that looks like a std::vector or dlib::array.
+        ensures
+            - This function computes an approximate form of a k nearest neighbors graph of
+              the elements in samples.  It does this by adding them to an hnsw_index and
+              calling find_k_nearest_neighbors_hnsw() on it.  This takes about
+              O(samples.size()*log(samples.size())) time, rather than the quadratic time
+              of find_k_nearest_neighbors(), so it can be used with millions of samples.
+            - Note that samples with an infinite distance between them are considered to be
+              not connected at all. Therefore, we exclude edges with such distances from
+              being output.
+            - for all valid i:
+                - #edges[i].distance() == dist_funct(samples[#edges[i].index1()], samples[#edges[i].index2()])
+                - #edges[i].distance() < std::numeric_limits<double>::infinity()
+            - contains_duplicate_pairs(#edges) == false
+            - This function will use num_threads concurrent threads of processing.  You
+              should set this value equal to the number of processing cores on your
+              computer for maximum speed.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_HNSW_INDEX_ABSTRACT_Hh_
+
@@ -5,6 +5,9 @@
 
 #include "graph_utils.h"
 #include "graph_utils/find_k_nearest_neighbors_lsh.h"
+#include "graph_utils/csr_graph.h"
+#include "graph_utils/hnsw_index.h"
+#include "graph_utils/descriptor_index.h"
 
 #endif // DLIB_GRAPH_UTILs_THREADED_H_ 
 
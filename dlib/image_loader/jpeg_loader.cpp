@@ -17,6 +17,7 @@
 #   include <jpeglib.h>
 #endif
 #include <sstream>
+#include <cstring>
 #include <setjmp.h>
 
 namespace dlib
@@ -27,7 +28,7 @@ namespace dlib
     jpeg_loader::
     jpeg_loader( const char* filename ) : height_( 0 ), width_( 0 ), output_components_(0)
     {
-        read_image( check_file( filename ), NULL, 0L );
+        read_image( check_file( filename ), NULL, 0L, jpeg_load_options() );
     }
 
 // ----------------------------------------------------------------------------------------
@@ -35,7 +36,7 @@ namespace dlib
     jpeg_loader::
     jpeg_loader( const std::string& filename ) : height_( 0 ), width_( 0 ), output_components_(0)
     {
-        read_image( check_file( filename.c_str() ), NULL, 0L );
+        read_image( check_file( filename.c_str() ), NULL, 0L, jpeg_load_options() );
     }
 
 // ----------------------------------------------------------------------------------------
@@ -43,7 +44,7 @@ namespace dlib
     jpeg_loader::
     jpeg_loader( const dlib::file& f ) : height_( 0 ), width_( 0 ), output_components_(0)
     {
-        read_image( check_file( f.full_name().c_str() ), NULL, 0L );
+        read_image( check_file( f.full_name().c_str() ), NULL, 0L, jpeg_load_options() );
     }
 
 // ----------------------------------------------------------------------------------------
@@ -51,7 +52,39 @@ namespace dlib
     jpeg_loader::
     jpeg_loader( const unsigned char* imgbuffer, size_t imgbuffersize ) : height_( 0 ), width_( 0 ), output_components_(0)
     {
-        read_image( NULL, imgbuffer, imgbuffersize );
+        read_image( NULL, imgbuffer, imgbuffersize, jpeg_load_options() );
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    jpeg_loader::
+    jpeg_loader( const char* filename, const jpeg_load_options& options ) : height_( 0 ), width_( 0 ), output_components_(0)
+    {
+        read_image( check_file( filename ), NULL, 0L, options );
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    jpeg_loader::
+    jpeg_loader( const std::string& filename, const jpeg_load_options& options ) : height_( 0 ), width_( 0 ), output_components_(0)
+    {
+        read_image( check_file( filename.c_str() ), NULL, 0L, options );
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    jpeg_loader::
+    jpeg_loader( const dlib::file& f, const jpeg_load_options& options ) : height_( 0 ), width_( 0 ), output_components_(0)
+    {
+        read_image( check_file( f.full_name().c_str() ), NULL, 0L, options );
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    jpeg_loader::
+    jpeg_loader( const unsigned char* imgbuffer, size_t imgbuffersize, const jpeg_load_options& options ) : height_( 0 ), width_( 0 ), output_components_(0)
+    {
+        read_image( NULL, imgbuffer, imgbuffersize, options );
     }
 
 // ----------------------------------------------------------------------------------------
@@ -90,6 +123,34 @@ namespace dlib
         return static_cast<long>(width_);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    long jpeg_loader::original_nr() const
+    {
+        return static_cast<long>(original_height_);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    long jpeg_loader::original_nc() const
+    {
+        return static_cast<long>(original_width_);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    unsigned long jpeg_loader::get_downscale() const
+    {
+        return downscale_;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    rectangle jpeg_loader::get_region() const
+    {
+        return region_;
+    }
+
 // ----------------------------------------------------------------------------------------
 
     struct jpeg_loader_error_mgr 
@@ -128,7 +189,12 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    void jpeg_loader::read_image( FILE * file, const unsigned char* imgbuffer, size_t imgbuffersize )
+    void jpeg_loader::read_image( 
+        FILE * file, 
+        const unsigned char* imgbuffer, 
+        size_t imgbuffersize, 
+        const jpeg_load_options& options 
+    )
     {
         
         jpeg_decompress_struct cinfo;
@@ -158,10 +224,31 @@ namespace dlib
 
         jpeg_read_header(&cinfo, TRUE);
 
+        original_height_ = cinfo.image_height;
+        original_width_ = cinfo.image_width;
+
+        // The part of the full resolution image the caller wants.
+        rectangle area = rectangle((unsigned long)original_width_, (unsigned long)original_height_);
+        if (!options.region.is_empty())
+            area = area.intersect(options.region);
+
+        // libjpeg can scale the image down by 2, 4 or 8 while decoding it, by running a
+        // smaller inverse DCT on each block.  That is far cheaper than decoding at full
+        // size and downsampling afterwards, so use the largest factor the caller allows
+        // that still leaves at least min_nr by min_nc pixels in the area.
+        downscale_ = 1;
+        for (unsigned long d = 2; d <= options.max_downscale && d <= 8; d *= 2)
+        {
+            if ((long)((area.height()+d-1)/d) < options.min_nr ||
+                (long)((area.width()+d-1)/d) < options.min_nc)
+                break;
+            downscale_ = d;
+        }
+        cinfo.scale_num = 1;
+        cinfo.scale_denom = downscale_;
+
         jpeg_start_decompress(&cinfo);
 
-        height_ = cinfo.output_height;
-        width_ = cinfo.output_width;
         output_components_ = cinfo.output_components;
 
         if (output_components_ != 1 && 
@@ -175,23 +262,87 @@ namespace dlib
             throw image_load_error(sout.str());
         }
 
-        std::vector<unsigned char*> rows;
-        rows.resize(height_);
+        // Map the area into the coordinates of the scaled output image.
+        if (area.is_empty())
+        {
+            region_ = rectangle();
+        }
+        else
+        {
+            const long d = downscale_;
+            region_ = rectangle(area.left()/d, area.top()/d, (area.right()+d)/d - 1, (area.bottom()+d)/d - 1);
+            region_ = region_.intersect(rectangle((unsigned long)cinfo.output_width, (unsigned long)cinfo.output_height));
+        }
+        height_ = region_.height();
+        width_ = region_.width();
 
         // size the image buffer
         data.resize(height_*width_*output_components_);
 
-        // setup pointers to each row
-        for (size_t i = 0; i < rows.size(); ++i)
-            rows[i] = &data[i*width_*output_components_];
-
-        // read the data into the buffer
-        while (cinfo.output_scanline < cinfo.output_height)
+        if (height_ != 0 && width_ != 0)
         {
-            jpeg_read_scanlines(&cinfo, &rows[cinfo.output_scanline], 100);
+            // Where the columns we want start in each decoded scanline, and how long the
+            // scanlines are.
+            size_t col_offset = region_.left();
+            size_t row_width = cinfo.output_width;
+#ifdef LIBJPEG_TURBO_VERSION
+            // libjpeg-turbo can skip the blocks outside the region entirely rather than
+            // decoding and throwing them away.  jpeg_crop_scanline() may widen the
+            // column range to a block boundary, so we still copy out the part we want.
+            if (width_ != cinfo.output_width)
+            {
+                JDIMENSION xoffset = region_.left();
+                JDIMENSION cropped_width = width_;
+                jpeg_crop_scanline(&cinfo, &xoffset, &cropped_width);
+                col_offset = region_.left() - xoffset;
+                row_width = cropped_width;
+            }
+            if (region_.top() > 0)
+                jpeg_skip_scanlines(&cinfo, region_.top());
+#endif
+
+            if (col_offset == 0 && row_width == width_ && cinfo.output_scanline == (JDIMENSION)region_.top())
+            {
+                // The scanlines are exactly the rows we want, so decode straight into the
+                // image buffer.
+                std::vector<unsigned char*> rows;
+                rows.resize(height_);
+
+                // setup pointers to each row
+                for (size_t i = 0; i < rows.size(); ++i)
+                    rows[i] = &data[i*width_*output_components_];
+
+                // read the data into the buffer
+                const size_t end = region_.bottom()+1;
+                while (cinfo.output_scanline < end)
+                {
+                    const size_t r = cinfo.output_scanline - region_.top();
+                    jpeg_read_scanlines(&cinfo, &rows[r], end - cinfo.output_scanline);
+                }
+            }
+            else
+            {
+                std::vector<unsigned char> scanline(row_width*output_components_);
+                unsigned char* scanline_ptr = scanline.data();
+                while (cinfo.output_scanline <= (JDIMENSION)region_.bottom())
+                {
+                    const long r = (long)cinfo.output_scanline - region_.top();
+                    jpeg_read_scanlines(&cinfo, &scanline_ptr, 1);
+                    if (r >= 0)
+                    {
+                        std::memcpy(&data[r*width_*output_components_], 
+                                    &scanline[col_offset*output_components_],
+                                    width_*output_components_);
+                    }
+                }
+            }
         }
 
-        jpeg_finish_decompress(&cinfo);
+        // jpeg_finish_decompress() insists on every scanline having been read, so only use
+        // it if we decoded the whole image.  Otherwise destroying the decompressor aborts
+        // the rest of the decode.
+        if (cinfo.output_scanline == cinfo.output_height)
+            jpeg_finish_decompress(&cinfo);
         jpeg_destroy_decompress(&cinfo);
 
         if (file != NULL) fclose(file);
@@ -9,11 +9,20 @@
 #include "image_loader.h"
 #include "../pixel.h"
 #include "../dir_nav.h"
+#include "../geometry/rectangle.h"
 #include "../test_for_odr_violations.h"
 
 namespace dlib
 {
 
+    struct jpeg_load_options
+    {
+        unsigned long max_downscale = 1;
+        long min_nr = 0;
+        long min_nc = 0;
+        rectangle region;
+    };
+
     class jpeg_loader : noncopyable
     {
     public:
@@ -22,12 +31,20 @@ namespace dlib
         jpeg_loader( const std::string& filename );
         jpeg_loader( const dlib::file& f );
         jpeg_loader( const unsigned char* imgbuffer, size_t buffersize );
+        jpeg_loader( const char* filename, const jpeg_load_options& options );
+        jpeg_loader( const std::string& filename, const jpeg_load_options& options );
+        jpeg_loader( const dlib::file& f, const jpeg_load_options& options );
+        jpeg_loader( const unsigned char* imgbuffer, size_t buffersize, const jpeg_load_options& options );
 
         bool is_gray() const;
         bool is_rgb() const;
         bool is_rgba() const;
         long nr() const;
         long nc() const;
+        long original_nr() const;
+        long original_nc() const;
+        unsigned long get_downscale() const;
+        rectangle get_region() const;
 
         template<typename T>
         void get_image( T& t_) const
@@ -80,10 +97,14 @@ namespace dlib
         }
         
         FILE * check_file(const char* filename );
-        void read_image( FILE *file, const unsigned char* imgbuffer, size_t imgbuffersize );
+        void read_image( FILE *file, const unsigned char* imgbuffer, size_t imgbuffersize, const jpeg_load_options& options );
         size_t height_; 
         size_t width_;
         size_t output_components_;
+        size_t original_height_ = 0;
+        size_t original_width_ = 0;
+        unsigned long downscale_ = 1;
+        rectangle region_;
         std::vector<unsigned char> data;
     };
 
@@ -124,6 +145,44 @@ namespace dlib
         jpeg_loader(reinterpret_cast<const unsigned char*>(imgbuff), imgbuffsize).get_image(image);
     }
 
+    template <
+        typename image_type
+        >
+    void load_jpeg (
+        image_type& image,
+        const std::string& file_name,
+        const jpeg_load_options& options
+    )
+    {
+        jpeg_loader(file_name, options).get_image(image);
+    }
+
+    template <
+        typename image_type
+        >
+    void load_jpeg (
+        image_type& image,
+        const unsigned char* imgbuff,
+        size_t imgbuffsize,
+        const jpeg_load_options& options
+    )
+    {
+        jpeg_loader(imgbuff, imgbuffsize, options).get_image(image);
+    }
+
+    template <
+        typename image_type
+        >
+    void load_jpeg (
+        image_type& image,
+        const char* imgbuff,
+        size_t imgbuffsize,
+        const jpeg_load_options& options
+    )
+    {
+        jpeg_loader(reinterpret_cast<const unsigned char*>(imgbuff), imgbuffsize, options).get_image(image);
+    }
+
 // ----------------------------------------------------------------------------------------
 
 }
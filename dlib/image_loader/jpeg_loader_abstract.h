@@ -7,11 +7,50 @@
 #include "../algs.h"
 #include "../pixel.h"
 #include "../dir_nav.h"
+#include "../geometry/rectangle_abstract.h"
 #include "../image_processing/generic_image.h"
 
 namespace dlib
 {
 
+// ----------------------------------------------------------------------------------------
+
+    struct jpeg_load_options
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This object tells a jpeg_loader to decode only part of a JPEG file, or to
+                decode it at reduced resolution.  Both are much cheaper than decoding the
+                whole image and then cropping or downsampling it, since libjpeg skips the
+                work for the pixels that aren't wanted.  The default values decode the
+                whole image at full resolution.
+
+                For example, to feed a 24 megapixel photo to a detector that wants images
+                about 640 pixels wide you could use:
+                    jpeg_load_options opts;
+                    opts.max_downscale = 8;
+                    opts.min_nc = 640;
+                    load_jpeg(img, "photo.jpg", opts);
+                which decodes the photo at 1/4 scale, about 1500 pixels wide.
+        !*/
+
+        unsigned long max_downscale = 1;
+        /*!
+            The image is decoded at 1/s of its size, where s is the largest of 1, 2, 4 and
+            8 that is <= max_downscale and that leaves at least min_nr rows and min_nc
+            columns in the decoded region.
+        !*/
+
+        long min_nr = 0;
+        long min_nc = 0;
+
+        rectangle region;
+        /*!
+            If non-empty, only the part of the image inside this rectangle is decoded.
+            It is given in the coordinates of the full resolution image.
+        !*/
+    };
+
     class jpeg_loader : noncopyable
     {
         /*!
@@ -78,6 +117,43 @@ namespace dlib
                   us from loading the given JPEG buffer.
         !*/
 
+        jpeg_loader( 
+            const char* filename,
+            const jpeg_load_options& options
+        );
+        jpeg_loader( 
+            const std::string& filename,
+            const jpeg_load_options& options
+        );
+        jpeg_loader( 
+            const dlib::file& f,
+            const jpeg_load_options& options
+        );
+        jpeg_loader( 
+            const unsigned char* imgbuffer,
+            size_t buffersize,
+            const jpeg_load_options& options
+        );
+        /*!
+            ensures
+                - These constructors are identical to the ones above except that they
+                  decode the image as described by options.  That is:
+                    - #get_downscale() == the scale factor picked as described in the
+                      documentation of jpeg_load_options.
+                    - Let IMG be the full JPEG image decoded at 1/get_downscale() scale.
+                      Then this object contains the sub-image of IMG inside #get_region(),
+                      where #get_region() is the smallest rectangle in IMG that covers
+                      options.region (or all of IMG if options.region is empty),
+                      clipped to IMG.  So #nr() == #get_region().height() and #nc() ==
+                      #get_region().width().  These are 0 if options.region doesn't
+                      overlap the image.
+            throws
+                - std::bad_alloc
+                - image_load_error
+                  This exception is thrown if there is some error that prevents
+                  us from loading the given JPEG file.
+        !*/
+
         ~jpeg_loader(
         );
         /*!
@@ -121,6 +197,44 @@ namespace dlib
                   object.
         !*/
 
+        long original_nr (
+        ) const;
+        /*!
+            ensures
+                - returns the number of rows in the JPEG file at full resolution.  This is
+                  the same as nr() unless a jpeg_load_options was given to the constructor.
+        !*/
+
+        long original_nc (
+        ) const;
+        /*!
+            ensures
+                - returns the number of columns in the JPEG file at full resolution.  This
+                  is the same as nc() unless a jpeg_load_options was given to the
+                  constructor.
+        !*/
+
+        unsigned long get_downscale (
+        ) const;
+        /*!
+            ensures
+                - returns the factor by which the image was scaled down while decoding it.
+                  This is always 1, 2, 4 or 8.
+        !*/
+
+        rectangle get_region (
+        ) const;
+        /*!
+            ensures
+                - returns the part of the image, in the coordinates of the image decoded at
+                  1/get_downscale() scale, held by this object.  So pixel (c,r) of the
+                  image given by get_image() is pixel
+                  (c+get_region().left(), r+get_region().top()) of the downscaled image,
+                  and corresponds to about
+                  get_downscale()*(c+get_region().left(), r+get_region().top()) in the
+                  full resolution image.
+        !*/
+
         template<
             typename image_type 
             >
@@ -186,6 +300,58 @@ namespace dlib
             - performs: jpeg_loader((unsigned char*)imgbuff, imgbuffsize).get_image(image);
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename image_type
+        >
+    void load_jpeg (
+        image_type& image,
+        const std::string& file_name,
+        const jpeg_load_options& options
+    );
+    /*!
+        requires
+            - image_type == an image object that implements the interface defined in
+              dlib/image_processing/generic_image.h 
+        ensures
+            - performs: jpeg_loader(file_name, options).get_image(image);
+    !*/
+
+    template <
+        typename image_type
+        >
+    void load_jpeg (
+        image_type& image,
+        const unsigned char* imgbuff,
+        size_t imgbuffsize,
+        const jpeg_load_options& options
+    );
+    /*!
+        requires
+            - image_type == an image object that implements the interface defined in
+              dlib/image_processing/generic_image.h 
+        ensures
+            - performs: jpeg_loader(imgbuff, imgbuffsize, options).get_image(image);
+    !*/
+
+    template <
+        typename image_type
+        >
+    void load_jpeg (
+        image_type& image,
+        const char* imgbuff,
+        size_t imgbuffsize,
+        const jpeg_load_options& options
+    );
+    /*!
+        requires
+            - image_type == an image object that implements the interface defined in
+              dlib/image_processing/generic_image.h 
+        ensures
+            - performs: jpeg_loader((unsigned char*)imgbuff, imgbuffsize, options).get_image(image);
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
@@ -0,0 +1,532 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_MULTI_CORRELATION_TrACKER_H_
+#define DLIB_MULTI_CORRELATION_TrACKER_H_
+
+#include "multi_correlation_tracker_abstract.h"
+#include "../geometry.h"
+#include "../matrix.h"
+#include "../array.h"
+#include "../array2d.h"
+#include "../statistics.h"
+#include "../image_transforms/assign_image.h"
+#include "../image_transforms/interpolation.h"
+#include "../image_transforms/fhog.h"
+#include "../threads/parallel_for_extension.h"
+#include <vector>
+#include <memory>
+#include <complex>
+#include <algorithm>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class multi_correlation_tracker
+    {
+    public:
+
+        explicit multi_correlation_tracker (
+            unsigned long filter_size = 6,
+            unsigned long num_scale_levels = 5,
+            unsigned long scale_window_size = 23,
+            double regularizer_space = 0.001,
+            double nu_space = 0.025,
+            double regularizer_scale = 0.001,
+            double nu_scale = 0.025,
+            double scale_pyramid_alpha = 1.020
+        ) :
+            filter_size(1 << filter_size), num_scale_levels(1 << num_scale_levels),
+            scale_window_size(scale_window_size),
+            regularizer_space(regularizer_space), nu_space(nu_space),
+            regularizer_scale(regularizer_scale), nu_scale(nu_scale),
+            scale_pyramid_alpha(scale_pyramid_alpha)
+        {
+            DLIB_CASSERT(num_scale_levels > 0,
+                "\t multi_correlation_tracker::multi_correlation_tracker()"
+                << "\n\t The real FFTs used by this object need an even number of scale levels."
+            );
+
+            // These only depend on the filter sizes, so they are made once here and
+            // shared by all the objects under track.
+            const long size = get_filter_size();
+            mask.set_size(size,size);
+            const point cent = center(get_rect(mask));
+            for (long r = 0; r < mask.nr(); ++r)
+            {
+                for (long c = 0; c < mask.nc(); ++c)
+                {
+                    double dist = length(point(c,r)-cent)/(size/2.0)*(pi/2);
+                    dist = std::min(dist, pi/2);
+                    mask(r,c) = std::cos(dist);
+                }
+            }
+
+            scale_cos_mask.resize(get_num_scale_levels());
+            const long max_level = get_num_scale_levels()/2;
+            for (unsigned long k = 0; k < get_num_scale_levels(); ++k)
+            {
+                double dist = std::abs((double)k-max_level)/max_level*pi/2;
+                dist = std::min(dist, pi/2);
+                scale_cos_mask[k] = std::cos(dist);
+            }
+
+            // start_track() always centers the scale target on the middle level.
+            matrix<float> temp;
+            make_scale_target_location_image(get_num_scale_levels()/2, initial_scale_target, temp);
+        }
+
+        unsigned long get_filter_size (
+        ) const { return filter_size; }
+
+        unsigned long get_num_scale_levels(
+        ) const { return num_scale_levels; }
+
+        unsigned long get_scale_window_size (
+        ) const { return scale_window_size; }
+
+        double get_regularizer_space (
+        ) const { return regularizer_space; }
+        double get_nu_space (
+        ) const { return nu_space;}
+
+        double get_regularizer_scale (
+        ) const { return regularizer_scale; }
+        double get_nu_scale (
+        ) const { return nu_scale;}
+
+        double get_scale_pyramid_alpha (
+        ) const { return scale_pyramid_alpha; }
+
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            if (num <= 1)
+                tp.reset();
+            else if (!tp || tp->num_threads_in_pool() != num)
+                tp = std::make_shared<thread_pool>(num);
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return tp ? tp->num_threads_in_pool() : 1;
+        }
+
+        unsigned long size (
+        ) const { return targets.size(); }
+
+        template <typename image_type>
+        void start_track (
+            const image_type& img,
+            const drectangle& p
+        )
+        {
+            DLIB_CASSERT(p.is_empty() == false,
+                "\t void multi_correlation_tracker::start_track()"
+                << "\n\t You can't give an empty rectangle."
+            );
+
+            workspace ws;
+            target t;
+
+            const point_transform_affine tform = inv(make_chip(img, p, ws));
+            make_target_location_image(tform(center(p)), ws.G, ws.real);
+            t.A.resize(ws.F.size());
+            t.B.set_size(ws.G.nr(), ws.G.nc());
+            t.B = 0;
+            for (unsigned long i = 0; i < ws.F.size(); ++i)
+            {
+                t.A[i] = pointwise_multiply(ws.G, ws.F[i]);
+                t.B += squared(real(ws.F[i]))+squared(imag(ws.F[i]));
+            }
+
+            t.position = p;
+
+            make_scale_space(img, p, ws);
+            t.As.set_size(ws.Fs.nr(), ws.Fs.nc());
+            t.Bs.set_size(ws.Fs.nc());
+            t.Bs = 0;
+            for (long i = 0; i < ws.Fs.nr(); ++i)
+            {
+                set_rowm(t.As,i) = pointwise_multiply(initial_scale_target, rowm(ws.Fs,i));
+                t.Bs += squared(real(rowm(ws.Fs,i)))+squared(imag(rowm(ws.Fs,i)));
+            }
+
+            targets.push_back(std::move(t));
+        }
+
+        void stop_track (
+            unsigned long idx
+        )
+        {
+            DLIB_ASSERT(idx < size(),
+                "\t void multi_correlation_tracker::stop_track()"
+                << "\n\t idx:    " << idx
+                << "\n\t size(): " << size()
+            );
+            targets.erase(targets.begin()+idx);
+        }
+
+        void clear (
+        )
+        {
+            targets.clear();
+        }
+
+        drectangle get_position (
+            unsigned long idx
+        ) const
+        {
+            DLIB_ASSERT(idx < size(),
+                "\t drectangle multi_correlation_tracker::get_position()"
+                << "\n\t idx:    " << idx
+                << "\n\t size(): " << size()
+            );
+            return targets[idx].position;
+        }
+
+        template <typename image_type>
+        std::vector<double> update_noscale (
+            const image_type& img,
+            const std::vector<drectangle>& guesses
+        )
+        {
+            return update_all(img, guesses, false);
+        }
+
+        template <typename image_type>
+        std::vector<double> update (
+            const image_type& img,
+            const std::vector<drectangle>& guesses
+        )
+        {
+            return update_all(img, guesses, true);
+        }
+
+        template <typename image_type>
+        std::vector<double> update_noscale (
+            const image_type& img
+        )
+        {
+            return update_all(img, get_positions(), false);
+        }
+
+        template <typename image_type>
+        std::vector<double> update (
+            const image_type& img
+        )
+        {
+            return update_all(img, get_positions(), true);
+        }
+
+    private:
+
+        struct target
+        {
+            // The filters are kept in the frequency domain, but since the features are
+            // real only the first filter_size/2+1 columns of each spectrum are stored.
+            std::vector<matrix<std::complex<float>>> A;
+            matrix<float> B;
+
+            // one row per scale feature
+            matrix<std::complex<float>> As;
+            matrix<float,1,0> Bs;
+
+            drectangle position;
+        };
+
+        struct workspace
+        {
+            std::vector<matrix<std::complex<float>>> F;
+            matrix<std::complex<float>> G;
+            matrix<float> real;
+            dlib::array<array2d<float>> hog;
+
+            matrix<std::complex<float>> Fs;
+            matrix<std::complex<float>> Gs;
+            matrix<float> scale_features;
+            matrix<float> scale_real;
+            dlib::array<dlib::array<array2d<float>>> scale_hogs;
+        };
+
+        std::vector<drectangle> get_positions (
+        ) const
+        {
+            std::vector<drectangle> guesses(targets.size());
+            for (unsigned long i = 0; i < targets.size(); ++i)
+                guesses[i] = targets[i].position;
+            return guesses;
+        }
+
+        template <typename image_type>
+        std::vector<double> update_all (
+            const image_type& img,
+            const std::vector<drectangle>& guesses,
+            bool do_scale
+        )
+        {
+            DLIB_CASSERT(guesses.size() == size(),
+                "\t std::vector<double> multi_correlation_tracker::update()"
+                << "\n\t You must give one guess for each object under track."
+                << "\n\t guesses.size(): " << guesses.size()
+                << "\n\t size():         " << size()
+            );
+
+            std::vector<double> psr(targets.size());
+            // The objects are split into one contiguous chunk per thread.  Each chunk
+            // gets a workspace, so the temporaries are reused from one object to the next.
+            const unsigned long num_chunks = std::min<unsigned long>(get_num_threads(), targets.size());
+            std::vector<workspace> ws(num_chunks);
+            auto update_chunk = [&](long k)
+            {
+                const unsigned long begin = targets.size()*k/num_chunks;
+                const unsigned long end = targets.size()*(k+1)/num_chunks;
+                for (unsigned long i = begin; i < end; ++i)
+                    psr[i] = update_target(img, guesses[i], targets[i], do_scale, ws[k]);
+            };
+            if (tp && num_chunks > 1)
+                parallel_for(*tp, 0, num_chunks, update_chunk);
+            else if (num_chunks == 1)
+                update_chunk(0);
+            return psr;
+        }
+
+        template <typename image_type>
+        double update_target (
+            const image_type& img,
+            const drectangle& guess,
+            target& t,
+            bool do_scale,
+            workspace& ws
+        ) const
+        {
+
+            const point_transform_affine tform = make_chip(img, guess, ws);
+
+            // use the current filter to predict the object's location
+            ws.G.set_size(t.B.nr(), t.B.nc());
+            ws.G = 0;
+            for (unsigned long i = 0; i < ws.F.size(); ++i)
+                ws.G += pointwise_multiply(ws.F[i], conj(t.A[i]));
+            ws.G = pointwise_multiply(ws.G, reciprocal(t.B+(float)get_regularizer_space()));
+            ws.real.set_size(get_filter_size(), get_filter_size());
+            ifftr({ws.real.nr(), ws.real.nc()}, &ws.G(0,0), &ws.real(0,0));
+            const dlib::vector<double,2> pp = max_point_interpolated(ws.real);
+
+            // Compute the peak to side lobe ratio.
+            const point p = pp;
+            running_stats<double> rs;
+            const rectangle peak = centered_rect(p, 8,8);
+            for (long r = 0; r < ws.real.nr(); ++r)
+            {
+                for (long c = 0; c < ws.real.nc(); ++c)
+                {
+                    if (!peak.contains(point(c,r)))
+                        rs.add(ws.real(r,c));
+                }
+            }
+            const double psr = (ws.real(p.y(),p.x())-rs.mean())/rs.stddev();
+
+            // update the position of the object
+            t.position = translate_rect(guess, tform(pp)-center(guess));
+
+            // now update the position filters
+            const float nu = get_nu_space();
+            make_target_location_image(pp, ws.G, ws.real);
+            t.B *= (1-nu);
+            for (unsigned long i = 0; i < ws.F.size(); ++i)
+            {
+                t.A[i] = nu*pointwise_multiply(ws.G, ws.F[i]) + (1-nu)*t.A[i];
+                t.B += nu*(squared(real(ws.F[i]))+squared(imag(ws.F[i])));
+            }
+
+            if (!do_scale)
+                return psr;
+
+            // Now predict the scale change
+            make_scale_space(img, t.position, ws);
+            ws.Gs.set_size(1, ws.Fs.nc());
+            ws.Gs = 0;
+            for (long i = 0; i < ws.Fs.nr(); ++i)
+                ws.Gs += pointwise_multiply(rowm(ws.Fs,i), conj(rowm(t.As,i)));
+            ws.Gs = pointwise_multiply(ws.Gs, reciprocal(t.Bs+(float)get_regularizer_scale()));
+            ws.scale_real.set_size(1, get_num_scale_levels());
+            ifftr({ws.scale_real.nc()}, &ws.Gs(0,0), &ws.scale_real(0,0));
+            const double pos = max_point_interpolated(ws.scale_real).x();
+
+            // update the rectangle's scale
+            t.position *= std::pow(get_scale_pyramid_alpha(), pos-(double)get_num_scale_levels()/2);
+
+            // Now update the scale filters
+            const float nus = get_nu_scale();
+            make_scale_target_location_image(pos, ws.Gs, ws.scale_real);
+            t.Bs *= (1-nus);
+            for (long i = 0; i < ws.Fs.nr(); ++i)
+            {
+                set_rowm(t.As,i) = nus*pointwise_multiply(ws.Gs, rowm(ws.Fs,i)) + (1-nus)*rowm(t.As,i);
+                t.Bs += nus*(squared(real(rowm(ws.Fs,i)))+squared(imag(rowm(ws.Fs,i))));
+            }
+
+            return psr;
+        }
+
+        template <typename image_type>
+        void make_scale_space(
+            const image_type& img,
+            const drectangle& position,
+            workspace& ws
+        ) const
+        {
+            typedef typename image_traits<image_type>::pixel_type pixel_type;
+            array2d<pixel_type> chip;
+
+            const long chip_size = get_scale_window_size();
+            drectangle ppp = position*std::pow(get_scale_pyramid_alpha(), -(double)get_num_scale_levels()/2);
+            std::vector<dlib::vector<double,2> > from_points, to_points;
+            from_points.push_back(point(0,0));
+            from_points.push_back(point(chip_size-1,0));
+            from_points.push_back(point(chip_size-1,chip_size-1));
+            ws.scale_hogs.resize(get_num_scale_levels());
+            for (unsigned long i = 0; i < get_num_scale_levels(); ++i)
+            {
+                // pull box into chip and extract its HOG
+                chip.set_size(chip_size,chip_size);
+                to_points.clear();
+                to_points.push_back(ppp.tl_corner());
+                to_points.push_back(ppp.tr_corner());
+                to_points.push_back(ppp.br_corner());
+                transform_image(img,chip,interpolate_bilinear(),find_affine_transform(from_points, to_points));
+
+                dlib::array<array2d<float>>& hog = ws.scale_hogs[i];
+                extract_fhog_features(chip, hog, 4);
+                hog.resize(32);
+                assign_image(hog[31], chip);
+                assign_image(hog[31], mat(hog[31])/255.0);
+
+                ppp *= get_scale_pyramid_alpha();
+            }
+
+            // Now copy the hog features into the rows of scale_features, applying the
+            // cosine window along each row, and take their FFTs.
+            const auto& hogs = ws.scale_hogs;
+            ws.scale_features.set_size(hogs[0].size()*hogs[0][0].size(), hogs.size());
+            long i = 0;
+            for (long r = 0; r < hogs[0][0].nr(); ++r)
+            {
+                for (long c = 0; c < hogs[0][0].nc(); ++c)
+                {
+                    for (unsigned long j = 0; j < hogs[0].size(); ++j)
+                    {
+                        for (unsigned long k = 0; k < hogs.size(); ++k)
+                            ws.scale_features(i,k) = hogs[k][j][r][c]*scale_cos_mask[k];
+                        ++i;
+                    }
+                }
+            }
+
+            ws.Fs.set_size(ws.scale_features.nr(), fftr_nc_size(ws.scale_features.nc()));
+            for (long n = 0; n < ws.Fs.nr(); ++n)
+                fftr({ws.scale_features.nc()}, &ws.scale_features(n,0), &ws.Fs(n,0));
+        }
+
+        template <typename image_type>
+        point_transform_affine make_chip (
+            const image_type& img,
+            const drectangle& p,
+            workspace& ws
+        ) const
+        {
+            typedef typename image_traits<image_type>::pixel_type pixel_type;
+            array2d<pixel_type> temp;
+            const double padding = 1.4;
+            const chip_details details(p*padding, chip_dims(get_filter_size(), get_filter_size()));
+            extract_image_chip(img, details, temp);
+
+            ws.F.resize(32);
+            extract_fhog_features(temp, ws.hog, 1, 3,3 );
+            for (unsigned long i = 0; i < ws.hog.size(); ++i)
+            {
+                ws.real = pointwise_multiply(mat(ws.hog[i]), mask);
+                real_fft(ws.real, ws.F[i]);
+            }
+
+            assign_image(ws.real, temp);
+            ws.real = pointwise_multiply(ws.real, mask)/255.0f;
+            real_fft(ws.real, ws.F[31]);
+
+            return inv(get_mapping_to_chip(details));
+        }
+
+        static void real_fft (
+            const matrix<float>& in,
+            matrix<std::complex<float>>& out
+        )
+        {
+            out.set_size(in.nr(), fftr_nc_size(in.nc()));
+            fftr({in.nr(), in.nc()}, &in(0,0), &out(0,0));
+        }
+
+        void make_target_location_image (
+            const dlib::vector<double,2>& p,
+            matrix<std::complex<float>>& g,
+            matrix<float>& temp
+        ) const
+        {
+            temp.set_size(get_filter_size(), get_filter_size());
+            temp = 0;
+            rectangle area = centered_rect(p, 21,21).intersect(get_rect(temp));
+            for (long r = area.top(); r <= area.bottom(); ++r)
+            {
+                for (long c = area.left(); c <= area.right(); ++c)
+                {
+                    double dist = length(point(c,r)-p);
+                    temp(r,c) = std::exp(-dist/3.0);
+                }
+            }
+            real_fft(temp, g);
+            g = conj(g);
+        }
+
+        void make_scale_target_location_image (
+            const double scale,
+            matrix<std::complex<float>>& g,
+            matrix<float>& temp
+        ) const
+        {
+            temp.set_size(1, get_num_scale_levels());
+            for (long i = 0; i < temp.size(); ++i)
+            {
+                double dist = std::pow((i-scale),2.0);
+                temp(i) = std::exp(-dist/1.000);
+            }
+            real_fft(temp, g);
+            g = conj(g);
+        }
+
+        std::vector<target> targets;
+
+        matrix<float> mask;
+        std::vector<float> scale_cos_mask;
+        matrix<std::complex<float>> initial_scale_target;
+
+        unsigned long filter_size;
+        unsigned long num_scale_levels;
+        unsigned long scale_window_size;
+        double regularizer_space;
+        double nu_space;
+        double regularizer_scale;
+        double nu_scale;
+        double scale_pyramid_alpha;
+
+        std::shared_ptr<thread_pool> tp;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_MULTI_CORRELATION_TrACKER_H_
+
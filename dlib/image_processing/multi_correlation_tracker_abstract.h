@@ -0,0 +1,243 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_MULTI_CORRELATION_TrACKER_ABSTRACT_H_
+#ifdef DLIB_MULTI_CORRELATION_TrACKER_ABSTRACT_H_
+
+#include "correlation_tracker_abstract.h"
+#include "../geometry/drectangle_abstract.h"
+#include <vector>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    class multi_correlation_tracker
+    {
+        /*!
+            WHAT THIS OBJECT REPRESENTS
+                This is a tool for tracking many moving objects in a video stream at once.
+                Each object is tracked the same way a correlation_tracker tracks a single
+                object, but all the objects are updated together by one call to update(),
+                which spreads them over a pool of threads.
+
+                Since every object in a multi_correlation_tracker uses the same filter
+                sizes, the cosine windows and the other values that only depend on those
+                sizes are computed once and shared by all of them, as are the FFT plans.
+                The filters themselves are kept in single precision and only the
+                non-redundant half of their spectrum is stored, since the features they
+                are computed from are real.  So the results differ slightly from the
+                ones a correlation_tracker with the same parameters would give, but each
+                object needs about a quarter of the memory and is faster to update.
+
+                The objects under track are numbered 0 to size()-1 in the order in which
+                they were added with start_track().  Removing one with stop_track()
+                shifts the numbers of the objects after it down by one.
+
+            THREAD SAFETY
+                The results of update() don't depend on get_num_threads().  However, you
+                must not call the methods of one multi_correlation_tracker from multiple
+                threads at the same time.
+        !*/
+
+    public:
+
+        explicit multi_correlation_tracker (
+            unsigned long filter_size = 6,
+            unsigned long num_scale_levels = 5,
+            unsigned long scale_window_size = 23,
+            double regularizer_space = 0.001,
+            double nu_space = 0.025,
+            double regularizer_scale = 0.001,
+            double nu_scale = 0.025,
+            double scale_pyramid_alpha = 1.020
+        );
+        /*!
+            requires
+                - num_scale_levels > 0
+            ensures
+                - The arguments have the same meaning as the ones given to the
+                  correlation_tracker constructor.  In particular,
+                  #get_filter_size() == 2^filter_size and
+                  #get_num_scale_levels() == 2^num_scale_levels.
+                - #size() == 0
+                - #get_num_threads() == 1
+        !*/
+
+        unsigned long get_filter_size (
+        ) const;
+        unsigned long get_num_scale_levels(
+        ) const;
+        unsigned long get_scale_window_size (
+        ) const;
+        double get_regularizer_space (
+        ) const;
+        double get_nu_space (
+        ) const;
+        double get_regularizer_scale (
+        ) const;
+        double get_nu_scale (
+        ) const;
+        double get_scale_pyramid_alpha (
+        ) const;
+        /*!
+            ensures
+                - returns the tracking parameters given to the constructor, in the same
+                  way the corresponding correlation_tracker methods do.
+        !*/
+
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            ensures
+                - #get_num_threads() == max(num,1)
+                - update() and update_noscale() will spread the objects under track over
+                  this many threads.
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads used to update the objects under track.
+        !*/
+
+        unsigned long size (
+        ) const;
+        /*!
+            ensures
+                - returns the number of objects currently under track.
+        !*/
+
+        template <
+            typename image_type
+            >
+        void start_track (
+            const image_type& img,
+            const drectangle& p
+        );
+        /*!
+            requires
+                - image_type == an image object that implements the interface defined in
+                  dlib/image_processing/generic_image.h
+                - p.is_empty() == false
+            ensures
+                - Starts tracking the thing inside the bounding box p in the given image.
+                - #size() == size() + 1
+                - #get_position(size()) == p
+                  (i.e. the new object is the last one)
+        !*/
+
+        void stop_track (
+            unsigned long idx
+        );
+        /*!
+            requires
+                - idx < size()
+            ensures
+                - Stops tracking object idx.
+                - #size() == size() - 1
+                - The objects after idx move down by one.  That is, for all i where
+                  idx <= i < #size(): #get_position(i) == get_position(i+1)
+        !*/
+
+        void clear (
+        );
+        /*!
+            ensures
+                - #size() == 0
+        !*/
+
+        drectangle get_position (
+            unsigned long idx
+        ) const;
+        /*!
+            requires
+                - idx < size()
+            ensures
+                - returns the predicted position of object idx.
+        !*/
+
+        template <
+            typename image_type
+            >
+        std::vector<double> update_noscale (
+            const image_type& img,
+            const std::vector<drectangle>& guesses
+        );
+        /*!
+            requires
+                - image_type == an image object that implements the interface defined in
+                  dlib/image_processing/generic_image.h
+                - guesses.size() == size()
+            ensures
+                - Updates each object under track as correlation_tracker::update_noscale()
+                  does, searching for object i in the area around guesses[i].
+                - #get_position(i) == the new predicted location of object i.  This
+                  location is a copy of guesses[i] that has been translated, but not
+                  scaled, so that it hopefully bounds the object in img.
+                - returns a vector PSR such that PSR.size() == size() and PSR[i] is the
+                  peak to side-lobe ratio of object i.  Larger values indicate higher
+                  confidence that the object is inside #get_position(i).
+        !*/
+
+        template <
+            typename image_type
+            >
+        std::vector<double> update (
+            const image_type& img,
+            const std::vector<drectangle>& guesses
+        );
+        /*!
+            requires
+                - image_type == an image object that implements the interface defined in
+                  dlib/image_processing/generic_image.h
+                - guesses.size() == size()
+            ensures
+                - Updates each object under track as correlation_tracker::update() does,
+                  searching for object i in the area around guesses[i].
+                - #get_position(i) == the new predicted location of object i.  This
+                  location is a copy of guesses[i] that has been translated and scaled so
+                  that it hopefully bounds the object in img.
+                - returns a vector PSR such that PSR.size() == size() and PSR[i] is the
+                  peak to side-lobe ratio of object i.
+        !*/
+
+        template <
+            typename image_type
+            >
+        std::vector<double> update_noscale (
+            const image_type& img
+        );
+        /*!
+            requires
+                - image_type == an image object that implements the interface defined in
+                  dlib/image_processing/generic_image.h
+            ensures
+                - performs: return update_noscale(img, G) where G[i] == get_position(i)
+        !*/
+
+        template <
+            typename image_type
+            >
+        std::vector<double> update (
+            const image_type& img
+        );
+        /*!
+            requires
+                - image_type == an image object that implements the interface defined in
+                  dlib/image_processing/generic_image.h
+            ensures
+                - performs: return update(img, G) where G[i] == get_position(i)
+        !*/
+
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_MULTI_CORRELATION_TrACKER_ABSTRACT_H_
+
+
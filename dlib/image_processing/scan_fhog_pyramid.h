@@ -8,7 +8,9 @@
 #include "../image_transforms.h"
 #include "../array.h"
 #include "../array2d.h"
+#include "../threads/thread_pool_extension.h"
 #include "object_detector.h"
+#include <memory>
 
 namespace dlib
 {
@@ -182,6 +184,20 @@ namespace dlib
         inline unsigned long get_min_pyramid_layer_height (
         ) const;
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            num_threads = num;
+            if (num_threads > 1)
+                tp = std::make_shared<thread_pool>(num_threads);
+            else
+                tp.reset();
+        }
+
+        unsigned long get_num_threads (
+        ) const { return num_threads; }
+
         void detect (
             const feature_vector_type& w,
             std::vector<std::pair<double, rectangle> >& dets,
@@ -393,6 +409,8 @@ namespace dlib
         unsigned long min_pyramid_layer_width;
         unsigned long min_pyramid_layer_height;
         double nuclear_norm_regularization_strength;
+        unsigned long num_threads;
+        std::shared_ptr<thread_pool> tp;
 
         void init()
         {
@@ -404,6 +422,7 @@ namespace dlib
             min_pyramid_layer_width = 64;
             min_pyramid_layer_height = 64;
             nuclear_norm_regularization_strength = 0;
+            num_threads = 1;
         }
 
     };
@@ -416,7 +435,8 @@ namespace dlib
         rectangle apply_filters_to_fhog (
             const fhog_filterbank& w,
             const array<array2d<float> >& feats,
-            array2d<float>& saliency_image
+            array2d<float>& saliency_image,
+            array2d<float>& scratch
         )
         {
             const unsigned long num_separable_filters = w.num_separable_filters();
@@ -435,7 +455,6 @@ namespace dlib
             else
             {
                 saliency_image.clear();
-                array2d<float> scratch;
 
                 // find the first filter to apply
                 unsigned long i = 0;
@@ -460,6 +479,17 @@ namespace dlib
             }
             return area;
         }
+
+        template <typename fhog_filterbank>
+        rectangle apply_filters_to_fhog (
+            const fhog_filterbank& w,
+            const array<array2d<float> >& feats,
+            array2d<float>& saliency_image
+        )
+        {
+            array2d<float> scratch;
+            return apply_filters_to_fhog(w, feats, saliency_image, scratch);
+        }
     }
 
 // ----------------------------------------------------------------------------------------
@@ -569,7 +599,8 @@ namespace dlib
             int filter_cols_padding,
             unsigned long min_pyramid_layer_width,
             unsigned long min_pyramid_layer_height,
-            unsigned long max_pyramid_levels
+            unsigned long max_pyramid_levels,
+            thread_pool* tp = nullptr
         )
         {
             unsigned long levels = 0;
@@ -588,7 +619,27 @@ namespace dlib
                 feats.set_max_size(levels);
             feats.set_size(levels);
 
+            typedef typename image_traits<image_type>::pixel_type pixel_type;
+            if (tp && levels > 1)
+            {
+                // Downsampling is cheap next to the fHOG extraction, so make the pyramid
+                // images here and hand each one to the pool as soon as it's ready.
+                array<array2d<pixel_type> > pyramid_images(levels);
 
+                tp->add_task_by_value([&](){ fe(img, feats[0], cell_size,filter_rows_padding,filter_cols_padding); });
+                pyr(img, pyramid_images[1]);
+                for (unsigned long i = 1; i < levels; ++i)
+                {
+                    if (i > 1)
+                        pyr(pyramid_images[i-1], pyramid_images[i]);
+                    tp->add_task_by_value([&,i](){ fe(pyramid_images[i], feats[i], cell_size,filter_rows_padding,filter_cols_padding); });
+                }
+                tp->wait_for_all_tasks();
+                DLIB_ASSERT(feats[0].size() == fe.get_num_planes(), 
+                    "Invalid feature extractor used with dlib::scan_fhog_pyramid.  The output does not have the \n"
+                    "indicated number of planes.");
+                return;
+            }
 
             // build our feature pyramid
             fe(img, feats[0], cell_size,filter_rows_padding,filter_cols_padding);
@@ -598,7 +649,6 @@ namespace dlib
 
             if (feats.size() > 1)
             {
-                typedef typename image_traits<image_type>::pixel_type pixel_type;
                 array2d<pixel_type> temp1, temp2;
                 pyr(img, temp1);
                 fe(temp1, feats[1], cell_size,filter_rows_padding,filter_cols_padding);
@@ -632,7 +682,7 @@ namespace dlib
         compute_fhog_window_size(width,height);
         impl::create_fhog_pyramid<Pyramid_type>(img, fe, feats, cell_size, height,
             width, min_pyramid_layer_width, min_pyramid_layer_height,
-            max_pyramid_levels);
+            max_pyramid_levels, tp.get());
     }
 
 // ----------------------------------------------------------------------------------------
@@ -667,6 +717,8 @@ namespace dlib
         min_pyramid_layer_width = item.min_pyramid_layer_width;
         min_pyramid_layer_height = item.min_pyramid_layer_height;
         nuclear_norm_regularization_strength = item.nuclear_norm_regularization_strength;
+        num_threads = item.num_threads;
+        tp = item.tp;
         fe = item.fe;
     }
 
@@ -758,13 +810,20 @@ namespace dlib
             return a.first < b.first;
         }
 
+        struct fhog_scan_scratch
+        {
+            array2d<float> saliency_image;
+            array2d<float> filter_scratch;
+        };
+
         template <
             typename pyramid_type,
             typename feature_extractor_type,
             typename fhog_filterbank
             >
-        void detect_from_fhog_pyramid (
-            const array<array<array2d<float> > >& feats,
+        void detect_from_fhog_level (
+            const array<array2d<float> >& level_feats,
+            const unsigned long l,
             const feature_extractor_type& fe,
             const fhog_filterbank& w,
             const double thresh,
@@ -773,35 +832,79 @@ namespace dlib
             const int cell_size,
             const int filter_rows_padding,
             const int filter_cols_padding,
+            fhog_scan_scratch& scratch,
             std::vector<std::pair<double, rectangle> >& dets
-        ) 
+        )
         {
-            dets.clear();
-
-            array2d<float> saliency_image;
+            array2d<float>& saliency_image = scratch.saliency_image;
             pyramid_type pyr;
+            const rectangle area = apply_filters_to_fhog(w, level_feats, saliency_image, scratch.filter_scratch);
 
-            // for all pyramid levels
-            for (unsigned long l = 0; l < feats.size(); ++l)
+            // now search the saliency image for any detections
+            for (long r = area.top(); r <= area.bottom(); ++r)
             {
-                const rectangle area = apply_filters_to_fhog(w, feats[l], saliency_image);
-
-                // now search the saliency image for any detections
-                for (long r = area.top(); r <= area.bottom(); ++r)
+                for (long c = area.left(); c <= area.right(); ++c)
                 {
-                    for (long c = area.left(); c <= area.right(); ++c)
+                    // if we found a detection
+                    if (saliency_image[r][c] >= thresh)
                     {
-                        // if we found a detection
-                        if (saliency_image[r][c] >= thresh)
-                        {
-                            rectangle rect = fe.feats_to_image(centered_rect(point(c,r),det_box_width,det_box_height), 
-                                cell_size, filter_rows_padding, filter_cols_padding);
-                            rect = pyr.rect_up(rect, l);
-                            dets.push_back(std::make_pair(saliency_image[r][c], rect));
-                        }
+                        rectangle rect = fe.feats_to_image(centered_rect(point(c,r),det_box_width,det_box_height), 
+                            cell_size, filter_rows_padding, filter_cols_padding);
+                        rect = pyr.rect_up(rect, l);
+                        dets.push_back(std::make_pair(saliency_image[r][c], rect));
                     }
                 }
             }
+        }
+
+        template <
+            typename pyramid_type,
+            typename feature_extractor_type,
+            typename fhog_filterbank
+            >
+        void detect_from_fhog_pyramid (
+            const array<array<array2d<float> > >& feats,
+            const feature_extractor_type& fe,
+            const fhog_filterbank& w,
+            const double thresh,
+            const unsigned long det_box_height,
+            const unsigned long det_box_width,
+            const int cell_size,
+            const int filter_rows_padding,
+            const int filter_cols_padding,
+            std::vector<std::pair<double, rectangle> >& dets,
+            thread_pool* tp = nullptr
+        ) 
+        {
+            dets.clear();
+
+            if (tp && feats.size() > 1)
+            {
+                // Scan the levels in parallel, largest first, and then concatenate their
+                // detections in level order so the output is the same as the serial scan's.
+                std::vector<std::vector<std::pair<double, rectangle> > > level_dets(feats.size());
+                std::vector<fhog_scan_scratch> scratch(feats.size());
+                for (unsigned long l = 0; l < feats.size(); ++l)
+                {
+                    tp->add_task_by_value([&,l](){
+                        detect_from_fhog_level<pyramid_type>(feats[l], l, fe, w, thresh, det_box_height,
+                            det_box_width, cell_size, filter_rows_padding, filter_cols_padding, scratch[l], level_dets[l]);
+                    });
+                }
+                tp->wait_for_all_tasks();
+                for (auto& d : level_dets)
+                    dets.insert(dets.end(), d.begin(), d.end());
+            }
+            else
+            {
+                fhog_scan_scratch scratch;
+                // for all pyramid levels
+                for (unsigned long l = 0; l < feats.size(); ++l)
+                {
+                    detect_from_fhog_level<pyramid_type>(feats[l], l, fe, w, thresh, det_box_height,
+                        det_box_width, cell_size, filter_rows_padding, filter_cols_padding, scratch, dets);
+                }
+            }
 
             std::sort(dets.rbegin(), dets.rend(), compare_pair_rect);
         }
@@ -852,7 +955,7 @@ namespace dlib
         compute_fhog_window_size(width,height);
 
         impl::detect_from_fhog_pyramid<pyramid_type>(feats, fe, w, thresh,
-            height-2*padding, width-2*padding, cell_size, height, width, dets);
+            height-2*padding, width-2*padding, cell_size, height, width, dets, tp.get());
     }
 
 // ----------------------------------------------------------------------------------------
@@ -1160,6 +1263,30 @@ namespace dlib
                                                                  detector_weights);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename Pyramid_type,
+        typename feature_extractor_type
+        >
+    void set_num_threads (
+        object_detector<scan_fhog_pyramid<Pyramid_type,feature_extractor_type> >& detector,
+        unsigned long num_threads
+    )
+    {
+        scan_fhog_pyramid<Pyramid_type,feature_extractor_type> scanner;
+        scanner.copy_configuration(detector.get_scanner());
+        scanner.set_num_threads(num_threads);
+
+        std::vector<matrix<double,0,1> > detector_weights;
+        for (unsigned long j = 0; j < detector.num_detectors(); ++j)
+            detector_weights.push_back(detector.get_w(j));
+
+        detector = object_detector<scan_fhog_pyramid<Pyramid_type,feature_extractor_type> >(scanner, 
+                                                                     detector.get_overlap_tester(),
+                                                                     detector_weights);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -85,6 +85,24 @@ namespace dlib
             - returns the updated detector
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename Pyramid_type,
+        typename feature_extractor_type
+        >
+    void set_num_threads (
+        object_detector<scan_fhog_pyramid<Pyramid_type,feature_extractor_type> >& detector,
+        unsigned long num_threads
+    );
+    /*!
+        ensures
+            - #detector.get_scanner().get_num_threads() == num_threads
+            - #detector finds the same objects as detector.  This is simply a convenient
+              way to turn on multithreaded scanning in a detector you loaded from disk,
+              since the scanner inside an object_detector can't be modified directly.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     class default_fhog_feature_extractor
@@ -218,6 +236,7 @@ namespace dlib
                 - get_min_pyramid_layer_width()  == 64
                 - get_min_pyramid_layer_height() == 64
                 - get_nuclear_norm_regularization_strength() == 0
+                - get_num_threads() == 1
 
             WHAT THIS OBJECT REPRESENTS
                 This object is a tool for running a fixed sized sliding window classifier
@@ -501,6 +520,31 @@ namespace dlib
                   value returned by this function.
         !*/
 
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            ensures
+                - #get_num_threads() == num
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads load() and detect() use.  If it is 1 then
+                  they run entirely in the calling thread.  Otherwise, this object owns a
+                  thread pool with get_num_threads() threads.  load() computes the HOG
+                  features of different pyramid levels in parallel and detect() scans
+                  different levels in parallel.  The results are exactly the same as with
+                  one thread.  Objects made with copy_configuration() share the thread
+                  pool of the object they were copied from.
+                - When get_num_threads() > 1 the feature extractor's operator() is called
+                  from several threads at once, so it must be safe to do so.
+                  default_fhog_feature_extractor is.
+                - This setting isn't saved by serialize().
+        !*/
+
         fhog_filterbank build_fhog_filterbank (
             const feature_vector_type& weights 
         ) const;
@@ -10,7 +10,10 @@
 #include "../geometry.h"
 #include "../pixel.h"
 #include "../statistics.h"
+#include "../simd.h"
+#include "../threads/parallel_for_extension.h"
 #include <utility>
+#include <cstdint>
 
 namespace dlib
 {
@@ -100,6 +103,133 @@ namespace dlib
             }
         };
 
+    // ------------------------------------------------------------------------------------
+
+        class flat_regression_forest
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object holds the trees of one level of a shape_predictor's cascade
+                    in a few contiguous arrays rather than as a std::vector of
+                    regression_tree objects, each holding a std::vector of leaf matrices.
+                    That keeps a tree's splits and leaves next to each other in memory and
+                    lets the leaf values be added to the shape with SIMD instructions.
+            !*/
+        public:
+
+            flat_regression_forest() = default;
+
+            flat_regression_forest (
+                const std::vector<regression_tree>& trees,
+                unsigned long shape_size_
+            ) : shape_size(shape_size_)
+            {
+                split_offsets.push_back(0);
+                leaf_offsets.push_back(0);
+                for (auto& tree : trees)
+                {
+                    DLIB_CASSERT(tree.leaf_values.size() == tree.splits.size()+1);
+                    for (auto& s : tree.splits)
+                        splits.push_back({static_cast<uint32_t>(s.idx1), static_cast<uint32_t>(s.idx2), s.thresh});
+                    for (auto& leaf : tree.leaf_values)
+                    {
+                        DLIB_CASSERT((unsigned long)leaf.size() == shape_size);
+                        leaf_values.insert(leaf_values.end(), leaf.begin(), leaf.end());
+                    }
+                    split_offsets.push_back(splits.size());
+                    leaf_offsets.push_back(leaf_values.size()/std::max<unsigned long>(shape_size,1));
+                }
+            }
+
+            unsigned long num_trees (
+            ) const { return split_offsets.size()-1; }
+
+            unsigned long num_leaves (
+                unsigned long tree
+            ) const { return leaf_offsets[tree+1] - leaf_offsets[tree]; }
+
+            unsigned long num_leaves (
+            ) const { return leaf_offsets.back(); }
+
+            std::vector<regression_tree> to_trees (
+            ) const
+            {
+                std::vector<regression_tree> trees(num_trees());
+                for (unsigned long t = 0; t < trees.size(); ++t)
+                {
+                    for (unsigned long i = split_offsets[t]; i < split_offsets[t+1]; ++i)
+                        trees[t].splits.push_back({splits[i].idx1, splits[i].idx2, splits[i].thresh});
+                    for (unsigned long i = leaf_offsets[t]; i < leaf_offsets[t+1]; ++i)
+                    {
+                        matrix<float,0,1> leaf(shape_size);
+                        std::copy(&leaf_values[i*shape_size], &leaf_values[i*shape_size]+shape_size, leaf.begin());
+                        trees[t].leaf_values.push_back(leaf);
+                    }
+                }
+                return trees;
+            }
+
+            inline const float* evaluate (
+                unsigned long tree,
+                const float* feature_pixel_values,
+                unsigned long& leaf_idx
+            ) const
+            /*!
+                ensures
+                    - runs the given tree on the feature pixel values and returns a pointer
+                      to the shape_size values of the leaf it ends up in.
+                    - #leaf_idx == the index of that leaf within the tree.
+            !*/
+            {
+                const compact_split* tree_splits = splits.data() + split_offsets[tree];
+                const unsigned long num_splits = split_offsets[tree+1] - split_offsets[tree];
+                unsigned long i = 0;
+                while (i < num_splits)
+                {
+                    const compact_split& s = tree_splits[i];
+                    if (feature_pixel_values[s.idx1] - feature_pixel_values[s.idx2] > s.thresh)
+                        i = left_child(i);
+                    else
+                        i = right_child(i);
+                }
+                leaf_idx = i - num_splits;
+                return leaf_values.data() + (leaf_offsets[tree] + leaf_idx)*shape_size;
+            }
+
+            inline void add_leaf (
+                float* shape,
+                const float* leaf
+            ) const
+            {
+                unsigned long i = 0;
+                for (; i + 8 <= shape_size; i += 8)
+                {
+                    simd8f s, l;
+                    s.load(shape+i);
+                    l.load(leaf+i);
+                    s += l;
+                    s.store(shape+i);
+                }
+                for (; i < shape_size; ++i)
+                    shape[i] += leaf[i];
+            }
+
+        private:
+
+            struct compact_split
+            {
+                uint32_t idx1;
+                uint32_t idx2;
+                float thresh;
+            };
+
+            unsigned long shape_size = 0;
+            std::vector<compact_split> splits;
+            std::vector<unsigned long> split_offsets; // tree t's splits are [split_offsets[t], split_offsets[t+1])
+            std::vector<unsigned long> leaf_offsets;  // same for its leaves
+            std::vector<float> leaf_values;           // one row of shape_size values per leaf
+        };
+
     // ------------------------------------------------------------------------------------
 
         inline vector<float,2> location (
@@ -297,7 +427,7 @@ namespace dlib
             const matrix<float,0,1>& initial_shape_,
             const std::vector<std::vector<impl::regression_tree> >& forests_,
             const std::vector<std::vector<dlib::vector<float,2> > >& pixel_coordinates
-        ) : initial_shape(initial_shape_), forests(forests_)
+        ) : initial_shape(initial_shape_)
         /*!
             requires
                 - initial_shape.size()%2 == 0
@@ -317,6 +447,8 @@ namespace dlib
             // their representations relative to the initial shape now and save it.
             for (unsigned long i = 0; i < pixel_coordinates.size(); ++i)
                 impl::create_shape_relative_encoding(initial_shape, pixel_coordinates[i], anchor_idx[i], deltas[i]);
+            for (auto& forest : forests_)
+                forests.emplace_back(forest, initial_shape.size());
         }
 
         unsigned long num_parts (
@@ -330,8 +462,7 @@ namespace dlib
         {
             unsigned long num = 0;
             for (unsigned long iter = 0; iter < forests.size(); ++iter)
-                for (unsigned long i = 0; i < forests[iter].size(); ++i)
-                    num += forests[iter][i].num_leaves();
+                num += forests[iter].num_leaves();
             return num;
         }
 
@@ -341,25 +472,63 @@ namespace dlib
             const rectangle& rect
         ) const
         {
-            using namespace impl;
-            matrix<float,0,1> current_shape = initial_shape;
-            std::vector<float> feature_pixel_values;
-            for (unsigned long iter = 0; iter < forests.size(); ++iter)
+            const image_type* pimg = &img;
+            std::vector<full_object_detection> dets;
+            predict_batch(&pimg, &rect, 1, dets);
+            return dets[0];
+        }
+
+        template <typename image_type>
+        std::vector<full_object_detection> operator()(
+            const image_type& img,
+            const std::vector<rectangle>& rects
+        ) const
+        {
+            std::vector<const image_type*> imgs(rects.size(), &img);
+            std::vector<full_object_detection> dets(rects.size());
+            parallel_for_blocked(0, rects.size(), [&](long begin, long end)
             {
-                extract_feature_pixel_values(img, rect, current_shape, initial_shape,
-                                             anchor_idx[iter], deltas[iter], feature_pixel_values);
-                unsigned long leaf_idx;
-                // evaluate all the trees at this level of the cascade.
-                for (unsigned long i = 0; i < forests[iter].size(); ++i)
-                    current_shape += forests[iter][i](feature_pixel_values, leaf_idx);
+                std::vector<full_object_detection> temp;
+                predict_batch(&imgs[begin], &rects[begin], end-begin, temp);
+                std::move(temp.begin(), temp.end(), dets.begin()+begin);
+            }, 1);
+            return dets;
+        }
+
+        template <typename image_array>
+        std::vector<std::vector<full_object_detection> > operator()(
+            const image_array& images,
+            const std::vector<std::vector<rectangle> >& rects
+        ) const
+        {
+            DLIB_CASSERT(images.size() == rects.size());
+            typedef typename std::remove_cv<typename std::remove_reference<decltype(images[0])>::type>::type image_type;
+            // Flatten all the objects into one list so they can be split evenly between
+            // threads regardless of how they are spread over the images.
+            std::vector<const image_type*> imgs;
+            std::vector<rectangle> all_rects;
+            for (unsigned long i = 0; i < rects.size(); ++i)
+            {
+                for (auto& rect : rects[i])
+                {
+                    imgs.push_back(&images[i]);
+                    all_rects.push_back(rect);
+                }
             }
 
-            // convert the current_shape into a full_object_detection
-            const point_transform_affine tform_to_img = unnormalizing_tform(rect);
-            std::vector<point> parts(current_shape.size()/2);
-            for (unsigned long i = 0; i < parts.size(); ++i)
-                parts[i] = tform_to_img(location(current_shape, i));
-            return full_object_detection(rect, parts);
+            std::vector<full_object_detection> dets(all_rects.size());
+            parallel_for_blocked(0, all_rects.size(), [&](long begin, long end)
+            {
+                std::vector<full_object_detection> temp;
+                predict_batch(&imgs[begin], &all_rects[begin], end-begin, temp);
+                std::move(temp.begin(), temp.end(), dets.begin()+begin);
+            }, 1);
+
+            std::vector<std::vector<full_object_detection> > out(rects.size());
+            for (unsigned long i = 0, k = 0; i < rects.size(); ++i)
+                for (unsigned long j = 0; j < rects[i].size(); ++j)
+                    out[i].push_back(std::move(dets[k++]));
+            return out;
         }
 
         template <typename image_type, typename T, typename U>
@@ -379,13 +548,14 @@ namespace dlib
                 extract_feature_pixel_values(img, rect, current_shape, initial_shape,
                                              anchor_idx[iter], deltas[iter], feature_pixel_values);
                 // evaluate all the trees at this level of the cascade.
-                for (unsigned long i = 0; i < forests[iter].size(); ++i)
+                for (unsigned long i = 0; i < forests[iter].num_trees(); ++i)
                 {
                     unsigned long leaf_idx;
-                    current_shape += forests[iter][i](feature_pixel_values, leaf_idx);
+                    const float* leaf = forests[iter].evaluate(i, feature_pixel_values.data(), leaf_idx);
+                    forests[iter].add_leaf(&current_shape(0), leaf);
 
                     feats.push_back(std::make_pair(feat_offset+leaf_idx, 1));
-                    feat_offset += forests[iter][i].num_leaves();
+                    feat_offset += forests[iter].num_leaves(i);
                 }
             }
 
@@ -402,8 +572,67 @@ namespace dlib
         friend void deserialize (shape_predictor& item, std::istream& in);
 
     private:
+
+        template <typename image_type>
+        void predict_batch (
+            const image_type* const* imgs,
+            const rectangle* rects,
+            unsigned long num,
+            std::vector<full_object_detection>& dets
+        ) const
+        /*!
+            ensures
+                - #dets[i] == the shape predicted for rects[i] in *imgs[i]
+        !*/
+        {
+            using namespace impl;
+            dets.resize(num);
+            // Shapes are run through the cascade a few at a time with the trees in the
+            // outer loop, so each tree is pulled into cache once per group instead of
+            // once per shape.  Each shape still adds up its trees in the same order as
+            // it would on its own, so the results don't depend on the grouping.
+            const unsigned long group_size = 16;
+            std::vector<matrix<float,0,1> > shapes(std::min(num, group_size));
+            std::vector<std::vector<float> > feature_pixel_values(shapes.size());
+            for (unsigned long begin = 0; begin < num; begin += group_size)
+            {
+                const unsigned long n = std::min(group_size, num-begin);
+                for (unsigned long j = 0; j < n; ++j)
+                    shapes[j] = initial_shape;
+                for (unsigned long iter = 0; iter < forests.size(); ++iter)
+                {
+                    for (unsigned long j = 0; j < n; ++j)
+                    {
+                        extract_feature_pixel_values(*imgs[begin+j], rects[begin+j], shapes[j], initial_shape,
+                                                     anchor_idx[iter], deltas[iter], feature_pixel_values[j]);
+                    }
+                    // evaluate all the trees at this level of the cascade.
+                    unsigned long leaf_idx;
+                    for (unsigned long i = 0; i < forests[iter].num_trees(); ++i)
+                    {
+                        for (unsigned long j = 0; j < n; ++j)
+                        {
+                            const float* leaf = forests[iter].evaluate(i, feature_pixel_values[j].data(), leaf_idx);
+                            forests[iter].add_leaf(&shapes[j](0), leaf);
+                        }
+                    }
+                }
+
+                // convert the shapes into full_object_detections
+                for (unsigned long j = 0; j < n; ++j)
+                {
+                    const rectangle& rect = rects[begin+j];
+                    const point_transform_affine tform_to_img = unnormalizing_tform(rect);
+                    std::vector<point> parts(shapes[j].size()/2);
+                    for (unsigned long i = 0; i < parts.size(); ++i)
+                        parts[i] = tform_to_img(location(shapes[j], i));
+                    dets[begin+j] = full_object_detection(rect, parts);
+                }
+            }
+        }
+
         matrix<float,0,1> initial_shape;
-        std::vector<std::vector<impl::regression_tree> > forests;
+        std::vector<impl::flat_regression_forest> forests;
         std::vector<std::vector<unsigned long> > anchor_idx; 
         std::vector<std::vector<dlib::vector<float,2> > > deltas;
     };
@@ -413,7 +642,10 @@ namespace dlib
         int version = 1;
         dlib::serialize(version, out);
         dlib::serialize(item.initial_shape, out);
-        dlib::serialize(item.forests, out);
+        std::vector<std::vector<impl::regression_tree> > forests;
+        for (auto& forest : item.forests)
+            forests.push_back(forest.to_trees());
+        dlib::serialize(forests, out);
         dlib::serialize(item.anchor_idx, out);
         dlib::serialize(item.deltas, out);
     }
@@ -425,7 +657,11 @@ namespace dlib
         if (version != 1)
             throw serialization_error("Unexpected version found while deserializing dlib::shape_predictor.");
         dlib::deserialize(item.initial_shape, in);
-        dlib::deserialize(item.forests, in);
+        std::vector<std::vector<impl::regression_tree> > forests;
+        dlib::deserialize(forests, in);
+        item.forests.clear();
+        for (auto& forest : forests)
+            item.forests.emplace_back(forest, item.initial_shape.size());
         dlib::deserialize(item.anchor_idx, in);
         dlib::deserialize(item.deltas, in);
     }
@@ -477,6 +713,12 @@ namespace dlib
         }
 #endif
 
+        std::vector<std::vector<rectangle> > rects(objects.size());
+        for (unsigned long i = 0; i < objects.size(); ++i)
+            for (unsigned long j = 0; j < objects[i].size(); ++j)
+                rects[i].push_back(objects[i][j].get_rect());
+        const std::vector<std::vector<full_object_detection> > dets = sp(images, rects);
+
         running_stats<double> rs;
         for (unsigned long i = 0; i < objects.size(); ++i)
         {
@@ -486,7 +728,7 @@ namespace dlib
                 // any scales.
                 const double scale = scales.size()==0 ? 1 : scales[i][j]; 
 
-                full_object_detection det = sp(images[i], objects[i][j].get_rect());
+                const full_object_detection& det = dets[i][j];
 
                 for (unsigned long k = 0; k < det.num_parts(); ++k)
                 {
@@ -111,6 +111,47 @@ namespace dlib
                   where the 3d argument is discarded.
         !*/
 
+        template <typename image_type>
+        std::vector<full_object_detection> operator()(
+            const image_type& img,
+            const std::vector<rectangle>& rects
+        ) const;
+        /*!
+            requires
+                - image_type == an image object that implements the interface defined in
+                  dlib/image_processing/generic_image.h 
+            ensures
+                - returns a vector DETS such that:
+                    - DETS.size() == rects.size()
+                    - for all valid i: DETS[i] == (*this)(img, rects[i])
+                - The objects are split between the threads of default_thread_pool() and
+                  each thread runs its objects through the trees together, which is much
+                  faster than calling (*this)(img, rects[i]) in a loop when there are many
+                  objects.
+        !*/
+
+        template <typename image_array>
+        std::vector<std::vector<full_object_detection> > operator()(
+            const image_array& images,
+            const std::vector<std::vector<rectangle> >& rects
+        ) const;
+        /*!
+            requires
+                - image_array is an array of image objects, such as a std::vector or
+                  dlib::array, where each image object implements the interface defined in
+                  dlib/image_processing/generic_image.h 
+                - images.size() == rects.size()
+            ensures
+                - returns a vector DETS such that:
+                    - DETS.size() == rects.size()
+                    - for all valid i:
+                        - DETS[i].size() == rects[i].size()
+                        - for all valid j: DETS[i][j] == (*this)(images[i], rects[i][j])
+                - Like the version of operator() above, this predicts all the shapes in
+                  parallel using default_thread_pool().  The objects are divided between
+                  the threads without regard to which image they are in.
+        !*/
+
     };
 
     void serialize (const shape_predictor& item, std::ostream& out);
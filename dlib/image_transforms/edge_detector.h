@@ -8,6 +8,7 @@
 #include "../array2d.h"
 #include "../geometry.h"
 #include <vector>
+#include "../threads/parallel_for_extension.h"
 #include "../image_keypoint/build_separable_poly_filters.h"
 
 namespace dlib
@@ -99,85 +100,129 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    template <
-        typename in_image_type,
-        typename out_image_type
-        >
-    void sobel_edge_detector (
-        const in_image_type& in_img_,
-        out_image_type& horz_,
-        out_image_type& vert_
-    )
+    namespace impl
     {
-        typedef typename image_traits<out_image_type>::pixel_type pixel_type;
-        COMPILE_TIME_ASSERT(pixel_traits<pixel_type>::is_unsigned == false);
-        DLIB_ASSERT( !is_same_object(in_img_,horz_) && !is_same_object(in_img_,vert_) &&
-                     !is_same_object(horz_,vert_),
-            "\tvoid sobel_edge_detector(in_img_, horz_, vert_)"
-            << "\n\t You can't give the same image as more than one argument"
-            << "\n\t is_same_object(in_img_,horz_): " << is_same_object(in_img_,horz_)
-            << "\n\t is_same_object(in_img_,vert_): " << is_same_object(in_img_,vert_)
-            << "\n\t is_same_object(horz_,vert_):    " << is_same_object(horz_,vert_)
-            );
+        template <
+            typename in_image_type,
+            typename out_image_type
+            >
+        void sobel_edge_detector (
+            const in_image_type& in_img_,
+            out_image_type& horz_,
+            out_image_type& vert_,
+            thread_pool* tp
+        )
+        {
+            typedef typename image_traits<out_image_type>::pixel_type pixel_type;
+            COMPILE_TIME_ASSERT(pixel_traits<pixel_type>::is_unsigned == false);
+            DLIB_ASSERT( !is_same_object(in_img_,horz_) && !is_same_object(in_img_,vert_) &&
+                         !is_same_object(horz_,vert_),
+                "\tvoid sobel_edge_detector(in_img_, horz_, vert_)"
+                << "\n\t You can't give the same image as more than one argument"
+                << "\n\t is_same_object(in_img_,horz_): " << is_same_object(in_img_,horz_)
+                << "\n\t is_same_object(in_img_,vert_): " << is_same_object(in_img_,vert_)
+                << "\n\t is_same_object(horz_,vert_):    " << is_same_object(horz_,vert_)
+                );
 
 
-        const int vert_filter[3][3] = {{-1,-2,-1}, 
-        {0,0,0}, 
-        {1,2,1}};
-        const int horz_filter[3][3] = { {-1,0,1}, 
-        {-2,0,2}, 
-        {-1,0,1}};
+            const int vert_filter[3][3] = {{-1,-2,-1}, 
+            {0,0,0}, 
+            {1,2,1}};
+            const int horz_filter[3][3] = { {-1,0,1}, 
+            {-2,0,2}, 
+            {-1,0,1}};
 
-        const long M = 3;
-        const long N = 3;
+            const long M = 3;
+            const long N = 3;
 
 
-        const_image_view<in_image_type> in_img(in_img_);
-        image_view<out_image_type> horz(horz_);
-        image_view<out_image_type> vert(vert_);
+            set_image_size(horz_, num_rows(in_img_), num_columns(in_img_));
+            set_image_size(vert_, num_rows(in_img_), num_columns(in_img_));
 
-        horz.set_size(in_img.nr(),in_img.nc());
-        vert.set_size(in_img.nr(),in_img.nc());
+            assign_border_pixels(horz_,1,1,0);
+            assign_border_pixels(vert_,1,1,0);
 
-        assign_border_pixels(horz,1,1,0);
-        assign_border_pixels(vert,1,1,0);
+            // figure out the range that we should apply the filter to
+            const long first_row = M/2;
+            const long first_col = N/2;
+            const long last_row = num_rows(in_img_) - M/2;
+            const long last_col = num_columns(in_img_) - N/2;
 
-        // figure out the range that we should apply the filter to
-        const long first_row = M/2;
-        const long first_col = N/2;
-        const long last_row = in_img.nr() - M/2;
-        const long last_col = in_img.nc() - N/2;
+            if (last_row <= first_row || last_col <= first_col)
+                return;
 
+            typedef typename pixel_traits<typename image_traits<in_image_type>::pixel_type>::basic_pixel_type bp_type;
+            typedef typename promote<bp_type>::type ptype;
 
-        // apply the filter to the image
-        for (long r = first_row; r < last_row; ++r)
-        {
-            for (long c = first_col; c < last_col; ++c)
+            const auto filter_rows = [&](long row_begin, long row_end)
             {
-                typedef typename pixel_traits<typename image_traits<in_image_type>::pixel_type>::basic_pixel_type bp_type;
-
-                typename promote<bp_type>::type p, horz_temp, vert_temp;
-                horz_temp = 0;
-                vert_temp = 0;
-                for (long m = 0; m < M; ++m)
+                // Use views local to this function so the compiler knows that writing to
+                // the output images doesn't change where the views point.
+                const_image_view<in_image_type> in_img(in_img_);
+                image_view<out_image_type> horz(horz_);
+                image_view<out_image_type> vert(vert_);
+
+                // apply the filter to the image
+                for (long r = row_begin; r < row_end; ++r)
                 {
-                    for (long n = 0; n < N; ++n)
+                    for (long c = first_col; c < last_col; ++c)
                     {
-                        // pull out the current pixel and put it into p
-                        p = get_pixel_intensity(in_img[r-M/2+m][c-N/2+n]);
+                        ptype p, horz_temp, vert_temp;
+                        horz_temp = 0;
+                        vert_temp = 0;
+                        for (long m = 0; m < M; ++m)
+                        {
+                            for (long n = 0; n < N; ++n)
+                            {
+                                // pull out the current pixel and put it into p
+                                p = get_pixel_intensity(in_img[r-M/2+m][c-N/2+n]);
+
+                                horz_temp += p*horz_filter[m][n];
+                                vert_temp += p*vert_filter[m][n];
+                            }
+                        }
+
+                        assign_pixel(horz[r][c] , horz_temp);
+                        assign_pixel(vert[r][c] , vert_temp);
 
-                        horz_temp += p*horz_filter[m][n];
-                        vert_temp += p*vert_filter[m][n];
                     }
                 }
+            };
 
-                assign_pixel(horz[r][c] , horz_temp);
-                assign_pixel(vert[r][c] , vert_temp);
-
-            }
+            if (tp)
+                parallel_for_blocked(*tp, first_row, last_row, filter_rows);
+            else
+                filter_rows(first_row, last_row);
         }
     }
 
+    template <
+        typename in_image_type,
+        typename out_image_type
+        >
+    void sobel_edge_detector (
+        const in_image_type& in_img,
+        out_image_type& horz,
+        out_image_type& vert
+    )
+    {
+        impl::sobel_edge_detector(in_img, horz, vert, nullptr);
+    }
+
+    template <
+        typename in_image_type,
+        typename out_image_type
+        >
+    void sobel_edge_detector (
+        const in_image_type& in_img,
+        out_image_type& horz,
+        out_image_type& vert,
+        thread_pool& tp
+    )
+    {
+        impl::sobel_edge_detector(in_img, horz, vert, &tp);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     namespace impl
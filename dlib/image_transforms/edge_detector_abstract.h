@@ -6,6 +6,7 @@
 #include "../pixel.h"
 #include "../image_processing/generic_image.h"
 #include "../geometry.h"
+#include "../threads/thread_pool_extension_abstract.h"
 #include <vector>
 
 namespace dlib
@@ -69,6 +70,26 @@ namespace dlib
                 - edge_orientation(#vert[r][c], #horz[r][c]) == the edge direction at this point in 
                   the image
     !*/
+
+    template <
+        typename in_image_type,
+        typename out_image_type
+        >
+    void sobel_edge_detector (
+        const in_image_type& in_img,
+        out_image_type& horz,
+        out_image_type& vert,
+        thread_pool& tp
+    );
+    /*!
+        requires
+            - The same requirements as the above sobel_edge_detector() apply.
+        ensures
+            - performs: sobel_edge_detector(in_img, horz, vert);
+              except that the rows of the image are split into stripes that are processed
+              in parallel by the threads in tp.  The output is exactly the same as the
+              serial version's.
+    !*/
     
 // ----------------------------------------------------------------------------------------
 
@@ -378,6 +378,135 @@ namespace dlib
         
         // ------------------------------------------------------------------------------------
 
+        template <
+            typename image_type,
+            bool is_rgb = pixel_traits<typename image_type::pixel_type>::rgb
+            >
+        class gradient_rows
+        {
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This object holds 3 rows of an image converted to int32, row r in slot
+                    r%3.  The simd8f get_gradient() above has to gather 32 pixels one at a
+                    time, while this object's get_gradient() does the same thing with 4
+                    vector loads.  Moving down the image only loads each row once.
+            !*/
+        public:
+            explicit gradient_rows (
+                const image_type& img_
+            ) : img(img_), nc(img_.nc()), rows(3*nc) {}
+
+            void load_row (
+                long r
+            )
+            {
+                int32* p = &rows[(r%3)*nc];
+                for (long c = 0; c < nc; ++c)
+                    p[c] = (int)get_pixel_intensity(img[r][c]);
+            }
+
+            void get_gradient (
+                long r,
+                long c,
+                simd8f& grad_x,
+                simd8f& grad_y,
+                simd8f& len
+            ) const
+            {
+                simd8i left, right, top, bottom;
+                left.load(&rows[(r%3)*nc + c-1]);
+                right.load(&rows[(r%3)*nc + c+1]);
+                top.load(&rows[((r-1)%3)*nc + c]);
+                bottom.load(&rows[((r+1)%3)*nc + c]);
+
+                grad_x = right - left;
+                grad_y = bottom - top;
+
+                len = (grad_x*grad_x + grad_y*grad_y);
+            }
+
+        private:
+            const image_type& img;
+            const long nc;
+            std::vector<int32> rows;
+        };
+
+        template <typename image_type>
+        class gradient_rows<image_type,true>
+        {
+        public:
+            explicit gradient_rows (
+                const image_type& img_
+            ) : img(img_), nc(img_.nc()), rows(9*nc) {}
+
+            void load_row (
+                long r
+            )
+            {
+                int32* red = &rows[3*(r%3)*nc];
+                int32* green = red + nc;
+                int32* blue = green + nc;
+                for (long c = 0; c < nc; ++c)
+                {
+                    red[c] = (int)img[r][c].red;
+                    green[c] = (int)img[r][c].green;
+                    blue[c] = (int)img[r][c].blue;
+                }
+            }
+
+            void get_gradient (
+                long r,
+                long c,
+                simd8f& grad_x,
+                simd8f& grad_y,
+                simd8f& len
+            ) const
+            {
+                simd8i grad_x_red, grad_y_red, grad_x_green, grad_y_green, grad_x_blue, grad_y_blue;
+                get_channel_gradient(r, c, 0, grad_x_red, grad_y_red);
+                get_channel_gradient(r, c, 1, grad_x_green, grad_y_green);
+                get_channel_gradient(r, c, 2, grad_x_blue, grad_y_blue);
+
+                simd8i rlen = grad_x_red*grad_x_red + grad_y_red*grad_y_red;
+                simd8i glen = grad_x_green*grad_x_green + grad_y_green*grad_y_green;
+                simd8i blen = grad_x_blue*grad_x_blue + grad_y_blue*grad_y_blue;
+
+                simd8i cmp = rlen > glen;
+                simd8i tgrad_x = select(cmp, grad_x_red, grad_x_green);
+                simd8i tgrad_y = select(cmp, grad_y_red, grad_y_green);
+                simd8i tlen = select(cmp, rlen, glen);
+
+                cmp = tlen > blen;
+                grad_x = select(cmp, tgrad_x, grad_x_blue);
+                grad_y = select(cmp, tgrad_y, grad_y_blue);
+                len = select(cmp, tlen, blen);
+            }
+
+        private:
+            void get_channel_gradient (
+                long r,
+                long c,
+                long channel,
+                simd8i& grad_x,
+                simd8i& grad_y
+            ) const
+            {
+                simd8i left, right, top, bottom;
+                left.load(&rows[(3*(r%3)+channel)*nc + c-1]);
+                right.load(&rows[(3*(r%3)+channel)*nc + c+1]);
+                top.load(&rows[(3*((r-1)%3)+channel)*nc + c]);
+                bottom.load(&rows[(3*((r+1)%3)+channel)*nc + c]);
+                grad_x = right - left;
+                grad_y = bottom - top;
+            }
+
+            const image_type& img;
+            const long nc;
+            std::vector<int32> rows;
+        };
+
+        // ------------------------------------------------------------------------------------
+
         template <typename T, typename mm1, typename mm2>
         inline void set_hog (
             dlib::array<array2d<T,mm1>,mm2>& hog,
@@ -786,22 +915,6 @@ namespace dlib
                 return;
             }
 
-            // We give hist extra padding around the edges (1 cell all the way around the
-            // edge) so we can avoid needing to do boundary checks when indexing into it
-            // later on.  So some statements assign to the boundary but those values are
-            // never used.
-            array2d<matrix<float,18,1> > hist(cells_nr+2, cells_nc+2);
-            for (long r = 0; r < hist.nr(); ++r)
-            {
-                for (long c = 0; c < hist.nc(); ++c)
-                {
-                    hist[r][c] = 0;
-                }
-            }
-
-            array2d<float> norm(cells_nr, cells_nc);
-            assign_all_pixels(norm, 0);
-
             // memory for HOG features
             const int hog_nr = std::max(cells_nr-2, 0);
             const int hog_nc = std::max(cells_nc-2, 0);
@@ -814,49 +927,206 @@ namespace dlib
             const int padding_cols_offset = (filter_cols_padding-1)/2;
             init_hog(hog, hog_nr, hog_nc, filter_rows_padding, filter_cols_padding);
 
+            /*
+                We make a single pass down the image.  The histograms have one cell of
+                padding all the way around the edge, so histogram row R (counting the
+                padding) covers cell row R-1.  A pixel row only votes into the two
+                histogram rows around it, so only 4 histogram rows and 4 rows of block
+                energies are ever alive at once.  As soon as the pixels can no longer
+                vote into histogram row R we finish it: compute its block energies and,
+                since that completes the 2x2 blocks around HOG row R-3, that row of
+                features.  That keeps the working set in cache no matter how big the
+                image is.  Each histogram bin still receives its votes in the same order
+                as before, so the output doesn't depend on the streaming.
+            */
+            const int hist_nc = cells_nc+2;
+            const int ring_size = 4;
+            std::vector<matrix<float,18,1> > hist_rows(ring_size*hist_nc);
+            std::vector<float> norm_rows(ring_size*cells_nc);
+            for (auto& h : hist_rows)
+                h = 0;
+            auto hist_row = [&](int R) { return &hist_rows[(R%ring_size)*hist_nc]; };
+            auto norm_row = [&](int r) { return &norm_rows[(r%ring_size)*cells_nc]; };
+
+            const float eps = 0.0001;
+            auto finish_hist_row = [&](int R)
+            {
+                if (1 <= R && R <= cells_nr)
+                {
+                    // compute energy in each block by summing over orientations
+                    const matrix<float,18,1>* h = hist_row(R);
+                    float* n = norm_row(R-1);
+                    for (int c = 0; c < cells_nc; ++c)
+                    {
+                        n[c] = 0;
+                        for (int o = 0; o < 9; o++) 
+                            n[c] += (h[c+1](o) + h[c+1](o+9)) * (h[c+1](o) + h[c+1](o+9));
+                    }
+                }
+
+                const int y = R-3;
+                if (0 <= y && y < hog_nr)
+                {
+                    // compute features
+                    const int yy = y+padding_rows_offset; 
+                    const float* n0 = norm_row(y);
+                    const float* n1 = norm_row(y+1);
+                    const float* n2 = norm_row(y+2);
+                    const matrix<float,18,1>* h = hist_row(y+2);
+                    for (int x = 0; x < hog_nc; x++) 
+                    {
+                        const simd4f z1(n1[x+1],
+                                        n0[x+1], 
+                                        n1[x],  
+                                        n0[x]);
+
+                        const simd4f z2(n1[x+2],
+                                        n0[x+2],
+                                        n1[x+1],
+                                        n0[x+1]);
+
+                        const simd4f z3(n2[x+1],
+                                        n1[x+1],
+                                        n2[x],
+                                        n1[x]);
+
+                        const simd4f z4(n2[x+2],
+                                        n1[x+2],
+                                        n2[x+1],
+                                        n1[x+1]);
+
+                        const simd4f nn = 0.2*sqrt(z1+z2+z3+z4+eps);
+                        const simd4f n = 0.1/nn;
+
+                        simd4f t = 0;
+
+                        const int xx = x+padding_cols_offset; 
+                        const matrix<float,18,1>& hh = h[x+2];
+
+                        // contrast-sensitive features
+                        for (int o = 0; o < 18; o+=3) 
+                        {
+                            simd4f temp0(hh(o));
+                            simd4f temp1(hh(o+1));
+                            simd4f temp2(hh(o+2));
+                            simd4f h0 = min(temp0,nn)*n;
+                            simd4f h1 = min(temp1,nn)*n;
+                            simd4f h2 = min(temp2,nn)*n;
+                            set_hog(hog,o,xx,yy,   sum(h0));
+                            set_hog(hog,o+1,xx,yy, sum(h1));
+                            set_hog(hog,o+2,xx,yy, sum(h2));
+                            t += h0+h1+h2;
+                        }
+
+                        t *= 2*0.2357;
+
+                        // contrast-insensitive features
+                        for (int o = 0; o < 9; o+=3) 
+                        {
+                            simd4f temp0 = hh(o)   + hh(o+9);
+                            simd4f temp1 = hh(o+1) + hh(o+9+1);
+                            simd4f temp2 = hh(o+2) + hh(o+9+2);
+                            simd4f h0 = min(temp0,nn)*n;
+                            simd4f h1 = min(temp1,nn)*n;
+                            simd4f h2 = min(temp2,nn)*n;
+                            set_hog(hog,o+18,xx,yy, sum(h0));
+                            set_hog(hog,o+18+1,xx,yy, sum(h1));
+                            set_hog(hog,o+18+2,xx,yy, sum(h2));
+                        }
+
+
+                        float temp[4];
+                        t.store(temp);
+
+                        // texture features
+                        set_hog(hog,27,xx,yy, temp[0]);
+                        set_hog(hog,28,xx,yy, temp[1]);
+                        set_hog(hog,29,xx,yy, temp[2]);
+                        set_hog(hog,30,xx,yy, temp[3]);
+                    }
+                }
+
+                // Row R-2 is no longer needed, so its slot becomes row R+2, the next row
+                // pixels will start voting into.
+                matrix<float,18,1>* next = hist_row(R+2);
+                for (int c = 0; c < hist_nc; ++c)
+                    next[c] = 0;
+            };
+
             const int visible_nr = std::min(cells_nr*cell_size,static_cast<int>(img.nr()))-1;
             const int visible_nc = std::min(cells_nc*cell_size,static_cast<int>(img.nc()))-1;
 
-            // First populate the gradient histograms
+            // The horizontal interpolation weights only depend on the column, so compute
+            // them once rather than for every row.
+            std::vector<int32> col_ixp(std::max(visible_nc,0));
+            std::vector<float> col_vx0(col_ixp.size());
+            int simd_end;
+            for (simd_end = 1; simd_end < visible_nc - 7; simd_end += 8)
+            {
+                simd8f xx(simd_end, simd_end + 1, simd_end + 2, simd_end + 3, simd_end + 4, simd_end + 5, simd_end + 6, simd_end + 7);
+                simd8f xp = (xx + 0.5) / static_cast<float>(cell_size) + 0.5;
+                simd8i ixp = simd8i(xp);
+                simd8f vx0 = xp - ixp;
+                ixp.store(&col_ixp[simd_end]);
+                vx0.store(&col_vx0[simd_end]);
+            }
+
+            gradient_rows<const_image_view<image_type> > grad_rows(img);
+            if (visible_nr > 1)
+            {
+                grad_rows.load_row(0);
+                grad_rows.load_row(1);
+            }
+
+            int next_hist_row = 0;
+            // Populate the gradient histograms
             for (int y = 1; y < visible_nr; y++) 
             {
+                grad_rows.load_row(y+1);
                 const float yp = (y + 0.5) / static_cast<float>(cell_size) - 0.5;
                 const int iyp = static_cast<int>(std::floor(yp));
                 const float vy0 = yp - iyp;
                 const float vy1 = 1.0 - vy0;
+
+                // Pixels from here on only vote into rows iyp+1 and below.
+                while (next_hist_row <= iyp)
+                    finish_hist_row(next_hist_row++);
+
+                matrix<float,18,1>* const hist0 = hist_row(iyp+1);
+                matrix<float,18,1>* const hist1 = hist_row(iyp+2);
+
                 int x;
-                for (x = 1; x < visible_nc - 7; x += 8)
+                for (x = 1; x < simd_end; x += 8)
                 {
-                    simd8f xx(x, x + 1, x + 2, x + 3, x + 4, x + 5, x + 6, x + 7);
                     // v will be the length of the gradient vectors.
                     simd8f grad_x, grad_y, v;
-                    get_gradient(y, x, img, grad_x, grad_y, v);
+                    grad_rows.get_gradient(y, x, grad_x, grad_y, v);
 
                     // We will use bilinear interpolation to add into the histogram bins.
-                    // So first we precompute the values needed to determine how much each
+                    // So first we look up the values needed to determine how much each
                     // pixel votes into each bin.
-                    simd8f xp = (xx + 0.5) / static_cast<float>(cell_size) + 0.5;
-                    simd8i ixp = simd8i(xp);
-                    simd8f vx0 = xp - ixp;
+                    simd8f vx0;
+                    vx0.load(&col_vx0[x]);
                     simd8f vx1 = 1.0f - vx0;
 
                     v = sqrt(v);
 
-                    // Now snap the gradient to one of 18 orientations
+                    // Now snap the gradient to one of 18 orientations.  Comparing |dot|
+                    // finds the same orientation as trying dot and -dot in turn, since at
+                    // most one of them can be positive, but with half the compares.
                     simd8f best_dot = 0;
+                    simd8f best_signed_dot = 0;
                     simd8f best_o = 0;
                     for (int o = 0; o < 9; o++)
                     {
-                        simd8f dot = grad_x*directions[o](0) + grad_y*directions[o](1);
-                        simd8f_bool cmp = dot>best_dot;
-                        best_dot = select(cmp, dot, best_dot);
-                        dot *= -1;
+                        const simd8f dot = grad_x*directions[o](0) + grad_y*directions[o](1);
+                        const simd8f abs_dot = max(dot, 0-dot);
+                        const simd8f_bool cmp = abs_dot>best_dot;
+                        best_dot = select(cmp, abs_dot, best_dot);
+                        best_signed_dot = select(cmp, dot, best_signed_dot);
                         best_o = select(cmp, o, best_o);
-
-                        cmp = dot > best_dot;
-                        best_dot = select(cmp, dot, best_dot);
-                        best_o = select(cmp, o + 9, best_o);
                     }
+                    best_o = select(best_signed_dot < 0, best_o + 9, best_o);
 
 
                     // Add the gradient magnitude, v, to 4 histograms around pixel using
@@ -870,51 +1140,19 @@ namespace dlib
                     simd8f v00 = vy0*vx0;
 
                     int32 _best_o[8]; simd8i(best_o).store(_best_o);
-                    int32 _ixp[8];    ixp.store(_ixp);
                     float _v11[8];    v11.store(_v11);
                     float _v01[8];    v01.store(_v01);
                     float _v10[8];    v10.store(_v10);
                     float _v00[8];    v00.store(_v00);
+                    const int32* _ixp = &col_ixp[x];
 
-                    hist[iyp + 1][_ixp[0]](_best_o[0]) += _v11[0];
-                    hist[iyp + 1 + 1][_ixp[0]](_best_o[0]) += _v01[0];
-                    hist[iyp + 1][_ixp[0] + 1](_best_o[0]) += _v10[0];
-                    hist[iyp + 1 + 1][_ixp[0] + 1](_best_o[0]) += _v00[0];
-
-                    hist[iyp + 1][_ixp[1]](_best_o[1]) += _v11[1];
-                    hist[iyp + 1 + 1][_ixp[1]](_best_o[1]) += _v01[1];
-                    hist[iyp + 1][_ixp[1] + 1](_best_o[1]) += _v10[1];
-                    hist[iyp + 1 + 1][_ixp[1] + 1](_best_o[1]) += _v00[1];
-
-                    hist[iyp + 1][_ixp[2]](_best_o[2]) += _v11[2];
-                    hist[iyp + 1 + 1][_ixp[2]](_best_o[2]) += _v01[2];
-                    hist[iyp + 1][_ixp[2] + 1](_best_o[2]) += _v10[2];
-                    hist[iyp + 1 + 1][_ixp[2] + 1](_best_o[2]) += _v00[2];
-
-                    hist[iyp + 1][_ixp[3]](_best_o[3]) += _v11[3];
-                    hist[iyp + 1 + 1][_ixp[3]](_best_o[3]) += _v01[3];
-                    hist[iyp + 1][_ixp[3] + 1](_best_o[3]) += _v10[3];
-                    hist[iyp + 1 + 1][_ixp[3] + 1](_best_o[3]) += _v00[3];
-
-                    hist[iyp + 1][_ixp[4]](_best_o[4]) += _v11[4];
-                    hist[iyp + 1 + 1][_ixp[4]](_best_o[4]) += _v01[4];
-                    hist[iyp + 1][_ixp[4] + 1](_best_o[4]) += _v10[4];
-                    hist[iyp + 1 + 1][_ixp[4] + 1](_best_o[4]) += _v00[4];
-
-                    hist[iyp + 1][_ixp[5]](_best_o[5]) += _v11[5];
-                    hist[iyp + 1 + 1][_ixp[5]](_best_o[5]) += _v01[5];
-                    hist[iyp + 1][_ixp[5] + 1](_best_o[5]) += _v10[5];
-                    hist[iyp + 1 + 1][_ixp[5] + 1](_best_o[5]) += _v00[5];
-
-                    hist[iyp + 1][_ixp[6]](_best_o[6]) += _v11[6];
-                    hist[iyp + 1 + 1][_ixp[6]](_best_o[6]) += _v01[6];
-                    hist[iyp + 1][_ixp[6] + 1](_best_o[6]) += _v10[6];
-                    hist[iyp + 1 + 1][_ixp[6] + 1](_best_o[6]) += _v00[6];
-
-                    hist[iyp + 1][_ixp[7]](_best_o[7]) += _v11[7];
-                    hist[iyp + 1 + 1][_ixp[7]](_best_o[7]) += _v01[7];
-                    hist[iyp + 1][_ixp[7] + 1](_best_o[7]) += _v10[7];
-                    hist[iyp + 1 + 1][_ixp[7] + 1](_best_o[7]) += _v00[7];
+                    for (int i = 0; i < 8; ++i)
+                    {
+                        hist0[_ixp[i]](_best_o[i]) += _v11[i];
+                        hist1[_ixp[i]](_best_o[i]) += _v01[i];
+                        hist0[_ixp[i] + 1](_best_o[i]) += _v10[i];
+                        hist1[_ixp[i] + 1](_best_o[i]) += _v00[i];
+                    }
                 }
                 // Now process the right columns that don't fit into simd registers.
                 for (; x < visible_nc; x++) 
@@ -948,101 +1186,16 @@ namespace dlib
                     const float vx0 = xp - ixp;
                     const float vx1 = 1.0 - vx0;
 
-                    hist[iyp+1][ixp+1](best_o) += vy1*vx1*v;
-                    hist[iyp+1+1][ixp+1](best_o) += vy0*vx1*v;
-                    hist[iyp+1][ixp+1+1](best_o) += vy1*vx0*v;
-                    hist[iyp+1+1][ixp+1+1](best_o) += vy0*vx0*v;
+                    hist0[ixp+1](best_o) += vy1*vx1*v;
+                    hist1[ixp+1](best_o) += vy0*vx1*v;
+                    hist0[ixp+1+1](best_o) += vy1*vx0*v;
+                    hist1[ixp+1+1](best_o) += vy0*vx0*v;
                 }
             }
 
-            // compute energy in each block by summing over orientations
-            for (int r = 0; r < cells_nr; ++r)
-            {
-                for (int c = 0; c < cells_nc; ++c)
-                {
-                    for (int o = 0; o < 9; o++) 
-                    {
-                        norm[r][c] += (hist[r+1][c+1](o) + hist[r+1][c+1](o+9)) * (hist[r+1][c+1](o) + hist[r+1][c+1](o+9));
-                    }
-                }
-            }
-
-            const float eps = 0.0001;
-            // compute features
-            for (int y = 0; y < hog_nr; y++) 
-            {
-                const int yy = y+padding_rows_offset; 
-                for (int x = 0; x < hog_nc; x++) 
-                {
-                    const simd4f z1(norm[y+1][x+1],
-                                    norm[y][x+1], 
-                                    norm[y+1][x],  
-                                    norm[y][x]);
-
-                    const simd4f z2(norm[y+1][x+2],
-                                    norm[y][x+2],
-                                    norm[y+1][x+1],
-                                    norm[y][x+1]);
-
-                    const simd4f z3(norm[y+2][x+1],
-                                    norm[y+1][x+1],
-                                    norm[y+2][x],
-                                    norm[y+1][x]);
-
-                    const simd4f z4(norm[y+2][x+2],
-                                    norm[y+1][x+2],
-                                    norm[y+2][x+1],
-                                    norm[y+1][x+1]);
-
-                    const simd4f nn = 0.2*sqrt(z1+z2+z3+z4+eps);
-                    const simd4f n = 0.1/nn;
-
-                    simd4f t = 0;
-
-                    const int xx = x+padding_cols_offset; 
-
-                    // contrast-sensitive features
-                    for (int o = 0; o < 18; o+=3) 
-                    {
-                        simd4f temp0(hist[y+1+1][x+1+1](o));
-                        simd4f temp1(hist[y+1+1][x+1+1](o+1));
-                        simd4f temp2(hist[y+1+1][x+1+1](o+2));
-                        simd4f h0 = min(temp0,nn)*n;
-                        simd4f h1 = min(temp1,nn)*n;
-                        simd4f h2 = min(temp2,nn)*n;
-                        set_hog(hog,o,xx,yy,   sum(h0));
-                        set_hog(hog,o+1,xx,yy, sum(h1));
-                        set_hog(hog,o+2,xx,yy, sum(h2));
-                        t += h0+h1+h2;
-                    }
-
-                    t *= 2*0.2357;
-
-                    // contrast-insensitive features
-                    for (int o = 0; o < 9; o+=3) 
-                    {
-                        simd4f temp0 = hist[y+1+1][x+1+1](o)   + hist[y+1+1][x+1+1](o+9);
-                        simd4f temp1 = hist[y+1+1][x+1+1](o+1) + hist[y+1+1][x+1+1](o+9+1);
-                        simd4f temp2 = hist[y+1+1][x+1+1](o+2) + hist[y+1+1][x+1+1](o+9+2);
-                        simd4f h0 = min(temp0,nn)*n;
-                        simd4f h1 = min(temp1,nn)*n;
-                        simd4f h2 = min(temp2,nn)*n;
-                        set_hog(hog,o+18,xx,yy, sum(h0));
-                        set_hog(hog,o+18+1,xx,yy, sum(h1));
-                        set_hog(hog,o+18+2,xx,yy, sum(h2));
-                    }
-
-
-                    float temp[4];
-                    t.store(temp);
-
-                    // texture features
-                    set_hog(hog,27,xx,yy, temp[0]);
-                    set_hog(hog,28,xx,yy, temp[1]);
-                    set_hog(hog,29,xx,yy, temp[2]);
-                    set_hog(hog,30,xx,yy, temp[3]);
-                }
-            }
+            // finish off the rows the last pixels voted into
+            while (next_hist_row <= cells_nr)
+                finish_hist_row(next_hist_row++);
         }
 
     // ------------------------------------------------------------------------------------
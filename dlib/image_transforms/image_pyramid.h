@@ -7,7 +7,12 @@
 #include "../pixel.h"
 #include "../array2d.h"
 #include "../geometry.h"
+#include "../threads/parallel_for_extension.h"
+#include "../array.h"
 #include "spatial_filtering.h"
+#include "assign_image.h"
+#include <vector>
+#include <memory>
 
 namespace dlib
 {
@@ -127,6 +132,19 @@ namespace dlib
             set_image_size(down, 0, 0);
         }
 
+        template <
+            typename in_image_type,
+            typename out_image_type
+            >
+        void operator() (
+            const in_image_type& original,
+            out_image_type& down,
+            thread_pool& 
+        ) const
+        {
+            (*this)(original, down);
+        }
+
         template <
             typename image_type
             >
@@ -147,6 +165,36 @@ namespace dlib
     namespace impl
     {
 
+        template <typename T>
+        void for_each_pyramid_row (
+            thread_pool* tp,
+            long begin,
+            long end,
+            const T& funct
+        )
+        /*!
+            ensures
+                - calls funct(r) for each r in [begin, end), spreading the rows over the
+                  threads in tp if tp != nullptr.
+        !*/
+        {
+            if (tp != nullptr && tp->num_threads_in_pool() > 1)
+            {
+                parallel_for_blocked(*tp, begin, end, [&](long b, long e)
+                {
+                    for (long r = b; r < e; ++r)
+                        funct(r);
+                });
+            }
+            else
+            {
+                for (long r = begin; r < end; ++r)
+                    funct(r);
+            }
+        }
+
+    // ----------------------------------------------------------------------------------------
+
         class pyramid_down_2_1 : noncopyable
         {
         public:
@@ -237,15 +285,15 @@ namespace dlib
                 typedef typename image_traits<U>::pixel_type U_pix;
                 const static bool value = pixel_traits<T_pix>::rgb && pixel_traits<U_pix>::rgb;
             };
-        public:
 
             template <
                 typename in_image_type,
                 typename out_image_type
                 >
-            typename disable_if<both_images_rgb<in_image_type,out_image_type> >::type operator() (
+            typename disable_if<both_images_rgb<in_image_type,out_image_type> >::type downsample (
                 const in_image_type& original_,
-                out_image_type& down_
+                out_image_type& down_,
+                thread_pool* tp
             ) const
             {
                 // make sure requires clause is not broken
@@ -271,8 +319,10 @@ namespace dlib
 
                 typedef typename pixel_traits<in_pixel_type>::basic_pixel_type bp_type;
                 typedef typename promote<bp_type>::type ptype;
-                array2d<ptype> temp_img;
-                temp_img.set_size(original.nr(), (original.nc()-3)/2);
+                const long temp_nr = original.nr();
+                const long temp_nc = (original.nc()-3)/2;
+                std::vector<ptype> temp_buffer(temp_nr*temp_nc);
+                ptype* const temp_img = temp_buffer.data();
                 down.set_size((original.nr()-3)/2, (original.nc()-3)/2);
 
 
@@ -283,10 +333,11 @@ namespace dlib
                 // one step.
 
                 // apply row filter
-                for (long r = 0; r < temp_img.nr(); ++r)
+                for_each_pyramid_row(tp, 0, temp_nr, [&](long r)
                 {
+                    ptype* const temp_row = temp_img + r*temp_nc;
                     long oc = 0;
-                    for (long c = 0; c < temp_img.nc(); ++c)
+                    for (long c = 0; c < temp_nc; ++c)
                     {
                         ptype pix1;
                         ptype pix2;
@@ -304,28 +355,27 @@ namespace dlib
                         pix3 *= 6;
                         pix4 *= 4;
                         
-                        assign_pixel(temp_img[r][c], pix1 + pix2 + pix3 + pix4 + pix5);
+                        assign_pixel(temp_row[c], pix1 + pix2 + pix3 + pix4 + pix5);
                         oc += 2;
                     }
-                }
+                });
 
 
-                // apply column filter
-                long dr = 0;
-                for (long r = 2; r < temp_img.nr()-2; r += 2)
+                // apply column filter.  Output row dr comes from row 2*dr+2 of temp_img.
+                for_each_pyramid_row(tp, 0, down.nr(), [&](long dr)
                 {
-                    for (long c = 0; c < temp_img.nc(); ++c)
+                    const ptype* const t = temp_img + (2*dr+2)*temp_nc;
+                    for (long c = 0; c < temp_nc; ++c)
                     {
-                        ptype temp = temp_img[r-2][c] + 
-                                    temp_img[r-1][c]*4 +  
-                                    temp_img[r  ][c]*6 +  
-                                    temp_img[r+1][c]*4 +  
-                                    temp_img[r+2][c];  
+                        ptype temp = t[c-2*temp_nc] + 
+                                    t[c-temp_nc]*4 +  
+                                    t[c        ]*6 +  
+                                    t[c+temp_nc]*4 +  
+                                    t[c+2*temp_nc];  
 
                         assign_pixel(down[dr][c],temp/256);
                     }
-                    ++dr;
-                }
+                });
 
             }
 
@@ -336,7 +386,6 @@ namespace dlib
                 uint16 green;
                 uint16 blue;
             };
-        public:
         // ------------------------------------------
         //       OVERLOAD FOR RGB TO RGB IMAGES
         // ------------------------------------------
@@ -344,9 +393,10 @@ namespace dlib
                 typename in_image_type,
                 typename out_image_type
                 >
-            typename enable_if<both_images_rgb<in_image_type,out_image_type> >::type operator() (
+            typename enable_if<both_images_rgb<in_image_type,out_image_type> >::type downsample (
                 const in_image_type& original_,
-                out_image_type& down_
+                out_image_type& down_,
+                thread_pool* tp
             ) const
             {
                 // make sure requires clause is not broken
@@ -370,8 +420,10 @@ namespace dlib
                     return;
                 }
 
-                array2d<rgbptype> temp_img;
-                temp_img.set_size(original.nr(), (original.nc()-3)/2);
+                const long temp_nr = original.nr();
+                const long temp_nc = (original.nc()-3)/2;
+                std::vector<rgbptype> temp_buffer(temp_nr*temp_nc);
+                rgbptype* const temp_img = temp_buffer.data();
                 down.set_size((original.nr()-3)/2, (original.nc()-3)/2);
 
 
@@ -382,10 +434,11 @@ namespace dlib
                 // one step.
 
                 // apply row filter
-                for (long r = 0; r < temp_img.nr(); ++r)
+                for_each_pyramid_row(tp, 0, temp_nr, [&](long r)
                 {
+                    rgbptype* const temp_row = temp_img + r*temp_nc;
                     long oc = 0;
-                    for (long c = 0; c < temp_img.nc(); ++c)
+                    for (long c = 0; c < temp_nc; ++c)
                     {
                         rgbptype pix1;
                         rgbptype pix2;
@@ -426,43 +479,69 @@ namespace dlib
                         temp.green = pix1.green + pix2.green + pix3.green + pix4.green + pix5.green;
                         temp.blue = pix1.blue + pix2.blue + pix3.blue + pix4.blue + pix5.blue;
 
-                        temp_img[r][c] = temp;
+                        temp_row[c] = temp;
 
                         oc += 2;
                     }
-                }
+                });
 
 
-                // apply column filter
-                long dr = 0;
-                for (long r = 2; r < temp_img.nr()-2; r += 2)
+                // apply column filter.  Output row dr comes from row 2*dr+2 of temp_img.
+                for_each_pyramid_row(tp, 0, down.nr(), [&](long dr)
                 {
-                    for (long c = 0; c < temp_img.nc(); ++c)
+                    const rgbptype* const t = temp_img + (2*dr+2)*temp_nc;
+                    for (long c = 0; c < temp_nc; ++c)
                     {
                         rgbptype temp;
-                        temp.red = temp_img[r-2][c].red + 
-                                temp_img[r-1][c].red*4 +  
-                                temp_img[r  ][c].red*6 +  
-                                temp_img[r+1][c].red*4 +  
-                                temp_img[r+2][c].red;  
-                        temp.green = temp_img[r-2][c].green + 
-                                    temp_img[r-1][c].green*4 +  
-                                    temp_img[r  ][c].green*6 +  
-                                    temp_img[r+1][c].green*4 +  
-                                    temp_img[r+2][c].green;  
-                        temp.blue = temp_img[r-2][c].blue + 
-                                    temp_img[r-1][c].blue*4 +  
-                                    temp_img[r  ][c].blue*6 +  
-                                    temp_img[r+1][c].blue*4 +  
-                                    temp_img[r+2][c].blue;  
+                        temp.red = t[c-2*temp_nc].red + 
+                                t[c-temp_nc].red*4 +  
+                                t[c        ].red*6 +  
+                                t[c+temp_nc].red*4 +  
+                                t[c+2*temp_nc].red;  
+                        temp.green = t[c-2*temp_nc].green + 
+                                    t[c-temp_nc].green*4 +  
+                                    t[c        ].green*6 +  
+                                    t[c+temp_nc].green*4 +  
+                                    t[c+2*temp_nc].green;  
+                        temp.blue = t[c-2*temp_nc].blue + 
+                                    t[c-temp_nc].blue*4 +  
+                                    t[c        ].blue*6 +  
+                                    t[c+temp_nc].blue*4 +  
+                                    t[c+2*temp_nc].blue;  
 
                         down[dr][c].red = temp.red/256;
                         down[dr][c].green = temp.green/256;
                         down[dr][c].blue = temp.blue/256;
                     }
-                    ++dr;
-                }
+                });
+
+            }
+
+        public:
+
+            template <
+                typename in_image_type,
+                typename out_image_type
+                >
+            void operator() (
+                const in_image_type& original,
+                out_image_type& down
+            ) const
+            {
+                downsample(original, down, nullptr);
+            }
 
+            template <
+                typename in_image_type,
+                typename out_image_type
+                >
+            void operator() (
+                const in_image_type& original,
+                out_image_type& down,
+                thread_pool& tp
+            ) const
+            {
+                downsample(original, down, &tp);
             }
 
             template <
@@ -578,15 +657,15 @@ namespace dlib
                 typedef typename image_traits<U>::pixel_type U_pix;
                 const static bool value = pixel_traits<T_pix>::rgb && pixel_traits<U_pix>::rgb;
             };
-        public:
 
             template <
                 typename in_image_type,
                 typename out_image_type
                 >
-            typename disable_if<both_images_rgb<in_image_type,out_image_type> >::type operator() (
+            typename disable_if<both_images_rgb<in_image_type,out_image_type> >::type downsample (
                 const in_image_type& original_,
-                out_image_type& down_
+                out_image_type& down_,
+                thread_pool* tp
             ) const
             {
                 // make sure requires clause is not broken
@@ -622,10 +701,11 @@ namespace dlib
                 down.set_size(part_nr, part_nc);
 
 
-                long rr = 1;
-                long r;
-                for (r = 0; r < full_nr; r+=size_out)
+                // Each block row makes two rows of the output, independently of the others.
+                for_each_pyramid_row(tp, 0, full_nr/size_out, [&](long i)
                 {
+                    const long r = i*size_out;
+                    const long rr = 1 + i*size_in;
                     long cc = 1;
                     long c;
                     for (c = 0; c < full_nc; c+=size_out)
@@ -650,8 +730,9 @@ namespace dlib
                         assign_pixel(down[r][c]     , (block[0][0]*9 + block[1][0]*3 + block[0][1]*3 + block[1][1])/(16*256));
                         assign_pixel(down[r+1][c]   , (block[2][0]*9 + block[1][0]*3 + block[2][1]*3 + block[1][1])/(16*256));
                     }
-                    rr += size_in;
-                }
+                });
+                const long r = full_nr;
+                const long rr = 1 + (full_nr/size_out)*size_in;
                 if (part_nr - full_nr == 1)
                 {
                     long cc = 1;
@@ -687,7 +768,6 @@ namespace dlib
                 uint32 blue;
             };
 
-        public:
         // ------------------------------------------
         //       OVERLOAD FOR RGB TO RGB IMAGES
         // ------------------------------------------
@@ -695,9 +775,10 @@ namespace dlib
                 typename in_image_type,
                 typename out_image_type
                 >
-            typename enable_if<both_images_rgb<in_image_type,out_image_type> >::type operator() (
+            typename enable_if<both_images_rgb<in_image_type,out_image_type> >::type downsample (
                 const in_image_type& original_,
-                out_image_type& down_
+                out_image_type& down_,
+                thread_pool* tp
             ) const
             {
                 // make sure requires clause is not broken
@@ -731,10 +812,11 @@ namespace dlib
                 down.set_size(part_nr, part_nc);
 
 
-                long rr = 1;
-                long r;
-                for (r = 0; r < full_nr; r+=size_out)
+                // Each block row makes two rows of the output, independently of the others.
+                for_each_pyramid_row(tp, 0, full_nr/size_out, [&](long i)
                 {
+                    const long r = i*size_out;
+                    const long rr = 1 + i*size_in;
                     long cc = 1;
                     long c;
                     for (c = 0; c < full_nc; c+=size_out)
@@ -775,8 +857,9 @@ namespace dlib
                         down[r+1][c].green   = (block[2][0].green*9 + block[1][0].green*3 + block[2][1].green*3 + block[1][1].green)/(16*256);
                         down[r+1][c].blue    = (block[2][0].blue*9  + block[1][0].blue*3  + block[2][1].blue*3  + block[1][1].blue)/(16*256);
                     }
-                    rr += size_in;
-                }
+                });
+                const long r = full_nr;
+                const long rr = 1 + (full_nr/size_out)*size_in;
                 if (part_nr - full_nr == 1)
                 {
                     long cc = 1;
@@ -810,6 +893,33 @@ namespace dlib
                 }
             }
 
+        public:
+
+            template <
+                typename in_image_type,
+                typename out_image_type
+                >
+            void operator() (
+                const in_image_type& original,
+                out_image_type& down
+            ) const
+            {
+                downsample(original, down, nullptr);
+            }
+
+            template <
+                typename in_image_type,
+                typename out_image_type
+                >
+            void operator() (
+                const in_image_type& original,
+                out_image_type& down,
+                thread_pool& tp
+            ) const
+            {
+                downsample(original, down, &tp);
+            }
+
             template <
                 typename image_type
                 >
@@ -945,6 +1055,19 @@ namespace dlib
             resize_image(original, down);
         }
 
+        template <
+            typename in_image_type,
+            typename out_image_type
+            >
+        void operator() (
+            const in_image_type& original,
+            out_image_type& down,
+            thread_pool& 
+        ) const
+        {
+            (*this)(original, down);
+        }
+
         template <
             typename image_type
             >
@@ -1021,6 +1144,116 @@ namespace dlib
         nc = 0;
     }
 
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        template <typename pyramid_type, typename in_image_type, typename out_image_type>
+        auto pyramid_down_with_pool (
+            const pyramid_type& pyr,
+            const in_image_type& original,
+            out_image_type& down,
+            thread_pool& tp,
+            int
+        ) -> decltype(pyr(original, down, tp), void())
+        {
+            pyr(original, down, tp);
+        }
+
+        template <typename pyramid_type, typename in_image_type, typename out_image_type>
+        void pyramid_down_with_pool (
+            const pyramid_type& pyr,
+            const in_image_type& original,
+            out_image_type& down,
+            thread_pool& ,
+            long
+        )
+        {
+            // pyramid types that don't know about thread pools just run serially.
+            pyr(original, down);
+        }
+    }
+
+    template <
+        typename pyramid_type,
+        typename image_type
+        >
+    class image_pyramid : noncopyable
+    {
+    public:
+
+        image_pyramid(
+        ) = default;
+
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            if (num <= 1)
+                tp.reset();
+            else if (!tp || tp->num_threads_in_pool() != num)
+                tp = std::make_shared<thread_pool>(num);
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return tp ? tp->num_threads_in_pool() : 1;
+        }
+
+        template <
+            typename in_image_type
+            >
+        void build (
+            const in_image_type& img,
+            unsigned long max_levels
+        )
+        {
+            DLIB_ASSERT(max_levels > 0);
+            // Only grow the level array.  Shrinking it would free the images of the
+            // lower levels, which we want to keep around for the next call.
+            if (levels.size() < max_levels)
+            {
+                levels.set_max_size(max_levels);
+                levels.set_size(max_levels);
+            }
+
+            assign_image(levels[0], img);
+            num = 1;
+            while (num < max_levels && num_rows(levels[num-1]) != 0 && num_columns(levels[num-1]) != 0)
+            {
+                if (tp)
+                    impl::pyramid_down_with_pool(pyr, levels[num-1], levels[num], *tp, 0);
+                else
+                    pyr(levels[num-1], levels[num]);
+                if (num_rows(levels[num]) == 0 || num_columns(levels[num]) == 0)
+                    break;
+                ++num;
+            }
+        }
+
+        unsigned long num_levels (
+        ) const { return num; }
+
+        const image_type& operator[] (
+            unsigned long idx
+        ) const
+        {
+            DLIB_ASSERT(idx < num_levels());
+            return levels[idx];
+        }
+
+        const pyramid_type& get_pyramid (
+        ) const { return pyr; }
+
+    private:
+
+        pyramid_type pyr;
+        dlib::array<image_type> levels;
+        unsigned long num = 0;
+        std::shared_ptr<thread_pool> tp;
+    };
+
 // ----------------------------------------------------------------------------------------
     
     namespace impl
@@ -7,6 +7,7 @@
 #include "../array2d.h"
 #include "../geometry.h"
 #include "../image_processing/generic_image.h"
+#include "../threads/thread_pool_extension_abstract.h"
 
 namespace dlib
 {
@@ -65,6 +66,25 @@ namespace dlib
                   points outside the #down image.  
         !*/
 
+        template <
+            typename in_image_type,
+            typename out_image_type
+            >
+        void operator() (
+            const in_image_type& original,
+            out_image_type& down,
+            thread_pool& tp
+        ) const;
+        /*!
+            requires
+                - The same requirements as operator()(original, down).
+            ensures
+                - This function is identical to operator()(original, down) except that the
+                  rows of #down are computed in parallel using the threads in tp.  The
+                  output is exactly the same.  Only pyramid_down<2> and pyramid_down<3>
+                  use the threads, the other ratios run serially.
+        !*/
+
         template <
             typename image_type
             >
@@ -228,6 +248,104 @@ namespace dlib
               image and stores it back into #nr and #nc.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename pyramid_type,
+        typename image_type
+        >
+    class image_pyramid : noncopyable
+    {
+        /*!
+            REQUIREMENTS ON pyramid_type
+                pyramid_type == one of the dlib::pyramid_down template instances defined
+                above, or another type with the same interface.
+
+            REQUIREMENTS ON image_type
+                image_type == an image object that implements the interface defined in
+                dlib/image_processing/generic_image.h and whose pixels don't have an alpha
+                channel.
+
+            INITIAL VALUE
+                - num_levels() == 0
+                - get_num_threads() == 1
+
+            WHAT THIS OBJECT REPRESENTS
+                This object builds an image pyramid and holds on to its levels.  It is
+                meant for processing streams of images, like video frames.  The images of
+                each level are reused by the next call to build(), so once the first frame
+                has been processed no further memory is allocated as long as the frames
+                stay the same size.  The downsampling of each level can also be spread
+                over several threads.
+        !*/
+
+    public:
+
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            ensures
+                - #get_num_threads() == max(num, 1)
+                - If num > 1 then build() computes the rows of each level in parallel with
+                  a thread pool owned by this object.
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads used to downsample each level.
+        !*/
+
+        template <
+            typename in_image_type
+            >
+        void build (
+            const in_image_type& img,
+            unsigned long max_levels
+        );
+        /*!
+            requires
+                - max_levels > 0
+                - in_image_type == an image object that implements the interface defined in
+                  dlib/image_processing/generic_image.h 
+            ensures
+                - (*this)[0] is a copy of img, converted to image_type.
+                - For i > 0, (*this)[i] is the output of get_pyramid() applied to
+                  (*this)[i-1].
+                - #num_levels() is the number of levels that were made.  This is
+                  max_levels unless a level would have come out empty, in which case the
+                  pyramid stops at the last non-empty level.
+                - The result is the same regardless of get_num_threads().
+        !*/
+
+        unsigned long num_levels (
+        ) const;
+        /*!
+            ensures
+                - returns the number of levels made by the last call to build().
+        !*/
+
+        const image_type& operator[] (
+            unsigned long idx
+        ) const;
+        /*!
+            requires
+                - idx < num_levels()
+            ensures
+                - returns the idx-th level of the pyramid.  Level 0 is the full size image.
+        !*/
+
+        const pyramid_type& get_pyramid (
+        ) const;
+        /*!
+            ensures
+                - returns the pyramid_down object used to make each level.  Use it to map
+                  points and rectangles between levels.
+        !*/
+    };
+
 // ----------------------------------------------------------------------------------------
 
     template <
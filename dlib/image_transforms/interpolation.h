@@ -592,71 +592,343 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    // This is an optimized version of resize_image for the case where bilinear
-    // interpolation is used.
     template <
         typename image_type1,
         typename image_type2
         >
-    typename disable_if_c<(is_rgb_image<image_type1>::value&&is_rgb_image<image_type2>::value) || 
-                          (is_grayscale_image<image_type1>::value&&is_grayscale_image<image_type2>::value)>::type 
-    resize_image (
-        const image_type1& in_img_,
-        image_type2& out_img_,
-        interpolate_bilinear
-    )
+    struct images_have_same_pixel_types
     {
-        // make sure requires clause is not broken
-        DLIB_ASSERT( is_same_object(in_img_, out_img_) == false ,
-            "\t void resize_image()"
-            << "\n\t Invalid inputs were given to this function."
-            << "\n\t is_same_object(in_img_, out_img_):  " << is_same_object(in_img_, out_img_)
-            );
+        typedef typename image_traits<image_type1>::pixel_type ptype1;
+        typedef typename image_traits<image_type2>::pixel_type ptype2;
+        const static bool value = is_same_type<ptype1, ptype2>::value;
+    };
 
-        const_image_view<image_type1> in_img(in_img_);
-        image_view<image_type2> out_img(out_img_);
+// ----------------------------------------------------------------------------------------
 
-        if (out_img.size() == 0 || in_img.size() == 0)
-            return;
+    namespace impl
+    {
+        template <
+            typename image_type1,
+            typename image_type2
+            >
+        struct use_simd_gray_resize
+        {
+            // True for the grayscale images the SIMD version of the bilinear resize
+            // handles, which are the ones with the same pixel type.
+            const static bool value = is_grayscale_image<image_type1>::value && is_grayscale_image<image_type2>::value &&
+                images_have_same_pixel_types<image_type1,image_type2>::value;
+        };
+
+        template <
+            typename image_type1,
+            typename image_type2
+            >
+        typename disable_if_c<(is_rgb_image<image_type1>::value&&is_rgb_image<image_type2>::value) || 
+                              (is_grayscale_image<image_type1>::value&&is_grayscale_image<image_type2>::value)>::type 
+        resize_image_bilinear_rows (
+            const image_type1& in_img_,
+            image_type2& out_img_,
+            long row_begin,
+            long row_end
+        )
+        {
+            const_image_view<image_type1> in_img(in_img_);
+            image_view<image_type2> out_img(out_img_);
+
+            if (out_img.size() == 0 || in_img.size() == 0)
+                return;
+
+
+            typedef typename image_traits<image_type1>::pixel_type T;
+            typedef typename image_traits<image_type2>::pixel_type U;
+            const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
+            const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
+            // y is accumulated exactly like a single pass over all the rows would do it,
+            // so the output doesn't depend on how the rows are split up.
+            double y = -y_scale;
+            for (long r = 0; r < row_begin; ++r)
+                y += y_scale;
+            for (long r = row_begin; r < row_end; ++r)
+            {
+                y += y_scale;
+                const long top    = static_cast<long>(std::floor(y));
+                const long bottom = std::min(top+1, in_img.nr()-1);
+                const double tb_frac = y - top;
+                double x = -x_scale;
+                if (pixel_traits<U>::grayscale)
+                {
+                    for (long c = 0; c < out_img.nc(); ++c)
+                    {
+                        x += x_scale;
+                        const long left   = static_cast<long>(std::floor(x));
+                        const long right  = std::min(left+1, in_img.nc()-1);
+                        const double lr_frac = x - left;
+
+                        double tl = 0, tr = 0, bl = 0, br = 0;
+
+                        assign_pixel(tl, in_img[top][left]);
+                        assign_pixel(tr, in_img[top][right]);
+                        assign_pixel(bl, in_img[bottom][left]);
+                        assign_pixel(br, in_img[bottom][right]);
 
+                        double temp = (1-tb_frac)*((1-lr_frac)*tl + lr_frac*tr) + 
+                            tb_frac*((1-lr_frac)*bl + lr_frac*br);
+
+                        assign_pixel(out_img[r][c], temp);
+                    }
+                }
+                else
+                {
+                    for (long c = 0; c < out_img.nc(); ++c)
+                    {
+                        x += x_scale;
+                        const long left   = static_cast<long>(std::floor(x));
+                        const long right  = std::min(left+1, in_img.nc()-1);
+                        const double lr_frac = x - left;
+
+                        const T tl = in_img[top][left];
+                        const T tr = in_img[top][right];
+                        const T bl = in_img[bottom][left];
+                        const T br = in_img[bottom][right];
+
+                        T temp;
+                        assign_pixel(temp, 0);
+                        vector_to_pixel(temp, 
+                            (1-tb_frac)*((1-lr_frac)*pixel_to_vector<double>(tl) + lr_frac*pixel_to_vector<double>(tr)) + 
+                                tb_frac*((1-lr_frac)*pixel_to_vector<double>(bl) + lr_frac*pixel_to_vector<double>(br)));
+                        assign_pixel(out_img[r][c], temp);
+                    }
+                }
+            }
+        }
+
+        template <
+            typename image_type1,
+            typename image_type2
+            >
+        typename enable_if_c<is_grayscale_image<image_type1>::value && is_grayscale_image<image_type2>::value &&
+                             !images_have_same_pixel_types<image_type1,image_type2>::value>::type 
+        resize_image_bilinear_rows (
+            const image_type1& in_img,
+            image_type2& out_img,
+            long row_begin,
+            long row_end
+        )
+        {
+            // Grayscale images with different pixel types don't have a specialized
+            // version, so they are resized with interpolate_bilinear like any other
+            // interpolation.
+            const double x_scale = (num_columns(in_img)-1)/(double)std::max<long>((num_columns(out_img)-1),1);
+            const double y_scale = (num_rows(in_img)-1)/(double)std::max<long>((num_rows(out_img)-1),1);
+            transform_image(in_img, out_img, interpolate_bilinear(), helper_resize_image(x_scale,y_scale),
+                            black_background(), rectangle(0, row_begin, num_columns(out_img)-1, row_end-1));
+        }
 
-        typedef typename image_traits<image_type1>::pixel_type T;
-        typedef typename image_traits<image_type2>::pixel_type U;
-        const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
-        const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
-        double y = -y_scale;
-        for (long r = 0; r < out_img.nr(); ++r)
+        template <
+            typename image_type,
+            typename image_type2
+            >
+        typename enable_if_c<use_simd_gray_resize<image_type,image_type2>::value>::type 
+        resize_image_bilinear_rows (
+            const image_type& in_img_,
+            image_type2& out_img_,
+            long row_begin,
+            long row_end
+        )
         {
-            y += y_scale;
-            const long top    = static_cast<long>(std::floor(y));
-            const long bottom = std::min(top+1, in_img.nr()-1);
-            const double tb_frac = y - top;
-            double x = -x_scale;
-            if (pixel_traits<U>::grayscale)
+            const_image_view<image_type> in_img(in_img_);
+            image_view<image_type2> out_img(out_img_);
+
+            if (out_img.size() == 0 || in_img.size() == 0)
+                return;
+
+            typedef typename image_traits<image_type2>::pixel_type U;
+            const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
+            const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
+            // y is accumulated exactly like a single pass over all the rows would do it,
+            // so the output doesn't depend on how the rows are split up.
+            double y = -y_scale;
+            for (long r = 0; r < row_begin; ++r)
+                y += y_scale;
+            for (long r = row_begin; r < row_end; ++r)
             {
-                for (long c = 0; c < out_img.nc(); ++c)
+                y += y_scale;
+                const long top    = static_cast<long>(std::floor(y));
+                const long bottom = std::min(top+1, in_img.nr()-1);
+                const double tb_frac = y - top;
+                double x = -4*x_scale;
+
+                const simd4f _tb_frac = tb_frac;
+                const simd4f _inv_tb_frac = 1-tb_frac;
+                const simd4f _x_scale = 4*x_scale;
+                simd4f _x(x, x+x_scale, x+2*x_scale, x+3*x_scale);
+                long c = 0;
+                for (;; c+=4)
+                {
+                    _x += _x_scale;
+                    simd4i left = simd4i(_x);
+
+                    simd4f _lr_frac = _x-left;
+                    simd4f _inv_lr_frac = 1-_lr_frac; 
+                    simd4i right = left+1;
+
+                    simd4f tlf = _inv_tb_frac*_inv_lr_frac;
+                    simd4f trf = _inv_tb_frac*_lr_frac;
+                    simd4f blf = _tb_frac*_inv_lr_frac;
+                    simd4f brf = _tb_frac*_lr_frac;
+
+                    int32 fleft[4];
+                    int32 fright[4];
+                    left.store(fleft);
+                    right.store(fright);
+
+                    if (fright[3] >= in_img.nc())
+                        break;
+                    simd4f tl(in_img[top][fleft[0]],     in_img[top][fleft[1]],     in_img[top][fleft[2]],     in_img[top][fleft[3]]);
+                    simd4f tr(in_img[top][fright[0]],    in_img[top][fright[1]],    in_img[top][fright[2]],    in_img[top][fright[3]]);
+                    simd4f bl(in_img[bottom][fleft[0]],  in_img[bottom][fleft[1]],  in_img[bottom][fleft[2]],  in_img[bottom][fleft[3]]);
+                    simd4f br(in_img[bottom][fright[0]], in_img[bottom][fright[1]], in_img[bottom][fright[2]], in_img[bottom][fright[3]]);
+
+                    simd4f out = simd4f(tlf*tl + trf*tr + blf*bl + brf*br);
+                    float fout[4];
+                    out.store(fout);
+
+                    const auto convert_to_output_type = [](float value)
+                    {
+                        if (std::is_integral<U>::value)
+                            return static_cast<U>(value + 0.5);
+                        else
+                            return static_cast<U>(value);
+                    };
+
+                    out_img[r][c]   = convert_to_output_type(fout[0]);
+                    out_img[r][c+1] = convert_to_output_type(fout[1]);
+                    out_img[r][c+2] = convert_to_output_type(fout[2]);
+                    out_img[r][c+3] = convert_to_output_type(fout[3]);
+                }
+                x = -x_scale + c*x_scale;
+                for (; c < out_img.nc(); ++c)
                 {
                     x += x_scale;
                     const long left   = static_cast<long>(std::floor(x));
                     const long right  = std::min(left+1, in_img.nc()-1);
-                    const double lr_frac = x - left;
+                    const float lr_frac = x - left;
 
-                    double tl = 0, tr = 0, bl = 0, br = 0;
+                    float tl = 0, tr = 0, bl = 0, br = 0;
 
                     assign_pixel(tl, in_img[top][left]);
                     assign_pixel(tr, in_img[top][right]);
                     assign_pixel(bl, in_img[bottom][left]);
                     assign_pixel(br, in_img[bottom][right]);
 
-                    double temp = (1-tb_frac)*((1-lr_frac)*tl + lr_frac*tr) + 
+                    float temp = (1-tb_frac)*((1-lr_frac)*tl + lr_frac*tr) + 
                         tb_frac*((1-lr_frac)*bl + lr_frac*br);
 
                     assign_pixel(out_img[r][c], temp);
                 }
             }
-            else
+        }
+
+        template <
+            typename image_type1,
+            typename image_type2
+            >
+        typename enable_if_c<is_rgb_image<image_type1>::value && is_rgb_image<image_type2>::value >::type
+        resize_image_bilinear_rows (
+            const image_type1& in_img_,
+            image_type2& out_img_,
+            long row_begin,
+            long row_end
+        )
+        {
+            const_image_view<image_type1> in_img(in_img_);
+            image_view<image_type2> out_img(out_img_);
+
+            if (out_img.size() == 0 || in_img.size() == 0)
+                return;
+
+
+            typedef typename image_traits<image_type1>::pixel_type T;
+            const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
+            const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
+            // y is accumulated exactly like a single pass over all the rows would do it,
+            // so the output doesn't depend on how the rows are split up.
+            double y = -y_scale;
+            for (long r = 0; r < row_begin; ++r)
+                y += y_scale;
+            for (long r = row_begin; r < row_end; ++r)
             {
-                for (long c = 0; c < out_img.nc(); ++c)
+                y += y_scale;
+                const long top    = static_cast<long>(std::floor(y));
+                const long bottom = std::min(top+1, in_img.nr()-1);
+                const double tb_frac = y - top;
+                double x = -4*x_scale;
+
+                const simd4f _tb_frac = tb_frac;
+                const simd4f _inv_tb_frac = 1-tb_frac;
+                const simd4f _x_scale = 4*x_scale;
+                simd4f _x(x, x+x_scale, x+2*x_scale, x+3*x_scale);
+                long c = 0;
+                for (;; c+=4)
+                {
+                    _x += _x_scale;
+                    simd4i left = simd4i(_x);
+                    simd4f lr_frac = _x-left;
+                    simd4f _inv_lr_frac = 1-lr_frac; 
+                    simd4i right = left+1;
+
+                    simd4f tlf = _inv_tb_frac*_inv_lr_frac;
+                    simd4f trf = _inv_tb_frac*lr_frac;
+                    simd4f blf = _tb_frac*_inv_lr_frac;
+                    simd4f brf = _tb_frac*lr_frac;
+
+                    int32 fleft[4];
+                    int32 fright[4];
+                    left.store(fleft);
+                    right.store(fright);
+
+                    if (fright[3] >= in_img.nc())
+                        break;
+                    simd4f tl(in_img[top][fleft[0]].red,     in_img[top][fleft[1]].red,     in_img[top][fleft[2]].red,     in_img[top][fleft[3]].red);
+                    simd4f tr(in_img[top][fright[0]].red,    in_img[top][fright[1]].red,    in_img[top][fright[2]].red,    in_img[top][fright[3]].red);
+                    simd4f bl(in_img[bottom][fleft[0]].red,  in_img[bottom][fleft[1]].red,  in_img[bottom][fleft[2]].red,  in_img[bottom][fleft[3]].red);
+                    simd4f br(in_img[bottom][fright[0]].red, in_img[bottom][fright[1]].red, in_img[bottom][fright[2]].red, in_img[bottom][fright[3]].red);
+
+                    simd4i out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
+                    int32 fout[4];
+                    out.store(fout);
+
+                    out_img[r][c].red   = static_cast<unsigned char>(fout[0]);
+                    out_img[r][c+1].red = static_cast<unsigned char>(fout[1]);
+                    out_img[r][c+2].red = static_cast<unsigned char>(fout[2]);
+                    out_img[r][c+3].red = static_cast<unsigned char>(fout[3]);
+
+
+                    tl = simd4f(in_img[top][fleft[0]].green,    in_img[top][fleft[1]].green,    in_img[top][fleft[2]].green,    in_img[top][fleft[3]].green);
+                    tr = simd4f(in_img[top][fright[0]].green,   in_img[top][fright[1]].green,   in_img[top][fright[2]].green,   in_img[top][fright[3]].green);
+                    bl = simd4f(in_img[bottom][fleft[0]].green, in_img[bottom][fleft[1]].green, in_img[bottom][fleft[2]].green, in_img[bottom][fleft[3]].green);
+                    br = simd4f(in_img[bottom][fright[0]].green, in_img[bottom][fright[1]].green, in_img[bottom][fright[2]].green, in_img[bottom][fright[3]].green);
+                    out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
+                    out.store(fout);
+                    out_img[r][c].green   = static_cast<unsigned char>(fout[0]);
+                    out_img[r][c+1].green = static_cast<unsigned char>(fout[1]);
+                    out_img[r][c+2].green = static_cast<unsigned char>(fout[2]);
+                    out_img[r][c+3].green = static_cast<unsigned char>(fout[3]);
+
+
+                    tl = simd4f(in_img[top][fleft[0]].blue,     in_img[top][fleft[1]].blue,     in_img[top][fleft[2]].blue,     in_img[top][fleft[3]].blue);
+                    tr = simd4f(in_img[top][fright[0]].blue,    in_img[top][fright[1]].blue,    in_img[top][fright[2]].blue,    in_img[top][fright[3]].blue);
+                    bl = simd4f(in_img[bottom][fleft[0]].blue,  in_img[bottom][fleft[1]].blue,  in_img[bottom][fleft[2]].blue,  in_img[bottom][fleft[3]].blue);
+                    br = simd4f(in_img[bottom][fright[0]].blue, in_img[bottom][fright[1]].blue, in_img[bottom][fright[2]].blue, in_img[bottom][fright[3]].blue);
+                    out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
+                    out.store(fout);
+                    out_img[r][c].blue   = static_cast<unsigned char>(fout[0]);
+                    out_img[r][c+1].blue = static_cast<unsigned char>(fout[1]);
+                    out_img[r][c+2].blue = static_cast<unsigned char>(fout[2]);
+                    out_img[r][c+3].blue = static_cast<unsigned char>(fout[3]);
+                }
+                x = -x_scale + c*x_scale;
+                for (; c < out_img.nc(); ++c)
                 {
                     x += x_scale;
                     const long left   = static_cast<long>(std::floor(x));
@@ -672,255 +944,99 @@ namespace dlib
                     assign_pixel(temp, 0);
                     vector_to_pixel(temp, 
                         (1-tb_frac)*((1-lr_frac)*pixel_to_vector<double>(tl) + lr_frac*pixel_to_vector<double>(tr)) + 
-                            tb_frac*((1-lr_frac)*pixel_to_vector<double>(bl) + lr_frac*pixel_to_vector<double>(br)));
+                        tb_frac*((1-lr_frac)*pixel_to_vector<double>(bl) + lr_frac*pixel_to_vector<double>(br)));
                     assign_pixel(out_img[r][c], temp);
                 }
             }
         }
+
+        template <
+            typename image_type1,
+            typename image_type2,
+            typename interpolation_type
+            >
+        void resize_image_rows (
+            const image_type1& in_img,
+            image_type2& out_img,
+            const interpolation_type& interp,
+            long row_begin,
+            long row_end
+        )
+        {
+            const double x_scale = (num_columns(in_img)-1)/(double)std::max<long>((num_columns(out_img)-1),1);
+            const double y_scale = (num_rows(in_img)-1)/(double)std::max<long>((num_rows(out_img)-1),1);
+            transform_image(in_img, out_img, interp, helper_resize_image(x_scale,y_scale),
+                            black_background(), rectangle(0, row_begin, num_columns(out_img)-1, row_end-1));
+        }
+
+        template <
+            typename image_type1,
+            typename image_type2
+            >
+        void resize_image_rows (
+            const image_type1& in_img,
+            image_type2& out_img,
+            interpolate_bilinear,
+            long row_begin,
+            long row_end
+        )
+        {
+            resize_image_bilinear_rows(in_img, out_img, row_begin, row_end);
+        }
     }
 
 // ----------------------------------------------------------------------------------------
 
+    // This is an optimized version of resize_image for the case where bilinear
+    // interpolation is used.
     template <
         typename image_type1,
         typename image_type2
         >
-    struct images_have_same_pixel_types
-    {
-        typedef typename image_traits<image_type1>::pixel_type ptype1;
-        typedef typename image_traits<image_type2>::pixel_type ptype2;
-        const static bool value = is_same_type<ptype1, ptype2>::value;
-    };
-
-    template <
-        typename image_type,
-        typename image_type2
-        >
-    typename enable_if_c<is_grayscale_image<image_type>::value && is_grayscale_image<image_type2>::value && images_have_same_pixel_types<image_type,image_type2>::value>::type 
-    resize_image (
-        const image_type& in_img_,
-        image_type2& out_img_,
+    void resize_image (
+        const image_type1& in_img,
+        image_type2& out_img,
         interpolate_bilinear
     )
     {
         // make sure requires clause is not broken
-        DLIB_ASSERT( is_same_object(in_img_, out_img_) == false ,
+        DLIB_ASSERT( is_same_object(in_img, out_img) == false ,
             "\t void resize_image()"
             << "\n\t Invalid inputs were given to this function."
-            << "\n\t is_same_object(in_img_, out_img_):  " << is_same_object(in_img_, out_img_)
+            << "\n\t is_same_object(in_img, out_img):  " << is_same_object(in_img, out_img)
             );
 
-        const_image_view<image_type> in_img(in_img_);
-        image_view<image_type2> out_img(out_img_);
-
-        if (out_img.size() == 0 || in_img.size() == 0)
-            return;
-
-        typedef typename image_traits<image_type>::pixel_type T;
-        const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
-        const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
-        double y = -y_scale;
-        for (long r = 0; r < out_img.nr(); ++r)
-        {
-            y += y_scale;
-            const long top    = static_cast<long>(std::floor(y));
-            const long bottom = std::min(top+1, in_img.nr()-1);
-            const double tb_frac = y - top;
-            double x = -4*x_scale;
-
-            const simd4f _tb_frac = tb_frac;
-            const simd4f _inv_tb_frac = 1-tb_frac;
-            const simd4f _x_scale = 4*x_scale;
-            simd4f _x(x, x+x_scale, x+2*x_scale, x+3*x_scale);
-            long c = 0;
-            for (;; c+=4)
-            {
-                _x += _x_scale;
-                simd4i left = simd4i(_x);
-
-                simd4f _lr_frac = _x-left;
-                simd4f _inv_lr_frac = 1-_lr_frac; 
-                simd4i right = left+1;
-
-                simd4f tlf = _inv_tb_frac*_inv_lr_frac;
-                simd4f trf = _inv_tb_frac*_lr_frac;
-                simd4f blf = _tb_frac*_inv_lr_frac;
-                simd4f brf = _tb_frac*_lr_frac;
-
-                int32 fleft[4];
-                int32 fright[4];
-                left.store(fleft);
-                right.store(fright);
-
-                if (fright[3] >= in_img.nc())
-                    break;
-                simd4f tl(in_img[top][fleft[0]],     in_img[top][fleft[1]],     in_img[top][fleft[2]],     in_img[top][fleft[3]]);
-                simd4f tr(in_img[top][fright[0]],    in_img[top][fright[1]],    in_img[top][fright[2]],    in_img[top][fright[3]]);
-                simd4f bl(in_img[bottom][fleft[0]],  in_img[bottom][fleft[1]],  in_img[bottom][fleft[2]],  in_img[bottom][fleft[3]]);
-                simd4f br(in_img[bottom][fright[0]], in_img[bottom][fright[1]], in_img[bottom][fright[2]], in_img[bottom][fright[3]]);
-
-                simd4f out = simd4f(tlf*tl + trf*tr + blf*bl + brf*br);
-                float fout[4];
-                out.store(fout);
-
-                const auto convert_to_output_type = [](float value)
-                {
-                    if (std::is_integral<T>::value)
-                        return static_cast<T>(value + 0.5);
-                    else
-                        return static_cast<T>(value);
-                };
-
-                out_img[r][c]   = convert_to_output_type(fout[0]);
-                out_img[r][c+1] = convert_to_output_type(fout[1]);
-                out_img[r][c+2] = convert_to_output_type(fout[2]);
-                out_img[r][c+3] = convert_to_output_type(fout[3]);
-            }
-            x = -x_scale + c*x_scale;
-            for (; c < out_img.nc(); ++c)
-            {
-                x += x_scale;
-                const long left   = static_cast<long>(std::floor(x));
-                const long right  = std::min(left+1, in_img.nc()-1);
-                const float lr_frac = x - left;
-
-                float tl = 0, tr = 0, bl = 0, br = 0;
-
-                assign_pixel(tl, in_img[top][left]);
-                assign_pixel(tr, in_img[top][right]);
-                assign_pixel(bl, in_img[bottom][left]);
-                assign_pixel(br, in_img[bottom][right]);
-
-                float temp = (1-tb_frac)*((1-lr_frac)*tl + lr_frac*tr) + 
-                    tb_frac*((1-lr_frac)*bl + lr_frac*br);
-
-                assign_pixel(out_img[r][c], temp);
-            }
-        }
+        impl::resize_image_bilinear_rows(in_img, out_img, 0, num_rows(out_img));
     }
 
 // ----------------------------------------------------------------------------------------
 
     template <
         typename image_type1,
-        typename image_type2
+        typename image_type2,
+        typename interpolation_type
         >
-    typename enable_if_c<is_rgb_image<image_type1>::value && is_rgb_image<image_type2>::value >::type resize_image (
-        const image_type1& in_img_,
-        image_type2& out_img_,
-        interpolate_bilinear
+    void resize_image (
+        const image_type1& in_img,
+        image_type2& out_img,
+        const interpolation_type& interp,
+        thread_pool& tp
     )
     {
         // make sure requires clause is not broken
-        DLIB_ASSERT( is_same_object(in_img_, out_img_) == false ,
+        DLIB_ASSERT( is_same_object(in_img, out_img) == false ,
             "\t void resize_image()"
             << "\n\t Invalid inputs were given to this function."
-            << "\n\t is_same_object(in_img_, out_img_):  " << is_same_object(in_img_, out_img_)
+            << "\n\t is_same_object(in_img, out_img):  " << is_same_object(in_img, out_img)
             );
 
-        const_image_view<image_type1> in_img(in_img_);
-        image_view<image_type2> out_img(out_img_);
-
-        if (out_img.size() == 0 || in_img.size() == 0)
+        if (num_rows(out_img) == 0 || num_columns(out_img) == 0)
             return;
 
-
-        typedef typename image_traits<image_type1>::pixel_type T;
-        const double x_scale = (in_img.nc()-1)/(double)std::max<long>((out_img.nc()-1),1);
-        const double y_scale = (in_img.nr()-1)/(double)std::max<long>((out_img.nr()-1),1);
-        double y = -y_scale;
-        for (long r = 0; r < out_img.nr(); ++r)
+        parallel_for_blocked(tp, 0, num_rows(out_img), [&](long begin, long end)
         {
-            y += y_scale;
-            const long top    = static_cast<long>(std::floor(y));
-            const long bottom = std::min(top+1, in_img.nr()-1);
-            const double tb_frac = y - top;
-            double x = -4*x_scale;
-
-            const simd4f _tb_frac = tb_frac;
-            const simd4f _inv_tb_frac = 1-tb_frac;
-            const simd4f _x_scale = 4*x_scale;
-            simd4f _x(x, x+x_scale, x+2*x_scale, x+3*x_scale);
-            long c = 0;
-            for (;; c+=4)
-            {
-                _x += _x_scale;
-                simd4i left = simd4i(_x);
-                simd4f lr_frac = _x-left;
-                simd4f _inv_lr_frac = 1-lr_frac; 
-                simd4i right = left+1;
-
-                simd4f tlf = _inv_tb_frac*_inv_lr_frac;
-                simd4f trf = _inv_tb_frac*lr_frac;
-                simd4f blf = _tb_frac*_inv_lr_frac;
-                simd4f brf = _tb_frac*lr_frac;
-
-                int32 fleft[4];
-                int32 fright[4];
-                left.store(fleft);
-                right.store(fright);
-
-                if (fright[3] >= in_img.nc())
-                    break;
-                simd4f tl(in_img[top][fleft[0]].red,     in_img[top][fleft[1]].red,     in_img[top][fleft[2]].red,     in_img[top][fleft[3]].red);
-                simd4f tr(in_img[top][fright[0]].red,    in_img[top][fright[1]].red,    in_img[top][fright[2]].red,    in_img[top][fright[3]].red);
-                simd4f bl(in_img[bottom][fleft[0]].red,  in_img[bottom][fleft[1]].red,  in_img[bottom][fleft[2]].red,  in_img[bottom][fleft[3]].red);
-                simd4f br(in_img[bottom][fright[0]].red, in_img[bottom][fright[1]].red, in_img[bottom][fright[2]].red, in_img[bottom][fright[3]].red);
-
-                simd4i out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
-                int32 fout[4];
-                out.store(fout);
-
-                out_img[r][c].red   = static_cast<unsigned char>(fout[0]);
-                out_img[r][c+1].red = static_cast<unsigned char>(fout[1]);
-                out_img[r][c+2].red = static_cast<unsigned char>(fout[2]);
-                out_img[r][c+3].red = static_cast<unsigned char>(fout[3]);
-
-
-                tl = simd4f(in_img[top][fleft[0]].green,    in_img[top][fleft[1]].green,    in_img[top][fleft[2]].green,    in_img[top][fleft[3]].green);
-                tr = simd4f(in_img[top][fright[0]].green,   in_img[top][fright[1]].green,   in_img[top][fright[2]].green,   in_img[top][fright[3]].green);
-                bl = simd4f(in_img[bottom][fleft[0]].green, in_img[bottom][fleft[1]].green, in_img[bottom][fleft[2]].green, in_img[bottom][fleft[3]].green);
-                br = simd4f(in_img[bottom][fright[0]].green, in_img[bottom][fright[1]].green, in_img[bottom][fright[2]].green, in_img[bottom][fright[3]].green);
-                out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
-                out.store(fout);
-                out_img[r][c].green   = static_cast<unsigned char>(fout[0]);
-                out_img[r][c+1].green = static_cast<unsigned char>(fout[1]);
-                out_img[r][c+2].green = static_cast<unsigned char>(fout[2]);
-                out_img[r][c+3].green = static_cast<unsigned char>(fout[3]);
-
-
-                tl = simd4f(in_img[top][fleft[0]].blue,     in_img[top][fleft[1]].blue,     in_img[top][fleft[2]].blue,     in_img[top][fleft[3]].blue);
-                tr = simd4f(in_img[top][fright[0]].blue,    in_img[top][fright[1]].blue,    in_img[top][fright[2]].blue,    in_img[top][fright[3]].blue);
-                bl = simd4f(in_img[bottom][fleft[0]].blue,  in_img[bottom][fleft[1]].blue,  in_img[bottom][fleft[2]].blue,  in_img[bottom][fleft[3]].blue);
-                br = simd4f(in_img[bottom][fright[0]].blue, in_img[bottom][fright[1]].blue, in_img[bottom][fright[2]].blue, in_img[bottom][fright[3]].blue);
-                out = simd4i(tlf*tl + trf*tr + blf*bl + brf*br);
-                out.store(fout);
-                out_img[r][c].blue   = static_cast<unsigned char>(fout[0]);
-                out_img[r][c+1].blue = static_cast<unsigned char>(fout[1]);
-                out_img[r][c+2].blue = static_cast<unsigned char>(fout[2]);
-                out_img[r][c+3].blue = static_cast<unsigned char>(fout[3]);
-            }
-            x = -x_scale + c*x_scale;
-            for (; c < out_img.nc(); ++c)
-            {
-                x += x_scale;
-                const long left   = static_cast<long>(std::floor(x));
-                const long right  = std::min(left+1, in_img.nc()-1);
-                const double lr_frac = x - left;
-
-                const T tl = in_img[top][left];
-                const T tr = in_img[top][right];
-                const T bl = in_img[bottom][left];
-                const T br = in_img[bottom][right];
-
-                T temp;
-                assign_pixel(temp, 0);
-                vector_to_pixel(temp, 
-                    (1-tb_frac)*((1-lr_frac)*pixel_to_vector<double>(tl) + lr_frac*pixel_to_vector<double>(tr)) + 
-                    tb_frac*((1-lr_frac)*pixel_to_vector<double>(bl) + lr_frac*pixel_to_vector<double>(br)));
-                assign_pixel(out_img[r][c], temp);
-            }
-        }
+            impl::resize_image_rows(in_img, out_img, interp, begin, end);
+        });
     }
 
 // ----------------------------------------------------------------------------------------
@@ -944,6 +1060,19 @@ namespace dlib
         resize_image(in_img, out_img, interpolate_bilinear());
     }
 
+    template <
+        typename image_type1,
+        typename image_type2
+        >
+    void resize_image (
+        const image_type1& in_img,
+        image_type2& out_img,
+        thread_pool& tp
+    )
+    {
+        resize_image(in_img, out_img, interpolate_bilinear(), tp);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -1834,124 +1963,176 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
-    template <
-        typename image_type1,
-        typename image_type2,
-        typename interpolation_type
-        >
-    void extract_image_chips (
-        const image_type1& img,
-        const std::vector<chip_details>& chip_locations,
-        dlib::array<image_type2>& chips,
-        const interpolation_type& interp
-    )
+    namespace impl
     {
-        // make sure requires clause is not broken
-#ifdef ENABLE_ASSERTS
-        for (unsigned long i = 0; i < chip_locations.size(); ++i)
+        template <
+            typename image_type1,
+            typename image_type2,
+            typename interpolation_type
+            >
+        void extract_image_chips (
+            const image_type1& img,
+            const std::vector<chip_details>& chip_locations,
+            dlib::array<image_type2>& chips,
+            const interpolation_type& interp,
+            thread_pool* tp
+        )
         {
-            DLIB_CASSERT(chip_locations[i].size() != 0 &&
-                         chip_locations[i].rect.is_empty() == false,
-            "\t void extract_image_chips()"
-            << "\n\t Invalid inputs were given to this function."
-            << "\n\t chip_locations["<<i<<"].size():            " << chip_locations[i].size()
-            << "\n\t chip_locations["<<i<<"].rect.is_empty(): " << chip_locations[i].rect.is_empty()
-            );
-        }
+            // make sure requires clause is not broken
+#ifdef ENABLE_ASSERTS
+            for (unsigned long i = 0; i < chip_locations.size(); ++i)
+            {
+                DLIB_CASSERT(chip_locations[i].size() != 0 &&
+                             chip_locations[i].rect.is_empty() == false,
+                "\t void extract_image_chips()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t chip_locations["<<i<<"].size():            " << chip_locations[i].size()
+                << "\n\t chip_locations["<<i<<"].rect.is_empty(): " << chip_locations[i].rect.is_empty()
+                );
+            }
 #endif 
 
-        // If nearest-neighbor interpolation is wanted, then don't use an image pyramid.
-        constexpr bool image_pyramid_enabled = !std::is_same<
-            typename std::remove_const<typename std::remove_reference<decltype(interp)>::type>::type,
-            interpolate_nearest_neighbor
-        >::value;
-
-        pyramid_down<2> pyr;
-        long max_depth = 0;
-        // If the chip is supposed to be much smaller than the source subwindow then you
-        // can't just extract it using bilinear interpolation since at a high enough
-        // downsampling amount it would effectively turn into nearest neighbor
-        // interpolation.  So we use an image pyramid to make sure the interpolation is
-        // fast but also high quality.  The first thing we do is figure out how deep the
-        // image pyramid needs to be.
-        rectangle bounding_box;
-        for (unsigned long i = 0; i < chip_locations.size(); ++i)
-        {
-            long depth = 0;
-            double grow = 2;
-            drectangle rect = pyr.rect_down(chip_locations[i].rect);
-            while (rect.area() > chip_locations[i].size() && image_pyramid_enabled)
+            // If nearest-neighbor interpolation is wanted, then don't use an image pyramid.
+            constexpr bool image_pyramid_enabled = !std::is_same<
+                typename std::remove_const<typename std::remove_reference<decltype(interp)>::type>::type,
+                interpolate_nearest_neighbor
+            >::value;
+
+            pyramid_down<2> pyr;
+            long max_depth = 0;
+            // If the chip is supposed to be much smaller than the source subwindow then you
+            // can't just extract it using bilinear interpolation since at a high enough
+            // downsampling amount it would effectively turn into nearest neighbor
+            // interpolation.  So we use an image pyramid to make sure the interpolation is
+            // fast but also high quality.  The first thing we do is figure out how deep the
+            // image pyramid needs to be.
+            rectangle bounding_box;
+            for (unsigned long i = 0; i < chip_locations.size(); ++i)
             {
-                rect = pyr.rect_down(rect);
-                ++depth;
-                // We drop the image size by a factor of 2 each iteration and then assume a
-                // border of 2 pixels is needed to avoid any border effects of the crop.
-                grow = grow*2 + 2;
+                long depth = 0;
+                double grow = 2;
+                drectangle rect = pyr.rect_down(chip_locations[i].rect);
+                while (rect.area() > chip_locations[i].size() && image_pyramid_enabled)
+                {
+                    rect = pyr.rect_down(rect);
+                    ++depth;
+                    // We drop the image size by a factor of 2 each iteration and then assume a
+                    // border of 2 pixels is needed to avoid any border effects of the crop.
+                    grow = grow*2 + 2;
+                }
+                drectangle rot_rect;
+                const vector<double,2> cent = center(chip_locations[i].rect);
+                rot_rect += rotate_point<double>(cent,chip_locations[i].rect.tl_corner(),chip_locations[i].angle);
+                rot_rect += rotate_point<double>(cent,chip_locations[i].rect.tr_corner(),chip_locations[i].angle);
+                rot_rect += rotate_point<double>(cent,chip_locations[i].rect.bl_corner(),chip_locations[i].angle);
+                rot_rect += rotate_point<double>(cent,chip_locations[i].rect.br_corner(),chip_locations[i].angle);
+                bounding_box += grow_rect(rot_rect, grow).intersect(get_rect(img));
+                max_depth = std::max(depth,max_depth);
             }
-            drectangle rot_rect;
-            const vector<double,2> cent = center(chip_locations[i].rect);
-            rot_rect += rotate_point<double>(cent,chip_locations[i].rect.tl_corner(),chip_locations[i].angle);
-            rot_rect += rotate_point<double>(cent,chip_locations[i].rect.tr_corner(),chip_locations[i].angle);
-            rot_rect += rotate_point<double>(cent,chip_locations[i].rect.bl_corner(),chip_locations[i].angle);
-            rot_rect += rotate_point<double>(cent,chip_locations[i].rect.br_corner(),chip_locations[i].angle);
-            bounding_box += grow_rect(rot_rect, grow).intersect(get_rect(img));
-            max_depth = std::max(depth,max_depth);
-        }
-        //std::cout << "max_depth: " << max_depth << std::endl;
-        //std::cout << "crop amount: " << bounding_box.area()/(double)get_rect(img).area() << std::endl;
-
-        // now make an image pyramid
-        dlib::array<array2d<typename image_traits<image_type1>::pixel_type> > levels(max_depth);
-        if (levels.size() != 0)
-            pyr(sub_image(img,bounding_box),levels[0]);
-        for (unsigned long i = 1; i < levels.size(); ++i)
-            pyr(levels[i-1],levels[i]);
+            //std::cout << "max_depth: " << max_depth << std::endl;
+            //std::cout << "crop amount: " << bounding_box.area()/(double)get_rect(img).area() << std::endl;
 
-        std::vector<dpoint> from, to;
-
-        // now pull out the chips
-        chips.resize(chip_locations.size());
-        for (unsigned long i = 0; i < chips.size(); ++i)
-        {
-            // If the chip doesn't have any rotation or scaling then use the basic version
-            // of chip extraction that just does a fast copy.
-            if (chip_locations[i].angle == 0 && 
-                chip_locations[i].rows == chip_locations[i].rect.height() &&
-                chip_locations[i].cols == chip_locations[i].rect.width())
+            // now make an image pyramid
+            dlib::array<array2d<typename image_traits<image_type1>::pixel_type> > levels(max_depth);
+            if (levels.size() != 0)
             {
-                impl::basic_extract_image_chip(img, chip_locations[i].rect, chips[i]);
+                if (tp)
+                    pyr(sub_image(img,bounding_box),levels[0],*tp);
+                else
+                    pyr(sub_image(img,bounding_box),levels[0]);
             }
-            else
+            for (unsigned long i = 1; i < levels.size(); ++i)
             {
-                set_image_size(chips[i], chip_locations[i].rows, chip_locations[i].cols);
+                if (tp)
+                    pyr(levels[i-1],levels[i],*tp);
+                else
+                    pyr(levels[i-1],levels[i]);
+            }
 
-                // figure out which level in the pyramid to use to extract the chip
-                int level = -1;
-                drectangle rect = translate_rect(chip_locations[i].rect, -bounding_box.tl_corner());
-                while (pyr.rect_down(rect).area() > chip_locations[i].size() && image_pyramid_enabled)
+            // now pull out the chips
+            chips.resize(chip_locations.size());
+            auto extract_chip = [&](long i)
+            {
+                // If the chip doesn't have any rotation or scaling then use the basic version
+                // of chip extraction that just does a fast copy.
+                if (chip_locations[i].angle == 0 && 
+                    chip_locations[i].rows == chip_locations[i].rect.height() &&
+                    chip_locations[i].cols == chip_locations[i].rect.width())
                 {
-                    ++level;
-                    rect = pyr.rect_down(rect);
+                    impl::basic_extract_image_chip(img, chip_locations[i].rect, chips[i]);
                 }
-
-                // find the appropriate transformation that maps from the chip to the input
-                // image
-                from.clear();
-                to.clear();
-                from.push_back(get_rect(chips[i]).tl_corner());  to.push_back(rotate_point<double>(center(rect),rect.tl_corner(),chip_locations[i].angle));
-                from.push_back(get_rect(chips[i]).tr_corner());  to.push_back(rotate_point<double>(center(rect),rect.tr_corner(),chip_locations[i].angle));
-                from.push_back(get_rect(chips[i]).bl_corner());  to.push_back(rotate_point<double>(center(rect),rect.bl_corner(),chip_locations[i].angle));
-                point_transform_affine trns = find_affine_transform(from,to);
-
-                // now extract the actual chip
-                if (level == -1)
-                    transform_image(sub_image(img,bounding_box),chips[i],interp,trns);
                 else
-                    transform_image(levels[level],chips[i],interp,trns);
-            }
+                {
+                    set_image_size(chips[i], chip_locations[i].rows, chip_locations[i].cols);
+
+                    // figure out which level in the pyramid to use to extract the chip
+                    int level = -1;
+                    drectangle rect = translate_rect(chip_locations[i].rect, -bounding_box.tl_corner());
+                    while (pyr.rect_down(rect).area() > chip_locations[i].size() && image_pyramid_enabled)
+                    {
+                        ++level;
+                        rect = pyr.rect_down(rect);
+                    }
+
+                    // find the appropriate transformation that maps from the chip to the input
+                    // image
+                    std::vector<dpoint> from, to;
+                    from.push_back(get_rect(chips[i]).tl_corner());  to.push_back(rotate_point<double>(center(rect),rect.tl_corner(),chip_locations[i].angle));
+                    from.push_back(get_rect(chips[i]).tr_corner());  to.push_back(rotate_point<double>(center(rect),rect.tr_corner(),chip_locations[i].angle));
+                    from.push_back(get_rect(chips[i]).bl_corner());  to.push_back(rotate_point<double>(center(rect),rect.bl_corner(),chip_locations[i].angle));
+                    point_transform_affine trns = find_affine_transform(from,to);
+
+                    // now extract the actual chip
+                    if (level == -1)
+                        transform_image(sub_image(img,bounding_box),chips[i],interp,trns);
+                    else
+                        transform_image(levels[level],chips[i],interp,trns);
+                }
+            };
+
+            // Each chip only reads from img and the pyramid, so they can all be
+            // extracted at the same time.
+            if (tp)
+                parallel_for(*tp, 0, chips.size(), extract_chip);
+            else
+                for (unsigned long i = 0; i < chips.size(); ++i)
+                    extract_chip(i);
         }
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename image_type1,
+        typename image_type2,
+        typename interpolation_type
+        >
+    void extract_image_chips (
+        const image_type1& img,
+        const std::vector<chip_details>& chip_locations,
+        dlib::array<image_type2>& chips,
+        const interpolation_type& interp
+    )
+    {
+        impl::extract_image_chips(img, chip_locations, chips, interp, nullptr);
+    }
+
+    template <
+        typename image_type1,
+        typename image_type2,
+        typename interpolation_type
+        >
+    void extract_image_chips (
+        const image_type1& img,
+        const std::vector<chip_details>& chip_locations,
+        dlib::array<image_type2>& chips,
+        const interpolation_type& interp,
+        thread_pool& tp
+    )
+    {
+        impl::extract_image_chips(img, chip_locations, chips, interp, &tp);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -1967,6 +2148,20 @@ namespace dlib
         extract_image_chips(img, chip_locations, chips, interpolate_bilinear());
     }
 
+    template <
+        typename image_type1,
+        typename image_type2
+        >
+    void extract_image_chips(
+        const image_type1& img,
+        const std::vector<chip_details>& chip_locations,
+        dlib::array<image_type2>& chips,
+        thread_pool& tp
+    )
+    {
+        extract_image_chips(img, chip_locations, chips, interpolate_bilinear(), tp);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -6,6 +6,7 @@
 #include "../pixel.h"
 #include "../image_processing/full_object_detection_abstract.h"
 #include "../image_processing/generic_image.h"
+#include "../threads/thread_pool_extension_abstract.h"
 #include <array>
 
 namespace dlib
@@ -413,6 +414,44 @@ namespace dlib
             - Uses the bilinear interpolation to perform the necessary pixel interpolation.
     !*/
 
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename image_type1,
+        typename image_type2,
+        typename interpolation_type
+        >
+    void resize_image (
+        const image_type1& in_img,
+        image_type2& out_img,
+        const interpolation_type& interp,
+        thread_pool& tp
+    );
+    /*!
+        requires
+            - The same requirements as resize_image(in_img, out_img, interp).
+        ensures
+            - This function is identical to resize_image(in_img, out_img, interp) except
+              that the rows of #out_img are computed in parallel using the threads in tp.
+              The output is exactly the same.
+    !*/
+
+    template <
+        typename image_type1,
+        typename image_type2
+        >
+    void resize_image (
+        const image_type1& in_img,
+        image_type2& out_img,
+        thread_pool& tp
+    );
+    /*!
+        requires
+            - The same requirements as resize_image(in_img, out_img).
+        ensures
+            - performs: resize_image(in_img, out_img, interpolate_bilinear(), tp)
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -1278,6 +1317,44 @@ namespace dlib
               above-defined extract_image_chips() function using bilinear interpolation.
     !*/
 
+    template <
+        typename image_type1,
+        typename image_type2,
+        typename interpolation_type
+        >
+    void extract_image_chips (
+        const image_type1& img,
+        const std::vector<chip_details>& chip_locations,
+        dlib::array<image_type2>& chips,
+        const interpolation_type& interp,
+        thread_pool& tp
+    );
+    /*!
+        requires
+            - The same requirements as extract_image_chips(img, chip_locations, chips, interp).
+        ensures
+            - This function is identical to extract_image_chips(img, chip_locations,
+              chips, interp) except that the chips, and the image pyramid used to extract
+              the smaller ones, are computed in parallel using the threads in tp.  The
+              output is exactly the same.  This is useful for batches of many chips, like
+              all the faces found in an image, which get extracted at the same time.
+    !*/
+
+    template <
+        typename image_type1,
+        typename image_type2
+        >
+    void extract_image_chips (
+        const image_type1& img,
+        const std::vector<chip_details>& chip_locations,
+        dlib::array<image_type2>& chips,
+        thread_pool& tp
+    );
+    /*!
+        ensures
+            - performs: extract_image_chips(img, chip_locations, chips, interpolate_bilinear(), tp)
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
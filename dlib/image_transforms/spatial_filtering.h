@@ -11,7 +11,10 @@
 #include "../matrix.h"
 #include "../geometry/border_enumerator.h"
 #include "../simd.h"
+#include "../threads/parallel_for_extension.h"
 #include <limits>
+#include <vector>
+#include <type_traits>
 #include "assign_image.h"
 
 namespace dlib
@@ -415,6 +418,194 @@ namespace dlib
 
     namespace impl
     {
+        /*
+            The separable filtering routines below are built on the same scheme.  Each row
+            of the input image is filtered with the row filter into a ring buffer holding
+            the last col_filter.size() filtered rows, and as soon as the ring is full an
+            output row is made by filtering down its columns.  So only a few rows of
+            temporary data exist at any time, which stay in cache even for huge images.
+            Moreover, any range of output rows can be computed independently, by starting
+            the ring col_filter.size()-1 rows above it, which is how the work is split
+            over a thread pool.  The output doesn't depend on how the rows are split up.
+        */
+
+        template <
+            typename ring_row_type,
+            typename filter_row_type,
+            typename filter_columns_type
+            >
+        void separable_filter_rows (
+            long row_begin,
+            long row_end,
+            long first_row,
+            long col_filter_size,
+            const ring_row_type& ring_row,
+            const filter_row_type& filter_row,
+            const filter_columns_type& filter_columns
+        )
+        /*!
+            requires
+                - ring_row(i) returns a pointer to row i of a ring buffer with
+                  col_filter_size rows.
+                - filter_row(r, dst) filters input row r with the row filter and stores
+                  the result into dst.
+                - filter_columns(r, rows) makes output row r from the col_filter_size
+                  filtered input rows in rows.
+            ensures
+                - computes the output rows in the range [row_begin, row_end).
+        !*/
+        {
+            typedef typename std::remove_const<typename std::remove_pointer<decltype(ring_row(0))>::type>::type type;
+            std::vector<const type*> rows(col_filter_size);
+
+            const long first_in = row_begin - first_row;
+            const long last_in = row_end - first_row + col_filter_size - 1;
+            for (long t = first_in; t < last_in; ++t)
+            {
+                filter_row(t, ring_row(t%col_filter_size));
+                const long top = t - col_filter_size + 1;
+                if (top >= first_in)
+                {
+                    for (long m = 0; m < col_filter_size; ++m)
+                        rows[m] = ring_row((top+m)%col_filter_size);
+                    filter_columns(top + first_row, &rows[0]);
+                }
+            }
+        }
+
+        template <
+            typename funct
+            >
+        void separable_filter_for (
+            thread_pool* tp,
+            long row_begin,
+            long row_end,
+            const funct& f
+        )
+        {
+            if (row_begin >= row_end)
+                return;
+            if (tp)
+                parallel_for_blocked(*tp, row_begin, row_end, f);
+            else
+                f(row_begin, row_end);
+        }
+
+    // ------------------------------------------------------------------------------------
+
+        template <typename T, typename F>
+        inline void correlate_row (
+            const T* src,
+            long n,
+            const F* filter,
+            long filter_size,
+            T* dst
+        )
+        /*!
+            ensures
+                - for all 0 <= i < n: #dst[i] == sum over k of src[i+k]*filter[k]
+        !*/
+        {
+            for (long i = 0; i < n; ++i)
+            {
+                T temp;
+                temp = 0;
+                for (long k = 0; k < filter_size; ++k)
+                    temp += src[i+k]*filter[k];
+                dst[i] = temp;
+            }
+        }
+
+        template <typename T, typename F>
+        inline void correlate_columns (
+            const T* const* rows,
+            long offset,
+            long n,
+            const F* filter,
+            long filter_size,
+            T* dst
+        )
+        /*!
+            ensures
+                - for all 0 <= i < n: #dst[i] == sum over k of rows[k][offset+i]*filter[k]
+        !*/
+        {
+            for (long i = 0; i < n; ++i)
+                dst[i] = 0;
+            for (long k = 0; k < filter_size; ++k)
+            {
+                const T* row = rows[k] + offset;
+                for (long i = 0; i < n; ++i)
+                    dst[i] += row[i]*filter[k];
+            }
+        }
+
+        // The float and int32 versions do 8 outputs at a time.  They add up the products
+        // in the same order as the generic versions, so the results are identical.
+        template <typename T, typename simd_type>
+        inline void simd_correlate_row (
+            const T* src,
+            long n,
+            const T* filter,
+            long filter_size,
+            T* dst
+        )
+        {
+            long i = 0;
+            for (; i+8 <= n; i += 8)
+            {
+                simd_type temp = 0, p;
+                for (long k = 0; k < filter_size; ++k)
+                {
+                    p.load(src+i+k);
+                    temp += p*simd_type(filter[k]);
+                }
+                temp.store(dst+i);
+            }
+            correlate_row(src+i, n-i, filter, filter_size, dst+i);
+        }
+
+        template <typename T, typename simd_type>
+        inline void simd_correlate_columns (
+            const T* const* rows,
+            long offset,
+            long n,
+            const T* filter,
+            long filter_size,
+            T* dst
+        )
+        {
+            long i = 0;
+            for (; i+8 <= n; i += 8)
+            {
+                simd_type temp = 0, p;
+                for (long k = 0; k < filter_size; ++k)
+                {
+                    p.load(rows[k]+offset+i);
+                    temp += p*simd_type(filter[k]);
+                }
+                temp.store(dst+i);
+            }
+            for (; i < n; ++i)
+            {
+                T temp = 0;
+                for (long k = 0; k < filter_size; ++k)
+                    temp += rows[k][offset+i]*filter[k];
+                dst[i] = temp;
+            }
+        }
+
+        inline void correlate_row (const float* src, long n, const float* filter, long filter_size, float* dst)
+        { simd_correlate_row<float,simd8f>(src, n, filter, filter_size, dst); }
+        inline void correlate_row (const int32* src, long n, const int32* filter, long filter_size, int32* dst)
+        { simd_correlate_row<int32,simd8i>(src, n, filter, filter_size, dst); }
+        inline void correlate_columns (const float* const* rows, long offset, long n, const float* filter, long filter_size, float* dst)
+        { simd_correlate_columns<float,simd8f>(rows, offset, n, filter, filter_size, dst); }
+        inline void correlate_columns (const int32* const* rows, long offset, long n, const int32* filter, long filter_size, int32* dst)
+        { simd_correlate_columns<int32,simd8i>(rows, offset, n, filter, filter_size, dst); }
+
+    // ------------------------------------------------------------------------------------
+
         template <
             typename in_image_type,
             typename out_image_type,
@@ -429,24 +620,27 @@ namespace dlib
             const matrix_exp<EXP2>& _col_filter,
             T scale,
             bool use_abs,
-            bool add_to 
+            bool add_to,
+            thread_pool* tp = nullptr
         )
         {
-            const_temp_matrix<EXP1> row_filter(_row_filter);
-            const_temp_matrix<EXP2> col_filter(_col_filter);
+            typedef typename EXP1::type ptype;
+            typedef typename EXP2::type ctype;
+            const matrix<ptype,0,1> row_filter(reshape_to_column_vector(_row_filter));
+            const matrix<ctype,0,1> col_filter(reshape_to_column_vector(_col_filter));
             COMPILE_TIME_ASSERT( pixel_traits<typename image_traits<in_image_type>::pixel_type>::has_alpha == false );
             COMPILE_TIME_ASSERT( pixel_traits<typename image_traits<out_image_type>::pixel_type>::has_alpha == false );
 
             DLIB_ASSERT(scale != 0 && row_filter.size() != 0 && col_filter.size() != 0 &&
-                is_vector(row_filter) &&
-                is_vector(col_filter),
+                is_vector(_row_filter) &&
+                is_vector(_col_filter),
                 "\trectangle spatially_filter_image_separable()"
                 << "\n\t Invalid inputs were given to this function."
                 << "\n\t scale: "<< scale
                 << "\n\t row_filter.size(): "<< row_filter.size()
                 << "\n\t col_filter.size(): "<< col_filter.size()
-                << "\n\t is_vector(row_filter): "<< is_vector(row_filter)
-                << "\n\t is_vector(col_filter): "<< is_vector(col_filter)
+                << "\n\t is_vector(row_filter): "<< is_vector(_row_filter)
+                << "\n\t is_vector(col_filter): "<< is_vector(_col_filter)
             );
             DLIB_ASSERT(is_same_object(in_img_, out_img_) == false,
                 "\trectangle spatially_filter_image_separable()"
@@ -477,242 +671,478 @@ namespace dlib
             if (!add_to)
                 zero_border_pixels(out_img, non_border); 
 
-            typedef typename EXP1::type ptype;
+            const long nc = in_img.nc();
+            const long num = last_col - first_col;
+            if (num <= 0)
+                return non_border;
+
+            separable_filter_for(tp, first_row, last_row, [&](long row_begin, long row_end)
+            {
+                // Each block of rows gets its own ring buffer.  As before, the pixels are
+                // converted to the row filter's type and both filters accumulate in that
+                // type, so the output is the same as filtering the whole image at once.
+                std::vector<ptype> ring(col_filter.size()*nc), src(nc), sums(num);
+
+                separable_filter_rows(row_begin, row_end, first_row, col_filter.size(),
+                    [&](long i) { return &ring[i*nc]; },
+                    [&](long r, ptype* dst)
+                    {
+                        for (long c = 0; c < nc; ++c)
+                            src[c] = get_pixel_intensity(in_img[r][c]);
+                        correlate_row(&src[0], num, &row_filter(0), row_filter.size(), dst+first_col);
+                    },
+                    [&](long r, const ptype* const* rows)
+                    {
+                        correlate_columns(rows, first_col, num, &col_filter(0), col_filter.size(), &sums[0]);
+                        for (long c = first_col; c < last_col; ++c)
+                        {
+                            ptype temp = sums[c-first_col];
+                            temp /= scale;
+
+                            if (use_abs && temp < 0)
+                            {
+                                temp = -temp;
+                            }
+
+                            // save this pixel to the output image
+                            if (add_to == false)
+                            {
+                                assign_pixel(out_img[r][c], temp);
+                            }
+                            else
+                            {
+                                assign_pixel(out_img[r][c], temp + out_img[r][c]);
+                            }
+                        }
+                    });
+            });
+            return non_border;
+        }
+
+    } // namespace impl
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename in_image_type,
+        typename out_image_type,
+        typename EXP1,
+        typename EXP2
+        >
+    struct is_float_filtering
+    {
+        const static bool value = is_same_type<typename image_traits<in_image_type>::pixel_type,float>::value &&
+                                  is_same_type<typename image_traits<out_image_type>::pixel_type,float>::value &&
+                                  is_same_type<typename EXP1::type,float>::value &&
+                                  is_same_type<typename EXP2::type,float>::value;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    namespace impl
+    {
+        template <
+            typename in_image_type,
+            typename out_image_type,
+            typename EXP1,
+            typename EXP2
+            >
+        rectangle float_spatially_filter_image_separable (
+            const in_image_type& in_img_,
+            out_image_type& out_img_,
+            const matrix_exp<EXP1>& _row_filter,
+            const matrix_exp<EXP2>& _col_filter,
+            out_image_type* scratch_,
+            bool add_to,
+            thread_pool* tp
+        )
+        {
+            // You can only use this function with images and filters containing float
+            // variables.
+            COMPILE_TIME_ASSERT((is_float_filtering<in_image_type,out_image_type,EXP1,EXP2>::value == true));
+
+
+            const_temp_matrix<EXP1> row_filter(_row_filter);
+            const_temp_matrix<EXP2> col_filter(_col_filter);
+            DLIB_ASSERT(row_filter.size() != 0 && col_filter.size() != 0 &&
+                is_vector(row_filter) &&
+                is_vector(col_filter),
+                "\trectangle float_spatially_filter_image_separable()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t row_filter.size(): "<< row_filter.size()
+                << "\n\t col_filter.size(): "<< col_filter.size()
+                << "\n\t is_vector(row_filter): "<< is_vector(row_filter)
+                << "\n\t is_vector(col_filter): "<< is_vector(col_filter)
+            );
+            DLIB_ASSERT(is_same_object(in_img_, out_img_) == false,
+                "\trectangle float_spatially_filter_image_separable()"
+                << "\n\tYou must give two different image objects"
+            );
+
 
-            array2d<ptype> temp_img;
-            temp_img.set_size(in_img.nr(), in_img.nc());
+            const_image_view<in_image_type> in_img(in_img_);
+            image_view<out_image_type> out_img(out_img_);
 
-            // apply the row filter
-            for (long r = 0; r < in_img.nr(); ++r)
+            // if there isn't any input image then don't do anything
+            if (in_img.size() == 0)
             {
-                for (long c = first_col; c < last_col; ++c)
+                out_img.clear();
+                return rectangle();
+            }
+
+            out_img.set_size(in_img.nr(),in_img.nc());
+
+            // figure out the range that we should apply the filter to
+            const long first_row = col_filter.size()/2;
+            const long first_col = row_filter.size()/2;
+            const long last_row = in_img.nr() - ((col_filter.size()-1)/2);
+            const long last_col = in_img.nc() - ((row_filter.size()-1)/2);
+
+            const rectangle non_border = rectangle(first_col, first_row, last_col-1, last_row-1);
+            if (!add_to)
+                zero_border_pixels(out_img, non_border); 
+
+            const auto filter_row = [&](long r, float* dst)
+            {
+                long c = first_col;
+                for (; c < last_col-7; c+=8)
                 {
-                    ptype p;
-                    ptype temp = 0;
+                    simd8f p,p2,p3, temp = 0, temp2=0, temp3=0;
+                    long n = 0;
+                    for (; n < row_filter.size()-2; n+=3)
+                    {
+                        // pull out the current pixel and put it into p
+                        p.load(&in_img[r][c-first_col+n]);
+                        p2.load(&in_img[r][c-first_col+n+1]);
+                        p3.load(&in_img[r][c-first_col+n+2]);
+                        temp += p*row_filter(n);
+                        temp2 += p2*row_filter(n+1);
+                        temp3 += p3*row_filter(n+2);
+                    }
+                    for (; n < row_filter.size(); ++n)
+                    {
+                        // pull out the current pixel and put it into p
+                        p.load(&in_img[r][c-first_col+n]);
+                        temp += p*row_filter(n);
+                    }
+                    temp += temp2 + temp3;
+                    temp.store(dst+c);
+                }
+                for (; c < last_col; ++c)
+                {
+                    float p;
+                    float temp = 0;
                     for (long n = 0; n < row_filter.size(); ++n)
                     {
                         // pull out the current pixel and put it into p
-                        p = get_pixel_intensity(in_img[r][c-first_col+n]);
+                        p = in_img[r][c-first_col+n];
                         temp += p*row_filter(n);
                     }
-                    temp_img[r][c] = temp;
+                    dst[c] = temp;
                 }
-            }
+            };
 
-            // apply the column filter 
-            for (long r = first_row; r < last_row; ++r)
+            const auto filter_columns = [&](long r, const float* const* rows)
             {
-                for (long c = first_col; c < last_col; ++c)
+                long c = first_col;
+                for (; c < last_col-7; c+=8)
                 {
-                    ptype temp = 0;
-                    for (long m = 0; m < col_filter.size(); ++m)
+                    simd8f p, p2, p3, temp = 0, temp2 = 0, temp3 = 0;
+                    long m = 0;
+                    for (; m < col_filter.size()-2; m+=3)
                     {
-                        temp += temp_img[r-first_row+m][c]*col_filter(m);
+                        p.load(rows[m]+c);
+                        p2.load(rows[m+1]+c);
+                        p3.load(rows[m+2]+c);
+                        temp += p*col_filter(m);
+                        temp2 += p2*col_filter(m+1);
+                        temp3 += p3*col_filter(m+2);
                     }
+                    for (; m < col_filter.size(); ++m)
+                    {
+                        p.load(rows[m]+c);
+                        temp += p*col_filter(m);
+                    }
+                    temp += temp2+temp3;
 
-                    temp /= scale;
-
-                    if (use_abs && temp < 0)
+                    // save this pixel to the output image
+                    if (add_to == false)
                     {
-                        temp = -temp;
+                        temp.store(&out_img[r][c]);
+                    }
+                    else
+                    {
+                        p.load(&out_img[r][c]);
+                        temp += p;
+                        temp.store(&out_img[r][c]);
+                    }
+                }
+                for (; c < last_col; ++c)
+                {
+                    float temp = 0;
+                    for (long m = 0; m < col_filter.size(); ++m)
+                    {
+                        temp += rows[m][c]*col_filter(m);
                     }
 
                     // save this pixel to the output image
                     if (add_to == false)
                     {
-                        assign_pixel(out_img[r][c], temp);
+                        out_img[r][c] = temp;
                     }
                     else
                     {
-                        assign_pixel(out_img[r][c], temp + out_img[r][c]);
+                        out_img[r][c] += temp;
                     }
                 }
+            };
+
+            if (last_col <= first_col || last_row <= first_row)
+                return non_border;
+
+            if (scratch_)
+            {
+                // The caller's scratch image holds the ring buffer.
+                image_view<out_image_type> scratch(*scratch_);
+                scratch.set_size(col_filter.size(), in_img.nc());
+                separable_filter_rows(first_row, last_row, first_row, col_filter.size(),
+                    [&](long i) { return &scratch[i][0]; }, filter_row, filter_columns);
+            }
+            else
+            {
+                const long nc = in_img.nc();
+                separable_filter_for(tp, first_row, last_row, [&](long row_begin, long row_end)
+                {
+                    std::vector<float> ring(col_filter.size()*nc);
+                    separable_filter_rows(row_begin, row_end, first_row, col_filter.size(),
+                        [&](long i) { return &ring[i*nc]; }, filter_row, filter_columns);
+                });
             }
             return non_border;
         }
-
-    } // namespace impl
+    }
 
 // ----------------------------------------------------------------------------------------
 
+    // This overload is optimized to use SIMD instructions when filtering float images with
+    // float filters.
     template <
         typename in_image_type,
         typename out_image_type,
         typename EXP1,
         typename EXP2
         >
-    struct is_float_filtering
+    rectangle float_spatially_filter_image_separable (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        const matrix_exp<EXP1>& row_filter,
+        const matrix_exp<EXP2>& col_filter,
+        out_image_type& scratch,
+        bool add_to = false
+    )
     {
-        const static bool value = is_same_type<typename image_traits<in_image_type>::pixel_type,float>::value &&
-                                  is_same_type<typename image_traits<out_image_type>::pixel_type,float>::value &&
-                                  is_same_type<typename EXP1::type,float>::value &&
-                                  is_same_type<typename EXP2::type,float>::value;
-    };
+        return impl::float_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, &scratch, add_to, nullptr);
+    }
 
 // ----------------------------------------------------------------------------------------
 
-    // This overload is optimized to use SIMD instructions when filtering float images with
-    // float filters.
     template <
         typename in_image_type,
         typename out_image_type,
         typename EXP1,
-        typename EXP2
+        typename EXP2,
+        typename T
         >
-    rectangle float_spatially_filter_image_separable (
-        const in_image_type& in_img_,
-        out_image_type& out_img_,
-        const matrix_exp<EXP1>& _row_filter,
-        const matrix_exp<EXP2>& _col_filter,
-        out_image_type& scratch_,
+    typename enable_if_c<pixel_traits<typename image_traits<out_image_type>::pixel_type>::grayscale && 
+                         is_float_filtering<in_image_type,out_image_type,EXP1,EXP2>::value,rectangle>::type 
+    spatially_filter_image_separable (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        const matrix_exp<EXP1>& row_filter,
+        const matrix_exp<EXP2>& col_filter,
+        T scale,
+        bool use_abs = false,
         bool add_to = false
     )
     {
-        // You can only use this function with images and filters containing float
-        // variables.
-        COMPILE_TIME_ASSERT((is_float_filtering<in_image_type,out_image_type,EXP1,EXP2>::value == true));
+        if (use_abs == false)
+        {
+            if (scale == 1)
+                return impl::float_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, (out_image_type*)nullptr, add_to, nullptr);
+            else
+                return impl::float_spatially_filter_image_separable(in_img, out_img, row_filter/scale, col_filter, (out_image_type*)nullptr, add_to, nullptr);
+        }
+        else
+        {
+            return impl::grayscale_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, scale, true, add_to);
+        }
+    }
 
+// ----------------------------------------------------------------------------------------
 
-        const_temp_matrix<EXP1> row_filter(_row_filter);
-        const_temp_matrix<EXP2> col_filter(_col_filter);
-        DLIB_ASSERT(row_filter.size() != 0 && col_filter.size() != 0 &&
-            is_vector(row_filter) &&
-            is_vector(col_filter),
-            "\trectangle float_spatially_filter_image_separable()"
-            << "\n\t Invalid inputs were given to this function."
-            << "\n\t row_filter.size(): "<< row_filter.size()
-            << "\n\t col_filter.size(): "<< col_filter.size()
-            << "\n\t is_vector(row_filter): "<< is_vector(row_filter)
-            << "\n\t is_vector(col_filter): "<< is_vector(col_filter)
-        );
-        DLIB_ASSERT(is_same_object(in_img_, out_img_) == false,
-            "\trectangle float_spatially_filter_image_separable()"
-            << "\n\tYou must give two different image objects"
-        );
+    template <
+        typename in_image_type,
+        typename out_image_type,
+        typename EXP1,
+        typename EXP2,
+        typename T
+        >
+    typename enable_if_c<pixel_traits<typename image_traits<out_image_type>::pixel_type>::grayscale && 
+                         !is_float_filtering<in_image_type,out_image_type,EXP1,EXP2>::value,rectangle>::type 
+    spatially_filter_image_separable (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        const matrix_exp<EXP1>& row_filter,
+        const matrix_exp<EXP2>& col_filter,
+        T scale,
+        bool use_abs = false,
+        bool add_to = false
+    )
+    {
+        return impl::grayscale_spatially_filter_image_separable(in_img,out_img, row_filter, col_filter, scale, use_abs, add_to);
+    }
 
+// ----------------------------------------------------------------------------------------
 
-        const_image_view<in_image_type> in_img(in_img_);
-        image_view<out_image_type> out_img(out_img_);
+    namespace impl
+    {
+        template <
+            typename in_image_type,
+            typename out_image_type,
+            typename EXP1,
+            typename EXP2,
+            typename T
+            >
+        rectangle color_spatially_filter_image_separable (
+            const in_image_type& in_img_,
+            out_image_type& out_img_,
+            const matrix_exp<EXP1>& _row_filter,
+            const matrix_exp<EXP2>& _col_filter,
+            T scale,
+            thread_pool* tp
+        )
+        {
+            typedef typename EXP1::type ftype;
+            const matrix<ftype,0,1> row_filter(reshape_to_column_vector(_row_filter));
+            const matrix<typename EXP2::type,0,1> col_filter(reshape_to_column_vector(_col_filter));
+            COMPILE_TIME_ASSERT( pixel_traits<typename image_traits<in_image_type>::pixel_type>::has_alpha == false );
+            COMPILE_TIME_ASSERT( pixel_traits<typename image_traits<out_image_type>::pixel_type>::has_alpha == false );
+
+            DLIB_ASSERT(scale != 0 && row_filter.size() != 0 && col_filter.size() != 0 &&
+                        is_vector(_row_filter) &&
+                        is_vector(_col_filter),
+                "\trectangle spatially_filter_image_separable()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t scale: "<< scale
+                << "\n\t row_filter.size(): "<< row_filter.size()
+                << "\n\t col_filter.size(): "<< col_filter.size()
+                << "\n\t is_vector(row_filter): "<< is_vector(_row_filter)
+                << "\n\t is_vector(col_filter): "<< is_vector(_col_filter)
+                );
+            DLIB_ASSERT(is_same_object(in_img_, out_img_) == false,
+                "\trectangle spatially_filter_image_separable()"
+                << "\n\tYou must give two different image objects"
+                );
+
+
+            const_image_view<in_image_type> in_img(in_img_);
+            image_view<out_image_type> out_img(out_img_);
+
+            // if there isn't any input image then don't do anything
+            if (in_img.size() == 0)
+            {
+                out_img.clear();
+                return rectangle();
+            }
 
-        // if there isn't any input image then don't do anything
-        if (in_img.size() == 0)
-        {
-            out_img.clear();
-            return rectangle();
-        }
+            out_img.set_size(in_img.nr(),in_img.nc());
 
-        out_img.set_size(in_img.nr(),in_img.nc());
 
-        // figure out the range that we should apply the filter to
-        const long first_row = col_filter.size()/2;
-        const long first_col = row_filter.size()/2;
-        const long last_row = in_img.nr() - ((col_filter.size()-1)/2);
-        const long last_col = in_img.nc() - ((row_filter.size()-1)/2);
+            // figure out the range that we should apply the filter to
+            const long first_row = col_filter.size()/2;
+            const long first_col = row_filter.size()/2;
+            const long last_row = in_img.nr() - ((col_filter.size()-1)/2);
+            const long last_col = in_img.nc() - ((row_filter.size()-1)/2);
 
-        const rectangle non_border = rectangle(first_col, first_row, last_col-1, last_row-1);
-        if (!add_to)
+            const rectangle non_border = rectangle(first_col, first_row, last_col-1, last_row-1);
             zero_border_pixels(out_img, non_border); 
 
-        image_view<out_image_type> scratch(scratch_);
-        scratch.set_size(in_img.nr(), in_img.nc());
+            typedef typename image_traits<in_image_type>::pixel_type pixel_type;
+            typedef matrix<ftype,pixel_traits<pixel_type>::num,1> ptype;
 
-        // apply the row filter
-        for (long r = 0; r < in_img.nr(); ++r)
-        {
-            long c = first_col;
-            for (; c < last_col-7; c+=8)
-            {
-                simd8f p,p2,p3, temp = 0, temp2=0, temp3=0;
-                long n = 0;
-                for (; n < row_filter.size()-2; n+=3)
-                {
-                    // pull out the current pixel and put it into p
-                    p.load(&in_img[r][c-first_col+n]);
-                    p2.load(&in_img[r][c-first_col+n+1]);
-                    p3.load(&in_img[r][c-first_col+n+2]);
-                    temp += p*row_filter(n);
-                    temp2 += p2*row_filter(n+1);
-                    temp3 += p3*row_filter(n+2);
-                }
-                for (; n < row_filter.size(); ++n)
-                {
-                    // pull out the current pixel and put it into p
-                    p.load(&in_img[r][c-first_col+n]);
-                    temp += p*row_filter(n);
-                }
-                temp += temp2 + temp3;
-                temp.store(&scratch[r][c]);
-            }
-            for (; c < last_col; ++c)
-            {
-                float p;
-                float temp = 0;
-                for (long n = 0; n < row_filter.size(); ++n)
-                {
-                    // pull out the current pixel and put it into p
-                    p = in_img[r][c-first_col+n];
-                    temp += p*row_filter(n);
-                }
-                scratch[r][c] = temp;
-            }
-        }
+            const long nc = in_img.nc();
+            const long num = last_col - first_col;
+            if (num <= 0)
+                return non_border;
 
-        // apply the column filter 
-        for (long r = first_row; r < last_row; ++r)
-        {
-            long c = first_col;
-            for (; c < last_col-7; c+=8)
+            separable_filter_for(tp, first_row, last_row, [&](long row_begin, long row_end)
             {
-                simd8f p, p2, p3, temp = 0, temp2 = 0, temp3 = 0;
-                long m = 0;
-                for (; m < col_filter.size()-2; m+=3)
-                {
-                    p.load(&scratch[r-first_row+m][c]);
-                    p2.load(&scratch[r-first_row+m+1][c]);
-                    p3.load(&scratch[r-first_row+m+2][c]);
-                    temp += p*col_filter(m);
-                    temp2 += p2*col_filter(m+1);
-                    temp3 += p3*col_filter(m+2);
-                }
-                for (; m < col_filter.size(); ++m)
-                {
-                    p.load(&scratch[r-first_row+m][c]);
-                    temp += p*col_filter(m);
-                }
-                temp += temp2+temp3;
+                std::vector<ptype> ring(col_filter.size()*nc), src(nc), sums(num);
 
-                // save this pixel to the output image
-                if (add_to == false)
-                {
-                    temp.store(&out_img[r][c]);
-                }
-                else
-                {
-                    p.load(&out_img[r][c]);
-                    temp += p;
-                    temp.store(&out_img[r][c]);
-                }
-            }
-            for (; c < last_col; ++c)
-            {
-                float temp = 0;
-                for (long m = 0; m < col_filter.size(); ++m)
-                {
-                    temp += scratch[r-first_row+m][c]*col_filter(m);
-                }
+                separable_filter_rows(row_begin, row_end, first_row, col_filter.size(),
+                    [&](long i) { return &ring[i*nc]; },
+                    [&](long r, ptype* dst)
+                    {
+                        for (long c = 0; c < nc; ++c)
+                            src[c] = pixel_to_vector<ftype>(in_img[r][c]);
+                        correlate_row(&src[0], num, &row_filter(0), row_filter.size(), dst+first_col);
+                    },
+                    [&](long r, const ptype* const* rows)
+                    {
+                        correlate_columns(rows, first_col, num, &col_filter(0), col_filter.size(), &sums[0]);
+                        for (long c = first_col; c < last_col; ++c)
+                        {
+                            ptype temp = sums[c-first_col];
+                            temp /= scale;
 
-                // save this pixel to the output image
-                if (add_to == false)
-                {
-                    out_img[r][c] = temp;
-                }
-                else
-                {
-                    out_img[r][c] += temp;
-                }
-            }
+                            // save this pixel to the output image
+                            pixel_type p;
+                            vector_to_pixel(p, temp);
+                            assign_pixel(out_img[r][c], p);
+                        }
+                    });
+            });
+            return non_border;
         }
-        return non_border;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename in_image_type,
+        typename out_image_type,
+        typename EXP1,
+        typename EXP2,
+        typename T
+        >
+    typename disable_if_c<pixel_traits<typename image_traits<out_image_type>::pixel_type>::grayscale,rectangle>::type 
+    spatially_filter_image_separable (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        const matrix_exp<EXP1>& row_filter,
+        const matrix_exp<EXP2>& col_filter,
+        T scale
+    )
+    {
+        return impl::color_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, scale, nullptr);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename in_image_type,
+        typename out_image_type,
+        typename EXP1,
+        typename EXP2
+        >
+    rectangle spatially_filter_image_separable (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        const matrix_exp<EXP1>& row_filter,
+        const matrix_exp<EXP2>& col_filter
+    )
+    {
+        return spatially_filter_image_separable(in_img,out_img,row_filter,col_filter,1);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -732,26 +1162,24 @@ namespace dlib
         const matrix_exp<EXP1>& row_filter,
         const matrix_exp<EXP2>& col_filter,
         T scale,
-        bool use_abs = false,
-        bool add_to = false
+        bool use_abs,
+        bool add_to,
+        thread_pool& tp
     )
     {
         if (use_abs == false)
         {
-            out_image_type scratch;
             if (scale == 1)
-                return float_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, scratch, add_to);
+                return impl::float_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, (out_image_type*)nullptr, add_to, &tp);
             else
-                return float_spatially_filter_image_separable(in_img, out_img, row_filter/scale, col_filter, scratch,  add_to);
+                return impl::float_spatially_filter_image_separable(in_img, out_img, row_filter/scale, col_filter, (out_image_type*)nullptr, add_to, &tp);
         }
         else
         {
-            return impl::grayscale_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, scale, true, add_to);
+            return impl::grayscale_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, scale, true, add_to, &tp);
         }
     }
 
-// ----------------------------------------------------------------------------------------
-
     template <
         typename in_image_type,
         typename out_image_type,
@@ -767,15 +1195,14 @@ namespace dlib
         const matrix_exp<EXP1>& row_filter,
         const matrix_exp<EXP2>& col_filter,
         T scale,
-        bool use_abs = false,
-        bool add_to = false
+        bool use_abs,
+        bool add_to,
+        thread_pool& tp
     )
     {
-        return impl::grayscale_spatially_filter_image_separable(in_img,out_img, row_filter, col_filter, scale, use_abs, add_to);
+        return impl::grayscale_spatially_filter_image_separable(in_img,out_img, row_filter, col_filter, scale, use_abs, add_to, &tp);
     }
 
-// ----------------------------------------------------------------------------------------
-
     template <
         typename in_image_type,
         typename out_image_type,
@@ -783,123 +1210,37 @@ namespace dlib
         typename EXP2,
         typename T
         >
-    typename disable_if_c<pixel_traits<typename image_traits<out_image_type>::pixel_type>::grayscale,rectangle>::type 
+    typename enable_if_c<pixel_traits<typename image_traits<out_image_type>::pixel_type>::grayscale,rectangle>::type 
     spatially_filter_image_separable (
-        const in_image_type& in_img_,
-        out_image_type& out_img_,
-        const matrix_exp<EXP1>& _row_filter,
-        const matrix_exp<EXP2>& _col_filter,
-        T scale
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        const matrix_exp<EXP1>& row_filter,
+        const matrix_exp<EXP2>& col_filter,
+        T scale,
+        thread_pool& tp
     )
     {
-        const_temp_matrix<EXP1> row_filter(_row_filter);
-        const_temp_matrix<EXP2> col_filter(_col_filter);
-        COMPILE_TIME_ASSERT( pixel_traits<typename image_traits<in_image_type>::pixel_type>::has_alpha == false );
-        COMPILE_TIME_ASSERT( pixel_traits<typename image_traits<out_image_type>::pixel_type>::has_alpha == false );
-
-        DLIB_ASSERT(scale != 0 && row_filter.size() != 0 && col_filter.size() != 0 &&
-                    is_vector(row_filter) &&
-                    is_vector(col_filter),
-            "\trectangle spatially_filter_image_separable()"
-            << "\n\t Invalid inputs were given to this function."
-            << "\n\t scale: "<< scale
-            << "\n\t row_filter.size(): "<< row_filter.size()
-            << "\n\t col_filter.size(): "<< col_filter.size()
-            << "\n\t is_vector(row_filter): "<< is_vector(row_filter)
-            << "\n\t is_vector(col_filter): "<< is_vector(col_filter)
-            );
-        DLIB_ASSERT(is_same_object(in_img_, out_img_) == false,
-            "\trectangle spatially_filter_image_separable()"
-            << "\n\tYou must give two different image objects"
-            );
-
-
-        const_image_view<in_image_type> in_img(in_img_);
-        image_view<out_image_type> out_img(out_img_);
-
-        // if there isn't any input image then don't do anything
-        if (in_img.size() == 0)
-        {
-            out_img.clear();
-            return rectangle();
-        }
-
-        out_img.set_size(in_img.nr(),in_img.nc());
-
-
-        // figure out the range that we should apply the filter to
-        const long first_row = col_filter.size()/2;
-        const long first_col = row_filter.size()/2;
-        const long last_row = in_img.nr() - ((col_filter.size()-1)/2);
-        const long last_col = in_img.nc() - ((row_filter.size()-1)/2);
-
-        const rectangle non_border = rectangle(first_col, first_row, last_col-1, last_row-1);
-        zero_border_pixels(out_img, non_border); 
-
-        typedef typename image_traits<in_image_type>::pixel_type pixel_type;
-        typedef matrix<typename EXP1::type,pixel_traits<pixel_type>::num,1> ptype;
-
-        array2d<ptype> temp_img;
-        temp_img.set_size(in_img.nr(), in_img.nc());
-
-        // apply the row filter
-        for (long r = 0; r < in_img.nr(); ++r)
-        {
-            for (long c = first_col; c < last_col; ++c)
-            {
-                ptype p;
-                ptype temp;
-                temp = 0;
-                for (long n = 0; n < row_filter.size(); ++n)
-                {
-                    // pull out the current pixel and put it into p
-                    p = pixel_to_vector<typename EXP1::type>(in_img[r][c-first_col+n]);
-                    temp += p*row_filter(n);
-                }
-                temp_img[r][c] = temp;
-            }
-        }
-
-        // apply the column filter 
-        for (long r = first_row; r < last_row; ++r)
-        {
-            for (long c = first_col; c < last_col; ++c)
-            {
-                ptype temp;
-                temp = 0;
-                for (long m = 0; m < col_filter.size(); ++m)
-                {
-                    temp += temp_img[r-first_row+m][c]*col_filter(m);
-                }
-
-                temp /= scale;
-
-
-                // save this pixel to the output image
-                pixel_type p;
-                vector_to_pixel(p, temp);
-                assign_pixel(out_img[r][c], p);
-            }
-        }
-        return non_border;
+        return spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, scale, false, false, tp);
     }
 
-// ----------------------------------------------------------------------------------------
-
     template <
         typename in_image_type,
         typename out_image_type,
         typename EXP1,
-        typename EXP2
+        typename EXP2,
+        typename T
         >
-    rectangle spatially_filter_image_separable (
+    typename disable_if_c<pixel_traits<typename image_traits<out_image_type>::pixel_type>::grayscale,rectangle>::type 
+    spatially_filter_image_separable (
         const in_image_type& in_img,
         out_image_type& out_img,
         const matrix_exp<EXP1>& row_filter,
-        const matrix_exp<EXP2>& col_filter
+        const matrix_exp<EXP2>& col_filter,
+        T scale,
+        thread_pool& tp
     )
     {
-        return spatially_filter_image_separable(in_img,out_img,row_filter,col_filter,1);
+        return impl::color_spatially_filter_image_separable(in_img, out_img, row_filter, col_filter, scale, &tp);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -1214,6 +1555,57 @@ namespace dlib
 
 // ----------------------------------------------------------------------------------------
 
+    namespace impl
+    {
+        template <
+            typename in_image_type,
+            typename out_image_type
+            >
+        rectangle gaussian_blur (
+            const in_image_type& in_img,
+            out_image_type& out_img,
+            double sigma,
+            int max_size,
+            thread_pool* tp
+        )
+        {
+            DLIB_ASSERT(sigma > 0 && max_size > 0 && (max_size%2)==1 &&
+                        is_same_object(in_img, out_img) == false,
+                "\t void gaussian_blur()"
+                << "\n\t Invalid inputs were given to this function."
+                << "\n\t sigma: " << sigma 
+                << "\n\t max_size:  " << max_size 
+                << "\n\t is_same_object(in_img,out_img): " << is_same_object(in_img,out_img) 
+            );
+
+            if (sigma < 18)
+            {
+                typedef typename pixel_traits<typename image_traits<out_image_type>::pixel_type>::basic_pixel_type type;
+                typedef typename promote<type>::type ptype;
+                const matrix<ptype,0,1>& filt = create_gaussian_filter<ptype>(sigma, max_size);
+                ptype scale = sum(filt);
+                scale = scale*scale;
+                if (tp)
+                    return spatially_filter_image_separable(in_img, out_img, filt, filt, scale, *tp);
+                else
+                    return spatially_filter_image_separable(in_img, out_img, filt, filt, scale);
+            }
+            else
+            {
+                // For large sigma we need to use a type with a lot of precision to avoid
+                // numerical problems.  So we use double here.
+                typedef double ptype;
+                const matrix<ptype,0,1>& filt = create_gaussian_filter<ptype>(sigma, max_size);
+                ptype scale = sum(filt);
+                scale = scale*scale;
+                if (tp)
+                    return spatially_filter_image_separable(in_img, out_img, filt, filt, scale, *tp);
+                else
+                    return spatially_filter_image_separable(in_img, out_img, filt, filt, scale);
+            }
+        }
+    }
+
     template <
         typename in_image_type,
         typename out_image_type
@@ -1225,35 +1617,22 @@ namespace dlib
         int max_size = 1001
     )
     {
-        DLIB_ASSERT(sigma > 0 && max_size > 0 && (max_size%2)==1 &&
-                    is_same_object(in_img, out_img) == false,
-            "\t void gaussian_blur()"
-            << "\n\t Invalid inputs were given to this function."
-            << "\n\t sigma: " << sigma 
-            << "\n\t max_size:  " << max_size 
-            << "\n\t is_same_object(in_img,out_img): " << is_same_object(in_img,out_img) 
-        );
-
-        if (sigma < 18)
-        {
-            typedef typename pixel_traits<typename image_traits<out_image_type>::pixel_type>::basic_pixel_type type;
-            typedef typename promote<type>::type ptype;
-            const matrix<ptype,0,1>& filt = create_gaussian_filter<ptype>(sigma, max_size);
-            ptype scale = sum(filt);
-            scale = scale*scale;
-            return spatially_filter_image_separable(in_img, out_img, filt, filt, scale);
-        }
-        else
-        {
-            // For large sigma we need to use a type with a lot of precision to avoid
-            // numerical problems.  So we use double here.
-            typedef double ptype;
-            const matrix<ptype,0,1>& filt = create_gaussian_filter<ptype>(sigma, max_size);
-            ptype scale = sum(filt);
-            scale = scale*scale;
-            return spatially_filter_image_separable(in_img, out_img, filt, filt, scale);
-        }
+        return impl::gaussian_blur(in_img, out_img, sigma, max_size, nullptr);
+    }
 
+    template <
+        typename in_image_type,
+        typename out_image_type
+        >
+    rectangle gaussian_blur (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        double sigma,
+        int max_size,
+        thread_pool& tp
+    )
+    {
+        return impl::gaussian_blur(in_img, out_img, sigma, max_size, &tp);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 #include "../pixel.h"
 #include "../matrix.h"
 #include "../image_processing/generic_image.h"
+#include "../threads/thread_pool_extension_abstract.h"
 
 namespace dlib
 {
@@ -71,6 +72,61 @@ namespace dlib
                   you can use this form of the function it can give a decent speed boost.
     !*/
 
+    template <
+        typename in_image_type,
+        typename out_image_type,
+        typename EXP1,
+        typename EXP2,
+        typename T
+        >
+    rectangle spatially_filter_image_separable (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        const matrix_exp<EXP1>& row_filter,
+        const matrix_exp<EXP2>& col_filter,
+        T scale,
+        bool use_abs,
+        bool add_to,
+        thread_pool& tp
+    );
+    /*!
+        requires
+            - The same requirements as the above spatially_filter_image_separable() apply,
+              except that in_img must contain grayscale pixels.
+        ensures
+            - performs: return spatially_filter_image_separable(in_img, out_img,
+              row_filter, col_filter, scale, use_abs, add_to);
+              except that the rows of out_img are split into stripes that are filtered in
+              parallel by the threads in tp.  The output is exactly the same as the serial
+              version's.
+    !*/
+
+    template <
+        typename in_image_type,
+        typename out_image_type,
+        typename EXP1,
+        typename EXP2,
+        typename T
+        >
+    rectangle spatially_filter_image_separable (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        const matrix_exp<EXP1>& row_filter,
+        const matrix_exp<EXP2>& col_filter,
+        T scale,
+        thread_pool& tp
+    );
+    /*!
+        requires
+            - The same requirements as the above spatially_filter_image_separable() apply.
+        ensures
+            - performs: return spatially_filter_image_separable(in_img, out_img,
+              row_filter, col_filter, scale);
+              except that the rows of out_img are split into stripes that are filtered in
+              parallel by the threads in tp.  The output is exactly the same as the serial
+              version's.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -174,12 +230,15 @@ namespace dlib
               filters.  In fact, spatially_filter_image_separable() invokes
               float_spatially_filter_image_separable() in those cases.  So why is
               float_spatially_filter_image_separable() in the public API?  The reason is
-              because the separable filtering routines internally allocate an image each
-              time they are called.  If you want to avoid this memory allocation then you
-              can call float_spatially_filter_image_separable() and provide the scratch
-              image as input.  This allows you to reuse the same scratch image for many
-              calls to float_spatially_filter_image_separable() and thereby avoid having it
-              allocated and freed for each call.
+              because the separable filtering routines internally need scratch memory to
+              hold the row filtered pixels.  If you want to control this memory yourself
+              then you can call float_spatially_filter_image_separable() and provide the
+              scratch image as input.  This allows you to reuse the same scratch image for
+              many calls to float_spatially_filter_image_separable() and thereby avoid
+              having it allocated and freed for each call.
+            - #scratch.nr() == col_filter.size() and #scratch.nc() == in_img.nc(), since
+              only col_filter.size() rows of row filtered pixels are needed at any one
+              time.  The contents of #scratch are undefined.
     !*/
 
 // ----------------------------------------------------------------------------------------
@@ -388,6 +447,26 @@ namespace dlib
               non-border pixels and therefore contain output from the filter.
     !*/
 
+    template <
+        typename in_image_type,
+        typename out_image_type
+        >
+    rectangle gaussian_blur (
+        const in_image_type& in_img,
+        out_image_type& out_img,
+        double sigma,
+        int max_size,
+        thread_pool& tp
+    );
+    /*!
+        requires
+            - The same requirements as the above gaussian_blur() apply.
+        ensures
+            - performs: return gaussian_blur(in_img, out_img, sigma, max_size);
+              except that the blur is computed in parallel by the threads in tp.  The
+              output is exactly the same as the serial version's.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
     template <
@@ -6,7 +6,11 @@
 #include "../geometry/rectangle.h"
 #include "matrix.h"
 #include "matrix_utilities.h"
+#include "matrix_subexp.h"
+#include "matrix_mat.h"
 #include "../enable_if.h"
+#include "../simd/simd8f.h"
+#include <vector>
 
 namespace dlib
 {
@@ -21,6 +25,317 @@ namespace dlib
         struct matrix_is_vector<EXP, typename enable_if_c<EXP::NR==1 || EXP::NC==1>::type > { static const bool value = true; };
     }
 
+// ------------------------------------------------------------------------------------
+
+    /*!  packed_sgemm() is a float matrix multiply, in the style of the BLAS sgemm routine,
+         that performs well without linking to an external BLAS library.  It conforms to
+         the following definition:
+
+        void packed_sgemm (
+            long m,
+            long n,
+            long k,
+            float alpha,
+            const float* A,
+            long lda,
+            bool trans_a,
+            const float* B,
+            long ldb,
+            bool trans_b,
+            float* C,
+            long ldc
+        );
+            requires
+                - m >= 0, n >= 0, k >= 0
+                - op(A) is the m by k row major matrix whose element (i,j) is
+                  A[i*lda+j] if trans_a == false and A[j*lda+i] otherwise.
+                - op(B) is the k by n row major matrix whose element (i,j) is
+                  B[i*ldb+j] if trans_b == false and B[j*ldb+i] otherwise.
+                - C points to an m by n row major matrix with rows ldc floats apart.
+                - C doesn't overlap A or B.
+            ensures
+                - #C == C + alpha*op(A)*op(B)
+
+         The product is computed in blocks sized for the CPU caches.  Blocks of op(A) and
+         op(B) are copied into contiguous panels and a register blocked SIMD kernel computes
+         each sgemm_mr by sgemm_nr tile of C from them.
+    !*/
+
+    namespace ma
+    {
+        const long sgemm_mr = 6;    // rows of C computed by one call to the micro kernel
+        const long sgemm_nr = 16;   // columns of C computed by one call to the micro kernel
+        const long sgemm_kc = 256;  // depth of a packed panel
+        const long sgemm_mc = 96;   // rows of op(A) packed at a time (multiple of sgemm_mr)
+        const long sgemm_nc = 2048; // columns of op(B) packed at a time (multiple of sgemm_nr)
+
+        inline void sgemm_pack_a (
+            long mc, long kc, const float* A, long lda, bool trans_a, float* dest
+        )
+        {
+            // Each sliver of sgemm_mr rows is stored column by column.
+            for (long i = 0; i < mc; i += sgemm_mr)
+            {
+                const long mr = std::min(sgemm_mr, mc-i);
+                for (long p = 0; p < kc; ++p)
+                {
+                    for (long r = 0; r < mr; ++r)
+                        dest[r] = trans_a ? A[p*lda + i+r] : A[(i+r)*lda + p];
+                    for (long r = mr; r < sgemm_mr; ++r)
+                        dest[r] = 0;
+                    dest += sgemm_mr;
+                }
+            }
+        }
+
+        inline void sgemm_pack_b (
+            long kc, long nc, const float* B, long ldb, bool trans_b, float* dest
+        )
+        {
+            // Each sliver of sgemm_nr columns is stored row by row.
+            for (long j = 0; j < nc; j += sgemm_nr)
+            {
+                const long nr = std::min(sgemm_nr, nc-j);
+                for (long p = 0; p < kc; ++p)
+                {
+                    if (!trans_b && nr == sgemm_nr)
+                    {
+                        const float* src = B + p*ldb + j;
+                        for (long c = 0; c < sgemm_nr; ++c)
+                            dest[c] = src[c];
+                    }
+                    else
+                    {
+                        for (long c = 0; c < nr; ++c)
+                            dest[c] = trans_b ? B[(j+c)*ldb + p] : B[p*ldb + j+c];
+                        for (long c = nr; c < sgemm_nr; ++c)
+                            dest[c] = 0;
+                    }
+                    dest += sgemm_nr;
+                }
+            }
+        }
+
+        inline void sgemm_store_row (
+            const simd8f& lo, const simd8f& hi, float alpha, float* c, long nr
+        )
+        {
+            // c[0:nr] += alpha*[lo hi][0:nr]
+            if (nr == sgemm_nr)
+            {
+                simd8f t;
+                t.load(c);   t = fmadd(simd8f(alpha), lo, t); t.store(c);
+                t.load(c+8); t = fmadd(simd8f(alpha), hi, t); t.store(c+8);
+            }
+            else
+            {
+                float temp[sgemm_nr];
+                lo.store(temp);
+                hi.store(temp+8);
+                for (long j = 0; j < nr; ++j)
+                    c[j] += alpha*temp[j];
+            }
+        }
+
+        inline void sgemm_micro_kernel (
+            long kc,
+            const float* a,
+            const float* b,
+            float alpha,
+            float* C,
+            long ldc,
+            long mr,
+            long nr
+        )
+        {
+            simd8f c00(0), c01(0), c10(0), c11(0), c20(0), c21(0),
+                   c30(0), c31(0), c40(0), c41(0), c50(0), c51(0);
+            simd8f b0, b1, av;
+            for (long p = 0; p < kc; ++p)
+            {
+                b0.load(b);
+                b1.load(b+8);
+                av = a[0]; c00 = fmadd(av, b0, c00); c01 = fmadd(av, b1, c01);
+                av = a[1]; c10 = fmadd(av, b0, c10); c11 = fmadd(av, b1, c11);
+                av = a[2]; c20 = fmadd(av, b0, c20); c21 = fmadd(av, b1, c21);
+                av = a[3]; c30 = fmadd(av, b0, c30); c31 = fmadd(av, b1, c31);
+                av = a[4]; c40 = fmadd(av, b0, c40); c41 = fmadd(av, b1, c41);
+                av = a[5]; c50 = fmadd(av, b0, c50); c51 = fmadd(av, b1, c51);
+                a += sgemm_mr;
+                b += sgemm_nr;
+            }
+
+            sgemm_store_row(c00, c01, alpha, C,       nr);  if (mr == 1) return;
+            sgemm_store_row(c10, c11, alpha, C+ldc,   nr);  if (mr == 2) return;
+            sgemm_store_row(c20, c21, alpha, C+2*ldc, nr);  if (mr == 3) return;
+            sgemm_store_row(c30, c31, alpha, C+3*ldc, nr);  if (mr == 4) return;
+            sgemm_store_row(c40, c41, alpha, C+4*ldc, nr);  if (mr == 5) return;
+            sgemm_store_row(c50, c51, alpha, C+5*ldc, nr);
+        }
+    }
+
+    inline void packed_sgemm (
+        long m,
+        long n,
+        long k,
+        float alpha,
+        const float* A,
+        long lda,
+        bool trans_a,
+        const float* B,
+        long ldb,
+        bool trans_b,
+        float* C,
+        long ldc
+    )
+    {
+        using namespace ma;
+        if (m <= 0 || n <= 0 || k <= 0 || alpha == 0)
+            return;
+
+        std::vector<float> packed_a(sgemm_mc*sgemm_kc);
+        std::vector<float> packed_b(std::min(sgemm_nc, (n+sgemm_nr-1)/sgemm_nr*sgemm_nr)*sgemm_kc);
+
+        for (long jc = 0; jc < n; jc += sgemm_nc)
+        {
+            const long nc = std::min(sgemm_nc, n-jc);
+            for (long pc = 0; pc < k; pc += sgemm_kc)
+            {
+                const long kc = std::min(sgemm_kc, k-pc);
+                sgemm_pack_b(kc, nc, trans_b ? B + jc*ldb + pc : B + pc*ldb + jc, ldb, trans_b, &packed_b[0]);
+
+                for (long ic = 0; ic < m; ic += sgemm_mc)
+                {
+                    const long mc = std::min(sgemm_mc, m-ic);
+                    sgemm_pack_a(mc, kc, trans_a ? A + pc*lda + ic : A + ic*lda + pc, lda, trans_a, &packed_a[0]);
+
+                    for (long jr = 0; jr < nc; jr += sgemm_nr)
+                    {
+                        const float* b = &packed_b[jr*kc];
+                        for (long ir = 0; ir < mc; ir += sgemm_mr)
+                        {
+                            sgemm_micro_kernel(kc, &packed_a[ir*kc], b, alpha,
+                                C + (ic+ir)*ldc + jc+jr, ldc,
+                                std::min(sgemm_mr, mc-ir), std::min(sgemm_nr, nc-jr));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+// ------------------------------------------------------------------------------------
+
+    namespace ma
+    {
+        // sgemm_operand tells default_matrix_multiply() how to hand a matrix expression
+        // directly to packed_sgemm().  Expressions without a specialization are first
+        // evaluated into a temporary matrix.
+        template <typename EXP>
+        struct sgemm_operand { static const bool value = false; };
+
+        template <long NR, long NC, typename MM>
+        struct sgemm_operand<matrix<float,NR,NC,MM,row_major_layout> >
+        {
+            static const bool value = true;
+            static const float* ptr (const matrix<float,NR,NC,MM,row_major_layout>& m) { return &m(0,0); }
+            static long ld (const matrix<float,NR,NC,MM,row_major_layout>& m) { return m.nc(); }
+            static bool trans () { return false; }
+        };
+
+        template <>
+        struct sgemm_operand<matrix_op<op_pointer_to_mat<float> > >
+        {
+            static const bool value = true;
+            static const float* ptr (const matrix_op<op_pointer_to_mat<float> >& m) { return m.op.ptr; }
+            static long ld (const matrix_op<op_pointer_to_mat<float> >& m) { return m.op.stride; }
+            static bool trans () { return false; }
+        };
+
+        template <typename M>
+        struct sgemm_operand<matrix_op<op_trans<M> > >
+        {
+            static const bool value = sgemm_operand<M>::value;
+            static const float* ptr (const matrix_op<op_trans<M> >& m) { return sgemm_operand<M>::ptr(m.op.m); }
+            static long ld (const matrix_op<op_trans<M> >& m) { return sgemm_operand<M>::ld(m.op.m); }
+            static bool trans () { return !sgemm_operand<M>::trans(); }
+        };
+
+        template <typename EXP>
+        struct sgemm_dest { static const bool value = false; };
+
+        template <long NR, long NC, typename MM>
+        struct sgemm_dest<matrix<float,NR,NC,MM,row_major_layout> >
+        {
+            static const bool value = true;
+            static float* ptr (matrix<float,NR,NC,MM,row_major_layout>& m) { return &m(0,0); }
+            static long ld (const matrix<float,NR,NC,MM,row_major_layout>& m) { return m.nc(); }
+        };
+
+        template <>
+        struct sgemm_dest<assignable_ptr_matrix<float> >
+        {
+            static const bool value = true;
+            static float* ptr (assignable_ptr_matrix<float>& m) { return m.ptr; }
+            static long ld (const assignable_ptr_matrix<float>& m) { return m.nc(); }
+        };
+
+        template <typename EXP>
+        typename enable_if_c<sgemm_operand<EXP>::value>::type get_sgemm_operand (
+            const EXP& m, matrix<float>&, const float*& ptr, long& ld, bool& trans
+        )
+        {
+            ptr = sgemm_operand<EXP>::ptr(m);
+            ld = sgemm_operand<EXP>::ld(m);
+            trans = sgemm_operand<EXP>::trans();
+        }
+
+        template <typename EXP>
+        typename disable_if_c<sgemm_operand<EXP>::value>::type get_sgemm_operand (
+            const EXP& m, matrix<float>& temp, const float*& ptr, long& ld, bool& trans
+        )
+        {
+            temp = m;
+            ptr = &temp(0,0);
+            ld = temp.nc();
+            trans = false;
+        }
+
+        template <typename matrix_dest_type, typename EXP1, typename EXP2>
+        typename enable_if_c<sgemm_dest<matrix_dest_type>::value &&
+                             is_same_type<typename EXP1::type,float>::value &&
+                             is_same_type<typename EXP2::type,float>::value, bool>::type
+        packed_sgemm_multiply (
+            matrix_dest_type& dest,
+            const EXP1& lhs,
+            const EXP2& rhs
+        )
+        {
+            matrix<float> lhs_temp, rhs_temp;
+            const float* A; const float* B;
+            long lda, ldb;
+            bool trans_a, trans_b;
+            get_sgemm_operand(lhs, lhs_temp, A, lda, trans_a);
+            get_sgemm_operand(rhs, rhs_temp, B, ldb, trans_b);
+            packed_sgemm(lhs.nr(), rhs.nc(), lhs.nc(), 1, A, lda, trans_a, B, ldb, trans_b,
+                sgemm_dest<matrix_dest_type>::ptr(dest), sgemm_dest<matrix_dest_type>::ld(dest));
+            return true;
+        }
+
+        template <typename matrix_dest_type, typename EXP1, typename EXP2>
+        typename disable_if_c<sgemm_dest<matrix_dest_type>::value &&
+                              is_same_type<typename EXP1::type,float>::value &&
+                              is_same_type<typename EXP2::type,float>::value, bool>::type
+        packed_sgemm_multiply (
+            matrix_dest_type& ,
+            const EXP1& ,
+            const EXP2& 
+        )
+        {
+            return false;
+        }
+    }
+
 // ------------------------------------------------------------------------------------
 
     /*!  This file defines the default_matrix_multiply() function.  It is a function 
@@ -82,6 +397,10 @@ namespace dlib
         {
             matrix_assign_default(dest, lhs*rhs, 1, true);
         }
+        else if (ma::packed_sgemm_multiply(dest, lhs, rhs))
+        {
+            // float matrices are handled by the packed SIMD kernel.
+        }
         else
         {
             // if the lhs and rhs matrices are big enough we should use a cache friendly
@@ -8,6 +8,7 @@
 #include "../matrix.h"
 #include "../algs.h"
 #include "../array.h"
+#include "../threads/parallel_for_extension.h"
 
 namespace dlib 
 {
@@ -19,10 +20,12 @@ namespace dlib
     {
         inline op_symm_cache( 
             const M& m_,
-            long max_size_megabytes_
+            long max_size_megabytes_,
+            thread_pool* tp_
         ) : 
             basic_op_m<M>(m_),
             max_size_megabytes(max_size_megabytes_),
+            tp(tp_),
             is_initialized(false)
         {
             lookup.assign(this->m.nr(), -1);
@@ -36,6 +39,7 @@ namespace dlib
             basic_op_m<M>(item.m),
             diag_cache(item.diag_cache),
             max_size_megabytes(item.max_size_megabytes),
+            tp(item.tp),
             is_initialized(false)
         {
             lookup.assign(this->m.nr(), -1);
@@ -81,14 +85,10 @@ namespace dlib
             if (is_cached(i) == false)
                 add_col_to_cache(i);
 
-            // find where this column is in the cache
-            long idx = lookup[i];
-            if (idx == next)
-            {
-                // if this column was the next to be replaced
-                // then make sure that doesn't happen
-                next = (next + 1)%cache.size();
-            }
+            // find where this column is in the cache and remember that it was just used
+            // so it's among the last to be replaced.
+            const long idx = lookup[i];
+            last_used[idx] = ++clock;
 
             return std::make_pair(&cache[idx](0), &references[idx]); 
         }
@@ -132,42 +132,41 @@ namespace dlib
                 cache.set_size(size);
 
                 rlookup.assign(size,-1);
-                next = 0;
+                last_used.assign(size,0);
+                clock = 0;
 
                 is_initialized = true;
             }
         }
 
-        void make_sure_next_is_unreferenced (
+        long find_unreferenced_slot (
         ) const
         {
-            if (references[next] != 0)
+            // The SMO solvers keep coming back to the columns of the variables in their
+            // current working set, so replace the unreferenced column that was used least
+            // recently.  Empty slots have a last_used value of 0 and therefore get used
+            // first.
+            long best = -1;
+            for (unsigned long i = 0; i < references.size(); ++i)
             {
-                // find an unreferenced element of the cache
-                unsigned long i;
-                for (i = 1; i < references.size(); ++i)
-                {
-                    const unsigned long idx = (next+i)%references.size();
-                    if (references[idx] == 0)
-                    {
-                        next = idx;
-                        break;
-                    }
-                }
-
-                // if all elements of the cache are referenced then make the cache bigger
-                // and use the new element.
-                if (references[next] != 0)
-                {
-                    cache.resize(cache.size()+1);
+                if (references[i] == 0 && (best == -1 || last_used[i] < last_used[best]))
+                    best = i;
+            }
+
+            // if all elements of the cache are referenced then make the cache bigger
+            // and use the new element.
+            if (best == -1)
+            {
+                cache.resize(cache.size()+1);
 
-                    next = references.size();
-                    references.resize(references.size()+1);
-                    references[next] = 0;
+                best = references.size();
+                references.resize(references.size()+1);
+                references[best] = 0;
 
-                    rlookup.push_back(-1);
-                }
+                rlookup.push_back(-1);
+                last_used.push_back(0);
             }
+            return best;
         }
 
         inline void add_col_to_cache(
@@ -175,20 +174,32 @@ namespace dlib
         ) const
         {
             init();
-            make_sure_next_is_unreferenced();
+            const long slot = find_unreferenced_slot();
 
-            // if the lookup table is pointing to cache[next] then clear lookup[next]
-            if (rlookup[next] != -1)
-                lookup[rlookup[next]] = -1;
+            // if the lookup table is pointing to cache[slot] then clear lookup[slot]
+            if (rlookup[slot] != -1)
+                lookup[rlookup[slot]] = -1;
 
-            // make the lookup table so that it says c is now cached at the spot indicated by next
-            lookup[c] = next;
-            rlookup[next] = c;
+            // make the lookup table so that it says c is now cached at the spot indicated by slot
+            lookup[c] = slot;
+            rlookup[slot] = c;
+            last_used[slot] = ++clock;
 
             // compute this column in the matrix and store it in the cache
-            cache[next] = matrix_cast<cache_element_type>(colm(this->m,c));
-
-            next = (next + 1)%cache.size();
+            if (tp)
+            {
+                matrix<type,0,1,typename M::mem_manager_type>& column = cache[slot];
+                column.set_size(this->m.nr());
+                parallel_for_blocked(*tp, 0, this->m.nr(), [&](long begin, long end)
+                {
+                    for (long r = begin; r < end; ++r)
+                        column(r) = this->m(r,c);
+                });
+            }
+            else
+            {
+                cache[slot] = matrix_cast<cache_element_type>(colm(this->m,c));
+            }
         }
 
         /*!
@@ -199,6 +210,8 @@ namespace dlib
             - diag_cache == the diagonal of the original matrix
             - is_initialized == false 
             - max_size_megabytes == the max_size_megabytes from symmetric_matrix_cache()
+            - tp == the thread_pool given to symmetric_matrix_cache(), or nullptr if there
+              wasn't one.  Missing columns are computed with it.
 
         CONVENTION
             - diag_cache == the diagonal of the original matrix
@@ -213,7 +226,9 @@ namespace dlib
                     - lookup[rlookup[x]] == x
                     - cache[x] == the cached column rlookup[x] of the matrix
 
-                - next == the next element in the cache table to use to cache something 
+                - last_used[i] == the value clock had when cache[i] was last loaded or
+                  returned by col(), or 0 if cache[i] has never been used.  Unreferenced
+                  elements with the smallest last_used are replaced first.
                 - references[i] == the number of outstanding references to cache element cache[i]
 
                 - diag_reference_count == the number of outstanding references to diag_cache. 
@@ -227,14 +242,45 @@ namespace dlib
         matrix<type,0,1,typename M::mem_manager_type> diag_cache;
         mutable std::vector<long> lookup;
         mutable std::vector<long> rlookup;
-        mutable long next;
+        mutable std::vector<unsigned long> last_used;
+        mutable unsigned long clock;
 
         const long max_size_megabytes;
+        thread_pool* const tp;
         mutable bool is_initialized;
         mutable long diag_reference_count;
 
     };
 
+    namespace impl
+    {
+        template <
+            typename cache_element_type,
+            typename EXP
+            >
+        const matrix_op<op_symm_cache<EXP,cache_element_type> >  symmetric_matrix_cache (
+            const matrix_exp<EXP>& m,
+            long max_size_megabytes,
+            thread_pool* tp
+        )
+        {
+            // Don't check that m is symmetric since doing so would be extremely onerous for the
+            // kinds of matrices intended for use with the symmetric_matrix_cache.  Check everything
+            // else though.
+            DLIB_ASSERT(m.size() > 0 && m.nr() == m.nc() && max_size_megabytes >= 0, 
+                "\tconst matrix_exp symmetric_matrix_cache(const matrix_exp& m, max_size_megabytes)"
+                << "\n\t You have given invalid arguments to this function"
+                << "\n\t m.nr():             " << m.nr()
+                << "\n\t m.nc():             " << m.nc() 
+                << "\n\t m.size():           " << m.size() 
+                << "\n\t max_size_megabytes: " << max_size_megabytes 
+                );
+
+            typedef op_symm_cache<EXP,cache_element_type> op;
+            return matrix_op<op>(op(m.ref(), max_size_megabytes, tp));
+        }
+    }
+
     template <
         typename cache_element_type,
         typename EXP
@@ -244,20 +290,20 @@ namespace dlib
         long max_size_megabytes
     )
     {
-        // Don't check that m is symmetric since doing so would be extremely onerous for the
-        // kinds of matrices intended for use with the symmetric_matrix_cache.  Check everything
-        // else though.
-        DLIB_ASSERT(m.size() > 0 && m.nr() == m.nc() && max_size_megabytes >= 0, 
-            "\tconst matrix_exp symmetric_matrix_cache(const matrix_exp& m, max_size_megabytes)"
-            << "\n\t You have given invalid arguments to this function"
-            << "\n\t m.nr():             " << m.nr()
-            << "\n\t m.nc():             " << m.nc() 
-            << "\n\t m.size():           " << m.size() 
-            << "\n\t max_size_megabytes: " << max_size_megabytes 
-            );
+        return impl::symmetric_matrix_cache<cache_element_type>(m, max_size_megabytes, nullptr);
+    }
 
-        typedef op_symm_cache<EXP,cache_element_type> op;
-        return matrix_op<op>(op(m.ref(), max_size_megabytes));
+    template <
+        typename cache_element_type,
+        typename EXP
+        >
+    const matrix_op<op_symm_cache<EXP,cache_element_type> >  symmetric_matrix_cache (
+        const matrix_exp<EXP>& m,
+        long max_size_megabytes,
+        thread_pool& tp
+    )
+    {
+        return impl::symmetric_matrix_cache<cache_element_type>(m, max_size_megabytes, &tp);
     }
 
 // ----------------------------------------------------------------------------------------
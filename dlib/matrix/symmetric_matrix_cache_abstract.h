@@ -4,6 +4,7 @@
 #ifndef DLIB_SYMMETRIC_MATRIX_CAcHE_ABSTRACT_Hh_
 
 #include "matrix_abstract.h"
+#include "../threads/thread_pool_extension_abstract.h"
 
 namespace dlib 
 {
@@ -55,6 +56,31 @@ namespace dlib
                       entire row/column/diagonal worth of data.  
     !*/
 
+    template <
+        typename cache_element_type
+        >
+    const matrix_exp symmetric_matrix_cache (
+        const matrix_exp& m,
+        long max_size_megabytes,
+        thread_pool& tp
+    );
+    /*!
+        requires
+            - m.size() > 0
+            - m.nr() == m.nc()
+            - max_size_megabytes >= 0
+            - The elements of m can be evaluated concurrently from multiple threads.  This
+              is true of kernel_matrix() expressions made from any of dlib's kernels.
+            - tp must outlive the returned matrix expression.
+        ensures
+            - performs: return symmetric_matrix_cache<cache_element_type>(m, max_size_megabytes);
+              except that whenever a column of m needs to be loaded into the cache its
+              elements are computed in parallel by the threads in tp.  The values stored
+              in the cache are exactly the same as without tp.  When loading a column of m
+              is expensive, for example, because m is the kernel_matrix() of a large
+              number of samples, this makes the SMO based SVM trainers much faster.
+    !*/
+
 // ----------------------------------------------------------------------------------------
 
 }
@@ -0,0 +1,286 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+#ifndef DLIB_FFMPEG_DNN
+#define DLIB_FFMPEG_DNN
+
+#include "ffmpeg_utils.h"
+#include "../dnn/input.h"
+#include <algorithm>
+#include <iterator>
+
+namespace dlib
+{
+    namespace ffmpeg
+    {
+
+// ---------------------------------------------------------------------------------------------------
+
+        class input_rgb_frame
+        {
+        public:
+            /*!
+                WHAT THIS OBJECT REPRESENTS
+                    This is an input layer for dlib's deep neural networks, i.e. it
+                    implements the EXAMPLE_INPUT_LAYER interface defined in
+                    dlib/dnn/input_abstract.h, whose input_type is a decoded video frame.
+                    It makes the tensor input_rgb_image would make from the frame's RGB
+                    image, so a network trained with input_rgb_image can be loaded with
+                    input_rgb_frame instead, but it reads the frame's pixels directly.
+
+                    When a frame in YUV420P, YUVJ420P, NV12 or NV21 format, which is what
+                    most video decoders output, is given to to_tensor(), its pixels are
+                    converted to RGB and written into the planar tensor in a single pass
+                    over the frame.  Frames in RGB24 and BGR24 format are read directly
+                    as well.  So, unlike calling convert() and then giving the image to
+                    input_rgb_image, no intermediate image is made.  Frames in any other
+                    format are converted to RGB24 with swscale first.
+
+                    YUV is converted to RGB with the BT.709 coefficients if the frame's
+                    colorspace says it uses them, and with the BT.601 coefficients
+                    otherwise.  Full range YUV is assumed for YUVJ420P frames and frames
+                    whose color_range is AVCOL_RANGE_JPEG, limited range otherwise.  The
+                    chroma samples of each 2x2 block of pixels are used for all four of
+                    them.  This is close to, but not bit for bit the same as, what swscale
+                    does when a frame is converted to RGB24.  For YUV420P frames swscale
+                    rounds a little differently, so the pixels typically differ by about
+                    one level out of 255 and by no more than a few.  For NV12 and NV21
+                    frames swscale also interpolates the chroma between neighboring
+                    samples, so pixels at sharp color edges can differ by much more.
+
+                THREAD SAFETY
+                    to_tensor() keeps the swscale context and RGB24 frame it uses for
+                    other formats inside this object, so don't call it on the same object
+                    from more than one thread at a time.  Copies of this object don't share
+                    them, so it's fine to give each thread its own copy, which is what
+                    dnn_data_loader does.
+            !*/
+
+            typedef frame input_type;
+
+            input_rgb_frame (
+            ) :
+                avg_red(122.782),
+                avg_green(117.001),
+                avg_blue(104.298)
+            {
+            }
+
+            input_rgb_frame (
+                float avg_red_,
+                float avg_green_,
+                float avg_blue_
+            ) : avg_red(avg_red_), avg_green(avg_green_), avg_blue(avg_blue_)
+            {}
+
+            input_rgb_frame (
+                const input_rgb_image& item
+            ) : avg_red(item.get_avg_red()),
+                avg_green(item.get_avg_green()),
+                avg_blue(item.get_avg_blue())
+            {}
+
+            float get_avg_red()   const { return avg_red; }
+            float get_avg_green() const { return avg_green; }
+            float get_avg_blue()  const { return avg_blue; }
+
+            bool image_contained_point ( const tensor& data, const point& p) const { return get_rect(data).contains(p); }
+            drectangle tensor_space_to_image_space ( const tensor& /*data*/, drectangle r) const { return r; }
+            drectangle image_space_to_tensor_space ( const tensor& /*data*/, double /*scale*/, drectangle r ) const { return r; }
+
+            template <typename forward_iterator>
+            void to_tensor (
+                forward_iterator ibegin,
+                forward_iterator iend,
+                resizable_tensor& data
+            ) const
+            {
+                DLIB_CASSERT(std::distance(ibegin,iend) > 0);
+                const long nr = ibegin->height();
+                const long nc = ibegin->width();
+                // make sure all the input frames are images with the same dimensions
+                for (auto i = ibegin; i != iend; ++i)
+                {
+                    DLIB_CASSERT(i->is_image() && i->height()==nr && i->width()==nc,
+                        "\t input_rgb_frame::to_tensor()"
+                        << "\n\t All frames given to to_tensor() must be images with the same dimensions."
+                        << "\n\t nr: " << nr
+                        << "\n\t nc: " << nc
+                        << "\n\t i->is_image(): " << i->is_image()
+                        << "\n\t i->height(): " << i->height()
+                        << "\n\t i->width(): " << i->width()
+                    );
+                }
+
+                data.set_size(std::distance(ibegin,iend), 3, nr, nc);
+
+                const size_t offset = nr*nc;
+                float* ptr = data.host();
+                for (auto i = ibegin; i != iend; ++i)
+                {
+                    to_planes(*i, ptr, ptr+offset, ptr+2*offset);
+                    ptr += offset*data.k();
+                }
+            }
+
+            friend void serialize(const input_rgb_frame& item, std::ostream& out)
+            {
+                serialize("input_rgb_frame", out);
+                serialize(item.avg_red, out);
+                serialize(item.avg_green, out);
+                serialize(item.avg_blue, out);
+            }
+
+            friend void deserialize(input_rgb_frame& item, std::istream& in)
+            {
+                std::string version;
+                deserialize(version, in);
+                if (version != "input_rgb_frame" && version != "input_rgb_image" &&
+                    version != "input_rgb_image_sized" && version != "input_rgb_image_pair")
+                    throw serialization_error("Unexpected version found while deserializing dlib::ffmpeg::input_rgb_frame.");
+                deserialize(item.avg_red, in);
+                deserialize(item.avg_green, in);
+                deserialize(item.avg_blue, in);
+
+                // read and discard the sizes if this was really a sized input layer.
+                if (version == "input_rgb_image_sized")
+                {
+                    size_t nr, nc;
+                    deserialize(nr, in);
+                    deserialize(nc, in);
+                }
+            }
+
+            friend std::ostream& operator<<(std::ostream& out, const input_rgb_frame& item)
+            {
+                out << "input_rgb_frame("<<item.avg_red<<","<<item.avg_green<<","<<item.avg_blue<<")";
+                return out;
+            }
+
+            friend void to_xml(const input_rgb_frame& item, std::ostream& out)
+            {
+                out << "<input_rgb_frame r='"<<item.avg_red<<"' g='"<<item.avg_green<<"' b='"<<item.avg_blue<<"'/>\n";
+            }
+
+        private:
+
+            template <typename pixel_type>
+            void packed_to_planes (
+                const frame& f,
+                float* r,
+                float* g,
+                float* b
+            ) const
+            {
+                const const_frame_image<pixel_type> img(f);
+                for (long y = 0; y < img.nr(); ++y)
+                {
+                    const pixel_type* row = img[y];
+                    for (long x = 0; x < img.nc(); ++x)
+                    {
+                        *r++ = (row[x].red-avg_red)/256.0f;
+                        *g++ = (row[x].green-avg_green)/256.0f;
+                        *b++ = (row[x].blue-avg_blue)/256.0f;
+                    }
+                }
+            }
+
+            void to_planes (
+                const frame& f,
+                float* r,
+                float* g,
+                float* b
+            ) const
+            {
+                const AVFrame& fr = f.get_frame();
+                // Where the U and V samples of a pixel are, relative to the start of its
+                // chroma row, and how far apart the samples of neighboring pixels are.
+                const uint8_t* u_plane;
+                const uint8_t* v_plane;
+                int u_stride, v_stride, chroma_step;
+                switch (f.pixfmt())
+                {
+                    case AV_PIX_FMT_YUV420P:
+                    case AV_PIX_FMT_YUVJ420P:
+                        u_plane = fr.data[1]; u_stride = fr.linesize[1];
+                        v_plane = fr.data[2]; v_stride = fr.linesize[2];
+                        chroma_step = 1;
+                        break;
+                    case AV_PIX_FMT_NV12:
+                        u_plane = fr.data[1];   u_stride = fr.linesize[1];
+                        v_plane = fr.data[1]+1; v_stride = fr.linesize[1];
+                        chroma_step = 2;
+                        break;
+                    case AV_PIX_FMT_NV21:
+                        v_plane = fr.data[1];   v_stride = fr.linesize[1];
+                        u_plane = fr.data[1]+1; u_stride = fr.linesize[1];
+                        chroma_step = 2;
+                        break;
+                    case AV_PIX_FMT_RGB24:
+                        packed_to_planes<rgb_pixel>(f, r, g, b);
+                        return;
+                    case AV_PIX_FMT_BGR24:
+                        packed_to_planes<bgr_pixel>(f, r, g, b);
+                        return;
+                    default:
+                        converter.resize(f, f.height(), f.width(), AV_PIX_FMT_RGB24, converter.rgb);
+                        packed_to_planes<rgb_pixel>(converter.rgb, r, g, b);
+                        return;
+                }
+
+                const bool full_range = f.pixfmt() == AV_PIX_FMT_YUVJ420P || fr.color_range == AVCOL_RANGE_JPEG;
+                const bool bt709 = fr.colorspace == AVCOL_SPC_BT709;
+
+                // Fold the range expansion, the YUV to RGB matrix, and the mean
+                // subtraction and scaling done by input_rgb_image into a few constants.
+                const float y_offset = full_range ? 0 : 16;
+                const float y_scale  = full_range ? 1 : 255/219.0f;
+                const float c_scale  = full_range ? 1 : 255/224.0f;
+                const float rv = c_scale*(bt709 ? 1.5748f   : 1.402f);
+                const float gu = c_scale*(bt709 ? 0.187324f : 0.344136f);
+                const float gv = c_scale*(bt709 ? 0.468124f : 0.714136f);
+                const float bu = c_scale*(bt709 ? 1.8556f   : 1.772f);
+
+                const long nr = f.height();
+                const long nc = f.width();
+                for (long y = 0; y < nr; ++y)
+                {
+                    const uint8_t* luma = fr.data[0] + y*fr.linesize[0];
+                    const uint8_t* urow = u_plane + (y/2)*u_stride;
+                    const uint8_t* vrow = v_plane + (y/2)*v_stride;
+                    for (long x = 0; x < nc; ++x)
+                    {
+                        const float l = (luma[x]-y_offset)*y_scale;
+                        const float u = urow[(x/2)*chroma_step]-128.0f;
+                        const float v = vrow[(x/2)*chroma_step]-128.0f;
+                        *r++ = (std::min(std::max(l + rv*v, 0.0f), 255.0f)-avg_red)/256.0f;
+                        *g++ = (std::min(std::max(l - gu*u - gv*v, 0.0f), 255.0f)-avg_green)/256.0f;
+                        *b++ = (std::min(std::max(l + bu*u, 0.0f), 255.0f)-avg_blue)/256.0f;
+                    }
+                }
+            }
+
+            struct rgb_converter : details::resizer
+            {
+                // The swscale context and the RGB frame are only caches, so a copy of the
+                // layer starts with empty ones rather than sharing them.
+                rgb_converter() = default;
+                rgb_converter(const rgb_converter&) {}
+                rgb_converter& operator=(const rgb_converter&) { return *this; }
+
+                frame rgb;
+            };
+
+            float avg_red;
+            float avg_green;
+            float avg_blue;
+            mutable rgb_converter converter;
+        };
+
+// ---------------------------------------------------------------------------------------------------
+
+    }
+}
+
+#endif //DLIB_FFMPEG_DNN
+
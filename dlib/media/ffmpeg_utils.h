@@ -535,6 +535,178 @@ namespace dlib
                 - converts a dlib audio object into a frame object
         !*/
 
+// ---------------------------------------------------------------------------------------------------
+
+        template <class pixel_type>
+        class frame_image
+        {
+        public:
+            /*!
+                REQUIREMENTS ON pixel_type
+                    pixel_type is a dlib pixel type, i.e. pixel_traits<pixel_type> is defined.
+
+                WHAT THIS OBJECT REPRESENTS
+                    This object is a writable view of one plane of a frame as a dlib image.
+                    It implements the interface defined in
+                    dlib/image_processing/generic_image.h by pointing directly at the
+                    frame's memory, so nothing is copied or converted.  Use it when you
+                    want to draw on a frame or otherwise modify its pixels in place.  To
+                    only read the pixels of a frame, use const_frame_image instead.
+
+                    Since it doesn't own the pixels, a frame_image must not outlive the
+                    frame it was made from, and it becomes invalid when that frame is
+                    resized, cleared or overwritten, for example by the next call to read().
+                    Also, set_size() isn't supported, so a frame_image can't be used as the
+                    output of functions that resize their output image.
+            !*/
+
+            typedef pixel_type type;
+
+            frame_image() = default;
+            /*!
+                ensures
+                    - #nr() == 0
+                    - #nc() == 0
+            !*/
+
+            explicit frame_image(
+                frame& f,
+                int plane = 0
+            );
+            /*!
+                requires
+                    - f.is_image() == true
+                    - One of the following is true:
+                        - plane == 0 and f.pixfmt() == pix_traits<pixel_type>::fmt
+                          (e.g. a packed RGB24 or BGR24 frame)
+                        - pixel_type is unsigned char and plane is a plane of f holding
+                          8 bit samples, one per pixel.  E.g. any of the planes of a
+                          YUV420P, YUVJ420P, YUV444P or GBRP frame, or the Y plane of an
+                          NV12 or NV21 frame.
+                ensures
+                    - Makes f writable first.  That is, if the pixels of f are shared with
+                      another frame, such as a reference frame kept by a decoder, f is
+                      given its own copy of them so writing to #*this doesn't change the
+                      other frame.
+                    - #*this is a view of the given plane of f.  Writing to #*this writes
+                      to f.
+                    - #nr() and #nc() are the size of the plane.  That is, f.height() and
+                      f.width(), divided by the chroma subsampling factors of f.pixfmt()
+                      and rounded up if plane is a chroma plane.
+                    - #width_step() == f.get_frame().linesize[plane]
+            !*/
+
+            long nr() const { return _nr; }
+            long nc() const { return _nc; }
+            long size() const { return _nr*_nc; }
+            long width_step() const { return _width_step; }
+            /*!
+                ensures
+                    - returns the number of bytes between the starts of two consecutive
+                      rows of this image.
+            !*/
+
+            pixel_type* operator[] (const long row);
+            const pixel_type* operator[] (const long row) const;
+            /*!
+                requires
+                    - 0 <= row < nr()
+                ensures
+                    - returns a pointer to the first pixel in the given row.
+            !*/
+
+            pixel_type& operator()(const long row, const long column) { return (*this)[row][column]; }
+            const pixel_type& operator()(const long row, const long column) const { return (*this)[row][column]; }
+
+        private:
+            char* _data = nullptr;
+            long _width_step = 0;
+            long _nr = 0;
+            long _nc = 0;
+        };
+
+// ---------------------------------------------------------------------------------------------------
+
+        template <class pixel_type>
+        class const_frame_image
+        {
+        public:
+            /*!
+                REQUIREMENTS ON pixel_type
+                    pixel_type is a dlib pixel type, i.e. pixel_traits<pixel_type> is defined.
+
+                WHAT THIS OBJECT REPRESENTS
+                    This object is a read-only view of one plane of a frame as a dlib
+                    image.  It is just like frame_image except that it only gives const
+                    access to the pixels, so it can be made from a const frame.  This is
+                    the cheapest way to hand a decoded frame to the image processing tools
+                    in dlib.  For example, the luma plane of a YUV420P or NV12 frame, as
+                    returned by most video decoders, is a grayscale image that HOG or FHOG
+                    based detectors can use directly:
+
+                        frame f;
+                        while (cap.read(f))
+                        {
+                            const_frame_image<unsigned char> luma(f);
+                            auto dets = detector(luma);
+                        }
+
+                    Since it doesn't own the pixels, a const_frame_image must not outlive
+                    the frame it was made from, and it becomes invalid when that frame is
+                    resized, cleared or overwritten, for example by the next call to read().
+            !*/
+
+            typedef pixel_type type;
+
+            const_frame_image() = default;
+            /*!
+                ensures
+                    - #nr() == 0
+                    - #nc() == 0
+            !*/
+
+            explicit const_frame_image(
+                const frame& f,
+                int plane = 0
+            );
+            /*!
+                requires
+                    - The same as for frame_image's constructor.
+                ensures
+                    - #*this is a read-only view of the given plane of f.
+                    - #nr() and #nc() are the size of the plane.  That is, f.height() and
+                      f.width(), divided by the chroma subsampling factors of f.pixfmt()
+                      and rounded up if plane is a chroma plane.
+                    - #width_step() == f.get_frame().linesize[plane]
+            !*/
+
+            long nr() const { return _nr; }
+            long nc() const { return _nc; }
+            long size() const { return _nr*_nc; }
+            long width_step() const { return _width_step; }
+            /*!
+                ensures
+                    - returns the number of bytes between the starts of two consecutive
+                      rows of this image.
+            !*/
+
+            const pixel_type* operator[] (const long row) const;
+            /*!
+                requires
+                    - 0 <= row < nr()
+                ensures
+                    - returns a pointer to the first pixel in the given row.
+            !*/
+
+            const pixel_type& operator()(const long row, const long column) const { return (*this)[row][column]; }
+
+        private:
+            const char* _data = nullptr;
+            long _width_step = 0;
+            long _nr = 0;
+            long _nc = 0;
+        };
+
 // ---------------------------------------------------------------------------------------------------
 
         struct resizing_args
@@ -1408,6 +1580,126 @@ namespace dlib
             (void)ret;
         }
 
+// ---------------------------------------------------------------------------------------------------
+
+        namespace details
+        {
+            template <class pixel_type>
+            inline void get_plane_view(
+                const frame& f,
+                int plane,
+                const uint8_t*& data,
+                long& width_step,
+                long& nr,
+                long& nc
+            )
+            {
+                DLIB_CASSERT(f.is_image(), "frame isn't an image type");
+                const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(f.pixfmt());
+                DLIB_CASSERT(desc != nullptr && 0 <= plane && plane < av_pix_fmt_count_planes(f.pixfmt()),
+                    "frame doesn't have a plane " << plane);
+
+                if (plane != 0 || f.pixfmt() != pix_traits<pixel_type>::fmt)
+                {
+                    // Otherwise the plane must hold exactly one 8 bit sample per pixel.
+                    bool ok = sizeof(pixel_type) == 1 && !(desc->flags & AV_PIX_FMT_FLAG_BITSTREAM);
+                    int num_comps = 0;
+                    for (int c = 0; c < desc->nb_components; ++c)
+                    {
+                        if (desc->comp[c].plane != plane)
+                            continue;
+                        ++num_comps;
+                        ok = ok && desc->comp[c].depth == 8 && desc->comp[c].step == 1 && desc->comp[c].shift == 0;
+                    }
+                    DLIB_CASSERT(ok && num_comps == 1,
+                        "plane " << plane << " of a " << av_get_pix_fmt_name(f.pixfmt()) << " frame can't be viewed as an image of this pixel type");
+                }
+
+                const AVFrame& fr = f.get_frame();
+                DLIB_CASSERT(fr.linesize[plane] > 0, "frames stored bottom up aren't supported");
+
+                data       = fr.data[plane];
+                width_step = fr.linesize[plane];
+                nr         = f.height();
+                nc         = f.width();
+
+                // The chroma planes of YUV formats are subsampled.
+                const bool is_chroma = (plane == 1 || plane == 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+                if (is_chroma)
+                {
+                    nr = -((-nr) >> desc->log2_chroma_h);
+                    nc = -((-nc) >> desc->log2_chroma_w);
+                }
+            }
+        }
+
+        template <class pixel_type>
+        inline frame_image<pixel_type>::frame_image(
+            frame& f,
+            int plane
+        )
+        {
+            DLIB_CASSERT(f.is_image(), "frame isn't an image type");
+            const int ret = av_frame_make_writable(&f.get_frame());
+            DLIB_CASSERT(ret >= 0, "av_frame_make_writable() failed : " << details::get_av_error(ret));
+            (void)ret;
+
+            const uint8_t* data;
+            details::get_plane_view<pixel_type>(f, plane, data, _width_step, _nr, _nc);
+            // f isn't const, so neither are its pixels.
+            _data = reinterpret_cast<char*>(const_cast<uint8_t*>(data));
+        }
+
+        template <class pixel_type>
+        inline const_frame_image<pixel_type>::const_frame_image(
+            const frame& f,
+            int plane
+        )
+        {
+            const uint8_t* data;
+            details::get_plane_view<pixel_type>(f, plane, data, _width_step, _nr, _nc);
+            _data = reinterpret_cast<const char*>(data);
+        }
+
+        template <class pixel_type>
+        inline pixel_type* frame_image<pixel_type>::operator[] (const long row)
+        {
+            DLIB_ASSERT(0 <= row && row < nr(),
+                "\tpixel_type* frame_image::operator[](row)"
+                << "\n\t you have asked for an out of bounds row "
+                << "\n\t row:  " << row
+                << "\n\t nr(): " << nr()
+                << "\n\t this:  " << this
+            );
+            return reinterpret_cast<pixel_type*>(_data + _width_step*row);
+        }
+
+        template <class pixel_type>
+        inline const pixel_type* frame_image<pixel_type>::operator[] (const long row) const
+        {
+            DLIB_ASSERT(0 <= row && row < nr(),
+                "\tconst pixel_type* frame_image::operator[](row)"
+                << "\n\t you have asked for an out of bounds row "
+                << "\n\t row:  " << row
+                << "\n\t nr(): " << nr()
+                << "\n\t this:  " << this
+            );
+            return reinterpret_cast<const pixel_type*>(_data + _width_step*row);
+        }
+
+        template <class pixel_type>
+        inline const pixel_type* const_frame_image<pixel_type>::operator[] (const long row) const
+        {
+            DLIB_ASSERT(0 <= row && row < nr(),
+                "\tconst pixel_type* const_frame_image::operator[](row)"
+                << "\n\t you have asked for an out of bounds row "
+                << "\n\t row:  " << row
+                << "\n\t nr(): " << nr()
+                << "\n\t this:  " << this
+            );
+            return reinterpret_cast<const pixel_type*>(_data + _width_step*row);
+        }
+
 // ---------------------------------------------------------------------------------------------------
 
         template<
@@ -1508,9 +1800,68 @@ namespace dlib
             av_samples_copy(f.get_frame().data, src_pointers, 0, 0, f.nsamples(), f.nchannels(), f.samplefmt());
         }
 
+// ---------------------------------------------------------------------------------------------------
+
+        template <class pixel_type>
+        inline long num_rows(const frame_image<pixel_type>& img) { return img.nr(); }
+
+        template <class pixel_type>
+        inline long num_columns(const frame_image<pixel_type>& img) { return img.nc(); }
+
+        template <class pixel_type>
+        inline void* image_data(frame_image<pixel_type>& img)
+        {
+            if (img.size() != 0)
+                return &img[0][0];
+            else
+                return 0;
+        }
+
+        template <class pixel_type>
+        inline const void* image_data(const frame_image<pixel_type>& img)
+        {
+            if (img.size() != 0)
+                return &img[0][0];
+            else
+                return 0;
+        }
+
+        template <class pixel_type>
+        inline size_t width_step(const frame_image<pixel_type>& img) { return img.width_step(); }
+
+        template <class pixel_type>
+        inline long num_rows(const const_frame_image<pixel_type>& img) { return img.nr(); }
+
+        template <class pixel_type>
+        inline long num_columns(const const_frame_image<pixel_type>& img) { return img.nc(); }
+
+        template <class pixel_type>
+        inline const void* image_data(const const_frame_image<pixel_type>& img)
+        {
+            if (img.size() != 0)
+                return &img[0][0];
+            else
+                return 0;
+        }
+
+        template <class pixel_type>
+        inline size_t width_step(const const_frame_image<pixel_type>& img) { return img.width_step(); }
+
 // ---------------------------------------------------------------------------------------------------
 
     }
+
+    template <class T>
+    struct image_traits<ffmpeg::frame_image<T>>
+    {
+        typedef T pixel_type;
+    };
+
+    template <class T>
+    struct image_traits<ffmpeg::const_frame_image<T>>
+    {
+        typedef T pixel_type;
+    };
 }
 
 #endif //DLIB_FFMPEG_UTILS
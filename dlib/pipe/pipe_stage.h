@@ -0,0 +1,251 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#ifndef DLIB_PIPE_STAGE_Hh_
+#define DLIB_PIPE_STAGE_Hh_
+
+#include "pipe_stage_abstract.h"
+#include "pipe_kernel_1.h"
+#include "../noncopyable.h"
+#include "../assert.h"
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    enum class pipe_overflow_policy
+    {
+        block,
+        drop_newest,
+        drop_oldest
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    bool enqueue_with_policy (
+        pipe<T>& p,
+        T& item,
+        pipe_overflow_policy policy,
+        unsigned long long& num_dropped
+    )
+    {
+        if (policy == pipe_overflow_policy::block)
+            return p.enqueue(item);
+
+        while (!p.enqueue_or_timeout(item, 0))
+        {
+            if (!p.is_enabled() || !p.is_enqueue_enabled())
+                return false;
+
+            if (policy == pipe_overflow_policy::drop_newest || p.max_size() == 0 || !p.is_dequeue_enabled())
+            {
+                ++num_dropped;
+                return true;
+            }
+
+            // Make room by throwing away the oldest item.  The dequeue can only fail if
+            // a consumer emptied the pipe in the meantime, in which case we just try
+            // again.
+            T oldest;
+            if (p.dequeue_or_timeout(oldest, 0))
+                ++num_dropped;
+        }
+        return true;
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    void close_when_empty (
+        pipe<T>& p
+    )
+    {
+        p.wait_until_empty();
+        p.disable_dequeue();
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename in_type,
+        typename out_type
+        >
+    class pipe_stage : noncopyable
+    {
+    public:
+
+        typedef std::function<bool(in_type&, out_type&)> function_type;
+
+        pipe_stage (
+            pipe<in_type>& in_,
+            pipe<out_type>& out_,
+            function_type f_,
+            unsigned long num_threads = 1,
+            pipe_overflow_policy policy_ = pipe_overflow_policy::block
+        ) :
+            in(in_),
+            out(out_),
+            f(std::move(f_)),
+            policy(policy_)
+        {
+            DLIB_CASSERT(f != nullptr);
+            num_threads = std::max<unsigned long>(num_threads, 1);
+            num_running = num_threads;
+            for (unsigned long i = 0; i < num_threads; ++i)
+                workers.emplace_back([this](){ thread(); });
+        }
+
+        ~pipe_stage (
+        )
+        {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (!finished)
+                    in.disable_dequeue();
+                // Nothing but disabling out wakes a thread waiting for out to be emptied
+                // or for room in it.
+                if (!out_closed)
+                    out.disable();
+            }
+            for (auto& w : workers)
+                w.join();
+        }
+
+        unsigned long get_num_threads (
+        ) const { return workers.size(); }
+
+        pipe_overflow_policy get_overflow_policy (
+        ) const { return policy; }
+
+        unsigned long long get_num_processed (
+        ) const { return num_processed; }
+
+        unsigned long long get_num_dropped (
+        ) const { return num_dropped; }
+
+        bool is_finished (
+        ) const
+        {
+            std::lock_guard<std::mutex> lock(m);
+            return finished;
+        }
+
+        void wait (
+        ) const
+        {
+            std::unique_lock<std::mutex> lock(m);
+            done.wait(lock, [this](){ return finished; });
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+    private:
+
+        void thread (
+        )
+        {
+            // Each thread reuses its input and output objects from one item to the next.
+            in_type item;
+            out_type result;
+            while (true)
+            {
+                // Number the items in the order they come out of the input pipe so the
+                // results can be put into the output pipe in that same order.
+                unsigned long long seq;
+                {
+                    std::lock_guard<std::mutex> lock(in_mutex);
+                    if (!in.dequeue(item))
+                        break;
+                    seq = next_in++;
+                }
+
+                bool keep = false;
+                try
+                {
+                    keep = f(item, result);
+                }
+                catch (...)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m);
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                    // This makes the other threads stop taking new items and tells
+                    // whoever feeds the input pipe that nobody is listening anymore.
+                    in.disable();
+                }
+                ++num_processed;
+
+                {
+                    std::unique_lock<std::mutex> lock(out_mutex);
+                    next_turn.wait(lock, [&](){ return next_out == seq; });
+                    if (keep)
+                    {
+                        unsigned long long dropped = 0;
+                        enqueue_with_policy(out, result, policy, dropped);
+                        num_dropped += dropped;
+                    }
+                    ++next_out;
+                }
+                next_turn.notify_all();
+            }
+
+            // The last thread to stop passes the end of the stream on to the next stage.
+            if (--num_running == 0)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    finished = true;
+                }
+                done.notify_all();
+                close_when_empty(out);
+                std::lock_guard<std::mutex> lock(m);
+                out_closed = true;
+            }
+        }
+
+        pipe<in_type>& in;
+        pipe<out_type>& out;
+        const function_type f;
+        const pipe_overflow_policy policy;
+
+        std::mutex in_mutex;
+        unsigned long long next_in = 0;
+
+        std::mutex out_mutex;
+        std::condition_variable next_turn;
+        unsigned long long next_out = 0;
+
+        std::atomic<unsigned long long> num_processed{0};
+        std::atomic<unsigned long long> num_dropped{0};
+        std::atomic<unsigned long> num_running{0};
+
+        mutable std::mutex m;
+        mutable std::condition_variable done;
+        bool finished = false;
+        bool out_closed = false;
+        std::exception_ptr error;
+
+        std::vector<std::thread> workers;
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_PIPE_STAGE_Hh_
+
@@ -0,0 +1,237 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+#undef DLIB_PIPE_STAGE_ABSTRACT_Hh_
+#ifdef DLIB_PIPE_STAGE_ABSTRACT_Hh_
+
+#include "pipe_kernel_abstract.h"
+#include "../noncopyable.h"
+#include <functional>
+
+namespace dlib
+{
+
+// ----------------------------------------------------------------------------------------
+
+    enum class pipe_overflow_policy
+    {
+        block,       // wait for room in the pipe
+        drop_newest, // discard the item that doesn't fit
+        drop_oldest  // discard the oldest item in the pipe to make room
+    };
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    bool enqueue_with_policy (
+        pipe<T>& p,
+        T& item,
+        pipe_overflow_policy policy,
+        unsigned long long& num_dropped
+    );
+    /*!
+        ensures
+            - Puts item into p, deciding what to do when p is full according to policy:
+                - pipe_overflow_policy::block: waits until there is room, just like
+                  p.enqueue(item) does.
+                - pipe_overflow_policy::drop_newest: doesn't wait.  If p is full item is
+                  discarded.
+                - pipe_overflow_policy::drop_oldest: doesn't wait.  If p is full the
+                  oldest items in p are dequeued and discarded until item fits.  If p
+                  has a max_size() of 0, or nothing can be dequeued from it, item is
+                  discarded instead.
+              So the last two never block, which is what you want when a real time
+              source, like a camera, feeds a consumer that is sometimes too slow to keep
+              up with it.
+            - Adds the number of items that were discarded to num_dropped.
+            - returns false if p isn't accepting items because it, or its enqueue
+              functions, are disabled.  Returns true otherwise, even if item was
+              discarded.
+            - #item is in an undefined but valid state for its type if it was put into p.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename T
+        >
+    void close_when_empty (
+        pipe<T>& p
+    );
+    /*!
+        ensures
+            - Waits until everything in p has been dequeued and then disables dequeueing
+              from p.  This is how a producer signals the end of its stream: consumers
+              get all the items in the pipe and then their calls to dequeue() return
+              false.  In particular, it makes a pipe_stage reading from p finish.
+    !*/
+
+// ----------------------------------------------------------------------------------------
+
+    template <
+        typename in_type,
+        typename out_type
+        >
+    class pipe_stage : noncopyable
+    {
+        /*!
+            REQUIREMENTS ON in_type AND out_type
+                They must meet the requirements of dlib::pipe.
+
+            WHAT THIS OBJECT REPRESENTS
+                This object is one stage of a processing pipeline.  It runs a pool of
+                threads that take items out of an input pipe, call a user supplied
+                function on each of them, and put the results into an output pipe.
+                Stages are connected by giving one stage's output pipe to the next
+                stage as its input, so that each step of the pipeline runs concurrently
+                with the others and the size of the pipes bounds the number of items
+                waiting between two steps.
+
+                The results are put into the output pipe in the same order as the items
+                they were made from came out of the input pipe, no matter how many
+                threads the stage uses.
+
+                For example, this decodes a video on one thread, converts its frames to
+                images on another, and runs a face detector on 4 more, showing the
+                detections as they arrive.  When the detector falls behind, frames are
+                dropped before they are converted, so what is shown stays close to real
+                time:
+
+                    dlib::pipe<ffmpeg::frame> frames(4);
+                    dlib::pipe<array2d<rgb_pixel>> images(8);
+                    dlib::pipe<std::vector<rectangle>> detections(8);
+
+                    pipe_stage<ffmpeg::frame, array2d<rgb_pixel>> converter(frames, images,
+                        [](ffmpeg::frame& f, array2d<rgb_pixel>& img) { convert(f, img); return true; });
+
+                    frontal_face_detector detector = get_frontal_face_detector();
+                    pipe_stage<array2d<rgb_pixel>, std::vector<rectangle>> detection(images, detections,
+                        [&](array2d<rgb_pixel>& img, std::vector<rectangle>& dets)
+                        {
+                            // object detectors aren't thread safe, so each thread uses its
+                            // own copy.
+                            thread_local frontal_face_detector local_detector = detector;
+                            dets = local_detector(img);
+                            return true;
+                        }, 4);
+
+                    std::thread decoder([&]
+                    {
+                        ffmpeg::demuxer cap({"rtsp://camera/stream", ffmpeg::video_enabled, ffmpeg::audio_disabled});
+                        ffmpeg::frame f;
+                        unsigned long long num_dropped = 0;
+                        while (cap.read(f))
+                            enqueue_with_policy(frames, f, pipe_overflow_policy::drop_oldest, num_dropped);
+                        close_when_empty(frames);
+                    });
+
+                    std::vector<rectangle> dets;
+                    while (detections.dequeue(dets))
+                        show(dets);
+                    decoder.join();
+
+            THREAD SAFETY
+                All methods of this object are thread safe.
+        !*/
+
+    public:
+
+        typedef std::function<bool(in_type&, out_type&)> function_type;
+
+        pipe_stage (
+            pipe<in_type>& in,
+            pipe<out_type>& out,
+            function_type f,
+            unsigned long num_threads = 1,
+            pipe_overflow_policy policy = pipe_overflow_policy::block
+        );
+        /*!
+            requires
+                - f != nullptr
+                - f(item, result) can be called concurrently from num_threads threads.  It
+                  must set result to the output for the input item, and return true if
+                  result should be passed on or false to skip this item.  Both item and
+                  result may hold values from an earlier call, whose memory f can reuse.
+                - in and out must outlive this object.
+            ensures
+                - #get_num_threads() == max(num_threads,1)
+                - #get_overflow_policy() == policy
+                - #get_num_processed() == 0
+                - #get_num_dropped() == 0
+                - Starts the threads, which immediately begin moving items from in to out.
+                  Each result is put into out with enqueue_with_policy(out, result,
+                  policy, ...).
+                - The stage finishes once the dequeue functions of in return false, i.e.
+                  once in, or its dequeue functions, are disabled, for example by
+                  close_when_empty(in).  After that it does close_when_empty(out), so
+                  that the end of the stream reaches the next stage as well.
+        !*/
+
+        ~pipe_stage (
+        );
+        /*!
+            ensures
+                - If the stage hasn't finished, dequeueing from in is disabled so that it
+                  stops right away.  The items being processed at that point are lost.
+                - If the stage hasn't closed out yet, because nobody has read the last
+                  results from it, out is disabled.
+                - Waits for all the threads to end.
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads running f.
+        !*/
+
+        pipe_overflow_policy get_overflow_policy (
+        ) const;
+        /*!
+            ensures
+                - returns the policy used to put results into a full output pipe.
+        !*/
+
+        unsigned long long get_num_processed (
+        ) const;
+        /*!
+            ensures
+                - returns the number of items f has been called on so far.
+        !*/
+
+        unsigned long long get_num_dropped (
+        ) const;
+        /*!
+            ensures
+                - returns the number of items that were discarded so far because the
+                  output pipe was full.  Items skipped because f returned false are not
+                  counted.
+        !*/
+
+        bool is_finished (
+        ) const;
+        /*!
+            ensures
+                - returns true if the stage has finished, i.e. all the items from in have
+                  been processed and their results put into out, or f threw an exception.
+                  Returns false otherwise.
+        !*/
+
+        void wait (
+        ) const;
+        /*!
+            ensures
+                - blocks until is_finished() == true
+            throws
+                - any exception thrown by f.  When f throws, the stage disables in, which
+                  also makes later enqueues into it fail, and finishes.
+        !*/
+    };
+
+// ----------------------------------------------------------------------------------------
+
+}
+
+#endif // DLIB_PIPE_STAGE_ABSTRACT_Hh_
+
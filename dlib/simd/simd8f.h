@@ -215,6 +215,18 @@ namespace dlib
     inline simd8f& operator/= (simd8f& lhs, const simd8f& rhs) 
     { lhs = lhs / rhs; return lhs; }
 
+// ----------------------------------------------------------------------------------------
+
+    // Returns a*b + c, as a single fused multiply-add instruction when FMA is available.
+    inline simd8f fmadd (const simd8f& a, const simd8f& b, const simd8f& c)
+    {
+#if defined(DLIB_HAVE_AVX) && defined(__FMA__)
+        return _mm256_fmadd_ps(a, b, c);
+#else
+        return a*b + c;
+#endif
+    }
+
 // ----------------------------------------------------------------------------------------
 
     inline simd8f_bool operator== (const simd8f& lhs, const simd8f& rhs) 
@@ -9,6 +9,7 @@
 #include "../matrix.h"
 #include "../algs.h"
 #include "../rand.h"
+#include "../threads/parallel_for_extension.h"
 #include "svm.h"
 
 #include "function.h"
@@ -49,7 +50,8 @@ namespace dlib
             have_bias(true),
             last_weight_1(false),
             do_shrinking(true),
-            do_svm_l2(false)
+            do_svm_l2(false),
+            num_threads(1)
         {
         }
 
@@ -64,7 +66,8 @@ namespace dlib
             have_bias(true),
             last_weight_1(false),
             do_shrinking(true),
-            do_svm_l2(false)
+            do_svm_l2(false),
+            num_threads(1)
         {
             // make sure requires clause is not broken
             DLIB_ASSERT(0 < C_,
@@ -114,6 +117,13 @@ namespace dlib
             bool enabled
         ) { do_svm_l2 = enabled; }
 
+        void set_num_threads (
+            unsigned long num
+        ) { num_threads = num; }
+
+        unsigned long get_num_threads (
+        ) const { return num_threads; }
+
         void be_verbose (
         )
         {
@@ -532,6 +542,9 @@ namespace dlib
             const scalar_type Dii_pos = 1/(2*Cpos);
             const scalar_type Dii_neg = 1/(2*Cneg);
 
+            // only used when num_threads > 1
+            thread_pool tp(num_threads > 1 ? num_threads : 0);
+
             // main loop
             for (unsigned long iter = 0; iter < max_iterations; ++iter)
             {
@@ -546,40 +559,33 @@ namespace dlib
                     std::swap(index[i], index[j]);
                 }
                 
-                // for all the active training samples
-                for (unsigned long ii = 0; ii < active_size; ++ii)
+                // Split the active samples into blocks that are optimized in parallel.
+                // Tiny blocks aren't worth the cost of merging their results, so small
+                // active sets are optimized by this thread alone.
+                const unsigned long num_blocks = std::min<unsigned long>(num_threads, active_size/min_block_size);
+                if (num_blocks > 1)
                 {
-                    const long i = index[ii];
-
-                    scalar_type G = y(i)*dot(w, x(i)) - 1;
-                    if (do_svm_l2)
+                    optimize_blocks(x, y, state, tp, num_blocks, active_size, PG_max_prev, PG_min_prev, PG_max, PG_min);
+                }
+                else
+                {
+                    // for all the active training samples
+                    for (unsigned long ii = 0; ii < active_size; ++ii)
                     {
-                        if (y(i) > 0)
-                            G += Dii_pos*alpha[i];
-                        else
-                            G += Dii_neg*alpha[i];
-                    }
-                    const scalar_type C = (y(i) > 0) ? Cpos : Cneg;
-                    const scalar_type U = do_svm_l2 ? std::numeric_limits<scalar_type>::infinity() : C;
+                        const long i = index[ii];
 
-                    scalar_type PG = 0;
-                    if (alpha[i] == 0)
-                    {
-                        if (G > PG_max_prev)
+                        scalar_type G = y(i)*dot(w, x(i)) - 1;
+                        if (do_svm_l2)
                         {
-                            // shrink the active set of training examples
-                            --active_size;
-                            std::swap(index[ii], index[active_size]);
-                            --ii;
-                            continue;
+                            if (y(i) > 0)
+                                G += Dii_pos*alpha[i];
+                            else
+                                G += Dii_neg*alpha[i];
                         }
+                        const scalar_type U = upper_bound(y(i));
 
-                        if (G < 0)
-                            PG = G;
-                    }
-                    else if (alpha[i] == U)
-                    {
-                        if (G < PG_min_prev)
+                        scalar_type PG;
+                        if (!projected_gradient(alpha[i], G, U, PG_max_prev, PG_min_prev, PG))
                         {
                             // shrink the active set of training examples
                             --active_size;
@@ -588,33 +594,26 @@ namespace dlib
                             continue;
                         }
 
-                        if (G > 0)
-                            PG = G;
-                    }
-                    else
-                    {
-                        PG = G;
-                    }
+                        if (PG > PG_max) 
+                            PG_max = PG;
+                        if (PG < PG_min) 
+                            PG_min = PG;
 
-                    if (PG > PG_max) 
-                        PG_max = PG;
-                    if (PG < PG_min) 
-                        PG_min = PG;
-
-                    // if PG != 0
-                    if (std::abs(PG) > 1e-12)
-                    {
-                        const scalar_type alpha_old = alpha[i];
-                        alpha[i] = std::min(std::max(alpha[i] - G/state.Q[i], (scalar_type)0.0), U);
-                        const scalar_type delta = (alpha[i]-alpha_old)*y(i);
-                        add_to(w, x(i), delta);
-                        if (have_bias && !last_weight_1)
-                            w(w.size()-1) -= delta;
+                        // if PG != 0
+                        if (std::abs(PG) > 1e-12)
+                        {
+                            const scalar_type alpha_old = alpha[i];
+                            alpha[i] = std::min(std::max(alpha[i] - G/state.Q[i], (scalar_type)0.0), U);
+                            const scalar_type delta = (alpha[i]-alpha_old)*y(i);
+                            add_to(w, x(i), delta);
+                            if (have_bias && !last_weight_1)
+                                w(w.size()-1) -= delta;
+
+                            if (last_weight_1)
+                                w(dims-1) = 1;
+                        }
 
-                        if (last_weight_1)
-                            w(dims-1) = 1;
                     }
-
                 }
 
                 if (verbose)
@@ -671,6 +670,174 @@ namespace dlib
             return df;
         }
 
+        scalar_type upper_bound (
+            scalar_type y
+        ) const
+        {
+            const scalar_type C = (y > 0) ? Cpos : Cneg;
+            return do_svm_l2 ? std::numeric_limits<scalar_type>::infinity() : C;
+        }
+
+        bool projected_gradient (
+            scalar_type alpha,
+            scalar_type G,
+            scalar_type U,
+            scalar_type PG_max_prev,
+            scalar_type PG_min_prev,
+            scalar_type& PG
+        ) const
+        /*!
+            ensures
+                - returns false if the sample with the given alpha and gradient G should
+                  be removed from the active set.
+                - else
+                    - #PG == the projected gradient of the sample.
+        !*/
+        {
+            PG = 0;
+            if (alpha == 0)
+            {
+                if (G > PG_max_prev)
+                    return false;
+
+                if (G < 0)
+                    PG = G;
+            }
+            else if (alpha == U)
+            {
+                if (G < PG_min_prev)
+                    return false;
+
+                if (G > 0)
+                    PG = G;
+            }
+            else
+            {
+                PG = G;
+            }
+            return true;
+        }
+
+        template <
+            typename in_sample_vector_type,
+            typename in_scalar_vector_type
+            >
+        void optimize_blocks (
+            const in_sample_vector_type& x,
+            const in_scalar_vector_type& y,
+            optimizer_state& state,
+            thread_pool& tp,
+            const unsigned long num_blocks,
+            unsigned long& active_size,
+            const scalar_type PG_max_prev,
+            const scalar_type PG_min_prev,
+            scalar_type& PG_max,
+            scalar_type& PG_min
+        ) const
+        /*!
+            ensures
+                - Does one pass of dual coordinate descent over the first active_size
+                  samples in state.index, which are split into num_blocks blocks that are
+                  optimized in parallel.  Each block updates its own alpha values against
+                  a private copy of the change in w, and the changes are added into w at
+                  the end of the pass.  To make sure adding the changes from all the blocks
+                  together can't overshoot, each block takes steps num_blocks times
+                  smaller than usual along its own changes.  This is the CoCoA+ scheme
+                  from "Adding vs. Averaging in Distributed Primal-Dual Optimization" by
+                  Ma et al.
+                - Samples shrunk from the active set are moved behind the active ones and
+                  #active_size is the new number of active samples.
+                - #PG_max and #PG_min are updated with the projected gradients of the
+                  samples.
+        !*/
+        {
+            std::vector<scalar_type>& alpha = state.alpha;
+            scalar_vector_type& w = state.w;
+            std::vector<long>& index = state.index;
+            const long dims = state.dims;
+            const scalar_type sigma = num_blocks;
+            const scalar_type Dii_pos = 1/(2*Cpos);
+            const scalar_type Dii_neg = 1/(2*Cneg);
+
+            std::vector<scalar_vector_type> dw(num_blocks);
+            std::vector<unsigned long> block_active(num_blocks);
+            std::vector<scalar_type> block_PG_max(num_blocks, PG_max), block_PG_min(num_blocks, PG_min);
+            const auto block_begin = [&](unsigned long k) { return active_size*k/num_blocks; };
+
+            parallel_for(tp, 0, num_blocks, [&](long k)
+            {
+                const unsigned long begin = block_begin(k);
+                unsigned long end = block_begin(k+1);
+                scalar_vector_type& dwk = dw[k];
+                dwk.set_size(w.size());
+                dwk = 0;
+                for (unsigned long ii = begin; ii < end; ++ii)
+                {
+                    const long i = index[ii];
+
+                    scalar_type G = y(i)*(dot(w, x(i)) + sigma*dot(dwk, x(i))) - 1;
+                    if (do_svm_l2)
+                    {
+                        if (y(i) > 0)
+                            G += Dii_pos*alpha[i];
+                        else
+                            G += Dii_neg*alpha[i];
+                    }
+                    const scalar_type U = upper_bound(y(i));
+
+                    scalar_type PG;
+                    if (!projected_gradient(alpha[i], G, U, PG_max_prev, PG_min_prev, PG))
+                    {
+                        // shrink the active set of this block
+                        --end;
+                        std::swap(index[ii], index[end]);
+                        --ii;
+                        continue;
+                    }
+
+                    block_PG_max[k] = std::max(block_PG_max[k], PG);
+                    block_PG_min[k] = std::min(block_PG_min[k], PG);
+
+                    // if PG != 0
+                    if (std::abs(PG) > 1e-12)
+                    {
+                        const scalar_type alpha_old = alpha[i];
+                        alpha[i] = std::min(std::max(alpha[i] - G/(sigma*state.Q[i]), (scalar_type)0.0), U);
+                        const scalar_type delta = (alpha[i]-alpha_old)*y(i);
+                        add_to(dwk, x(i), delta);
+                        if (have_bias && !last_weight_1)
+                            dwk(dwk.size()-1) -= delta;
+
+                        if (last_weight_1)
+                            dwk(dims-1) = 0;
+                    }
+                }
+                block_active[k] = end - begin;
+            });
+
+            // Merge the blocks.  Their active samples go to the front of index, followed
+            // by the samples they shrunk.
+            std::vector<long> shrunk;
+            unsigned long new_active_size = 0;
+            for (unsigned long k = 0; k < num_blocks; ++k)
+            {
+                w += dw[k];
+                PG_max = std::max(PG_max, block_PG_max[k]);
+                PG_min = std::min(PG_min, block_PG_min[k]);
+
+                const unsigned long begin = block_begin(k);
+                const unsigned long end = block_begin(k+1);
+                shrunk.insert(shrunk.end(), index.begin()+begin+block_active[k], index.begin()+end);
+                for (unsigned long ii = begin; ii < begin+block_active[k]; ++ii)
+                    index[new_active_size++] = index[ii];
+            }
+            std::copy(shrunk.begin(), shrunk.end(), index.begin()+new_active_size);
+            active_size = new_active_size;
+
+            if (last_weight_1)
+                w(dims-1) = 1;
+        }
+
         scalar_type dot (
             const scalar_vector_type& w,
             const sample_type& sample
@@ -698,6 +865,10 @@ namespace dlib
         bool last_weight_1;
         bool do_shrinking;
         bool do_svm_l2;
+        unsigned long num_threads;
+
+        // The smallest number of samples worth giving to a thread.
+        const static unsigned long min_block_size = 1000;
 
     }; // end of class svm_c_linear_dcd_trainer
 
@@ -68,6 +68,7 @@ namespace dlib
                 - #includes_bias() == true
                 - #shrinking_enabled() == true
                 - #solving_svm_l2_problem() == false
+                - #get_num_threads() == 1
         !*/
 
         explicit svm_c_linear_dcd_trainer (
@@ -88,6 +89,7 @@ namespace dlib
                 - #includes_bias() == true
                 - #shrinking_enabled() == true
                 - #solving_svm_l2_problem() == false
+                - #get_num_threads() == 1
         !*/
 
         bool includes_bias (
@@ -159,6 +161,29 @@ namespace dlib
                 - #solving_svm_l2_problem() == enabled
         !*/
 
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            ensures
+                - #get_num_threads() == num
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads used by train().  When this is more than
+                  1, each pass of the optimizer splits the active training samples into
+                  up to get_num_threads() blocks and optimizes the blocks in parallel,
+                  combining their updates with the CoCoA+ method.  The blocks are made
+                  from consecutive samples in the optimizer's random order, so the
+                  results don't depend on how the threads are scheduled.  They differ
+                  slightly from the results of single threaded training, but both
+                  converge to the same solution.  Sets of fewer than a few thousand active
+                  samples are always optimized by a single thread.
+        !*/
+
         void be_verbose (
         );
         /*!
@@ -13,6 +13,7 @@
 #include "function.h"
 #include "kernel.h"
 #include "../optimization/optimization_solve_qp3_using_smo.h"
+#include "../threads/parallel_for_extension.h"
 
 namespace dlib 
 {
@@ -36,6 +37,7 @@ namespace dlib
             Cpos(1),
             Cneg(1),
             cache_size(200),
+            num_threads(1),
             eps(0.001)
         {
         }
@@ -48,6 +50,7 @@ namespace dlib
             Cpos(C_),
             Cneg(C_),
             cache_size(200),
+            num_threads(1),
             eps(0.001)
         {
             // make sure requires clause is not broken
@@ -77,6 +80,19 @@ namespace dlib
             return cache_size;
         }
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return num_threads;
+        }
+
         void set_epsilon (
             scalar_type eps_
         )
@@ -187,6 +203,7 @@ namespace dlib
             exchange(Cpos,            item.Cpos);
             exchange(Cneg,            item.Cneg);
             exchange(cache_size,      item.cache_size);
+            exchange(num_threads,     item.num_threads);
             exchange(eps,             item.eps);
         }
 
@@ -223,7 +240,11 @@ namespace dlib
 
             solve_qp3_using_smo<scalar_vector_type> solver;
 
-            solver(symmetric_matrix_cache<float>((diagm(y)*kernel_matrix(kernel_function,x)*diagm(y)), cache_size), 
+            // The kernel matrix columns the solver asks for are computed by these
+            // threads.  A pool without threads computes them in this thread instead.
+            thread_pool tp(num_threads > 1 ? num_threads : 0);
+
+            solver(symmetric_matrix_cache<float>((diagm(y)*kernel_matrix(kernel_function,x)*diagm(y)), cache_size, tp), 
                    uniform_matrix<scalar_type>(y.size(),1,-1),
                    y, 
                    0,
@@ -336,6 +357,7 @@ namespace dlib
         scalar_type Cpos;
         scalar_type Cneg;
         long cache_size;
+        unsigned long num_threads;
         scalar_type eps;
     }; // end of class svm_c_trainer
 
@@ -14,6 +14,7 @@
 #include "function.h"
 #include "kernel.h"
 #include "../optimization/optimization_solve_qp2_using_smo.h"
+#include "../threads/parallel_for_extension.h"
 
 namespace dlib 
 {
@@ -36,6 +37,7 @@ namespace dlib
         ) :
             nu(0.1),
             cache_size(200),
+            num_threads(1),
             eps(0.001)
         {
         }
@@ -47,6 +49,7 @@ namespace dlib
             kernel_function(kernel_),
             nu(nu_),
             cache_size(200),
+            num_threads(1),
             eps(0.001)
         {
             // make sure requires clause is not broken
@@ -76,6 +79,19 @@ namespace dlib
             return cache_size;
         }
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return num_threads;
+        }
+
         void set_epsilon (
             scalar_type eps_
         )
@@ -146,6 +162,7 @@ namespace dlib
             exchange(kernel_function, item.kernel_function);
             exchange(nu,              item.nu);
             exchange(cache_size,      item.cache_size);
+            exchange(num_threads,     item.num_threads);
             exchange(eps,             item.eps);
         }
 
@@ -182,7 +199,11 @@ namespace dlib
 
             solve_qp2_using_smo<scalar_vector_type> solver;
 
-            solver(symmetric_matrix_cache<float>((diagm(y)*kernel_matrix(kernel_function,x)*diagm(y)), cache_size), 
+            // The kernel matrix columns the solver asks for are computed by these
+            // threads.  A pool without threads computes them in this thread instead.
+            thread_pool tp(num_threads > 1 ? num_threads : 0);
+
+            solver(symmetric_matrix_cache<float>((diagm(y)*kernel_matrix(kernel_function,x)*diagm(y)), cache_size, tp), 
                    y, 
                    nu,
                    alpha,
@@ -303,6 +324,7 @@ namespace dlib
         kernel_type kernel_function;
         scalar_type nu;
         long cache_size;
+        unsigned long num_threads;
         scalar_type eps;
     }; // end of class svm_nu_trainer
 
@@ -13,6 +13,7 @@
 #include "function.h"
 #include "kernel.h"
 #include "../optimization/optimization_solve_qp3_using_smo.h"
+#include "../threads/parallel_for_extension.h"
 
 namespace dlib 
 {
@@ -35,6 +36,7 @@ namespace dlib
         ) :
             nu(0.1),
             cache_size(200),
+            num_threads(1),
             eps(0.001)
         {
         }
@@ -46,6 +48,7 @@ namespace dlib
             kernel_function(kernel_),
             nu(nu_),
             cache_size(200),
+            num_threads(1),
             eps(0.001)
         {
             // make sure requires clause is not broken
@@ -75,6 +78,19 @@ namespace dlib
             return cache_size;
         }
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return num_threads;
+        }
+
         void set_epsilon (
             scalar_type eps_
         )
@@ -143,6 +159,7 @@ namespace dlib
             exchange(kernel_function, item.kernel_function);
             exchange(nu,              item.nu);
             exchange(cache_size,      item.cache_size);
+            exchange(num_threads,     item.num_threads);
             exchange(eps,             item.eps);
         }
 
@@ -174,7 +191,11 @@ namespace dlib
 
             solve_qp3_using_smo<scalar_vector_type> solver;
 
-            solver(symmetric_matrix_cache<float>(kernel_matrix(kernel_function,x), cache_size), 
+            // The kernel matrix columns the solver asks for are computed by these
+            // threads.  A pool without threads computes them in this thread instead.
+            thread_pool tp(num_threads > 1 ? num_threads : 0);
+
+            solver(symmetric_matrix_cache<float>(kernel_matrix(kernel_function,x), cache_size, tp), 
                    zeros_matrix<scalar_type>(x.size(),1),
                    ones_matrix<scalar_type>(x.size(),1), 
                    nu*x.size(),
@@ -264,6 +285,7 @@ namespace dlib
         kernel_type kernel_function;
         scalar_type nu;
         long cache_size;
+        unsigned long num_threads;
         scalar_type eps;
     }; // end of class svm_one_class_trainer
 
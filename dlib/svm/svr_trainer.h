@@ -13,6 +13,7 @@
 #include "function.h"
 #include "kernel.h"
 #include "../optimization/optimization_solve_qp3_using_smo.h"
+#include "../threads/parallel_for_extension.h"
 
 namespace dlib 
 {
@@ -36,6 +37,7 @@ namespace dlib
             C(1),
             eps_insensitivity(0.1),
             cache_size(200),
+            num_threads(1),
             eps(0.001)
         {
         }
@@ -59,6 +61,19 @@ namespace dlib
             return cache_size;
         }
 
+        void set_num_threads (
+            unsigned long num
+        )
+        {
+            num_threads = num;
+        }
+
+        unsigned long get_num_threads (
+        ) const
+        {
+            return num_threads;
+        }
+
         void set_epsilon (
             scalar_type eps_
         )
@@ -151,6 +166,7 @@ namespace dlib
             exchange(C,            item.C);
             exchange(eps_insensitivity, item.eps_insensitivity);
             exchange(cache_size,      item.cache_size);
+            exchange(num_threads,     item.num_threads);
             exchange(eps,             item.eps);
         }
 
@@ -260,7 +276,11 @@ namespace dlib
 
             solve_qp3_using_smo<scalar_vector_type> solver;
 
-            solver(symmetric_matrix_cache<float>(make_quad(kernel_matrix(kernel_function,x)), cache_size), 
+            // The kernel matrix columns the solver asks for are computed by these
+            // threads.  A pool without threads computes them in this thread instead.
+            thread_pool tp(num_threads > 1 ? num_threads : 0);
+
+            solver(symmetric_matrix_cache<float>(make_quad(kernel_matrix(kernel_function,x)), cache_size, tp), 
                    uniform_matrix<scalar_type>(2*x.size(),1, eps_insensitivity) + join_cols(y,-y),
                    join_cols(uniform_matrix<scalar_type>(x.size(),1,1), uniform_matrix<scalar_type>(x.size(),1,-1)), 
                    0,
@@ -373,6 +393,7 @@ namespace dlib
         scalar_type C;
         scalar_type eps_insensitivity;
         long cache_size;
+        unsigned long num_threads;
         scalar_type eps;
     }; // end of class svr_trainer
 
@@ -51,6 +51,7 @@ namespace dlib
                 - #get_c() == 1
                 - #get_epsilon_insensitivity() == 0.1
                 - #get_cache_size() == 200
+                - #get_num_threads() == 1
                 - #get_epsilon() == 0.001
         !*/
 
@@ -75,6 +76,27 @@ namespace dlib
                   memory, obviously.)
         !*/
 
+        void set_num_threads (
+            unsigned long num
+        );
+        /*!
+            ensures
+                - #get_num_threads() == num
+        !*/
+
+        unsigned long get_num_threads (
+        ) const;
+        /*!
+            ensures
+                - returns the number of threads used to compute the kernel matrix
+                  columns needed during training.  Computing them is usually what takes
+                  most of the time when training on a lot of samples, so you should
+                  usually set this equal to the number of processing cores on your
+                  machine.  The number of threads doesn't affect the result.
+                - The kernel must be safe to call from multiple threads at once when
+                  get_num_threads() > 1.  All of dlib's kernels are.
+        !*/
+
         void set_epsilon (
             scalar_type eps
         );
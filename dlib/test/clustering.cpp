@@ -143,10 +143,58 @@ namespace
         const double m1 = modularity(edges, labels);
         const double m2 = compute_modularity_simple(edges, labels);
         const double m3 = modularity(oedges, labels);
+        const double m4 = modularity(csr_graph(edges), labels);
+        const double m5 = modularity(csr_graph(oedges), labels);
 
         DLIB_TEST(std::abs(m1-m2) < 1e-12);
         DLIB_TEST(std::abs(m2-m3) < 1e-12);
         DLIB_TEST(std::abs(m3-m1) < 1e-12);
+        DLIB_TEST(std::abs(m4-m1) < 1e-12);
+        DLIB_TEST(std::abs(m5-m1) < 1e-12);
+    }
+
+    void test_csr_graph(dlib::rand& rnd)
+    {
+        print_spinner();
+        std::vector<sample_pair> edges;
+        std::vector<ordered_sample_pair> oedges;
+        std::vector<unsigned long> labels;
+
+        make_test_graph(rnd, edges, labels, 5, 10, 3, 0.10);
+        edges.push_back(sample_pair(3,3,2));
+        convert_unordered_to_ordered(edges, oedges);
+        std::sort(oedges.begin(), oedges.end(), &order_by_index<ordered_sample_pair>);
+
+        const csr_graph g(edges);
+        DLIB_TEST(g.size() == max_index_plus_one(edges));
+        DLIB_TEST(g.number_of_edges() == oedges.size());
+        std::vector<ordered_sample_pair> temp;
+        for (unsigned long i = 0; i < g.size(); ++i)
+        {
+            for (auto e = g.edges_begin(i); e != g.edges_end(i); ++e)
+                temp.push_back(ordered_sample_pair(i, g.neighbor(e), g.weight(e)));
+        }
+        std::sort(temp.begin(), temp.end(), &order_by_index<ordered_sample_pair>);
+        DLIB_TEST(temp.size() == oedges.size());
+        for (unsigned long i = 0; i < temp.size(); ++i)
+        {
+            DLIB_TEST(temp[i] == oedges[i]);
+            DLIB_TEST(temp[i].distance() == oedges[i].distance());
+        }
+
+        std::ostringstream sout;
+        serialize(g, sout);
+        std::istringstream sin(sout.str());
+        csr_graph g2;
+        DLIB_TEST(g2.size() == 0);
+        deserialize(g2, sin);
+        DLIB_TEST(g2.size() == g.size());
+        DLIB_TEST(g2.number_of_edges() == g.number_of_edges());
+        for (unsigned long e = 0; e < g.number_of_edges(); ++e)
+        {
+            DLIB_TEST(g2.neighbor(e) == g.neighbor(e));
+            DLIB_TEST(g2.weight(e) == g.weight(e));
+        }
     }
 
     void test_newman_clustering(dlib::rand& rnd)
@@ -220,6 +268,84 @@ namespace
         }
     }
 
+    void test_parallel_chinese_whispers(dlib::rand& rnd)
+    {
+        print_spinner();
+        std::vector<sample_pair> edges;
+        std::vector<unsigned long> labels;
+
+        make_test_graph(rnd, edges, labels, 5, 30, 3, 0.10);
+        const csr_graph graph(edges);
+
+        std::vector<unsigned long> labels2, labels3;
+        const unsigned long seed = rnd.get_random_32bit_number();
+        dlib::rand rnd2(seed), rnd3(seed);
+        unsigned long num_clusters = chinese_whispers(graph, labels2, 200, 1, rnd2);
+        DLIB_TEST(chinese_whispers(graph, labels3, 200, 4, rnd3) == num_clusters);
+        DLIB_TEST(labels2 == labels3);
+
+        DLIB_TEST(labels.size() == labels2.size());
+        DLIB_TEST(num_clusters == 5);
+
+        for (unsigned long i = 0; i < labels.size(); ++i)
+        {
+            for (unsigned long j = 0; j < labels.size(); ++j)
+            {
+                if (labels[i] == labels[j])
+                {
+                    DLIB_TEST(labels2[i] == labels2[j]);
+                }
+                else
+                {
+                    DLIB_TEST(labels2[i] != labels2[j]);
+                }
+            }
+        }
+    }
+
+    void test_louvain_clustering(dlib::rand& rnd)
+    {
+        print_spinner();
+        std::vector<sample_pair> edges;
+        std::vector<unsigned long> labels;
+
+        make_test_graph(rnd, edges, labels, 5, 30, 3, 0.10);
+        if (rnd.get_random_double() < 0.5)
+            remove_duplicate_edges(edges);
+
+
+        std::vector<unsigned long> labels2, labels3, labels4;
+
+        unsigned long num_clusters = louvain_cluster(edges, labels2);
+        DLIB_TEST(louvain_cluster(csr_graph(edges), labels3, 4) == num_clusters);
+        DLIB_TEST(labels2 == labels3);
+        DLIB_TEST(labels.size() == labels2.size());
+        DLIB_TEST(num_clusters == 5);
+
+        for (unsigned long i = 0; i < labels.size(); ++i)
+        {
+            for (unsigned long j = 0; j < labels.size(); ++j)
+            {
+                if (labels[i] == labels[j])
+                {
+                    DLIB_TEST(labels2[i] == labels2[j]);
+                }
+                else
+                {
+                    DLIB_TEST(labels2[i] != labels2[j]);
+                }
+            }
+        }
+
+        // On graphs without such a clear structure Louvain should still do at least as
+        // well as the Newman method.
+        make_test_graph(rnd, edges, labels, 10, 20, 20, 0.5);
+        louvain_cluster(edges, labels3);
+        newman_cluster(edges, labels4);
+        DLIB_TEST_MSG(modularity(edges, labels3) >= modularity(edges, labels4) - 0.01,
+            modularity(edges, labels3) << "  " << modularity(edges, labels4));
+    }
+
     void test_bottom_up_clustering()
     {
         std::vector<dpoint> pts;
@@ -361,8 +487,16 @@ namespace
             std::vector<unsigned long> labels;
             DLIB_TEST(newman_cluster(edges, labels) == 0);
             DLIB_TEST(chinese_whispers(edges, labels) == 0);
+            DLIB_TEST(chinese_whispers(csr_graph(edges), labels, 100, 2) == 0);
+            DLIB_TEST(labels.size() == 0);
+            DLIB_TEST(louvain_cluster(edges, labels) == 0);
+            DLIB_TEST(labels.size() == 0);
 
             edges.push_back(sample_pair(0,1,1));
+            DLIB_TEST(chinese_whispers(csr_graph(edges), labels, 100, 2) == 1);
+            DLIB_TEST(labels.size() == 2);
+            DLIB_TEST(louvain_cluster(edges, labels) == 1);
+            DLIB_TEST(labels.size() == 2);
             DLIB_TEST(newman_cluster(edges, labels) == 1);
             DLIB_TEST(labels.size() == 2);
             DLIB_TEST(chinese_whispers(edges, labels) == 1);
@@ -370,6 +504,8 @@ namespace
 
             edges.clear();
             edges.push_back(sample_pair(0,0,1));
+            DLIB_TEST(louvain_cluster(edges, labels) == 1);
+            DLIB_TEST(labels.size() == 1);
             DLIB_TEST(newman_cluster(edges, labels) == 1);
             DLIB_TEST(labels.size() == 1);
             DLIB_TEST(chinese_whispers(edges, labels) == 1);
@@ -383,6 +519,8 @@ namespace
             DLIB_TEST(labels.size() == 2);
 
             edges.push_back(sample_pair(0,0,1));
+            DLIB_TEST(louvain_cluster(edges, labels) == 2);
+            DLIB_TEST(labels.size() == 2);
             DLIB_TEST(newman_cluster(edges, labels) == 2);
             DLIB_TEST(labels.size() == 2);
             DLIB_TEST(chinese_whispers(edges, labels) == 2);
@@ -398,6 +536,15 @@ namespace
             for (int i = 0; i < 10; ++i)
                 test_chinese_whispers(rnd);
 
+            for (int i = 0; i < 10; ++i)
+                test_csr_graph(rnd);
+
+            for (int i = 0; i < 10; ++i)
+                test_parallel_chinese_whispers(rnd);
+
+            for (int i = 0; i < 10; ++i)
+                test_louvain_clustering(rnd);
+
 
         }
     } a;
@@ -80,6 +80,83 @@ namespace
                 DLIB_TEST(rect_confidence >= 0.97);
                 print_spinner();
             }
+
+            test_multi_correlation_tracker(frames, sizeof(frames)/sizeof(frames[0]));
+        }
+
+        template <typename frame_fn_type>
+        void test_multi_correlation_tracker (
+            const frame_fn_type* frames,
+            unsigned long num_frames
+        )
+        {
+            dlog << LINFO << "test_multi_correlation_tracker()";
+
+            std::vector<drectangle> rects = {centered_rect(point(93, 110), 38, 86),
+                                             centered_rect(point(60, 60), 30, 30),
+                                             centered_rect(point(130, 90), 40, 50)};
+
+            std::vector<correlation_tracker> singles(rects.size());
+            multi_correlation_tracker serial, threaded;
+            threaded.set_num_threads(4);
+            DLIB_TEST(serial.get_num_threads() == 1);
+            DLIB_TEST(threaded.get_num_threads() == 4);
+            DLIB_TEST(serial.get_filter_size() == singles[0].get_filter_size());
+            DLIB_TEST(serial.get_num_scale_levels() == singles[0].get_num_scale_levels());
+
+            array2d<unsigned char> img;
+            std::istringstream sin(frames[0]());
+            load_bmp(img, sin);
+            for (unsigned long i = 0; i < rects.size(); ++i)
+            {
+                singles[i].start_track(img, rects[i]);
+                serial.start_track(img, rects[i]);
+                threaded.start_track(img, rects[i]);
+                DLIB_TEST(serial.get_position(i) == rects[i]);
+            }
+            DLIB_TEST(serial.size() == rects.size());
+
+            for (unsigned long f = 1; f < num_frames; ++f)
+            {
+                std::istringstream sin(frames[f]());
+                load_bmp(img, sin);
+
+                // Alternate between the two kinds of update to cover both.
+                const bool do_scale = (f%2) == 1;
+                const std::vector<double> psr1 = do_scale ? serial.update(img) : serial.update_noscale(img);
+                const std::vector<double> psr2 = do_scale ? threaded.update(img) : threaded.update_noscale(img);
+                DLIB_TEST(psr1.size() == rects.size());
+                DLIB_TEST(psr1 == psr2);
+                for (unsigned long i = 0; i < rects.size(); ++i)
+                {
+                    // The number of threads must not change the results at all.
+                    DLIB_TEST(serial.get_position(i) == threaded.get_position(i));
+
+                    // The single precision filters should track the same way as the
+                    // double precision ones used by correlation_tracker.
+                    const double psr = do_scale ? singles[i].update(img) : singles[i].update_noscale(img);
+                    const drectangle pos = serial.get_position(i);
+                    const drectangle correct_pos = singles[i].get_position();
+                    const double overlap = pos.intersect(correct_pos).area()/correct_pos.area();
+                    dlog << LINFO << "frame " << f << " target " << i << " psr: " << psr1[i] << " correct psr: " << psr
+                         << " pos: " << pos << " correct pos: " << correct_pos;
+                    DLIB_TEST(std::abs(psr1[i] - psr) < 0.01*psr);
+                    DLIB_TEST(overlap > 0.99);
+                    DLIB_TEST(std::abs(pos.width() - correct_pos.width()) < 0.01*correct_pos.width());
+                }
+                print_spinner();
+            }
+
+            // Removing a target shifts the ones after it down.
+            const drectangle last = serial.get_position(2);
+            serial.stop_track(1);
+            DLIB_TEST(serial.size() == 2);
+            DLIB_TEST(serial.get_position(1) == last);
+            std::vector<drectangle> guesses = {serial.get_position(0), serial.get_position(1)};
+            DLIB_TEST(serial.update(img, guesses).size() == 2);
+            serial.clear();
+            DLIB_TEST(serial.size() == 0);
+            DLIB_TEST(serial.update(img).size() == 0);
         }
 
     // ------------------------------------------------------------------------------------
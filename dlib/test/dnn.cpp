@@ -9,6 +9,9 @@
 #include <vector>
 #include <random>
 #include <numeric>
+#include <atomic>
+#include <thread>
+#include <chrono>
 #include "../dnn.h"
 
 #include "tester.h"
@@ -888,7 +891,7 @@ namespace
         }    
 
         auto& net_output = layer<tag1>(net).get_output();
-        DLIB_TEST(max(abs(mat(net_output) - expected_output)) < 1e-5);
+        DLIB_TEST(max(abs(reshape(mat(net_output), sequence_dim, embedding_dim) - expected_output)) < 1e-5);
     }
 
 // ----------------------------------------------------------------------------------------
@@ -2245,6 +2248,24 @@ namespace
             auto res = test_layer(l);
             DLIB_TEST_MSG(res, res);
         }        
+        {
+            print_spinner();
+            kv_cache_ l;
+            auto res = test_layer(l);
+            DLIB_TEST_MSG(res, res);
+        }
+        {
+            print_spinner();
+            attention_<1, ATTENTION_NO_MASK> l;
+            auto res = test_layer(l, 3);
+            DLIB_TEST_MSG(res, res);
+        }
+        {
+            print_spinner();
+            attention_<2, ATTENTION_CAUSAL_MASK> l;
+            auto res = test_layer(l, 6);
+            DLIB_TEST_MSG(res, res);
+        }
         {
             print_spinner();
             extract_<0,2,2,2> l;
@@ -5129,6 +5150,238 @@ void test_multm_prev()
         DLIB_TEST(max(squared(mat(out_nobias) - mat(out_nobias_fused))) < 1e-10);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    void test_fuse_layers_activations()
+    {
+        print_spinner();
+        using net_type = relu<affine<fc<10,
+            elu<add_prev1<clipped_relu<affine<con<6,3,3,1,1,
+            tag1<leaky_relu<affine<con<6,3,3,1,1,input_rgb_image>>>>>>>>>>>>;
+
+        for (bool use_bias : {true, false})
+        {
+            net_type net;
+            if (!use_bias)
+                disable_duplicative_biases(net);
+            matrix<rgb_pixel> image(9, 7);
+            dlib::rand rnd(0);
+            for (auto& p : image)
+                p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+            resizable_tensor x;
+            net.to_tensor(&image, &image+1, x);
+            net.forward(x);
+
+            // Give the affine layers and biases something to fold in.
+            visit_computational_layers(net, [&](auto& l)
+            {
+                for (auto& v : l.get_layer_params())
+                    v = rnd.get_random_gaussian()*0.5f;
+            });
+            const matrix<float> expected = mat(net.forward(x));
+
+            net_type fused(net);
+            fuse_layers(fused);
+            DLIB_TEST(!layer<0>(fused).layer_details().is_disabled());
+            DLIB_TEST(layer<1>(fused).layer_details().is_disabled());
+            DLIB_TEST(layer<3>(fused).layer_details().is_disabled());
+            DLIB_TEST(layer<4>(fused).layer_details().get_fused_activation() == fused_activation::ELU);
+            DLIB_TEST(layer<5>(fused).layer_details().is_disabled());
+            DLIB_TEST(layer<6>(fused).layer_details().is_disabled());
+            DLIB_TEST(layer<7>(fused).layer_details().get_fused_activation() == fused_activation::CLIPPED_RELU);
+            DLIB_TEST(layer<9>(fused).layer_details().is_disabled());
+            DLIB_TEST(layer<10>(fused).layer_details().is_disabled());
+            DLIB_TEST(layer<11>(fused).layer_details().get_fused_activation() == fused_activation::LEAKY_RELU);
+            DLIB_TEST(layer<11>(fused).layer_details().get_fused_activation_param() == 0.01f);
+
+            const matrix<float> out = mat(fused.forward(x));
+            DLIB_TEST_MSG(max(abs(out - expected)) < 1e-4, max(abs(out - expected)));
+
+            // Fusing again changes nothing.
+            fuse_layers(fused);
+            DLIB_TEST(max(abs(mat(fused.forward(x)) - out)) == 0);
+
+            std::ostringstream sout;
+            serialize(fused, sout);
+            net_type fused2;
+            std::istringstream sin(sout.str());
+            deserialize(fused2, sin);
+            DLIB_TEST(layer<4>(fused2).layer_details().get_fused_activation() == fused_activation::ELU);
+            DLIB_TEST(max(abs(mat(fused2.forward(x)) - out)) == 0);
+        }
+
+        // A fused activation that doesn't exist is rejected when deserializing.
+        con_<6,3,3,1,1> l1, l2;
+        l1.set_fused_activation(fused_activation::ELU, 0.5f);
+        l2.set_fused_activation(fused_activation::LEAKY_RELU, 0.5f);
+        std::ostringstream sout1, sout2;
+        serialize(l1, sout1);
+        serialize(l2, sout2);
+        std::string bad = sout1.str();
+        DLIB_TEST(bad.size() == sout2.str().size());
+        const auto diff = std::mismatch(bad.begin(), bad.end(), sout2.str().begin());
+        DLIB_TEST(diff.first != bad.end() && *diff.first == 4);
+        *diff.first = 9;
+        std::istringstream sin(bad);
+        bool threw = false;
+        try { deserialize(l1, sin); } catch (serialization_error&) { threw = true; }
+        DLIB_TEST(threw);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename SUBNET> using mem_block = relu<add_prev1<con<4,3,3,1,1,relu<con<4,3,3,1,1,tag1<SUBNET>>>>>>;
+    template <typename SUBNET> using mem_block_down = relu<add_prev2<avg_pool<2,2,2,2,skip1<tag2<con<6,3,3,2,2,relu<con<4,3,3,1,1,tag1<SUBNET>>>>>>>>>;
+
+    void test_inference_memory_sharing()
+    {
+        print_spinner();
+        using net_type = fc<3,avg_pool_everything<repeat<2,mem_block,mem_block_down<mem_block<relu<con<4,3,3,1,1,input<matrix<float>>>>>>>>>;
+        net_type net;
+
+        dlib::rand rnd(0);
+        std::vector<matrix<float>> samples;
+        for (int i = 0; i < 5; ++i)
+            samples.push_back(matrix_cast<float>(randm(12,10,rnd)));
+        resizable_tensor x3, x5;
+        net.to_tensor(samples.begin(), samples.begin()+3, x3);
+        net.to_tensor(samples.begin(), samples.end(), x5);
+        const matrix<float> expected3 = mat(net.forward(x3));
+        const matrix<float> expected5 = mat(net.forward(x5));
+
+        net_type shared(net);
+        enable_inference_memory_sharing(shared);
+        for (int iter = 0; iter < 2; ++iter)
+        {
+            DLIB_TEST(max(abs(mat(shared.forward(x3)) - expected3)) == 0);
+            // The input to the fc layer isn't needed once the fc layer has run.
+            DLIB_TEST(layer<1>(shared).get_output().size() == 0);
+            DLIB_TEST(max(abs(mat(shared.forward(x5)) - expected5)) == 0);
+        }
+
+        disable_inference_memory_sharing(shared);
+        DLIB_TEST(max(abs(mat(shared.forward(x3)) - expected3)) == 0);
+        DLIB_TEST(layer<1>(shared).get_output().size() != 0);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_data_loader()
+    {
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<2,relu<fc<8,input<matrix<float>>>>>>;
+        net_type net;
+
+        // Two well separated classes.  A sample's class and position both come from rnd.
+        auto make_sample = [](dlib::rand& rnd, matrix<float>& x, unsigned long& y)
+        {
+            y = rnd.get_random_32bit_number()%2;
+            x.set_size(4,1);
+            for (auto& v : x)
+                v = rnd.get_random_gaussian()*0.3f + (y == 0 ? -1 : 1);
+        };
+
+        resizable_tensor x1, x4;
+        std::vector<unsigned long> y1, y4;
+        {
+            dnn_data_loader<net_type> loader1(net, make_sample, 10, 1, 1, 7);
+            dnn_data_loader<net_type> loader4(net, make_sample, 10, 4, 0, 7);
+            DLIB_TEST(loader4.get_num_workers() == 4);
+            DLIB_TEST(loader4.get_max_prefetched_batches() == 8);
+            for (int i = 0; i < 20; ++i)
+            {
+                loader1.get_next(x1, y1);
+                loader4.get_next(x4, y4);
+                DLIB_TEST(x1.num_samples() == 10 && x1.k() == 1 && x1.nr() == 4 && x1.nc() == 1);
+                DLIB_TEST(y1 == y4);
+                DLIB_TEST(max(abs(mat(x1) - mat(x4))) == 0);
+            }
+            DLIB_TEST(loader4.get_num_batches_delivered() == 20);
+        }
+
+        // A different seed gives different mini-batches.
+        {
+            dnn_data_loader<net_type> loader(net, make_sample, 10, 2, 0, 8);
+            loader.get_next(x4, y4);
+            DLIB_TEST(max(abs(mat(x1) - mat(x4))) != 0);
+        }
+
+        // Exceptions thrown by the generator come out of get_next().
+        {
+            int calls = 0;
+            auto bad_sample = [&](dlib::rand& rnd, matrix<float>& x, unsigned long& y)
+            {
+                // The constructor's call happens before any worker is started.
+                if (calls++ != 0)
+                    throw dlib::error("bad sample");
+                make_sample(rnd, x, y);
+            };
+            dnn_data_loader<net_type> loader(net, bad_sample, 10, 1);
+            for (int i = 0; i < 2; ++i)
+            {
+                bool thrown = false;
+                try { loader.get_next(x1, y1); }
+                catch (dlib::error&) { thrown = true; }
+                DLIB_TEST(thrown);
+            }
+        }
+
+        // Mini-batches made before the failed one are still delivered.
+        {
+            std::atomic<int> calls(0);
+            auto bad_sample = [&](dlib::rand& rnd, matrix<float>& x, unsigned long& y)
+            {
+                // One call from the constructor, then 3 good mini-batches.
+                if (calls++ > 30)
+                    throw dlib::error("bad sample");
+                make_sample(rnd, x, y);
+            };
+            dnn_data_loader<net_type> loader(net, bad_sample, 10, 1, 8);
+            // Give the worker time to fail before anything is asked for.
+            while (calls <= 31)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            for (int i = 0; i < 3; ++i)
+            {
+                loader.get_next(x1, y1);
+                DLIB_TEST(x1.num_samples() == 10);
+            }
+            for (int i = 0; i < 2; ++i)
+            {
+                bool thrown = false;
+                try { loader.get_next(x1, y1); }
+                catch (dlib::error&) { thrown = true; }
+                DLIB_TEST(thrown);
+            }
+            DLIB_TEST(loader.get_num_batches_delivered() == 3);
+        }
+
+        // Train with the tensors the loader makes.
+        dnn_trainer<net_type> trainer(net, sgd());
+        trainer.set_learning_rate(0.1);
+        dnn_data_loader<net_type> loader(net, make_sample, 10, 2);
+        for (int i = 0; i < 300; ++i)
+        {
+            loader.get_next(x1, y1);
+            trainer.train_one_step(x1, y1);
+        }
+        loader.get_next(x1, y1);
+        trainer.test_one_step(x1, y1);
+        DLIB_TEST(trainer.get_train_one_step_calls() == 300);
+        DLIB_TEST(trainer.get_test_one_step_calls() == 1);
+        net.clean();
+
+        dlib::rand rnd(1);
+        std::vector<matrix<float>> samples(100);
+        std::vector<unsigned long> labels(100);
+        for (size_t i = 0; i < samples.size(); ++i)
+            make_sample(rnd, samples[i], labels[i]);
+        const auto predicted = net(samples);
+        int num_right = 0;
+        for (size_t i = 0; i < samples.size(); ++i)
+            num_right += predicted[i] == labels[i];
+        DLIB_TEST_MSG(num_right >= 95, num_right);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     void test_reorg()
@@ -5222,6 +5475,309 @@ void test_multm_prev()
         DLIB_TEST(max(abs(mat(net_output) - mat(expected_output))) < 1e-5);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename SUBNET>
+    using kv_attention = multm_prev1<softmaxm<tril_mask<
+                         multm_prev2<linear_no_bias<8, skip3<
+                         tag2<transpose<kv_cache<linear_no_bias<8, skip3<
+                         tag1<kv_cache<linear_no_bias<8,
+                         tag3<SUBNET>>>>>>>>>>>>>>>;
+
+    void test_kv_cache()
+    {
+        print_spinner();
+        using net_type = linear<5, kv_attention<positional_encodings<input<matrix<float>>>>>;
+        net_type net;
+
+        dlib::rand rnd;
+        matrix<float> seq(7, 4);
+        for (long r = 0; r < seq.nr(); ++r)
+            for (long c = 0; c < seq.nc(); ++c)
+                seq(r, c) = rnd.get_random_gaussian();
+
+        resizable_tensor x;
+        net.to_tensor(&seq, &seq + 1, x);
+        const matrix<float> full = mat(net.forward(x));
+        DLIB_TEST(full.size() == 7*5);
+
+        // Push a 3 token prompt and then one token at a time.  Each step should only
+        // produce the rows for the new tokens, and they should match the full pass.
+        enable_kv_cache(net);
+        for (int round = 0; round < 2; ++round)
+        {
+            long pos = 0;
+            for (long len : {3L, 1L, 1L, 1L, 1L})
+            {
+                const matrix<float> part = rowm(seq, range(pos, pos + len - 1));
+                net.to_tensor(&part, &part + 1, x);
+                const tensor& out = net.forward(x);
+                DLIB_TEST(out.nr() == len);
+                DLIB_TEST(out.nc() == 5);
+                const matrix<float> expected = rowm(reshape(full, 7, 5), range(pos, pos + len - 1));
+                DLIB_TEST_MSG(max(abs(reshape(mat(out), len, 5) - expected)) < 1e-5,
+                    max(abs(reshape(mat(out), len, 5) - expected)));
+                pos += len;
+            }
+            DLIB_TEST(layer<tag1>(net).subnet().layer_details().get_kv_cache_length() == 7);
+            clear_kv_cache(net);
+            DLIB_TEST(layer<tag1>(net).subnet().layer_details().get_kv_cache_length() == 0);
+        }
+
+        disable_kv_cache(net);
+        net.to_tensor(&seq, &seq + 1, x);
+        DLIB_TEST(max(abs(mat(net.forward(x)) - full)) < 1e-5);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_cpu_gemm()
+    {
+        print_spinner();
+        tt::tensor_rand rnd(0);
+        // Include products big enough to be split across threads.
+        for (auto dims : std::vector<std::array<long,3>>{{1,1,1}, {7,5,3}, {33,70,129}, {300,40,520}, {20,2100,300}})
+        {
+            const long m = dims[0], n = dims[1], k = dims[2];
+            for (int ta = 0; ta < 2; ++ta)
+            for (int tb = 0; tb < 2; ++tb)
+            for (float beta : {0.0f, 1.0f, 0.5f})
+            {
+                resizable_tensor lhs = ta ? resizable_tensor(k,m) : resizable_tensor(m,k);
+                resizable_tensor rhs = tb ? resizable_tensor(n,k) : resizable_tensor(k,n);
+                resizable_tensor dest(m,1,1,n);
+                rnd.fill_uniform(lhs);
+                rnd.fill_uniform(rhs);
+                rnd.fill_uniform(dest);
+
+                matrix<double> a = matrix_cast<double>(mat(lhs)), b = matrix_cast<double>(mat(rhs));
+                if (ta) a = trans(a);
+                if (tb) b = trans(b);
+                const matrix<double> expected = 2*a*b + beta*matrix_cast<double>(mat(dest));
+
+                cpu::gemm(beta, dest, 2, lhs, ta==1, rhs, tb==1);
+                const double err = max(abs(matrix_cast<double>(mat(dest)) - expected));
+                DLIB_TEST_MSG(err < 1e-4*k, m << " " << n << " " << k << " " << ta << tb << " err: " << err);
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_cpu_conv_algorithms()
+    {
+        // cpu::tensor_conv picks between several algorithms based on the filter shape, so
+        // check each of them against a direct evaluation of the convolution.
+        print_spinner();
+        tt::tensor_rand rnd(0);
+        struct conv_case { long nf, fr, fc, stride_y, stride_x, pad_y, pad_x; };
+        for (auto cc : std::vector<conv_case>{
+                {5,3,3,1,1,0,0}, {5,3,3,1,1,1,1}, {4,3,3,1,1,2,1}, {3,3,3,1,1,0,2},
+                {3,3,3,1,1,2,2}, {6,1,1,1,1,0,0}, {3,1,1,2,2,0,0}, {4,5,3,2,1,2,1},
+                {2,3,3,2,2,1,1}})
+        {
+            for (auto dims : std::vector<std::array<long,4>>{{1,1,3,3}, {3,4,7,10}, {2,17,9,8}})
+            {
+                resizable_tensor data(dims[0], dims[1], dims[2], dims[3]);
+                resizable_tensor filters(cc.nf, data.k(), cc.fr, cc.fc);
+                if (cc.fr > data.nr() + 2*cc.pad_y || cc.fc > data.nc() + 2*cc.pad_x)
+                    continue;
+                rnd.fill_uniform(data);
+                rnd.fill_uniform(filters);
+
+                cpu::tensor_conv conv;
+                conv.setup(data, filters, cc.stride_y, cc.stride_x, cc.pad_y, cc.pad_x);
+                resizable_tensor output;
+                conv(false, output, data, filters);
+
+                resizable_tensor expected;
+                expected.copy_size(output);
+                expected = 0;
+                auto e = expected.host();
+                for (long n = 0; n < output.num_samples(); ++n)
+                for (long k = 0; k < output.k(); ++k)
+                for (long r = 0; r < output.nr(); ++r)
+                for (long c = 0; c < output.nc(); ++c)
+                {
+                    double sum = 0;
+                    for (long kk = 0; kk < data.k(); ++kk)
+                    for (long y = 0; y < filters.nr(); ++y)
+                    for (long x = 0; x < filters.nc(); ++x)
+                    {
+                        const long yy = r*cc.stride_y - cc.pad_y + y;
+                        const long xx = c*cc.stride_x - cc.pad_x + x;
+                        if (0 <= yy && yy < data.nr() && 0 <= xx && xx < data.nc())
+                        {
+                            sum += data.host()[((n*data.k() + kk)*data.nr() + yy)*data.nc() + xx]*
+                                filters.host()[((k*data.k() + kk)*filters.nr() + y)*filters.nc() + x];
+                        }
+                    }
+                    e[((n*output.k() + k)*output.nr() + r)*output.nc() + c] = sum;
+                }
+
+                DLIB_TEST_MSG(max(abs(mat(output) - mat(expected))) < 1e-4,
+                    cc.fr << "x" << cc.fc << " stride " << cc.stride_y << " pad " << cc.pad_y << " error: "
+                    << max(abs(mat(output) - mat(expected))));
+
+                conv(true, output, data, filters);
+                DLIB_TEST(max(abs(mat(output) - 2*mat(expected))) < 2e-4);
+
+                // The biases and relu are applied by each algorithm as it writes the output.
+                resizable_tensor biases(1, cc.nf);
+                rnd.fill_uniform(biases);
+                biases = 8*mat(biases) - 6;
+                for (long n = 0; n < output.num_samples(); ++n)
+                for (long k = 0; k < output.k(); ++k)
+                for (long j = 0; j < output.nr()*output.nc(); ++j)
+                    e[(n*output.k() + k)*output.nr()*output.nc() + j] += biases.host()[k];
+                conv(false, output, data, filters, biases, false);
+                DLIB_TEST(max(abs(mat(output) - mat(expected))) < 1e-4);
+                conv(false, output, data, filters, biases, true);
+                DLIB_TEST(max(abs(mat(output) - lowerbound(mat(expected), 0))) < 1e-4);
+                output = mat(expected);
+                conv(true, output, data, filters, biases, true);
+                DLIB_TEST(max(abs(mat(output) - lowerbound(2*mat(expected), 0))) < 2e-4);
+            }
+        }
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_int8_quantization()
+    {
+        print_spinner();
+        using net_type = loss_multiclass_log<fc<5,relu<fc<20,
+            relu<con<8,3,3,1,1,relu<con<6,5,5,2,2,input<matrix<float>>>>>>>>>>;
+        net_type net;
+
+        dlib::rand rnd(0);
+        std::vector<matrix<float>> samples;
+        for (int i = 0; i < 40; ++i)
+            samples.push_back(matrix_cast<float>(randm(19,23,rnd)));
+
+        resizable_tensor x;
+        net.to_tensor(samples.begin(), samples.end(), x);
+        const matrix<float> expected = mat(net.subnet().forward(x));
+        const size_t float_params = count_parameters(net);
+
+        quantize_to_int8(net, samples, 16);
+        DLIB_TEST(layer<1>(net).layer_details().is_quantized());
+        DLIB_TEST(layer<3>(net).layer_details().is_quantized());
+        DLIB_TEST(layer<5>(net).layer_details().is_quantized());
+        DLIB_TEST(layer<7>(net).layer_details().is_quantized());
+        DLIB_TEST(count_parameters(net) == 0 && float_params > 0);
+
+        const matrix<float> quantized = mat(net.subnet().forward(x));
+        const double err = max(abs(quantized - expected))/max(abs(expected));
+        DLIB_TEST_MSG(err < 0.05, "relative error: " << err);
+
+        // The quantized network must survive serialization.
+        std::ostringstream sout;
+        serialize(net, sout);
+        net_type net2;
+        std::istringstream sin(sout.str());
+        deserialize(net2, sin);
+        DLIB_TEST(layer<1>(net2).layer_details().is_quantized());
+        DLIB_TEST(max(abs(mat(net2.subnet().forward(x)) - quantized)) == 0);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_scaled_dot_product_attention(
+        const long num_samples,
+        const long nr,
+        const long num_heads,
+        const long d_head,
+        const bool causal
+    )
+    {
+        print_spinner();
+        const long d_model = num_heads*d_head;
+        resizable_tensor qkv(num_samples, 2, nr, 3*d_model), out, stats;
+        resizable_tensor grad_out(num_samples, 2, nr, d_model);
+        tt::tensor_rand rnd(0);
+        rnd.fill_gaussian(qkv);
+        rnd.fill_gaussian(grad_out);
+
+        tt::scaled_dot_product_attention(out, stats, qkv, num_heads, causal);
+        DLIB_TEST(out.num_samples() == num_samples && out.k() == 2 && out.nr() == nr && out.nc() == d_model);
+
+        resizable_tensor qkv_grad;
+        qkv_grad.copy_size(qkv);
+        qkv_grad = 1;
+        tt::scaled_dot_product_attention_gradient(qkv_grad, grad_out, qkv, out, stats, num_heads, causal);
+
+        // Compare against the attention computed one matrix at a time.
+        const float scale = 1.0f/std::sqrt(static_cast<float>(d_head));
+        double max_out_error = 0, max_grad_error = 0;
+        for (long p = 0; p < num_samples*2; ++p)
+        {
+            const matrix<float> x = reshape(mat(qkv.host() + p*nr*3*d_model, nr*3*d_model, 1), nr, 3*d_model);
+            const matrix<float> y = reshape(mat(out.host() + p*nr*d_model, nr*d_model, 1), nr, d_model);
+            const matrix<float> g = reshape(mat(grad_out.host() + p*nr*d_model, nr*d_model, 1), nr, d_model);
+            const matrix<float> xg = reshape(mat(qkv_grad.host() + p*nr*3*d_model, nr*3*d_model, 1), nr, 3*d_model);
+            for (long h = 0; h < num_heads; ++h)
+            {
+                const matrix<float> q = colm(x, range(h*d_head, (h+1)*d_head-1));
+                const matrix<float> k = colm(x, range(d_model + h*d_head, d_model + (h+1)*d_head-1));
+                const matrix<float> v = colm(x, range(2*d_model + h*d_head, 2*d_model + (h+1)*d_head-1));
+                const matrix<float> gh = colm(g, range(h*d_head, (h+1)*d_head-1));
+
+                matrix<float> weights = q*trans(k)*scale;
+                for (long r = 0; r < nr; ++r)
+                {
+                    for (long c = 0; c < nr; ++c)
+                    {
+                        if (causal && c > r)
+                            weights(r,c) = -std::numeric_limits<float>::infinity();
+                    }
+                    const float m = max(rowm(weights, r));
+                    set_rowm(weights, r) = exp(rowm(weights, r) - m);
+                    set_rowm(weights, r) = rowm(weights, r)/sum(rowm(weights, r));
+                }
+                const matrix<float> expected = weights*v;
+                max_out_error = std::max<double>(max_out_error, max(abs(colm(y, range(h*d_head, (h+1)*d_head-1)) - expected)));
+
+                const matrix<float> dw = gh*trans(v);
+                matrix<float> ds = pointwise_multiply(weights, dw);
+                for (long r = 0; r < nr; ++r)
+                    set_rowm(ds, r) = rowm(ds, r) - sum(rowm(ds, r))*rowm(weights, r);
+                const matrix<float> dq = ds*k*scale + 1;
+                const matrix<float> dk = trans(ds)*q*scale + 1;
+                const matrix<float> dv = trans(weights)*gh + 1;
+                max_grad_error = std::max<double>(max_grad_error, max(abs(colm(xg, range(h*d_head, (h+1)*d_head-1)) - dq)));
+                max_grad_error = std::max<double>(max_grad_error, max(abs(colm(xg, range(d_model + h*d_head, d_model + (h+1)*d_head-1)) - dk)));
+                max_grad_error = std::max<double>(max_grad_error, max(abs(colm(xg, range(2*d_model + h*d_head, 2*d_model + (h+1)*d_head-1)) - dv)));
+            }
+        }
+        DLIB_TEST_MSG(max_out_error < 1e-4, max_out_error);
+        DLIB_TEST_MSG(max_grad_error < 1e-3, max_grad_error);
+    }
+
+    void test_attention_layer()
+    {
+        print_spinner();
+        using net_type = causal_attention<2, linear<12, input<matrix<float>>>>;
+        net_type net;
+        matrix<float> x = matrix_cast<float>(randm(5, 3));
+        resizable_tensor xt;
+        net.to_tensor(&x, &x + 1, xt);
+        const tensor& out = net.forward(xt);
+        DLIB_TEST(out.nr() == 5 && out.nc() == 4);
+
+        // The first position can only attend to itself, so it must be its own value vector.
+        const tensor& qkv = net.subnet().get_output();
+        for (long c = 0; c < 4; ++c)
+            DLIB_TEST(std::abs(out.host()[c] - qkv.host()[8 + c]) < 1e-5);
+
+        std::ostringstream sout;
+        serialize(net, sout);
+        std::istringstream sin(sout.str());
+        net_type net2;
+        deserialize(net2, sin);
+        DLIB_TEST(max(abs(mat(net2.forward(xt)) - mat(net.forward(xt)))) < 1e-6);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class dnn_tester : public tester
@@ -5308,6 +5864,16 @@ void test_multm_prev()
             test_positional_encodings();
             test_embeddings();
             test_tril();
+            test_kv_cache();
+            test_cpu_gemm();
+            test_cpu_conv_algorithms();
+            test_int8_quantization();
+            test_scaled_dot_product_attention(1, 1, 1, 4, true);
+            test_scaled_dot_product_attention(2, 7, 2, 3, false);
+            test_scaled_dot_product_attention(2, 7, 2, 3, true);
+            test_scaled_dot_product_attention(1, 70, 3, 5, true);
+            test_scaled_dot_product_attention(1, 70, 1, 8, false);
+            test_attention_layer();
             test_adaptive_computation_time_network();
             test_basic_tensor_ops();
             test_resize_to();
@@ -5345,6 +5911,9 @@ void test_multm_prev()
             test_set_learning_rate_multipliers();
             test_input_ouput_mappers();
             test_fuse_layers();
+            test_fuse_layers_activations();
+            test_inference_memory_sharing();
+            test_data_loader();
             test_reorg();
             test_input_tensor();
         }
@@ -76,6 +76,39 @@ namespace
             std::vector<rectangle> dets = detector(images[0]);
             DLIB_TEST(dets.size() == 3);
 
+            print_spinner();
+
+            // The batched predictions must match predicting one object at a time.
+            std::vector<rectangle> rects = dets;
+            for (auto& obj : objects[0])
+                rects.push_back(obj.get_rect());
+            for (unsigned long j = 0; j < dets.size(); ++j)
+                rects.push_back(translate_rect(dets[j], j+3, -1));
+            std::vector<full_object_detection> shapes = sp(images[0], rects);
+            std::vector<std::vector<full_object_detection> > batched = sp(images, std::vector<std::vector<rectangle> >{rects});
+            DLIB_TEST(shapes.size() == rects.size());
+            DLIB_TEST(batched.size() == 1 && batched[0].size() == rects.size());
+            ostringstream sout;
+            serialize(sp, sout);
+            istringstream sin(sout.str());
+            shape_predictor sp2;
+            deserialize(sp2, sin);
+            for (unsigned long j = 0; j < rects.size(); ++j)
+            {
+                const full_object_detection single = sp(images[0], rects[j]);
+                std::vector<std::pair<unsigned long,double> > feats;
+                const full_object_detection with_feats = sp2(images[0], rects[j], feats);
+                DLIB_TEST(feats.size() > 0);
+                DLIB_TEST(single.num_parts() == sp.num_parts());
+                DLIB_TEST(shapes[j].get_rect() == rects[j]);
+                for (unsigned long k = 0; k < single.num_parts(); ++k)
+                {
+                    DLIB_TEST(shapes[j].part(k) == single.part(k));
+                    DLIB_TEST(batched[0][j].part(k) == single.part(k));
+                    DLIB_TEST(with_feats.part(k) == single.part(k));
+                }
+            }
+
 
             /*
             // visualize the detections
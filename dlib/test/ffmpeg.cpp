@@ -9,6 +9,7 @@
 #include <dlib/dir_nav.h>
 #include <dlib/config_reader.h>
 #include <dlib/media.h>
+#include <dlib/media/ffmpeg_dnn.h>
 #include <dlib/array2d.h>
 #include <dlib/matrix.h>
 #include <dlib/rand.h>
@@ -427,6 +428,102 @@ namespace
     }
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////
+// FRAME VIEWS AND DNN INPUT
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    void test_frame_image (
+        const std::string& filepath,
+        const int nframes
+    )
+    {
+        // Decode the file three times, in the decoder's own pixel format, converted to
+        // RGB24, and converted to NV12, so each decoded frame can be compared with the
+        // other versions of it.
+        demuxer cap1({filepath, video_enabled, audio_disabled});
+        demuxer cap2({filepath, video_enabled, audio_disabled});
+        demuxer cap3({filepath, video_enabled, audio_disabled});
+        DLIB_TEST(cap1.is_open());
+        DLIB_TEST(cap2.is_open());
+        DLIB_TEST(cap3.is_open());
+
+        resizing_args args_rgb;
+        args_rgb.fmt = AV_PIX_FMT_RGB24;
+        resizing_args args_nv12;
+        args_nv12.fmt = AV_PIX_FMT_NV12;
+
+        input_rgb_image input_image;
+        input_rgb_frame input_frame(input_image);
+        frame f, rgb, nv12;
+        matrix<rgb_pixel> img;
+        resizable_tensor expected, data, data_nv12;
+        int counter = 0;
+
+        while (cap1.read(f) && cap2.read(rgb, args_rgb) && cap3.read(nv12, args_nv12))
+        {
+            DLIB_TEST(f.is_image());
+            DLIB_TEST(rgb.pixfmt() == AV_PIX_FMT_RGB24);
+            convert(rgb, img);
+            input_image.to_tensor(&img, &img+1, expected);
+
+            // A view of a packed RGB frame is the image convert() makes, and
+            // input_rgb_frame reads it exactly like input_rgb_image reads that image.
+            const const_frame_image<rgb_pixel> view(rgb);
+            DLIB_TEST(view.nr() == img.nr() && view.nc() == img.nc());
+            DLIB_TEST(mat(view) == img);
+            input_frame.to_tensor(&rgb, &rgb+1, data);
+            DLIB_TEST(max(abs(mat(data) - mat(expected))) == 0);
+
+            // Frames in the decoder's own format are converted to RGB by
+            // input_rgb_frame, which doesn't round exactly like swscale.
+            const input_rgb_frame input_copy = input_frame;
+            input_copy.to_tensor(&f, &f+1, data);
+            DLIB_TEST(have_same_dimensions(data, expected));
+            DLIB_TEST_MSG(mean(abs(mat(data) - mat(expected))) < 2/256.0, 
+                get_pixel_fmt_str(f.pixfmt()) << " " << mean(abs(mat(data) - mat(expected))));
+
+            if (f.pixfmt() == AV_PIX_FMT_YUV420P || f.pixfmt() == AV_PIX_FMT_YUVJ420P)
+            {
+                const const_frame_image<unsigned char> luma(f, 0);
+                const const_frame_image<unsigned char> u(f, 1);
+                DLIB_TEST(luma.nr() == f.height() && luma.nc() == f.width());
+                DLIB_TEST(u.nr() == (f.height()+1)/2 && u.nc() == (f.width()+1)/2);
+                DLIB_TEST(luma.width_step() == f.get_frame().linesize[0]);
+
+                // Writing through a frame_image changes only that frame.  In particular it
+                // mustn't change the reference frames the decoder uses for the frames
+                // after this one, which the comparisons above would then catch.
+                const matrix<unsigned char> old_luma = mat(luma);
+                frame copy = f;
+                frame_image<unsigned char> copy_luma(copy, 0);
+                frame_image<unsigned char> writable_luma(f, 0);
+                assign_all_pixels(writable_luma, 0);
+                DLIB_TEST(max(mat(const_frame_image<unsigned char>(f, 0))) == 0);
+                DLIB_TEST(mat(copy_luma) == old_luma);
+            }
+
+            // swscale turns a YUV420P frame into NV12 by only moving its chroma samples
+            // around, so input_rgb_frame must make the same tensor from both.  The NV12
+            // frame doesn't keep the color tags of f though, so only frames that use the
+            // default colorspace and range are compared.
+            DLIB_TEST(nv12.pixfmt() == AV_PIX_FMT_NV12);
+            if (f.pixfmt() == AV_PIX_FMT_YUV420P &&
+                f.get_frame().colorspace != AVCOL_SPC_BT709 &&
+                f.get_frame().color_range != AVCOL_RANGE_JPEG)
+            {
+                input_frame.to_tensor(&nv12, &nv12+1, data_nv12);
+                DLIB_TEST(max(abs(mat(data_nv12) - mat(data))) == 0);
+            }
+
+            if (++counter % 10 == 0)
+                print_spinner();
+        }
+
+        DLIB_TEST(counter == nframes);
+    }
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
 // ENCODER
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -919,6 +1016,7 @@ namespace
                     {
                         test_demuxer_images_only<array2d<rgb_pixel>>(filepath, nframes, height, width);
                         test_demuxer_images_only<matrix<bgr_pixel>>(filepath, nframes, height, width);
+                        test_frame_image(filepath, nframes);
                     }
 
                     test_demuxer_full(filepath, nframes, height, width, sample_rate, has_video, has_audio);
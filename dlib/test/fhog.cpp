@@ -8,6 +8,7 @@
 #include <dlib/compress_stream.h>
 #include <dlib/base64.h>
 #include <dlib/image_io.h>
+#include <dlib/rand.h>
 
 namespace  
 {
@@ -117,6 +118,32 @@ namespace
             }
         }
 
+        void test_gray_rgb_agree()
+        {
+            // An RGB image with equal color channels has the same gradients as the
+            // grayscale image, so the two must give exactly the same features.  The sizes
+            // and cell sizes exercise both the 8 pixel wide and the leftover column code.
+            print_spinner();
+            dlib::rand rnd;
+            array2d<unsigned char> gimg;
+            array2d<rgb_pixel> img;
+            dlib::array<array2d<float> > ghog, hog;
+            for (int iter = 0; iter < 30; ++iter)
+            {
+                gimg.set_size(rnd.get_random_32bit_number()%100+1, rnd.get_random_32bit_number()%100+1);
+                for (auto& p : gimg)
+                    p = rnd.get_random_8bit_number();
+                assign_image(img, gimg);
+
+                const int cell_size = rnd.get_random_32bit_number()%8+1;
+                extract_fhog_features(gimg, ghog, cell_size, 3, 2);
+                extract_fhog_features(img, hog, cell_size, 3, 2);
+                DLIB_TEST(ghog.size() == hog.size());
+                for (unsigned long i = 0; i < hog.size(); ++i)
+                    DLIB_TEST_MSG(mat(ghog[i]) == mat(hog[i]), gimg.nr() << " " << gimg.nc() << " " << cell_size);
+            }
+        }
+
         void test_point_transforms()
         {
             dlib::rand rnd;
@@ -158,6 +185,7 @@ namespace
         {
             test_point_transforms();
             test_on_small();
+            test_gray_rgb_agree();
 
             print_spinner();
             // load the testing data
@@ -0,0 +1,325 @@
+// Copyright (C) 2026  Davis E. King (davis@dlib.net)
+// License: Boost Software License   See LICENSE.txt for the full license.
+
+#include "tester.h"
+#include <dlib/graph_utils_threaded.h>
+#include <dlib/matrix.h>
+#include <dlib/rand.h>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+
+namespace
+{
+    using namespace test;
+    using namespace dlib;
+    using namespace std;
+    dlib::logger dlog("test.hnsw_index");
+
+    typedef matrix<double,0,1> sample_type;
+    typedef hnsw_index<sample_type, squared_euclidean_distance> index_type;
+
+// ----------------------------------------------------------------------------------------
+
+    std::vector<sample_type> make_samples (
+        dlib::rand& rnd,
+        unsigned long num
+    )
+    {
+        // Make clumps of samples around a few centers, since that is what makes
+        // approximate nearest neighbor search hard.
+        dlib::rand center_rnd;
+        std::vector<sample_type> centers;
+        for (int i = 0; i < 20; ++i)
+            centers.push_back(10*gaussian_randm(8,1,center_rnd.get_random_32bit_number()));
+
+        std::vector<sample_type> samples;
+        for (unsigned long i = 0; i < num; ++i)
+        {
+            sample_type samp = centers[rnd.get_random_32bit_number()%centers.size()];
+            for (long j = 0; j < samp.size(); ++j)
+                samp(j) += rnd.get_random_gaussian();
+            samples.push_back(samp);
+        }
+        return samples;
+    }
+
+    std::vector<unsigned long> brute_force_nearest (
+        const std::vector<sample_type>& samples,
+        const sample_type& item,
+        unsigned long k
+    )
+    {
+        std::vector<std::pair<double,unsigned long> > dists;
+        for (unsigned long i = 0; i < samples.size(); ++i)
+            dists.push_back(std::make_pair(length_squared(samples[i]-item), i));
+        std::sort(dists.begin(), dists.end());
+        std::vector<unsigned long> nearest;
+        for (unsigned long i = 0; i < k && i < dists.size(); ++i)
+            nearest.push_back(dists[i].second);
+        return nearest;
+    }
+
+    double recall (
+        const index_type& index,
+        const std::vector<sample_type>& samples,
+        const std::vector<sample_type>& queries,
+        unsigned long k
+    )
+    {
+        unsigned long num_found = 0;
+        for (const auto& q : queries)
+        {
+            const std::vector<unsigned long> truth = brute_force_nearest(samples, q, k);
+            const auto found = index.find_nearest(q, k);
+            DLIB_TEST(found.size() == k);
+            for (unsigned long i = 0; i < found.size(); ++i)
+            {
+                DLIB_TEST(std::abs(found[i].first - length_squared(samples[found[i].second]-q)) < 1e-12);
+                if (i > 0)
+                    DLIB_TEST(found[i-1].first <= found[i].first);
+                if (std::find(truth.begin(), truth.end(), found[i].second) != truth.end())
+                    ++num_found;
+            }
+        }
+        return num_found/(double)(queries.size()*k);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_small_indexes()
+    {
+        index_type index;
+        DLIB_TEST(index.size() == 0);
+        DLIB_TEST(index.get_max_neighbors() == 16);
+        DLIB_TEST(index.get_ef_construction() == 100);
+        DLIB_TEST(index.get_ef_search() == 50);
+
+        sample_type samp(3);
+        samp = 1, 2, 3;
+        DLIB_TEST(index.find_nearest(samp, 3).size() == 0);
+
+        DLIB_TEST(index.add(samp) == 0);
+        auto found = index.find_nearest(samp, 3);
+        DLIB_TEST(found.size() == 1);
+        DLIB_TEST(found[0].second == 0 && found[0].first == 0);
+
+        samp = 1, 2, 4;
+        DLIB_TEST(index.add(samp) == 1);
+        found = index.find_nearest(samp, 3);
+        DLIB_TEST(found.size() == 2);
+        DLIB_TEST(found[0].second == 1 && found[0].first == 0);
+        DLIB_TEST(found[1].second == 0 && found[1].first == 1);
+        DLIB_TEST(index[1] == samp);
+
+        index.clear();
+        DLIB_TEST(index.size() == 0);
+        DLIB_TEST(index.find_nearest(samp, 3).size() == 0);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_search()
+    {
+        dlib::rand rnd;
+        const std::vector<sample_type> samples = make_samples(rnd, 5000);
+        const std::vector<sample_type> queries = make_samples(rnd, 100);
+
+        index_type index(squared_euclidean_distance(), 12, 100);
+        for (const auto& samp : samples)
+            index.add(samp);
+        double r = recall(index, samples, queries, 10);
+        dlog << LINFO << "recall, serially added: " << r;
+        DLIB_TEST_MSG(r > 0.95, r);
+
+        // Adding the samples in parallel should work about as well and not depend on the
+        // number of threads.
+        index_type index1(squared_euclidean_distance(), 12, 100);
+        index_type index4(squared_euclidean_distance(), 12, 100);
+        index1.add(samples, 1);
+        index4.add(samples, 4);
+        DLIB_TEST(index4.size() == samples.size());
+        r = recall(index4, samples, queries, 10);
+        dlog << LINFO << "recall, added in parallel: " << r;
+        DLIB_TEST_MSG(r > 0.95, r);
+        for (const auto& q : queries)
+            DLIB_TEST(index1.find_nearest(q, 10) == index4.find_nearest(q, 10));
+
+        // Searching harder should find more of the true neighbors.
+        index4.set_ef_search(200);
+        DLIB_TEST(index4.get_ef_search() == 200);
+        const double r2 = recall(index4, samples, queries, 10);
+        dlog << LINFO << "recall with ef_search == 200: " << r2;
+        DLIB_TEST_MSG(r2 >= r && r2 > 0.99, r2);
+
+        // Samples can be added to an existing index and found right away.
+        const std::vector<sample_type> more_samples = make_samples(rnd, 1000);
+        index4.add(more_samples, 4);
+        DLIB_TEST(index4.size() == samples.size() + more_samples.size());
+        for (unsigned long i = 0; i < more_samples.size(); i += 10)
+        {
+            const auto found = index4.find_nearest(more_samples[i], 1);
+            DLIB_TEST(found.size() == 1);
+            DLIB_TEST(found[0].first == 0);
+            DLIB_TEST(index4[found[0].second] == more_samples[i]);
+        }
+
+        std::ostringstream sout;
+        serialize(index4, sout);
+        std::istringstream sin(sout.str());
+        index_type index5;
+        deserialize(index5, sin);
+        DLIB_TEST(index5.size() == index4.size());
+        DLIB_TEST(index5.get_max_neighbors() == 12);
+        DLIB_TEST(index5.get_ef_search() == 200);
+        for (const auto& q : queries)
+            DLIB_TEST(index5.find_nearest(q, 10) == index4.find_nearest(q, 10));
+        index5.add(queries[0]);
+        index4.add(queries[0]);
+        DLIB_TEST(index5.find_nearest(queries[1], 10) == index4.find_nearest(queries[1], 10));
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    void test_knn_graph()
+    {
+        dlib::rand rnd;
+        const std::vector<sample_type> samples = make_samples(rnd, 2000);
+
+        std::vector<sample_pair> edges1, edges2;
+        find_k_nearest_neighbors(samples, squared_euclidean_distance(), 5, edges1);
+        find_k_nearest_neighbors_hnsw(samples, squared_euclidean_distance(), 5, 4, edges2);
+        DLIB_TEST(contains_duplicate_pairs(edges2) == false);
+
+        std::sort(edges1.begin(), edges1.end(), order_by_index<sample_pair>);
+        unsigned long num_found = 0;
+        for (const auto& e : edges2)
+        {
+            DLIB_TEST(e.index1() < samples.size() && e.index2() < samples.size());
+            DLIB_TEST(e.index1() != e.index2());
+            DLIB_TEST(std::abs(e.distance() - length_squared(samples[e.index1()]-samples[e.index2()])) < 1e-12);
+            if (std::binary_search(edges1.begin(), edges1.end(), e, order_by_index<sample_pair>))
+                ++num_found;
+        }
+        const double r = num_found/(double)edges1.size();
+        dlog << LINFO << "edges1.size(): " << edges1.size() << "  edges2.size(): " << edges2.size() << "  recall: " << r;
+        DLIB_TEST_MSG(r > 0.97, r);
+
+        // Distance functions that return infinity disconnect samples.
+        std::vector<sample_pair> edges3;
+        find_k_nearest_neighbors_hnsw(samples, squared_euclidean_distance(0, 10), 5, 4, edges3);
+        for (const auto& e : edges3)
+            DLIB_TEST(e.distance() <= 10);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    template <typename T>
+    void test_descriptor_index(
+        double min_recall
+    )
+    {
+        // Make descriptors that look like face descriptors: a few samples of each of many
+        // identities, with unit length.
+        dlib::rand rnd;
+        std::vector<matrix<float,0,1> > descriptors, queries;
+        for (int id = 0; id < 400; ++id)
+        {
+            const matrix<float,0,1> center = normalize(matrix_cast<float>(gaussian_randm(128,1,id)));
+            for (int i = 0; i < 6; ++i)
+            {
+                matrix<float,0,1> d = center;
+                for (long j = 0; j < d.size(); ++j)
+                    d(j) += 0.03*rnd.get_random_gaussian();
+                if (i == 0)
+                    queries.push_back(normalize(d));
+                else
+                    descriptors.push_back(normalize(d));
+            }
+        }
+
+        descriptor_index<T> index;
+        DLIB_TEST(index.size() == 0);
+        DLIB_TEST(index.num_dimensions() == 0);
+        DLIB_TEST(index.find_nearest(queries[0], 5).size() == 0);
+        index.add(descriptors, 4);
+        DLIB_TEST(index.size() == descriptors.size());
+        DLIB_TEST(index.num_dimensions() == 128);
+        for (unsigned long i = 0; i < descriptors.size(); i += 100)
+            DLIB_TEST(max(abs(index[i] - descriptors[i])) < 0.01);
+
+        const auto results = index.find_nearest(queries, 5, 4);
+        DLIB_TEST(results.size() == queries.size());
+        unsigned long num_found = 0;
+        for (unsigned long i = 0; i < queries.size(); ++i)
+        {
+            DLIB_TEST(results[i] == index.find_nearest(queries[i], 5));
+            DLIB_TEST(results[i].size() == 5);
+            std::vector<std::pair<double,unsigned long> > truth;
+            for (unsigned long j = 0; j < descriptors.size(); ++j)
+                truth.push_back(std::make_pair(length(queries[i]-index[j]), j));
+            std::sort(truth.begin(), truth.end());
+            for (unsigned long j = 0; j < results[i].size(); ++j)
+            {
+                DLIB_TEST(std::abs(results[i][j].first - length(queries[i]-index[results[i][j].second])) < 1e-5);
+                for (unsigned long n = 0; n < 5; ++n)
+                {
+                    if (truth[n].second == results[i][j].second)
+                        ++num_found;
+                }
+            }
+            // The nearest descriptor should be one of the same identity.
+            DLIB_TEST(results[i][0].second/5 == i);
+        }
+        const double r = num_found/(5.0*queries.size());
+        dlog << LINFO << "descriptor_index recall: " << r;
+        DLIB_TEST_MSG(r > min_recall, r);
+
+        std::ostringstream sout;
+        serialize(index, sout);
+        dlog << LINFO << "serialized descriptor_index size: " << sout.str().size();
+        std::istringstream sin(sout.str());
+        descriptor_index<T> index2;
+        deserialize(index2, sin);
+        DLIB_TEST(index2.size() == index.size());
+        DLIB_TEST(index2.num_dimensions() == 128);
+        DLIB_TEST(index2.find_nearest(queries, 5, 1) == results);
+
+        DLIB_TEST(index2.add(queries[0]) == descriptors.size());
+        const auto found = index2.find_nearest(queries[0], 1);
+        DLIB_TEST(found.size() == 1 && found[0].second == descriptors.size());
+        DLIB_TEST(found[0].first < 0.01);
+
+        index2.clear();
+        DLIB_TEST(index2.size() == 0);
+        DLIB_TEST(index2.num_dimensions() == 0);
+    }
+
+// ----------------------------------------------------------------------------------------
+
+    class test_hnsw_index : public tester
+    {
+    public:
+        test_hnsw_index (
+        ) :
+            tester ("test_hnsw_index",
+                "Runs tests on the hnsw_index and descriptor_index objects and find_k_nearest_neighbors_hnsw().")
+        {}
+
+        void perform_test (
+        )
+        {
+            test_small_indexes();
+            print_spinner();
+            test_search();
+            print_spinner();
+            test_knn_graph();
+            print_spinner();
+            test_descriptor_index<float>(0.95);
+            print_spinner();
+            test_descriptor_index<int8>(0.9);
+        }
+    } a;
+
+}
+
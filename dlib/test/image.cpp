@@ -1,6 +1,7 @@
 // Copyright (C) 2008  Davis E. King (davis@dlib.net)
 // License: Boost Software License   See LICENSE.txt for the full license.
 #include <sstream>
+#include <fstream>
 #include <string>
 #include <cstdlib>
 #include <ctime>
@@ -2455,6 +2456,200 @@ namespace
         DLIB_TEST(img_d == img_t);
     }
 
+    template <typename in_pixel, typename out_pixel, typename interpolation_type>
+    void test_parallel_resize_image(
+        thread_pool& tp,
+        dlib::rand& rnd
+    )
+    {
+        print_spinner();
+        for (int iter = 0; iter < 4; ++iter)
+        {
+            matrix<in_pixel> img(rnd.get_integer_in_range(1,90), rnd.get_integer_in_range(1,90));
+            for (auto& p : img)
+                assign_pixel(p, rnd.get_random_8bit_number());
+
+            matrix<out_pixel> serial(rnd.get_integer_in_range(1,120), rnd.get_integer_in_range(1,120));
+            matrix<out_pixel> parallel(serial.nr(), serial.nc());
+            resize_image(img, serial, interpolation_type());
+            resize_image(img, parallel, interpolation_type(), tp);
+            DLIB_TEST(serial == parallel);
+        }
+    }
+
+    void test_parallel_resize_and_chips()
+    {
+        thread_pool tp(4);
+        dlib::rand rnd;
+
+        test_parallel_resize_image<unsigned char, unsigned char, interpolate_bilinear>(tp, rnd);
+        test_parallel_resize_image<unsigned char, float, interpolate_bilinear>(tp, rnd);
+        test_parallel_resize_image<float, float, interpolate_bilinear>(tp, rnd);
+        test_parallel_resize_image<int, unsigned char, interpolate_bilinear>(tp, rnd);
+        test_parallel_resize_image<rgb_pixel, rgb_pixel, interpolate_bilinear>(tp, rnd);
+        test_parallel_resize_image<bgr_pixel, rgb_pixel, interpolate_bilinear>(tp, rnd);
+        test_parallel_resize_image<rgb_pixel, unsigned char, interpolate_bilinear>(tp, rnd);
+        test_parallel_resize_image<rgb_pixel, rgb_pixel, interpolate_quadratic>(tp, rnd);
+        test_parallel_resize_image<float, float, interpolate_nearest_neighbor>(tp, rnd);
+
+        // Resizing 8bit images into float images gives the same pixels as resizing them
+        // into double images, in the serial and the threaded versions.
+        {
+            matrix<unsigned char> img(37,53);
+            for (auto& p : img)
+                p = rnd.get_random_8bit_number();
+            matrix<float> out(71,29), out_parallel(71,29);
+            matrix<double> ref(71,29);
+            resize_image(img, out);
+            resize_image(img, out_parallel, tp);
+            resize_image(img, ref);
+            DLIB_TEST(out == matrix_cast<float>(ref));
+            DLIB_TEST(out_parallel == out);
+        }
+
+        print_spinner();
+        matrix<rgb_pixel> img(300,400);
+        for (auto& p : img)
+            p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+        std::vector<chip_details> dets;
+        for (int i = 0; i < 20; ++i)
+        {
+            const dpoint center(rnd.get_integer_in_range(0,400), rnd.get_integer_in_range(0,300));
+            const long size = rnd.get_integer_in_range(10,250);
+            // some chips need the image pyramid, some don't, and some are plain copies.
+            if (i%5 == 0)
+                dets.push_back(chip_details(centered_rect(center, size, size)));
+            else
+                dets.push_back(chip_details(centered_drect(center, size, size), chip_dims(40,40), rnd.get_random_double()));
+        }
+        dlib::array<matrix<rgb_pixel>> serial, parallel;
+        extract_image_chips(img, dets, serial);
+        extract_image_chips(img, dets, parallel, tp);
+        DLIB_TEST(serial.size() == parallel.size());
+        for (unsigned long i = 0; i < serial.size(); ++i)
+            DLIB_TEST(serial[i] == parallel[i]);
+
+        extract_image_chips(img, dets, serial, interpolate_nearest_neighbor());
+        extract_image_chips(img, dets, parallel, interpolate_nearest_neighbor(), tp);
+        for (unsigned long i = 0; i < serial.size(); ++i)
+            DLIB_TEST(serial[i] == parallel[i]);
+    }
+
+    void test_parallel_filtering()
+    {
+        thread_pool tp(4);
+        dlib::rand rnd;
+
+        for (int iter = 0; iter < 10; ++iter)
+        {
+            print_spinner();
+            // include images smaller than the filters
+            const long nr = rnd.get_integer_in_range(1,80);
+            const long nc = rnd.get_integer_in_range(1,80);
+            matrix<unsigned char> img(nr,nc);
+            matrix<rgb_pixel> cimg(nr,nc);
+            for (long r = 0; r < nr; ++r)
+            {
+                for (long c = 0; c < nc; ++c)
+                {
+                    img(r,c) = rnd.get_random_8bit_number();
+                    cimg(r,c) = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+                }
+            }
+            const matrix<float> fimg = matrix_cast<float>(img);
+            const double sigma = rnd.get_double_in_range(0.5,4);
+
+            matrix<unsigned char> blur1, blur2;
+            DLIB_TEST(gaussian_blur(img, blur1, sigma) == gaussian_blur(img, blur2, sigma, 1001, tp));
+            DLIB_TEST(blur1 == blur2);
+
+            matrix<float> fblur1, fblur2;
+            gaussian_blur(fimg, fblur1, sigma);
+            gaussian_blur(fimg, fblur2, sigma, 1001, tp);
+            DLIB_TEST(fblur1 == fblur2);
+
+            matrix<rgb_pixel> cblur1, cblur2;
+            gaussian_blur(cimg, cblur1, sigma);
+            gaussian_blur(cimg, cblur2, sigma, 1001, tp);
+            DLIB_TEST(cblur1 == cblur2);
+
+            matrix<int> row_filter(rnd.get_integer_in_range(1,8),1);
+            matrix<int> col_filter(rnd.get_integer_in_range(1,8),1);
+            for (auto& v : row_filter) v = rnd.get_integer_in_range(-5,6);
+            for (auto& v : col_filter) v = rnd.get_integer_in_range(-5,6);
+            // add_to is set, so start with some junk in the outputs
+            matrix<short> out1(nr,nc), out2;
+            for (auto& v : out1) v = rnd.get_integer_in_range(-100,100);
+            out2 = out1;
+            DLIB_TEST(spatially_filter_image_separable(img, out1, row_filter, col_filter, 3, true, true) ==
+                      spatially_filter_image_separable(img, out2, row_filter, col_filter, 3, true, true, tp));
+            DLIB_TEST(out1 == out2);
+
+            const matrix<float> frow_filter = matrix_cast<float>(row_filter);
+            const matrix<float> fcol_filter = matrix_cast<float>(col_filter);
+            matrix<float> fout1, fout2;
+            spatially_filter_image_separable(fimg, fout1, frow_filter, fcol_filter, 2);
+            spatially_filter_image_separable(fimg, fout2, frow_filter, fcol_filter, 2, tp);
+            DLIB_TEST(fout1 == fout2);
+            matrix<float> scratch;
+            float_spatially_filter_image_separable(fimg, fout2, frow_filter, fcol_filter, scratch);
+            DLIB_TEST(fout1*2 == fout2);
+
+            matrix<short> horz1, vert1, horz2, vert2;
+            sobel_edge_detector(img, horz1, vert1);
+            sobel_edge_detector(img, horz2, vert2, tp);
+            DLIB_TEST(horz1 == horz2);
+            DLIB_TEST(vert1 == vert2);
+        }
+    }
+
+    template <
+        typename pixel_type,
+        typename filter_type
+        >
+    void test_separable_filtering_real_images (
+        dlib::rand& rnd,
+        const double eps
+    )
+    {
+        thread_pool tp(3);
+        for (int iter = 0; iter < 20; ++iter)
+        {
+            print_spinner();
+            const long nr = rnd.get_integer_in_range(1,60);
+            const long nc = rnd.get_integer_in_range(1,60);
+            matrix<pixel_type> img(nr,nc);
+            for (auto& p : img)
+                p = rnd.get_random_gaussian()*50;
+
+            matrix<filter_type,1,0> row_filter(rnd.get_integer_in_range(1,8));
+            matrix<filter_type,1,0> col_filter(rnd.get_integer_in_range(1,8));
+            for (auto& v : row_filter) v = rnd.get_integer_in_range(-5,6) + (filter_type)rnd.get_random_double();
+            for (auto& v : col_filter) v = rnd.get_integer_in_range(-5,6) + (filter_type)rnd.get_random_double();
+            const matrix<filter_type> filter = trans(col_filter)*row_filter;
+
+            const filter_type scale = rnd.get_integer_in_range(1,4);
+            const bool use_abs = rnd.get_random_double() < 0.5;
+            const bool add_to = rnd.get_random_double() < 0.5;
+            matrix<pixel_type> out1(nr,nc), out2, out3;
+            for (auto& p : out1)
+                p = rnd.get_random_gaussian();
+            out2 = out1;
+            out3 = out1;
+
+            // The separable version must agree with filtering by the full 2D filter.  For
+            // integer filters the pixels are truncated to integers by both, so there is no
+            // rounding error at all.
+            const rectangle area = spatially_filter_image(img, out1, filter, scale, use_abs, add_to);
+            DLIB_TEST(spatially_filter_image_separable(img, out2, row_filter, col_filter, scale, use_abs, add_to) == area);
+            DLIB_TEST(spatially_filter_image_separable(img, out3, row_filter, col_filter, scale, use_abs, add_to, tp) == area);
+            const double err = max(abs(matrix_cast<double>(out1) - matrix_cast<double>(out2)));
+            const double bound = eps*(sum(abs(matrix_cast<double>(filter)))*max(abs(matrix_cast<double>(img))) + max(abs(matrix_cast<double>(out1))));
+            DLIB_TEST_MSG(err <= bound, "err: " << err << "  bound: " << bound);
+            DLIB_TEST(out2 == out3);
+        }
+    }
+
     void test_draw_string()
     {
         print_spinner();
@@ -2508,6 +2703,116 @@ namespace
         return delta / size;
     }
 
+    void test_jpeg_load_options()
+    {
+#ifdef DLIB_JPEG_SUPPORT
+        print_spinner();
+        array2d<rgb_pixel> img(203, 301);
+        for (long r = 0; r < img.nr(); ++r)
+        {
+            for (long c = 0; c < img.nc(); ++c)
+            {
+                img[r][c].red = static_cast<unsigned char>(r + c/3);
+                img[r][c].green = static_cast<unsigned char>(128 + 100*std::sin(r/15.0));
+                img[r][c].blue = static_cast<unsigned char>(c*200/img.nc());
+            }
+        }
+        save_jpeg(img, "test_load_options.jpg", 95);
+
+        matrix<rgb_pixel> full, dec;
+        load_jpeg(full, "test_load_options.jpg");
+
+        // Default options decode the same image as the old constructors.
+        {
+            jpeg_loader loader("test_load_options.jpg", jpeg_load_options());
+            loader.get_image(dec);
+            DLIB_TEST(dec == full);
+            DLIB_TEST(loader.get_downscale() == 1);
+            DLIB_TEST(loader.get_region() == get_rect(full));
+            DLIB_TEST(loader.original_nr() == 203 && loader.original_nc() == 301);
+        }
+
+        for (unsigned long d : {2, 4, 8})
+        {
+            jpeg_load_options opts;
+            opts.max_downscale = d;
+            jpeg_loader loader("test_load_options.jpg", opts);
+            loader.get_image(dec);
+            DLIB_TEST(loader.get_downscale() == d);
+            DLIB_TEST(loader.original_nr() == 203 && loader.original_nc() == 301);
+            DLIB_TEST(dec.nr() == (long)(203+d-1)/(long)d);
+            DLIB_TEST(dec.nc() == (long)(301+d-1)/(long)d);
+            DLIB_TEST(loader.get_region() == get_rect(dec));
+
+            // The DCT domain downscaling should look like downsampling the full image.
+            matrix<rgb_pixel> small(dec.nr(), dec.nc());
+            resize_image(full, small);
+            DLIB_TEST_MSG(avg_pixel_delta(small, dec) < 6, avg_pixel_delta(small, dec));
+
+            // Decoding a region gives the same pixels as cropping the downscaled image.
+            opts.region = rectangle(37, 21, 180, 150);
+            loader.get_image(dec);
+            matrix<rgb_pixel> whole = dec, part;
+            load_jpeg(part, "test_load_options.jpg", opts);
+            jpeg_loader loader2("test_load_options.jpg", opts);
+            const rectangle expected(37/d, 21/d, (180+d)/d - 1, (150+d)/d - 1);
+            DLIB_TEST(loader2.get_region() == expected);
+            DLIB_TEST(num_rows(part) == (long)expected.height() && num_columns(part) == (long)expected.width());
+            DLIB_TEST(avg_pixel_delta(part, matrix<rgb_pixel>(subm(whole, expected))) < 1);
+        }
+
+        // min_nr and min_nc limit how far the image is scaled down.
+        {
+            jpeg_load_options opts;
+            opts.max_downscale = 8;
+            opts.min_nc = 100;
+            DLIB_TEST(jpeg_loader("test_load_options.jpg", opts).get_downscale() == 2);
+            opts.min_nc = 0;
+            opts.min_nr = 27;
+            DLIB_TEST(jpeg_loader("test_load_options.jpg", opts).get_downscale() == 4);
+            opts.min_nr = 1000;
+            DLIB_TEST(jpeg_loader("test_load_options.jpg", opts).get_downscale() == 1);
+        }
+
+        // The region is clipped to the image.
+        {
+            jpeg_load_options opts;
+            opts.region = rectangle(250, 190, 400, 400);
+            load_jpeg(dec, "test_load_options.jpg", opts);
+            DLIB_TEST(dec == subm(full, rectangle(250, 190, 300, 202)));
+            opts.region = rectangle(500, 500, 600, 600);
+            load_jpeg(dec, "test_load_options.jpg", opts);
+            DLIB_TEST(dec.size() == 0);
+        }
+
+        // Loading from memory works the same way.
+        {
+            std::ifstream fin("test_load_options.jpg", std::ios::binary);
+            std::vector<char> buf((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+            jpeg_load_options opts;
+            opts.max_downscale = 4;
+            opts.region = rectangle(10, 10, 100, 60);
+            matrix<rgb_pixel> from_file;
+            load_jpeg(from_file, "test_load_options.jpg", opts);
+            load_jpeg(dec, buf.data(), buf.size(), opts);
+            DLIB_TEST(dec == from_file);
+        }
+
+        // And on grayscale images.
+        {
+            array2d<unsigned char> gray;
+            assign_image(gray, img);
+            save_jpeg(gray, "test_load_options.jpg", 95);
+            matrix<unsigned char> gfull, gdec;
+            load_jpeg(gfull, "test_load_options.jpg");
+            jpeg_load_options opts;
+            opts.region = rectangle(5, 7, 120, 99);
+            load_jpeg(gdec, "test_load_options.jpg", opts);
+            DLIB_TEST(gdec == subm(gfull, opts.region));
+        }
+#endif
+    }
+
     void test_webp()
     {
 #ifdef DLIB_WEBP_SUPPORT
@@ -2700,8 +3005,19 @@ namespace
             test_null_rotate_image_with_interpolation_quadratic();
             test_interpolate_bilinear();
             test_letterbox_image();
+            test_parallel_resize_and_chips();
+            test_parallel_filtering();
+            {
+                dlib::rand rnd;
+                test_separable_filtering_real_images<float,int>(rnd, 0);
+                test_separable_filtering_real_images<double,int>(rnd, 0);
+                test_separable_filtering_real_images<float,float>(rnd, 1e-5);
+                test_separable_filtering_real_images<double,double>(rnd, 1e-12);
+                test_separable_filtering_real_images<float,double>(rnd, 1e-6);
+            }
             test_draw_string();
             test_webp();
+            test_jpeg_load_options();
         }
     } a;
 
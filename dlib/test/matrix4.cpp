@@ -1100,6 +1100,55 @@ namespace
 
     }
 
+    void test_packed_sgemm()
+    {
+        print_spinner();
+        dlib::rand rnd;
+
+        // Use sizes that aren't multiples of any of the kernel's block sizes.
+        const long sizes[] = {1, 5, 17, 100, 300};
+        for (long m : sizes)
+        for (long n : {3L, 16L, 129L, 2100L})
+        for (long k : {1L, 7L, 257L})
+        for (int ta = 0; ta < 2; ++ta)
+        for (int tb = 0; tb < 2; ++tb)
+        {
+            if (m*n*k > 5000000)
+                continue;
+            matrix<float> A = matrix_cast<float>(ta ? randm(k,m,rnd) : randm(m,k,rnd));
+            matrix<float> B = matrix_cast<float>(tb ? randm(n,k,rnd) : randm(k,n,rnd));
+            matrix<float> C = matrix_cast<float>(randm(m,n,rnd));
+
+            matrix<double> a = matrix_cast<double>(A), b = matrix_cast<double>(B);
+            if (ta) a = trans(a);
+            if (tb) b = trans(b);
+            const matrix<double> expected = matrix_cast<double>(C) + 0.5*a*b;
+
+            packed_sgemm(m, n, k, 0.5f, &A(0,0), A.nc(), ta==1, &B(0,0), B.nc(), tb==1, &C(0,0), C.nc());
+            DLIB_TEST_MSG(max(abs(matrix_cast<double>(C) - expected)) < 1e-3*std::max<long>(k,10),
+                m << " " << n << " " << k << " " << ta << " " << tb);
+        }
+
+        // Float matrix products of various expression types should agree with double
+        // precision ones.
+        const matrix<float> A = matrix_cast<float>(randm(70,90,rnd));
+        const matrix<float> B = matrix_cast<float>(randm(90,50,rnd));
+        const matrix<double> a = matrix_cast<double>(A), b = matrix_cast<double>(B);
+        matrix<float> C;
+        C = A*B;
+        DLIB_TEST(max(abs(matrix_cast<double>(C) - a*b)) < 1e-3);
+        C = trans(B)*trans(A);
+        DLIB_TEST(max(abs(matrix_cast<double>(C) - trans(b)*trans(a))) < 1e-3);
+        C = 2*mat(&A(0,0), 70, 90)*B + trans(C);
+        DLIB_TEST(max(abs(matrix_cast<double>(C) - 3*a*b)) < 1e-3);
+        C = subm(A,0,0,70,60)*subm(B,30,0,60,50);
+        DLIB_TEST(max(abs(matrix_cast<double>(C) - subm(a,0,0,70,60)*subm(b,30,0,60,50))) < 1e-3);
+        std::vector<float> buf(70*50);
+        set_ptrm(&buf[0], 70, 50) = A*B;
+        set_ptrm(&buf[0], 70, 50) += A*B;
+        DLIB_TEST(max(abs(matrix_cast<double>(mat(&buf[0], 70, 50)) - 2*a*b)) < 1e-3);
+    }
+
     class matrix_tester : public tester
     {
     public:
@@ -1124,6 +1173,7 @@ namespace
 
             test_complex();
             test_linpiece();
+            test_packed_sgemm();
         }
     } a;
 
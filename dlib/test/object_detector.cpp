@@ -430,6 +430,27 @@ namespace
             DLIB_TEST(d1.size() == d2.size());
             DLIB_TEST(set_intersection_size(d1,d2) == d1.size());
         }
+
+        {
+            // Scanning with several threads must give exactly the serial results.
+            object_detector<image_scanner_type> threaded = detector;
+            set_num_threads(threaded, 4);
+            DLIB_TEST(threaded.get_scanner().get_num_threads() == 4);
+            DLIB_TEST(detector.get_scanner().get_num_threads() == 1);
+            for (unsigned long i = 0; i < images.size(); ++i)
+            {
+                std::vector<rect_detection> dets1, dets2;
+                detector(images[i], dets1, -0.5);
+                threaded(images[i], dets2, -0.5);
+                DLIB_TEST(dets1.size() > 0);
+                DLIB_TEST(dets1.size() == dets2.size());
+                for (unsigned long j = 0; j < dets1.size(); ++j)
+                {
+                    DLIB_TEST(dets1[j].rect == dets2[j].rect);
+                    DLIB_TEST(dets1[j].detection_confidence == dets2[j].detection_confidence);
+                }
+            }
+        }
     }
 
 // ----------------------------------------------------------------------------------------
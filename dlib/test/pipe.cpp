@@ -8,6 +8,7 @@
 #include <ctime>
 #include <dlib/misc_api.h>
 #include <dlib/pipe.h>
+#include <thread>
 
 #include "tester.h"
 
@@ -665,6 +666,145 @@ namespace
 
 
 
+    void test_enqueue_with_policy()
+    {
+        dlog << LINFO << "in test_enqueue_with_policy()";
+
+        dlib::pipe<int> p(2);
+        unsigned long long num_dropped = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            int item = i;
+            DLIB_TEST(enqueue_with_policy(p, item, pipe_overflow_policy::drop_newest, num_dropped));
+        }
+        DLIB_TEST(num_dropped == 2);
+        int item;
+        DLIB_TEST(p.dequeue(item) && item == 0);
+        DLIB_TEST(p.dequeue(item) && item == 1);
+
+        num_dropped = 0;
+        for (int i = 0; i < 5; ++i)
+        {
+            item = i;
+            DLIB_TEST(enqueue_with_policy(p, item, pipe_overflow_policy::drop_oldest, num_dropped));
+        }
+        DLIB_TEST(num_dropped == 3);
+        DLIB_TEST(p.dequeue(item) && item == 3);
+        DLIB_TEST(p.dequeue(item) && item == 4);
+
+        // Without a waiting consumer nothing fits into a pipe of size 0.
+        dlib::pipe<int> p0(0);
+        num_dropped = 0;
+        item = 1;
+        DLIB_TEST(enqueue_with_policy(p0, item, pipe_overflow_policy::drop_oldest, num_dropped));
+        DLIB_TEST(num_dropped == 1);
+
+        p.disable_enqueue();
+        DLIB_TEST(enqueue_with_policy(p, item, pipe_overflow_policy::drop_oldest, num_dropped) == false);
+        DLIB_TEST(enqueue_with_policy(p, item, pipe_overflow_policy::block, num_dropped) == false);
+        DLIB_TEST(num_dropped == 1);
+    }
+
+    void test_pipe_stage()
+    {
+        dlog << LINFO << "in test_pipe_stage()";
+
+        for (unsigned long num_threads : {1, 2, 4})
+        {
+            // Two stages with several threads each must deliver everything, in order,
+            // and pass the end of the stream along.
+            dlib::pipe<int> source(3);
+            dlib::pipe<long> middle(2), sink(5);
+            pipe_stage<int, long> square(source, middle, [](int& x, long& y) {
+                dlib::sleep(x%3);
+                y = (long)x*x;
+                return true;
+            }, num_threads);
+            pipe_stage<long, long> only_even(middle, sink, [](long& x, long& y) {
+                y = x;
+                return (x%2) == 0;
+            }, num_threads);
+            DLIB_TEST(square.get_num_threads() == num_threads);
+            DLIB_TEST(square.get_overflow_policy() == pipe_overflow_policy::block);
+
+            std::thread producer([&](){
+                for (int i = 0; i < 100; ++i)
+                    source.enqueue(int(i));
+                close_when_empty(source);
+            });
+
+            std::vector<long> results;
+            long y;
+            while (sink.dequeue(y))
+                results.push_back(y);
+            producer.join();
+
+            DLIB_TEST(results.size() == 50);
+            for (unsigned long i = 0; i < results.size(); ++i)
+                DLIB_TEST(results[i] == (long)(4*i*i));
+            square.wait();
+            only_even.wait();
+            DLIB_TEST(square.is_finished() && only_even.is_finished());
+            DLIB_TEST(square.get_num_processed() == 100);
+            DLIB_TEST(only_even.get_num_processed() == 100);
+            DLIB_TEST(square.get_num_dropped() == 0);
+            print_spinner();
+        }
+
+        {
+            // A slow consumer makes a stage that drops its oldest outputs lose items,
+            // but never slows down the stage itself.
+            dlib::pipe<int> in(10), out(2);
+            pipe_stage<int, int> stage(in, out, [](int& x, int& y) { y = x; return true; },
+                                       2, pipe_overflow_policy::drop_oldest);
+            for (int i = 0; i < 50; ++i)
+                in.enqueue(int(i));
+            close_when_empty(in);
+            stage.wait();
+            DLIB_TEST(stage.get_num_processed() == 50);
+            DLIB_TEST(stage.get_num_dropped() == 48);
+
+            // stage is finished so the remaining items can be read and then dequeue()
+            // reports the end of the stream.
+            int y;
+            DLIB_TEST(out.dequeue(y) && y == 48);
+            DLIB_TEST(out.dequeue(y) && y == 49);
+            DLIB_TEST(out.dequeue(y) == false);
+        }
+
+        {
+            // Exceptions thrown by the stage's function are reported by wait().
+            dlib::pipe<int> in(10), out(100);
+            pipe_stage<int, int> stage(in, out, [](int& x, int& y) {
+                if (x == 5)
+                    throw dlib::error("bad item");
+                y = x;
+                return true;
+            }, 3);
+            for (int i = 0; i < 10; ++i)
+                in.enqueue(int(i));
+            bool threw = false;
+            try { stage.wait(); } catch (dlib::error&) { threw = true; }
+            DLIB_TEST(threw);
+            int item = 0;
+            DLIB_TEST(in.enqueue(item) == false);
+            DLIB_TEST(out.size() <= 5);
+        }
+
+        {
+            // Destroying a stage that is blocked on a full output pipe must not hang.
+            dlib::pipe<int> in(10), out(1);
+            {
+                pipe_stage<int, int> stage(in, out, [](int& x, int& y) { y = x; return true; }, 2);
+                for (int i = 0; i < 10; ++i)
+                    in.enqueue(int(i));
+                dlib::sleep(10);
+                DLIB_TEST(stage.is_finished() == false);
+            }
+            DLIB_TEST(out.size() == 1);
+        }
+    }
+
     class pipe_tester : public tester
     {
     public:
@@ -680,6 +820,9 @@ namespace
             pipe_kernel_test<dlib::pipe<int> >();
 
             do_zero_size_test_with_timeouts();
+
+            test_enqueue_with_policy();
+            test_pipe_stage();
         }
     } a;
 
@@ -329,6 +329,76 @@ void test_pyramid_down_small_sizes()
     }
 }
 
+// ----------------------------------------------------------------------------------------
+
+template <typename pyramid_down_type>
+void test_image_pyramid()
+{
+    print_spinner();
+    dlib::rand rnd;
+    pyramid_down_type pyr;
+    thread_pool tp(3);
+    image_pyramid<pyramid_down_type, array2d<unsigned char> > gray_pyramid;
+    image_pyramid<pyramid_down_type, matrix<rgb_pixel> > rgb_pyramid;
+    gray_pyramid.set_num_threads(3);
+    DLIB_TEST(gray_pyramid.get_num_threads() == 3);
+    DLIB_TEST(rgb_pyramid.get_num_threads() == 1);
+
+    for (int iter = 0; iter < 20; ++iter)
+    {
+        array2d<unsigned char> img1(rnd.get_random_32bit_number()%300, rnd.get_random_32bit_number()%300);
+        matrix<rgb_pixel> img2(rnd.get_random_32bit_number()%300, rnd.get_random_32bit_number()%300);
+        for (auto& p : img1)
+            p = rnd.get_random_8bit_number();
+        for (auto& p : img2)
+            p = rgb_pixel(rnd.get_random_8bit_number(), rnd.get_random_8bit_number(), rnd.get_random_8bit_number());
+
+        // Using a thread pool must not change the output.
+        array2d<unsigned char> down1, down1_tp;
+        matrix<rgb_pixel> down2, down2_tp;
+        pyr(img1, down1);
+        pyr(img1, down1_tp, tp);
+        pyr(img2, down2);
+        pyr(img2, down2_tp, tp);
+        DLIB_TEST(mat(down1) == mat(down1_tp));
+        DLIB_TEST(down2 == down2_tp);
+
+        // Each level of the pyramid should be the previous one run through pyr.
+        const unsigned long max_levels = 1 + rnd.get_random_32bit_number()%6;
+        gray_pyramid.build(img1, max_levels);
+        rgb_pyramid.build(img2, max_levels);
+        DLIB_TEST(gray_pyramid.num_levels() >= 1 && gray_pyramid.num_levels() <= max_levels);
+        DLIB_TEST(rgb_pyramid.num_levels() >= 1 && rgb_pyramid.num_levels() <= max_levels);
+        DLIB_TEST(mat(gray_pyramid[0]) == mat(img1));
+        DLIB_TEST(rgb_pyramid[0] == img2);
+        array2d<unsigned char> expected1;
+        assign_image(expected1, img1);
+        for (unsigned long i = 1; i < max_levels; ++i)
+        {
+            pyr(expected1);
+            if (expected1.size() == 0)
+            {
+                DLIB_TEST(gray_pyramid.num_levels() == i);
+                break;
+            }
+            DLIB_TEST(i < gray_pyramid.num_levels());
+            DLIB_TEST(mat(gray_pyramid[i]) == mat(expected1));
+        }
+        matrix<rgb_pixel> expected2 = img2;
+        for (unsigned long i = 1; i < max_levels; ++i)
+        {
+            pyr(expected2);
+            if (expected2.size() == 0)
+            {
+                DLIB_TEST(rgb_pyramid.num_levels() == i);
+                break;
+            }
+            DLIB_TEST(i < rgb_pyramid.num_levels());
+            DLIB_TEST(rgb_pyramid[i] == expected2);
+        }
+    }
+}
+
 // ----------------------------------------------------------------------------------------
 
 
@@ -363,6 +433,13 @@ void test_pyramid_down_small_sizes()
             dlog << LINFO << "call test_pyramid_down_small_sizes<pyramid_down<9> >();";
             test_pyramid_down_small_sizes<pyramid_down<9> >();
 
+            dlog << LINFO << "call test_image_pyramid<pyramid_down<2> >();";
+            test_image_pyramid<pyramid_down<2> >();
+            dlog << LINFO << "call test_image_pyramid<pyramid_down<3> >();";
+            test_image_pyramid<pyramid_down<3> >();
+            dlog << LINFO << "call test_image_pyramid<pyramid_down<6> >();";
+            test_image_pyramid<pyramid_down<6> >();
+
             print_spinner();
             dlog << LINFO << "call test_pyramid_down_rgb2<pyramid_down<2> >();";
             test_pyramid_down_rgb2<pyramid_down<2> >();
@@ -633,6 +633,54 @@ namespace
 
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename trainer_type, typename... T>
+    void check_threaded_training (
+        trainer_type trainer,
+        const T&... training_data
+    )
+    {
+        print_spinner();
+        // Use a small cache so the trainer has to compute kernel columns all the time.
+        trainer.set_cache_size(1);
+        const auto df1 = trainer.train(training_data...);
+        trainer.set_num_threads(4);
+        DLIB_TEST(trainer.get_num_threads() == 4);
+        const auto df2 = trainer.train(training_data...);
+
+        DLIB_TEST(df1.b == df2.b);
+        DLIB_TEST(df1.alpha == df2.alpha);
+        DLIB_TEST(df1.basis_vectors.size() == df2.basis_vectors.size());
+    }
+
+    void test_threaded_kernel_trainers()
+    {
+        typedef matrix<double,0,1> sample_type;
+        typedef radial_basis_kernel<sample_type> kernel_type;
+
+        dlib::rand rnd;
+        std::vector<sample_type> samples;
+        std::vector<double> labels, targets;
+        for (int i = 0; i < 1000; ++i)
+        {
+            sample_type samp = randm(3,1,rnd);
+            samples.push_back(samp);
+            labels.push_back(sum(samp) > 1.5 ? +1 : -1);
+            targets.push_back(std::sin(10*samp(0)) + samp(1));
+        }
+
+        svm_c_trainer<kernel_type> c_trainer(kernel_type(1), 10);
+        DLIB_TEST(c_trainer.get_num_threads() == 1);
+        check_threaded_training(c_trainer, samples, labels);
+        check_threaded_training(svm_nu_trainer<kernel_type>(kernel_type(1), 0.1), samples, labels);
+        svm_one_class_trainer<kernel_type> one_class_trainer(kernel_type(1), 0.1);
+        check_threaded_training(one_class_trainer, samples);
+        svr_trainer<kernel_type> svr;
+        svr.set_kernel(kernel_type(1));
+        check_threaded_training(svr, samples, targets);
+    }
+
 // ----------------------------------------------------------------------------------------
 
     class svm_tester : public tester
@@ -653,6 +701,7 @@ namespace
             test_regression();
             test_anomaly_detection();
             test_svm_trainer2();
+            test_threaded_kernel_trainers();
         }
     } a;
 
@@ -503,6 +503,76 @@ namespace
         DLIB_TEST(df(sample) < 0);
     }
 
+// ----------------------------------------------------------------------------------------
+
+    template <typename kernel_type>
+    void test_threaded_version (
+        const std::vector<typename kernel_type::sample_type>& samples,
+        const std::vector<double>& labels,
+        bool force_weight
+    )
+    {
+        svm_c_linear_dcd_trainer<kernel_type> trainer, threaded_trainer;
+        trainer.set_c(0.1);
+        trainer.set_epsilon(1e-8);
+        trainer.force_last_weight_to_1(force_weight);
+        threaded_trainer = trainer;
+        threaded_trainer.set_num_threads(4);
+        DLIB_TEST(trainer.get_num_threads() == 1);
+        DLIB_TEST(threaded_trainer.get_num_threads() == 4);
+
+        const decision_function<kernel_type> df = trainer.train(samples, labels);
+        const decision_function<kernel_type> df2 = threaded_trainer.train(samples, labels);
+        const double diff = length(sparse_to_dense(df.basis_vectors(0)) - sparse_to_dense(df2.basis_vectors(0)));
+        dlog << LINFO << "threaded w diff: " << diff << "   b diff: " << std::abs(df.b - df2.b);
+        DLIB_TEST_MSG(diff < 1e-6, diff);
+        DLIB_TEST(std::abs(df.b - df2.b) < 1e-6);
+
+        // The threaded solver must also be able to warm start from its own state after
+        // more samples are added.
+        typename svm_c_linear_dcd_trainer<kernel_type>::optimizer_state state;
+        const std::vector<typename kernel_type::sample_type> first_samples(samples.begin(), samples.begin()+3000);
+        const std::vector<double> first_labels(labels.begin(), labels.begin()+3000);
+        threaded_trainer.train(first_samples, first_labels, state);
+        const decision_function<kernel_type> df3 = threaded_trainer.train(samples, labels, state);
+        const double diff3 = length(sparse_to_dense(df.basis_vectors(0)) - sparse_to_dense(df3.basis_vectors(0)));
+        dlog << LINFO << "warm started threaded w diff: " << diff3 << "   b diff: " << std::abs(df.b - df3.b);
+        DLIB_TEST_MSG(diff3 < 1e-6, diff3);
+        DLIB_TEST(std::abs(df.b - df3.b) < 1e-6);
+    }
+
+    void test_threaded ()
+    {
+        typedef matrix<double,20,1> dense_sample_type;
+        typedef std::map<unsigned long,double> sparse_sample_type;
+        std::vector<dense_sample_type> dense_samples;
+        std::vector<sparse_sample_type> sparse_samples;
+        std::vector<double> labels;
+
+        // Make enough samples that the threaded trainer splits them into several blocks.
+        dlib::rand rnd;
+        double label = +1;
+        for (int i = 0; i < 5000; ++i)
+        {
+            label *= -1;
+            dense_sample_type sample = zeros_matrix<double>(20,1);
+            sparse_sample_type sparse_sample;
+            for (int j = 0; j < 5; ++j)
+            {
+                const unsigned long idx = rnd.get_random_32bit_number()%20;
+                sample(idx) = label*rnd.get_random_double() + 0.3*rnd.get_random_gaussian();
+                sparse_sample[idx] = sample(idx);
+            }
+            dense_samples.push_back(sample);
+            sparse_samples.push_back(sparse_sample);
+            labels.push_back(label);
+        }
+
+        test_threaded_version<linear_kernel<dense_sample_type>>(dense_samples, labels, false);
+        test_threaded_version<linear_kernel<dense_sample_type>>(dense_samples, labels, true);
+        test_threaded_version<sparse_linear_kernel<sparse_sample_type>>(sparse_samples, labels, false);
+    }
+
     class tester_svm_c_linear_dcd : public tester
     {
     public:
@@ -539,6 +609,8 @@ namespace
             print_spinner();
 
             test_l2_version();
+            print_spinner();
+            test_threaded();
         }
     } a;
 
@@ -4,6 +4,8 @@
 #include "tester.h"
 #include <dlib/matrix.h>
 #include <dlib/rand.h>
+#include <dlib/threads.h>
+#include <dlib/svm.h>
 #include <vector>
 #include <sstream>
 
@@ -187,6 +189,37 @@ namespace
         }
 
 
+        void test_threaded (
+        )
+        {
+            print_spinner();
+            dlog << LINFO << "test_threaded()";
+            std::vector<matrix<double,0,1>> samples;
+            for (int i = 0; i < 3000; ++i)
+                samples.push_back(randm(5,1,rnd));
+            const radial_basis_kernel<matrix<double,0,1>> kern(0.3);
+            const auto K = kernel_matrix(kern, samples);
+
+            thread_pool tp(4);
+            // A size of 0 leaves room for only a couple of columns, so most accesses load
+            // a new column.
+            const auto serial = symmetric_matrix_cache<float>(K, 0);
+            const auto parallel = symmetric_matrix_cache<float>(K, 0, tp);
+            for (int iter = 0; iter < 200; ++iter)
+            {
+                const long i = rnd.get_random_32bit_number()%samples.size();
+                const long j = rnd.get_random_32bit_number()%samples.size();
+                // hold on to a few columns while others are loaded.
+                const auto ci = colm(parallel,i);
+                const auto cj = colm(parallel,j);
+                DLIB_TEST(equal(ci, colm(serial,i)));
+                DLIB_TEST(equal(cj, colm(serial,j)));
+                DLIB_TEST(parallel(i,j) == (float)K(i,j));
+                DLIB_TEST(ci(j) == serial(j,i));
+            }
+            DLIB_TEST(equal(diag(parallel), matrix_cast<float>(diag(K))));
+        }
+
         void perform_test (
         )
         {
@@ -198,6 +231,8 @@ namespace
                 test_stuff(2);
             }
 
+            test_threaded();
+
         }
     };
 
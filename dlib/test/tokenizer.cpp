@@ -7,6 +7,7 @@
 #include <regex>
 
 #include <dlib/tokenizer.h>
+#include <dlib/rand.h>
 #include "tester.h"
 
 namespace  
@@ -406,6 +407,48 @@ namespace
 
             DLIB_TEST_MSG(text == decoded, "decoded: " << decoded);
         }
+
+        // The whole training text should be compressed and survive a round trip.
+        const std::vector<int> encoded_training = loaded_test.encode(training_text);
+        DLIB_TEST(encoded_training.size() < training_text.size());
+        DLIB_TEST(encoded_training == test.encode(training_text));
+        DLIB_TEST(postprocess_decoded_text(loaded_test.decode(encoded_training)) == training_text);
+
+        // The parallel versions of encode() must give the same results as the serial one.
+        thread_pool tp(3);
+        std::vector<std::string> texts = test_strings;
+        texts.push_back(training_text);
+        texts.push_back("");
+        std::vector<std::vector<int>> batch = loaded_test.encode(texts, tp);
+        DLIB_TEST(batch.size() == texts.size());
+        std::string big_text;
+        for (size_t i = 0; i < texts.size(); ++i) {
+            DLIB_TEST(batch[i] == test.encode(texts[i]));
+            for (int j = 0; j < 400; ++j) big_text += texts[i];
+        }
+        DLIB_TEST(loaded_test.encode(big_text, tp) == loaded_test.encode(big_text));
+        DLIB_TEST(postprocess_decoded_text(loaded_test.decode(loaded_test.encode(big_text, tp))) == big_text);
+
+        // Training with a thread pool must learn the same merges as serial training.  Use
+        // many distinct words so that the work is actually split between threads.
+        dlib::rand rnd;
+        std::string random_text;
+        while (random_text.size() < 300000) {
+            const int len = 1 + rnd.get_random_32bit_number() % 8;
+            for (int i = 0; i < len; ++i)
+                random_text += static_cast<char>('a' + rnd.get_random_32bit_number() % 20);
+            random_text += " \n\t"[rnd.get_random_32bit_number() % 3];
+        }
+        bpe_tok parallel_test;
+        parallel_test.train(random_text, 600, tp);
+        bpe_tok serial_test;
+        serial_test.train(random_text, 600);
+        DLIB_TEST(parallel_test.get_vocab_size() == serial_test.get_vocab_size());
+        std::ostringstream parallel_out, serial_out;
+        serialize(parallel_test, parallel_out);
+        serialize(serial_test, serial_out);
+        DLIB_TEST(parallel_out.str() == serial_out.str());
+        DLIB_TEST(parallel_test.encode(random_text, tp) == serial_test.encode(random_text));
     }
 
     class tokenizer_tester : public tester
@@ -19,6 +19,7 @@
 
 #include "../base64.h"
 #include "../serialize.h"
+#include "../threads.h"
 #include "bpe_tokenizer_abstract.h"
 
 namespace dlib
@@ -43,164 +44,77 @@ namespace dlib
 
             // Initialize special tokens
             initialize_special_tokens();
+            build_merge_ranks();
         }
 
         // Train the tokenizer on input data
         void train(const std::string& text, size_t max_vocab_size, size_t max_bytes = 0, bool verbose = false)
         {
-            if (text.empty()) return;
-
-            // Convert text to bytes
-            std::vector<uint8_t> data(text.begin(), text.end());
-            if (max_bytes > 0 && data.size() > max_bytes) data.resize(max_bytes);
-
-            // Calculate available merges (reserving space for special tokens)
-            size_t num_merges = max_vocab_size - BPE_BASE_VOCAB_SIZE - special_token_list.size();
-
-            if (num_merges <= 0) {
-                if (verbose) {
-                    std::cout << "Warning: max_vocab_size too small for any merges. Need at least "
-                        << (BPE_BASE_VOCAB_SIZE + special_token_list.size() + 1) << " tokens." << std::endl;
-                }
-                return;
-            }
-
-            if (verbose) {
-                std::cout << "Training BPE tokenizer on " << data.size() << " bytes..." << std::endl;
-                std::cout << "Target vocabulary size: " << max_vocab_size << std::endl;
-                std::cout << "Base vocabulary: " << BPE_BASE_VOCAB_SIZE << " tokens" << std::endl;
-                std::cout << "Special tokens: " << special_token_list.size() << " tokens" << std::endl;
-                std::cout << "Available merges: " << num_merges << std::endl;
-            }
-
-            // Reset merges beyond base vocabulary
-            merges.clear();
-            for (int i = 0; i < BPE_BASE_VOCAB_SIZE; ++i) {
-                Merge m;
-                m.token_id = i;
-                m.left = i;
-                m.right = i;
-                m.pattern.push_back(static_cast<uint8_t>(i));
-                merges.push_back(m);
-            }
-
-            // Tokenize input into segments (split on whitespace and newlines)
-            std::vector<std::list<uint16_t>> segments;
-            std::vector<uint32_t> segment_counts;
-            tokenize(data, segments, segment_counts);
-
-            if (verbose) {
-                std::cout << "Created " << segments.size() << " segments for training" << std::endl;
-            }
-
-            // Initialize pair counting
-            std::unordered_map<uint32_t, std::pair<int32_t, std::pair<uint16_t, uint16_t>>> pair_counts;
-            std::unordered_map<uint32_t, std::unordered_set<uint32_t>> where_to_update;
-
-            // Count initial pairs
-            for (uint32_t i = 0; i < segments.size(); i++) {
-                countInSegment(segments[i], i, segment_counts[i], pair_counts, where_to_update);
-            }
-
-            // Main training loop
-            size_t merges_performed = 0;
-
-            for (size_t merge_idx = 0; merge_idx < num_merges; merge_idx++) {
-                // Find most frequent pair
-                int32_t max_count = 0;
-                std::pair<uint16_t, uint16_t> max_pair = findMaxPair(pair_counts, max_count);
-
-                if (max_count <= 0) {
-                    if (verbose) {
-                        std::cout << "\nNo more pairs to merge at iteration " << merge_idx << std::endl;
-                    }
-                    break;
-                }
-
-                uint16_t new_token = BPE_BASE_VOCAB_SIZE + merge_idx;
-
-                // Create merge entry
-                Merge m;
-                m.token_id = new_token;
-                m.left = max_pair.first;
-                m.right = max_pair.second;
-
-                // Build pattern for new token
-                m.pattern = merges[max_pair.first].pattern;
-                const auto& right_pattern = merges[max_pair.second].pattern;
-                m.pattern.insert(m.pattern.end(), right_pattern.begin(), right_pattern.end());
-
-                merges.push_back(m);
-
-                // Store mapping for fast encoding
-                uint32_t pair_key = (static_cast<uint32_t>(max_pair.first) << 16) | max_pair.second;
-
-                if (verbose && (merge_idx % 1000 == 0 || merge_idx < 10)) {
-                    std::cout << "Merge " << merge_idx << ": (" << max_pair.first << ", " << max_pair.second
-                        << ") -> " << new_token << " (occurrences: " << max_count
-                        << ", pattern length: " << m.pattern.size() << ")" << std::endl;
-                }
-
-                // Apply merge to all affected segments
-                auto affected_segments = where_to_update[pair_key];
-                applyMerge(max_pair, new_token, segments, segment_counts, affected_segments,
-                    pair_counts, where_to_update);
-
-                // Clear this pair's count
-                pair_counts[pair_key].first = 0;
-
-                merges_performed++;
-            }
-
-            // Update vocabulary size: base + special tokens + actual merges performed
-            vocab_size = merges.size() + special_token_list.size();
-            initialize_special_tokens();
+            train_impl(text, max_vocab_size, max_bytes, verbose, nullptr);
+        }
 
-            if (verbose) {
-                std::cout << "\nTraining complete!" << std::endl;
-                std::cout << "Base vocabulary: " << BPE_BASE_VOCAB_SIZE << " tokens" << std::endl;
-                std::cout << "Merges performed: " << merges_performed << std::endl;
-                std::cout << "Special tokens: " << special_token_list.size() << " tokens" << std::endl;
-                std::cout << "Total vocabulary size: " << vocab_size << std::endl;
-            }
+        // Train the tokenizer on input data using the threads in tp
+        void train(const std::string& text, size_t max_vocab_size, thread_pool& tp, size_t max_bytes = 0, bool verbose = false)
+        {
+            train_impl(text, max_vocab_size, max_bytes, verbose, &tp);
         }
 
         // Encode text into tokens
         std::vector<int> encode(const std::string& text) const
         {
-            if (text.empty()) return {};
-
-            // Convert to initial tokens
             std::vector<int> tokens;
-            tokens.reserve(text.size());
-            for (unsigned char byte : text) {
-                tokens.push_back(static_cast<int>(byte));
-            }
-
-            // Apply all merges in order
-            for (size_t merge_idx = BPE_BASE_VOCAB_SIZE; merge_idx < merges.size(); merge_idx++) {
-                const Merge& m = merges[merge_idx];
+            if (text.empty()) return tokens;
 
-                std::vector<int> new_tokens;
-                new_tokens.reserve(tokens.size());
-
-                for (size_t i = 0; i < tokens.size(); ) {
-                    if (i < tokens.size() - 1 && tokens[i] == m.left && tokens[i + 1] == m.right) {
-                        new_tokens.push_back(m.token_id);
-                        i += 2;
-                    }
-                    else {
-                        new_tokens.push_back(tokens[i]);
-                        i++;
-                    }
-                }
+            tokens.reserve(text.size());
+            encode_segments(reinterpret_cast<const uint8_t*>(text.data()),
+                reinterpret_cast<const uint8_t*>(text.data()) + text.size(), tokens);
+            return tokens;
+        }
 
-                tokens = std::move(new_tokens);
+        // Encode a large text by splitting it into chunks encoded in parallel
+        std::vector<int> encode(const std::string& text, thread_pool& tp) const
+        {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(text.data());
+            const size_t size = text.size();
+
+            // Cut the text into roughly equal chunks, each ending right after a segment
+            // delimiter so that no segment is split between two chunks.
+            const size_t min_chunk_size = 1 << 16;
+            const size_t num_chunks = std::max<size_t>(1,
+                std::min<size_t>(tp.num_threads_in_pool() * 4, size / min_chunk_size));
+            std::vector<size_t> bounds(1, 0);
+            for (size_t c = 1; c < num_chunks; ++c) {
+                size_t pos = std::max(bounds.back(), c * size / num_chunks);
+                while (pos < size && !is_segment_delimiter(data[pos])) ++pos;
+                if (pos < size) ++pos;
+                if (pos > bounds.back() && pos < size) bounds.push_back(pos);
             }
+            bounds.push_back(size);
+
+            std::vector<std::vector<int>> chunk_tokens(bounds.size() - 1);
+            parallel_for(tp, 0, chunk_tokens.size(), [&](long c) {
+                chunk_tokens[c].reserve(bounds[c + 1] - bounds[c]);
+                encode_segments(data + bounds[c], data + bounds[c + 1], chunk_tokens[c]);
+            }, 1);
 
+            size_t total = 0;
+            for (const auto& t : chunk_tokens) total += t.size();
+            std::vector<int> tokens;
+            tokens.reserve(total);
+            for (const auto& t : chunk_tokens) tokens.insert(tokens.end(), t.begin(), t.end());
             return tokens;
         }
 
+        // Encode a batch of texts in parallel
+        std::vector<std::vector<int>> encode(const std::vector<std::string>& texts, thread_pool& tp) const
+        {
+            std::vector<std::vector<int>> results(texts.size());
+            parallel_for(tp, 0, texts.size(), [&](long i) {
+                results[i] = encode(texts[i]);
+            });
+            return results;
+        }
+
         // Decode tokens back to text
         std::string decode(const std::vector<int>& tokens, bool display_special_tokens = true) const
         {
@@ -308,6 +222,7 @@ namespace dlib
 
             // Initialize special tokens
             item.initialize_special_tokens();
+            item.build_merge_ranks();
         }
 
     private:
@@ -335,6 +250,10 @@ namespace dlib
         size_t vocab_size;
         std::vector<Merge> merges;
 
+        // Maps a pair of adjacent tokens to the index in merges of the merge that
+        // combines them.  Lower indices are applied first when encoding.
+        std::unordered_map<uint64_t, int> merge_ranks;
+
         // Special tokens handling
         std::map<std::string, int> special_tokens;
         std::unordered_map<int, std::string> special_token_map;
@@ -354,127 +273,488 @@ namespace dlib
             }
         }
 
-        // Segment-based training functions from BPETokenizer
-        void tokenize(const std::vector<uint8_t>& data,
-            std::vector<std::list<uint16_t>>& segments,
-            std::vector<uint32_t>& segment_counts)
+        static uint64_t pair_key(int left, int right)
+        {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(left)) << 32) | static_cast<uint32_t>(right);
+        }
+
+        static bool is_segment_delimiter(uint8_t byte)
+        {
+            return byte == ' ' || byte == '\n' || byte == '\t' || byte == '\r';
+        }
+
+        void build_merge_ranks()
+        {
+            merge_ranks.clear();
+            merge_ranks.reserve(merges.size());
+            for (size_t i = BPE_BASE_VOCAB_SIZE; i < merges.size(); ++i)
+                merge_ranks.emplace(pair_key(merges[i].left, merges[i].right), static_cast<int>(i));
+        }
+
+        int get_merge_rank(int left, int right) const
         {
-            segments.clear();
-            segment_counts.clear();
+            auto it = merge_ranks.find(pair_key(left, right));
+            return it != merge_ranks.end() ? it->second : -1;
+        }
 
-            // Split on whitespace and newlines to create meaningful segments
-            std::list<uint16_t> current_segment;
+        struct merge_candidate
+        {
+            int rank;
+            int pos;
+            // Orders a max-heap so that its top is the lowest rank, leftmost pair.
+            bool operator<(const merge_candidate& item) const
+            {
+                return rank > item.rank || (rank == item.rank && pos > item.pos);
+            }
+        };
+
+        struct encode_scratch
+        {
+            std::vector<int> tokens, next, prev;
+            std::vector<merge_candidate> heap;
+            std::unordered_map<std::string, std::vector<int>> cache;
+        };
 
-            for (size_t i = 0; i < data.size(); i++) {
-                uint8_t byte = data[i];
+        // Encodes [begin, end), segment by segment.  Training never lets a merge cross a
+        // segment delimiter so the result is the same as encoding the text as a whole.
+        void encode_segments(const uint8_t* begin, const uint8_t* end, std::vector<int>& tokens) const
+        {
+            encode_scratch scratch;
+            const uint8_t* segment = begin;
+            for (const uint8_t* p = begin; p != end; ++p) {
+                if (is_segment_delimiter(*p)) {
+                    encode_segment(segment, p, tokens, scratch);
+                    tokens.push_back(*p);
+                    segment = p + 1;
+                }
+            }
+            encode_segment(segment, end, tokens, scratch);
+        }
+
+        void encode_segment(const uint8_t* begin, const uint8_t* end, std::vector<int>& tokens, encode_scratch& s) const
+        {
+            const int n = static_cast<int>(end - begin);
+            if (n == 0) return;
+            if (n == 1 || merge_ranks.empty()) {
+                tokens.insert(tokens.end(), begin, end);
+                return;
+            }
 
-                // Split on whitespace and newlines
-                if (byte == ' ' || byte == '\n' || byte == '\t' || byte == '\r') {
-                    if (!current_segment.empty()) {
-                        segments.push_back(current_segment);
-                        segment_counts.push_back(1);
-                        current_segment.clear();
+            // Words repeat a lot in natural text so remember the ones already encoded.
+            std::string key(reinterpret_cast<const char*>(begin), n);
+            auto cached = s.cache.find(key);
+            if (cached != s.cache.end()) {
+                tokens.insert(tokens.end(), cached->second.begin(), cached->second.end());
+                return;
+            }
+
+            // Tokens are kept in a linked list over an array so merging two tokens is
+            // O(1), and the candidate merges are kept in a heap ordered by merge rank.
+            // Stale heap entries are discarded when popped.
+            s.tokens.assign(begin, end);
+            s.next.resize(n);
+            s.prev.resize(n);
+            s.heap.clear();
+            for (int i = 0; i < n; ++i) {
+                s.next[i] = i + 1;
+                s.prev[i] = i - 1;
+            }
+            for (int i = 0; i + 1 < n; ++i) {
+                const int rank = get_merge_rank(s.tokens[i], s.tokens[i + 1]);
+                if (rank >= 0) s.heap.push_back({ rank, i });
+            }
+            std::make_heap(s.heap.begin(), s.heap.end());
+
+            while (!s.heap.empty()) {
+                std::pop_heap(s.heap.begin(), s.heap.end());
+                const merge_candidate c = s.heap.back();
+                s.heap.pop_back();
+
+                const int i = c.pos;
+                const int j = s.next[i];
+                if (s.tokens[i] < 0 || j >= n || get_merge_rank(s.tokens[i], s.tokens[j]) != c.rank)
+                    continue;
+
+                s.tokens[i] = merges[c.rank].token_id;
+                s.tokens[j] = -1;
+                s.next[i] = s.next[j];
+                if (s.next[i] < n) s.prev[s.next[i]] = i;
+
+                if (s.prev[i] >= 0) {
+                    const int rank = get_merge_rank(s.tokens[s.prev[i]], s.tokens[i]);
+                    if (rank >= 0) {
+                        s.heap.push_back({ rank, s.prev[i] });
+                        std::push_heap(s.heap.begin(), s.heap.end());
                     }
-                    // Add the delimiter as its own segment
-                    segments.push_back({ static_cast<uint16_t>(byte) });
-                    segment_counts.push_back(1);
                 }
-                else {
-                    current_segment.push_back(static_cast<uint16_t>(byte));
+                if (s.next[i] < n) {
+                    const int rank = get_merge_rank(s.tokens[i], s.tokens[s.next[i]]);
+                    if (rank >= 0) {
+                        s.heap.push_back({ rank, i });
+                        std::push_heap(s.heap.begin(), s.heap.end());
+                    }
                 }
             }
 
-            // Add the last segment if not empty
-            if (!current_segment.empty()) {
-                segments.push_back(current_segment);
-                segment_counts.push_back(1);
-            }
+            const size_t first = tokens.size();
+            for (int i = 0; i < n; i = s.next[i])
+                tokens.push_back(s.tokens[i]);
+            s.cache.emplace(std::move(key), std::vector<int>(tokens.begin() + first, tokens.end()));
         }
 
-        // Count pairs in a segment and update global pair counts
-        void countInSegment(const std::list<uint16_t>& segment, uint32_t segment_idx,
-            int32_t count_delta,
-            std::unordered_map<uint32_t, std::pair<int32_t, std::pair<uint16_t, uint16_t>>>& pair_counts,
-            std::unordered_map<uint32_t, std::unordered_set<uint32_t>>& where_to_update)
+        // Training data: the distinct words of the training text stored back to back in a
+        // single array.  Word i occupies symbols[offset[i]], ..., symbols[offset[i]+length[i]-1]
+        // and appears count[i] times in the text.  Words shrink in place as merges are applied.
+        struct bpe_training_words
         {
-            if (segment.size() < 2) return;
+            std::vector<uint16_t> symbols;
+            std::vector<size_t> offset;
+            std::vector<uint32_t> length;
+            std::vector<int64_t> count;
 
-            auto it = segment.begin();
-            uint16_t prev_token = *it;
-            ++it;
+            size_t size() const { return offset.size(); }
+        };
 
-            while (it != segment.end()) {
-                uint16_t curr_token = *it;
-                uint32_t pair_key = (static_cast<uint32_t>(prev_token) << 16) | curr_token;
+        struct pair_stats
+        {
+            int64_t count = 0;
+            // Words that contain, or used to contain, this pair.  May hold duplicates.
+            std::vector<uint32_t> words;
+        };
+        using pair_count_map = std::unordered_map<uint32_t, pair_stats>;
 
-                auto& entry = pair_counts[pair_key];
-                entry.first += count_delta;
-                entry.second = { prev_token, curr_token };
+        struct pair_candidate
+        {
+            int64_t count;
+            uint32_t key;
+            // Orders a max-heap by count, breaking ties in favor of the smallest pair.
+            bool operator<(const pair_candidate& item) const
+            {
+                return count < item.count || (count == item.count && key > item.key);
+            }
+        };
 
-                if (count_delta > 0) {
-                    where_to_update[pair_key].insert(segment_idx);
-                }
-                else {
-                    where_to_update[pair_key].erase(segment_idx);
+        // Returns how many shards to split work items into, giving each at least
+        // min_shard_size items since smaller jobs aren't worth handing to a thread pool.
+        static long num_shards(thread_pool* tp, size_t work, size_t min_shard_size = 1024)
+        {
+            if (!tp) return 1;
+            return std::max<long>(1, std::min<long>(tp->num_threads_in_pool(), work / min_shard_size));
+        }
+
+        // Calls f(shard, begin, end) for num_shards contiguous subranges of [0, n).
+        template <typename F>
+        static void for_each_shard(thread_pool* tp, long shards, size_t n, F&& f)
+        {
+            if (shards == 1) {
+                f(0, 0, n);
+                return;
+            }
+            parallel_for(*tp, 0, shards, [&](long k) {
+                f(k, n * k / shards, n * (k + 1) / shards);
+            }, 1);
+        }
+
+        void count_words(const std::vector<uint8_t>& data, bpe_training_words& words, thread_pool* tp)
+        {
+            // Split the data on segment delimiters so no word straddles two shards.
+            const long shards = num_shards(tp, data.size(), 1 << 16);
+            std::vector<size_t> bounds(1, 0);
+            for (long k = 1; k < shards; ++k) {
+                size_t pos = std::max(bounds.back(), data.size() * k / shards);
+                while (pos < data.size() && !is_segment_delimiter(data[pos])) ++pos;
+                bounds.push_back(pos);
+            }
+            bounds.push_back(data.size());
+
+            std::vector<std::unordered_map<std::string, int64_t>> shard_counts(shards);
+            for_each_shard(tp, shards, shards, [&](long, size_t kb, size_t ke) {
+                for (size_t k = kb; k < ke; ++k) {
+                    auto& counts = shard_counts[k];
+                    const char* begin = reinterpret_cast<const char*>(data.data());
+                    size_t start = bounds[k];
+                    for (size_t i = bounds[k]; i <= bounds[k + 1]; ++i) {
+                        if (i == bounds[k + 1] || is_segment_delimiter(data[i])) {
+                            // Delimiters are single byte segments so they never form pairs.
+                            if (i - start >= 2) ++counts[std::string(begin + start, i - start)];
+                            start = i + 1;
+                        }
+                    }
                 }
+            });
+
+            for (long k = 1; k < shards; ++k) {
+                for (const auto& entry : shard_counts[k])
+                    shard_counts[0][entry.first] += entry.second;
+                shard_counts[k].clear();
+            }
 
-                prev_token = curr_token;
-                ++it;
+            // Sort the words so training doesn't depend on the hash table layout.
+            std::vector<std::pair<std::string, int64_t>> sorted(shard_counts[0].begin(), shard_counts[0].end());
+            shard_counts[0].clear();
+            std::sort(sorted.begin(), sorted.end());
+
+            size_t total = 0;
+            for (const auto& w : sorted) total += w.first.size();
+            words.symbols.clear();
+            words.symbols.reserve(total);
+            words.offset.resize(sorted.size());
+            words.length.resize(sorted.size());
+            words.count.resize(sorted.size());
+            for (size_t i = 0; i < sorted.size(); ++i) {
+                words.offset[i] = words.symbols.size();
+                words.length[i] = sorted[i].first.size();
+                words.count[i] = sorted[i].second;
+                for (unsigned char byte : sorted[i].first)
+                    words.symbols.push_back(byte);
             }
         }
 
-        // Find the most frequent pair
-        std::pair<uint16_t, uint16_t> findMaxPair(
-            const std::unordered_map<uint32_t, std::pair<int32_t, std::pair<uint16_t, uint16_t>>>& pair_counts,
-            int32_t& max_count)
+        static uint32_t training_pair_key(uint16_t left, uint16_t right)
         {
-            max_count = 0;
-            std::pair<uint16_t, uint16_t> max_pair = { 0, 0 };
+            return (static_cast<uint32_t>(left) << 16) | right;
+        }
 
-            for (const auto& entry : pair_counts) {
-                int32_t count = entry.second.first;
-                const auto& pair = entry.second.second;
+        void count_pairs(const bpe_training_words& words, pair_count_map& pair_counts, thread_pool* tp)
+        {
+            const long shards = num_shards(tp, words.size());
+            std::vector<pair_count_map> shard_counts(shards);
+            for_each_shard(tp, shards, words.size(), [&](long k, size_t begin, size_t end) {
+                auto& counts = shard_counts[k];
+                for (size_t w = begin; w < end; ++w) {
+                    const uint16_t* sym = &words.symbols[words.offset[w]];
+                    for (uint32_t i = 0; i + 1 < words.length[w]; ++i) {
+                        auto& entry = counts[training_pair_key(sym[i], sym[i + 1])];
+                        entry.count += words.count[w];
+                        if (entry.words.empty() || entry.words.back() != w)
+                            entry.words.push_back(w);
+                    }
+                }
+            });
+
+            pair_counts.swap(shard_counts[0]);
+            for (long k = 1; k < shards; ++k) {
+                for (auto& entry : shard_counts[k]) {
+                    auto& dest = pair_counts[entry.first];
+                    dest.count += entry.second.count;
+                    dest.words.insert(dest.words.end(), entry.second.words.begin(), entry.second.words.end());
+                }
+                shard_counts[k].clear();
+            }
+        }
 
-                if (count > max_count || (count == max_count && pair < max_pair)) {
-                    max_count = count;
-                    max_pair = pair;
+        // Apply a merge to all affected words
+        void apply_merge(const std::pair<uint16_t, uint16_t>& merge_pair, uint16_t new_token_id,
+            bpe_training_words& words,
+            std::vector<uint32_t>& affected_words,
+            pair_count_map& pair_counts,
+            std::vector<pair_candidate>& heap,
+            thread_pool* tp)
+        {
+            std::sort(affected_words.begin(), affected_words.end());
+            affected_words.erase(std::unique(affected_words.begin(), affected_words.end()), affected_words.end());
+
+            // Each shard rewrites its own words and records the resulting changes to the
+            // pair counts, which are then combined on this thread.
+            const long shards = num_shards(tp, affected_words.size());
+            std::vector<pair_count_map> shard_deltas(shards);
+            for_each_shard(tp, shards, affected_words.size(), [&](long k, size_t begin, size_t end) {
+                auto& deltas = shard_deltas[k];
+                for (size_t a = begin; a < end; ++a) {
+                    const uint32_t w = affected_words[a];
+                    uint16_t* sym = &words.symbols[words.offset[w]];
+                    const uint32_t len = words.length[w];
+                    const int64_t count = words.count[w];
+
+                    // Stale entries in a pair's word list can point to words that no longer
+                    // contain the pair.
+                    bool found = false;
+                    for (uint32_t i = 0; i + 1 < len && !found; ++i)
+                        found = sym[i] == merge_pair.first && sym[i + 1] == merge_pair.second;
+                    if (!found) continue;
+
+                    // Remove the pairs of the old word, merge, then add the pairs of the new word.
+                    for (uint32_t i = 0; i + 1 < len; ++i)
+                        deltas[training_pair_key(sym[i], sym[i + 1])].count -= count;
+
+                    uint32_t new_len = 0;
+                    for (uint32_t i = 0; i < len; ) {
+                        if (i + 1 < len && sym[i] == merge_pair.first && sym[i + 1] == merge_pair.second) {
+                            sym[new_len++] = new_token_id;
+                            i += 2;
+                        }
+                        else {
+                            sym[new_len++] = sym[i++];
+                        }
+                    }
+                    words.length[w] = new_len;
+
+                    for (uint32_t i = 0; i + 1 < new_len; ++i) {
+                        auto& entry = deltas[training_pair_key(sym[i], sym[i + 1])];
+                        entry.count += count;
+                        if (entry.words.empty() || entry.words.back() != w)
+                            entry.words.push_back(w);
+                    }
+                }
+            });
+
+            const uint32_t merged_key = training_pair_key(merge_pair.first, merge_pair.second);
+            std::vector<uint32_t> changed;
+            for (auto& deltas : shard_deltas) {
+                for (auto& entry : deltas) {
+                    if (entry.first == merged_key || (entry.second.count == 0 && entry.second.words.empty()))
+                        continue;
+                    auto& dest = pair_counts[entry.first];
+                    dest.count += entry.second.count;
+                    dest.words.insert(dest.words.end(), entry.second.words.begin(), entry.second.words.end());
+                    changed.push_back(entry.first);
                 }
             }
 
-            return max_pair;
+            // Push the updated counts, the old heap entries for these pairs are now stale.
+            std::sort(changed.begin(), changed.end());
+            changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+            for (uint32_t key : changed) {
+                auto it = pair_counts.find(key);
+                if (it->second.count > 0) {
+                    heap.push_back({ it->second.count, key });
+                    std::push_heap(heap.begin(), heap.end());
+                }
+                else {
+                    pair_counts.erase(it);
+                }
+            }
         }
 
-        // Apply a merge to all affected segments
-        void applyMerge(const std::pair<uint16_t, uint16_t>& merge_pair, uint16_t new_token_id,
-            std::vector<std::list<uint16_t>>& segments,
-            const std::vector<uint32_t>& segment_counts,
-            const std::unordered_set<uint32_t>& affected_segments,
-            std::unordered_map<uint32_t, std::pair<int32_t, std::pair<uint16_t, uint16_t>>>& pair_counts,
-            std::unordered_map<uint32_t, std::unordered_set<uint32_t>>& where_to_update)
+        // Trains the tokenizer, sharding the work over tp when it isn't null.
+        void train_impl(const std::string& text, size_t max_vocab_size, size_t max_bytes, bool verbose, thread_pool* tp)
         {
-            for (uint32_t segment_idx : affected_segments) {
-                auto& segment = segments[segment_idx];
-                int32_t count = segment_counts[segment_idx];
-
-                // Remove old pair counts for this segment
-                countInSegment(segment, segment_idx, -count, pair_counts, where_to_update);
-
-                // Apply merge in this segment
-                auto it = segment.begin();
-                while (it != segment.end()) {
-                    auto next_it = std::next(it);
-                    if (next_it != segment.end() && *it == merge_pair.first && *next_it == merge_pair.second) {
-                        *it = new_token_id;
-                        segment.erase(next_it);
-                        // Don't increment it, check the same position again
+            if (text.empty()) return;
+
+            // Convert text to bytes
+            std::vector<uint8_t> data(text.begin(), text.end());
+            if (max_bytes > 0 && data.size() > max_bytes) data.resize(max_bytes);
+
+            // Calculate available merges (reserving space for special tokens)
+            size_t num_merges = max_vocab_size - BPE_BASE_VOCAB_SIZE - special_token_list.size();
+
+            if (num_merges <= 0) {
+                if (verbose) {
+                    std::cout << "Warning: max_vocab_size too small for any merges. Need at least "
+                        << (BPE_BASE_VOCAB_SIZE + special_token_list.size() + 1) << " tokens." << std::endl;
+                }
+                return;
+            }
+
+            if (verbose) {
+                std::cout << "Training BPE tokenizer on " << data.size() << " bytes..." << std::endl;
+                std::cout << "Target vocabulary size: " << max_vocab_size << std::endl;
+                std::cout << "Base vocabulary: " << BPE_BASE_VOCAB_SIZE << " tokens" << std::endl;
+                std::cout << "Special tokens: " << special_token_list.size() << " tokens" << std::endl;
+                std::cout << "Available merges: " << num_merges << std::endl;
+            }
+
+            // Reset merges beyond base vocabulary
+            merges.clear();
+            for (int i = 0; i < BPE_BASE_VOCAB_SIZE; ++i) {
+                Merge m;
+                m.token_id = i;
+                m.left = i;
+                m.right = i;
+                m.pattern.push_back(static_cast<uint8_t>(i));
+                merges.push_back(m);
+            }
+
+            // Count the distinct words (whitespace separated segments) of the text.  Every
+            // occurrence of a word merges the same way, so each is stored once along with
+            // its frequency.
+            bpe_training_words words;
+            count_words(data, words, tp);
+
+            if (verbose) {
+                std::cout << "Created " << words.size() << " distinct segments for training" << std::endl;
+            }
+
+            // Count initial pairs
+            pair_count_map pair_counts;
+            count_pairs(words, pair_counts, tp);
+            std::vector<pair_candidate> heap;
+            heap.reserve(pair_counts.size());
+            for (const auto& entry : pair_counts)
+                heap.push_back({ entry.second.count, entry.first });
+            std::make_heap(heap.begin(), heap.end());
+
+            // Main training loop
+            size_t merges_performed = 0;
+
+            for (size_t merge_idx = 0; merge_idx < num_merges; merge_idx++) {
+                // Find most frequent pair.  Counts change as merges are applied and the
+                // heap isn't updated in place, so discard entries that are out of date.
+                int64_t max_count = 0;
+                uint32_t max_key = 0;
+                while (!heap.empty()) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    const pair_candidate c = heap.back();
+                    heap.pop_back();
+                    auto it = pair_counts.find(c.key);
+                    if (it != pair_counts.end() && it->second.count == c.count && c.count > 0) {
+                        max_count = c.count;
+                        max_key = c.key;
+                        break;
                     }
-                    else {
-                        ++it;
+                }
+
+                if (max_count <= 0) {
+                    if (verbose) {
+                        std::cout << "\nNo more pairs to merge at iteration " << merge_idx << std::endl;
                     }
+                    break;
+                }
+
+                const std::pair<uint16_t, uint16_t> max_pair(max_key >> 16, max_key & 0xFFFF);
+                uint16_t new_token = BPE_BASE_VOCAB_SIZE + merge_idx;
+
+                // Create merge entry
+                Merge m;
+                m.token_id = new_token;
+                m.left = max_pair.first;
+                m.right = max_pair.second;
+
+                // Build pattern for new token
+                m.pattern = merges[max_pair.first].pattern;
+                const auto& right_pattern = merges[max_pair.second].pattern;
+                m.pattern.insert(m.pattern.end(), right_pattern.begin(), right_pattern.end());
+
+                merges.push_back(m);
+
+                if (verbose && (merge_idx % 1000 == 0 || merge_idx < 10)) {
+                    std::cout << "Merge " << merge_idx << ": (" << max_pair.first << ", " << max_pair.second
+                        << ") -> " << new_token << " (occurrences: " << max_count
+                        << ", pattern length: " << m.pattern.size() << ")" << std::endl;
                 }
 
-                // Add new pair counts for this segment
-                countInSegment(segment, segment_idx, count, pair_counts, where_to_update);
+                // Apply merge to all affected words
+                std::vector<uint32_t> affected_words;
+                affected_words.swap(pair_counts[max_key].words);
+                apply_merge(max_pair, new_token, words, affected_words, pair_counts, heap, tp);
+
+                // Clear this pair's count
+                pair_counts.erase(max_key);
+
+                merges_performed++;
+            }
+
+            // Update vocabulary size: base + special tokens + actual merges performed
+            vocab_size = merges.size() + special_token_list.size();
+            initialize_special_tokens();
+            build_merge_ranks();
+
+            if (verbose) {
+                std::cout << "\nTraining complete!" << std::endl;
+                std::cout << "Base vocabulary: " << BPE_BASE_VOCAB_SIZE << " tokens" << std::endl;
+                std::cout << "Merges performed: " << merges_performed << std::endl;
+                std::cout << "Special tokens: " << special_token_list.size() << " tokens" << std::endl;
+                std::cout << "Total vocabulary size: " << vocab_size << std::endl;
             }
         }
     };
@@ -65,6 +65,25 @@ namespace dlib
                   of size `vocab_size`.
                 - If max_bytes==0, uses entire text.
                 - If `verbose` is true, progress information is printed to the standard output.
+                - Each distinct whitespace separated segment of the text is stored only once,
+                  together with its number of occurrences, so training time and memory scale
+                  with the number of distinct words rather than the size of the text.
+        !*/
+
+        void train(
+            const std::string& text,
+            size_t vocab_size,
+            thread_pool& tp,
+            size_t max_bytes = 0,
+            bool verbose = false
+        );
+        /*!
+            requires
+                - vocab_size >= 256
+            ensures
+                - Performs the same training as train(text, vocab_size, max_bytes, verbose) and
+                  learns exactly the same merges.  However, counting the words and pairs of
+                  tokens, as well as applying each merge, is split across the threads in tp.
         !*/
 
         std::vector<int> encode(
@@ -75,6 +94,31 @@ namespace dlib
                 - Encodes the input text into a sequence of subword tokens.
                 - Special tokens are automatically added to mark the beginning and end of paragraphs.
                 - Returns a vector of token IDs representing the encoded text.
+                - The text is encoded one whitespace separated segment at a time.  Within a
+                  segment, the adjacent pair of tokens with the earliest learned merge is
+                  merged first (leftmost first on ties) using a priority queue, so encoding
+                  runs in O(N log N) time rather than O(N * number of merges).
+        !*/
+
+        std::vector<int> encode(
+            const std::string& text,
+            thread_pool& tp
+        ) const;
+        /*!
+            ensures
+                - returns encode(text).  However, the text is split into chunks on segment
+                  boundaries and the chunks are encoded in parallel using the threads in tp.
+                  This is useful for encoding large training corpora.
+        !*/
+
+        std::vector<std::vector<int>> encode(
+            const std::vector<std::string>& texts,
+            thread_pool& tp
+        ) const;
+        /*!
+            ensures
+                - returns a vector R such that R.size() == texts.size() and R[i] == encode(texts[i]).
+                - The texts are encoded in parallel using the threads in tp.
         !*/
 
         std::string decode(